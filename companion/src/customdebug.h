@@ -27,8 +27,9 @@
 #if defined(DEBUG_STORAGE_IMPORT)
   inline QDebug eepromImportDebug() { return QDebug(QtDebugMsg); }
 #else
+  // the message is not even built when the debug output is disabled
   #undef eepromImportDebug
-  inline QNoDebug eepromImportDebug() { return QNoDebug(); }
+  #define eepromImportDebug() while (false) QNoDebug()
 #endif
 
 
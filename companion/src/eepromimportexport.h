@@ -22,7 +22,144 @@
 #define _EEPROMIMPORTEXPORT_H_
 
 #include "customdebug.h"
-#include <QBitArray>
+#include <QByteArray>
+#include <QVector>
+#include <algorithm>
+#include <vector>
+
+// Bits are stored LSB first, a field starts right after the previous one
+class ExportBuffer {
+  public:
+    ExportBuffer():
+      offset(0)
+    {
+    }
+
+    unsigned int bitsCount() const
+    {
+      return offset;
+    }
+
+    // count <= 32
+    void writeBits(unsigned int value, unsigned int count)
+    {
+      reserve(count);
+      uint8_t * data = (uint8_t *)buffer.data();
+      while (count > 0) {
+        unsigned int shift = offset % 8;
+        if (shift == 0 && count >= 8) {
+          data[offset / 8] = value;
+          value >>= 8;
+          offset += 8;
+          count -= 8;
+        }
+        else {
+          unsigned int n = std::min(8 - shift, count);
+          data[offset / 8] |= (value & ((1 << n) - 1)) << shift;
+          value >>= n;
+          offset += n;
+          count -= n;
+        }
+      }
+    }
+
+    void writeBytes(const char * bytes, unsigned int count)
+    {
+      if (offset % 8 == 0) {
+        reserve(count * 8);
+        memcpy(buffer.data() + offset / 8, bytes, count);
+        offset += count * 8;
+      }
+      else {
+        for (unsigned int i=0; i<count; i++) {
+          writeBits((uint8_t)bytes[i], 8);
+        }
+      }
+    }
+
+    void writeZeros(unsigned int count)
+    {
+      // the buffer is already cleared
+      reserve(count);
+      offset += count;
+    }
+
+    const QByteArray & bytes()
+    {
+      buffer.resize((offset + 7) / 8);
+      return buffer;
+    }
+
+  protected:
+    void reserve(unsigned int count)
+    {
+      int size = (offset + count + 7) / 8;
+      if (size > buffer.size()) {
+        int previous = buffer.size();
+        buffer.resize(std::max(size, 2 * previous + 64));
+        memset(buffer.data() + previous, 0, buffer.size() - previous);
+      }
+    }
+
+    QByteArray buffer;
+    unsigned int offset;
+};
+
+class ImportBuffer {
+  public:
+    explicit ImportBuffer(const QByteArray & bytes):
+      data((const uint8_t *)bytes.constData()),
+      size(bytes.size() * 8),
+      offset(0)
+    {
+    }
+
+    unsigned int position() const
+    {
+      return offset;
+    }
+
+    void seek(unsigned int position)
+    {
+      offset = position;
+    }
+
+    // count <= 32, the bits after the end of the input are read as 0
+    unsigned int readBits(unsigned int count)
+    {
+      unsigned int value = 0;
+      unsigned int shift = 0;
+      while (count > 0) {
+        unsigned int bit = offset % 8;
+        unsigned int n = std::min(8 - bit, count);
+        if (offset < size) {
+          value |= ((data[offset / 8] >> bit) & ((1 << n) - 1)) << shift;
+        }
+        shift += n;
+        offset += n;
+        count -= n;
+      }
+      return value;
+    }
+
+    void readBytes(char * bytes, unsigned int count)
+    {
+      if (offset % 8 == 0 && offset + count * 8 <= size) {
+        memcpy(bytes, data + offset / 8, count);
+        offset += count * 8;
+      }
+      else {
+        for (unsigned int i=0; i<count; i++) {
+          bytes[i] = readBits(8);
+        }
+      }
+    }
+
+  protected:
+    const uint8_t * data;
+    unsigned int size;
+    unsigned int offset;
+};
 
 class DataField {
   public:
@@ -42,60 +179,46 @@ class DataField {
     }
 
     virtual unsigned int size() = 0;
-    virtual void ExportBits(QBitArray & output) = 0;
-    virtual void ImportBits(const QBitArray & input) = 0;
-
-    QBitArray bytesToBits(QByteArray bytes)
-    {
-      QBitArray bits(bytes.count()*8);
-      // Convert from QByteArray to QBitArray
-      for (int i=0; i<bytes.count(); ++i)
-        for (int b=0; b<8; ++b)
-          bits.setBit(i*8+b, bytes.at(i)&(1<<b));
-      return bits;
-    }
+    virtual void ExportBits(ExportBuffer & output) = 0;
+    virtual void ImportBits(ImportBuffer & input) = 0;
 
-    QByteArray bitsToBytes(QBitArray bits, int offset=0)
+    // false when the size depends on the data (only known once the previous fields are imported)
+    virtual bool isFixedSize()
     {
-      QByteArray bytes;
-      bytes.resize((offset+bits.count()+7)/8);
-      bytes.fill(0);
-      // Convert from QBitArray to QByteArray
-      for (int b=0; b<bits.count(); ++b)
-        bytes[(b+offset)/8] = ( bytes.at((b+offset)/8) | ((bits[b]?1:0)<<((b+offset)%8)));
-      return bytes;
+      return true;
     }
 
     int Export(QByteArray & output)
     {
-      QBitArray result;
-      ExportBits(result);
-      output = bitsToBytes(result);
+      ExportBuffer buffer;
+      ExportBits(buffer);
+      output = buffer.bytes();
       return 0;
     }
 
     int Import(const QByteArray & input)
     {
-      QBitArray bits = bytesToBits(input);
-      if ((unsigned int)bits.size() < size()) {
+      if ((unsigned int)input.size() * 8 < size()) {
         qDebug() << QString("Error importing %1: size to small %2/%3").arg(getName()).arg(input.size()).arg(size());
         return -1;
       }
-      ImportBits(bits);
+      ImportBuffer buffer(input);
+      ImportBits(buffer);
       return 0;
     }
 
     virtual int Dump(int level=0, int offset=0)
     {
-      QBitArray bits;
-      ExportBits(bits);
-      QByteArray bytes = bitsToBytes(bits);
-      int result = (offset+bits.count()) % 8;
+      ExportBuffer buffer;
+      ExportBits(buffer);
+      QByteArray bytes = buffer.bytes();
+      int count = buffer.bitsCount();
+      int result = (offset+count) % 8;
       for (int i=0; i<level; i++) printf("  ");
-      if (bits.count() % 8 == 0)
+      if (count % 8 == 0)
         printf("%s (%dbytes) ", getName(), bytes.count());
       else
-        printf("%s (%dbits) ", getName(), bits.count());
+        printf("%s (%dbits) ", getName(), count);
       for (int i=0; i<bytes.count(); i++) {
         unsigned char c = bytes[i];
         if ((i==0 && offset) || (i==bytes.count()-1 && result!=0))
@@ -160,27 +283,27 @@ class BaseUnsignedField: public DataField {
     {
     }
 
-    virtual void ExportBits(QBitArray & output)
+    virtual void ExportBits(ExportBuffer & output)
     {
       container value = field;
       if (value > max) value = max;
       if (value < min) value = min;
 
-      output.resize(N);
-      for (int i=0; i<N; i++) {
-        if (value & ((container)1<<i)) {
-          output.setBit(i);
-        }
+      // 32 bits at a time, wider fields (the X9E switches warning states) are split in words
+      uint64_t bits = (uint64_t)value;
+      for (int i=0; i<N; i+=32) {
+        output.writeBits(i < 64 ? (unsigned int)(bits >> i) : 0, std::min(N - i, 32));
       }
     }
 
-    virtual void ImportBits(const QBitArray & input)
+    virtual void ImportBits(ImportBuffer & input)
     {
-      field = 0;
-      for (int i=0; i<N; i++) {
-        if (input[i])
-          field |= ((container)1<<i);
+      uint64_t bits = 0;
+      for (int i=0; i<N; i+=32) {
+        uint64_t word = input.readBits(std::min(N - i, 32));
+        if (i < 64) bits |= word << i;
       }
+      field = (container)bits;
       eepromImportDebug() << QString("\timported %1<%2>: 0x%3(%4)").arg(name).arg(N).arg(field, 0, 16).arg(field);
     }
 
@@ -227,17 +350,14 @@ class BoolField: public DataField {
     {
     }
 
-    virtual void ExportBits(QBitArray & output)
+    virtual void ExportBits(ExportBuffer & output)
     {
-      output.resize(N);
-      if (field) {
-        output.setBit(0);
-      }
+      output.writeBits(field ? 1 : 0, N);
     }
 
-    virtual void ImportBits(const QBitArray & input)
+    virtual void ImportBits(ImportBuffer & input)
     {
-      field = input[0] ? true : false;
+      field = (input.readBits(N) & 1) ? true : false;
       eepromImportDebug() << QString("\timported %1<%2>: 0x%3(%4)").arg(name).arg(N).arg(field, 0, 16).arg(field);
     }
 
@@ -280,31 +400,20 @@ class SignedField: public DataField {
     {
     }
 
-    virtual void ExportBits(QBitArray & output)
+    virtual void ExportBits(ExportBuffer & output)
     {
       int value = field;
       if (value > max) value = max;
       if (value < min) value = min;
 
-      output.resize(N);
-      for (int i=0; i<N; i++) {
-        if (((unsigned int)value) & (1<<i))
-          output.setBit(i);
-      }
+      output.writeBits((unsigned int)value, N);
     }
 
-    virtual void ImportBits(const QBitArray & input)
+    virtual void ImportBits(ImportBuffer & input)
     {
-      unsigned int value = 0;
-      for (int i=0; i<N; i++) {
-        if (input[i])
-          value |= (1<<i);
-      }
-
-      if (input[N-1]) {
-        for (unsigned int i=N; i<8*sizeof(int); i++) {
-          value |= (1<<i);
-        }
+      unsigned int value = input.readBits(N);
+      if (N < 32 && (value & (1u << (N-1)))) {
+        value |= ~0u << (N % 32);
       }
 
       field = (int)value;
@@ -330,6 +439,17 @@ class SpareBitsField: public UnsignedField<N> {
       spare(0)
     {
     }
+
+    virtual void ExportBits(ExportBuffer & output)
+    {
+      output.writeZeros(N);
+    }
+
+    virtual void ImportBits(ImportBuffer & input)
+    {
+      input.seek(input.position() + N);
+    }
+
   protected:
     unsigned int spare;
 };
@@ -344,31 +464,16 @@ class CharField: public DataField {
     {
     }
 
-    virtual void ExportBits(QBitArray & output)
+    virtual void ExportBits(ExportBuffer & output)
     {
-      output.resize(N*8);
-      int b = 0;
-      int len = truncate ? strlen(field) : N;
-      for (int i=0; i<N; i++) {
-        int idx = (i>=len ? 0 : field[i]);
-        for (int j=0; j<8; j++, b++) {
-          if (idx & (1<<j))
-            output.setBit(b);
-        }
-      }
+      int len = truncate ? std::min<int>(strlen(field), N) : N;
+      output.writeBytes(field, len);
+      output.writeZeros((N-len)*8);
     }
 
-    virtual void ImportBits(const QBitArray & input)
+    virtual void ImportBits(ImportBuffer & input)
     {
-      unsigned int b = 0;
-      for (int i=0; i<N; i++) {
-        int8_t idx = 0;
-        for (int j=0; j<8; j++) {
-          if (input[b++])
-            idx |= (1<<j);
-        }
-        field[i] = idx;
-      }
+      input.readBytes(field, N);
       eepromImportDebug() << QString("\timported %1<%2>: '%3'").arg(name).arg(N).arg(field);
     }
 
@@ -394,30 +499,22 @@ class ZCharField: public DataField {
     {
     }
 
-    virtual void ExportBits(QBitArray & output)
+    virtual void ExportBits(ExportBuffer & output)
     {
-      output.resize(N*8);
-      int b = 0;
+      char bytes[N];
       int len = strlen(field);
       for (int i=0; i<N; i++) {
-        int idx = i>=len ? 0 : char2idx(field[i]);
-        for (int j=0; j<8; j++, b++) {
-          if (idx & (1<<j))
-            output.setBit(b);
-        }
+        bytes[i] = i>=len ? 0 : char2idx(field[i]);
       }
+      output.writeBytes(bytes, N);
     }
 
-    virtual void ImportBits(const QBitArray & input)
+    virtual void ImportBits(ImportBuffer & input)
     {
-      unsigned int b = 0;
+      char bytes[N];
+      input.readBytes(bytes, N);
       for (int i=0; i<N; i++) {
-        int8_t idx = 0;
-        for (int j=0; j<8; j++) {
-          if (input[b++])
-            idx |= (1<<j);
-        }
-        field[i] = idx2char(idx);
+        field[i] = idx2char(bytes[i]);
       }
 
       field[N] = '\0';
@@ -442,7 +539,10 @@ class ZCharField: public DataField {
 class StructField: public DataField {
   public:
     StructField(DataField * parent, const char * name="Struct"):
-      DataField(parent, name)
+      DataField(parent, name),
+      layoutValid(false),
+      fixedSize(true),
+      fixedSizeValue(0)
     {
     }
 
@@ -455,36 +555,45 @@ class StructField: public DataField {
     inline void Append(DataField * field) {
       //eepromImportDebug() << QString("StructField(%1) appending field: %2").arg(name).arg(field->getName());
       fields.append(field);
+      layoutValid = false;
     }
 
-    virtual void ExportBits(QBitArray & output)
+    virtual void ExportBits(ExportBuffer & output)
     {
-      int offset = 0;
-      output.resize(size());
       foreach(DataField *field, fields) {
-        QBitArray bits;
-        field->ExportBits(bits);
-        for (int i=0; i<bits.size(); i++)
-          output[offset++] = bits[i];
+        field->ExportBits(output);
       }
     }
 
-    virtual void ImportBits(const QBitArray & input)
+    virtual void ImportBits(ImportBuffer & input)
     {
       eepromImportDebug() << QString("\timporting %1[%2]:").arg(name).arg(fields.size());
-      int offset = 0;
-      foreach(DataField *field, fields) {
-        unsigned int size = field->size();
-        QBitArray bits(size);
-        for (unsigned int i=0; i<size; i++) {
-          bits[i] = input[offset++];
+      unsigned int start = input.position();
+      updateLayout();
+      if (fixedSize) {
+        for (int i=0; i<fields.size(); i++) {
+          input.seek(start + offsets[i]);
+          fields[i]->ImportBits(input);
+        }
+        input.seek(start + fixedSizeValue);
+      }
+      else {
+        unsigned int offset = start;
+        foreach(DataField *field, fields) {
+          unsigned int size = field->size();
+          field->ImportBits(input);
+          offset += size;
+          input.seek(offset);
         }
-        field->ImportBits(bits);
       }
     }
 
     virtual unsigned int size()
     {
+      updateLayout();
+      if (fixedSize) {
+        return fixedSizeValue;
+      }
       unsigned int result = 0;
       foreach(DataField *field, fields) {
         result += field->size();
@@ -492,6 +601,12 @@ class StructField: public DataField {
       return result;
     }
 
+    virtual bool isFixedSize()
+    {
+      updateLayout();
+      return fixedSize;
+    }
+
     virtual int Dump(int level=0, int offset=0)
     {
       for (int i=0; i<level; i++) printf("  ");
@@ -503,7 +618,28 @@ class StructField: public DataField {
     }
 
   protected:
+    // the sizes and offsets of the fields are computed once the struct is complete
+    void updateLayout()
+    {
+      if (!layoutValid) {
+        unsigned int offset = 0;
+        fixedSize = true;
+        offsets.resize(fields.size());
+        for (int i=0; i<fields.size(); i++) {
+          fixedSize = fixedSize && fields[i]->isFixedSize();
+          offsets[i] = offset;
+          offset += fields[i]->size();
+        }
+        fixedSizeValue = offset;
+        layoutValid = true;
+      }
+    }
+
     QList<DataField *> fields;
+    QVector<unsigned int> offsets;
+    bool layoutValid;
+    bool fixedSize;
+    unsigned int fixedSizeValue;
 };
 
 class TransformedField: public DataField {
@@ -518,15 +654,17 @@ class TransformedField: public DataField {
     {
     }
 
-    virtual void ExportBits(QBitArray & output)
+    virtual void ExportBits(ExportBuffer & output)
     {
+      clearState();
       beforeExport();
       field.ExportBits(output);
     }
 
-    virtual void ImportBits(const QBitArray & input)
+    virtual void ImportBits(ImportBuffer & input)
     {
       eepromImportDebug() << QString("\timporting TransformedField %1:").arg(field.getName());
+      clearState();
       field.ImportBits(input);
       afterImport();
     }
@@ -542,12 +680,24 @@ class TransformedField: public DataField {
       return field.size();
     }
 
+    virtual bool isFixedSize()
+    {
+      return field.isFixedSize();
+    }
+
     virtual void beforeExport() = 0;
 
     virtual void afterImport() = 0;
 
+    // restores the values computed from the data as the constructor left them, the fields
+    // are reused for the data of all the models (see OpenTxLayout)
+    virtual void clearState()
+    {
+    }
+
     virtual int Dump(int level=0, int offset=0)
     {
+      clearState();
       beforeExport();
       return field.Dump(level, offset);
     }
@@ -561,67 +711,74 @@ class ConversionTable {
   public:
     bool exportValue(const int before, int &after)
     {
-      after = 0;
-
-      for (std::list<ConversionTuple>::iterator it=exportTable.begin(); it!=exportTable.end(); it++) {
-        ConversionTuple tuple = *it;
-        if (before == tuple.a) {
-          after = tuple.b;
-          return true;
-        }
-      }
-
-      return false;
+      return exportTable.find(before, after);
     }
 
     bool importValue(const int before, int &after)
     {
-      after = 0;
-
-      for (std::list<ConversionTuple>::iterator it=importTable.begin(); it!=importTable.end(); it++) {
-        ConversionTuple tuple = *it;
-        if (before == tuple.b) {
-          after = tuple.a;
-          return true;
-        }
-      }
-
-      return false;
+      return importTable.find(before, after);
     }
 
   protected:
 
-    class ConversionTuple {
+    // The conversions sorted by key, the first one added wins when a key is added twice.
+    // The array is sorted on the first lookup, once the table is complete
+    class ConversionIndex {
       public:
-        ConversionTuple(const int a, const int b):
-          a(a),
-          b(b)
+        ConversionIndex():
+          sorted(true)
+        {
+        }
+
+        void add(const int key, const int value)
+        {
+          entries.push_back(std::make_pair(key, value));
+          sorted = false;
+        }
+
+        bool find(const int key, int & value)
+        {
+          if (!sorted) {
+            std::stable_sort(entries.begin(), entries.end(), compareKeys);
+            sorted = true;
+          }
+          std::vector< std::pair<int, int> >::const_iterator it = std::lower_bound(entries.begin(), entries.end(), std::make_pair(key, 0), compareKeys);
+          if (it != entries.end() && it->first == key) {
+            value = it->second;
+            return true;
+          }
+          value = 0;
+          return false;
+        }
+
+      protected:
+        static bool compareKeys(const std::pair<int, int> & a, const std::pair<int, int> & b)
         {
+          return a.first < b.first;
         }
 
-        int a;
-        int b;
+        std::vector< std::pair<int, int> > entries;
+        bool sorted;
     };
 
     void addConversion(const int a, const int b)
     {
-      ConversionTuple conversion(a, b);
-      importTable.push_back(conversion);
-      exportTable.push_back(conversion);
+      importTable.add(b, a);
+      exportTable.add(a, b);
     }
 
     void addImportConversion(const int a, const int b)
     {
-      importTable.push_back(ConversionTuple(a, b));
+      importTable.add(b, a);
     }
 
     void addExportConversion(const int a, const int b)
     {
-      exportTable.push_back(ConversionTuple(a, b));
+      exportTable.add(a, b);
     }
 
-    std::list<ConversionTuple> importTable;
-    std::list<ConversionTuple> exportTable;
+    ConversionIndex importTable;
+    ConversionIndex exportTable;
 };
 
 template<class T>
@@ -407,11 +407,52 @@ class SourcesConversionTable: public ConversionTable {
 
 std::list<SourcesConversionTable::Cache> SourcesConversionTable::internalCache;
 
-void OpenTxEepromCleanup(void)
-{
-  SourcesConversionTable::Cleanup();
-  SwitchesConversionTable::Cleanup();
-}
+// The other tables only depend on the board and the version, they are built once
+// and shared by the fields of all the models
+template <class T>
+class BoardConversionTables {
+  protected:
+    class Cache {
+      public:
+        Cache(Board::Type board, unsigned int version, T * table):
+          board(board),
+          version(version),
+          table(table)
+        {
+        }
+        Board::Type board;
+        unsigned int version;
+        T * table;
+    };
+
+    static std::list<Cache> internalCache;
+
+  public:
+    static T * getInstance(Board::Type board, unsigned int version)
+    {
+      for (typename std::list<Cache>::iterator it=internalCache.begin(); it!=internalCache.end(); it++) {
+        Cache element = *it;
+        if (element.board == board && element.version == version)
+          return element.table;
+      }
+
+      Cache element(board, version, new T(board, version));
+      internalCache.push_back(element);
+      return element.table;
+    }
+
+    static void Cleanup()
+    {
+      for (typename std::list<Cache>::iterator it=internalCache.begin(); it!=internalCache.end(); it++) {
+        Cache element = *it;
+        delete element.table;
+      }
+      internalCache.clear();
+    }
+};
+
+template <class T>
+std::list<typename BoardConversionTables<T>::Cache> BoardConversionTables<T>::internalCache;
 
 template <int N>
 class SwitchField: public ConversionField< SignedField<N> > {
@@ -542,8 +583,7 @@ template <int N>
 class TelemetrySourceField: public ConversionField< UnsignedField<N> > {
   public:
     TelemetrySourceField(DataField * parent, RawSource & source, Board::Type board, unsigned int version):
-      ConversionField< UnsignedField<N> >(parent, _source, &conversionTable, "Telemetry source"),
-      conversionTable(board, version),
+      ConversionField< UnsignedField<N> >(parent, _source, BoardConversionTables<TelemetrySourcesConversionTable>::getInstance(board, version), "Telemetry source"),
       source(source),
       board(board),
       version(version),
@@ -569,7 +609,6 @@ class TelemetrySourceField: public ConversionField< UnsignedField<N> > {
     }
 
   protected:
-    TelemetrySourcesConversionTable conversionTable;
     RawSource & source;
     Board::Type board;
     unsigned int version;
@@ -875,6 +914,13 @@ class FlightModeField: public TransformedField {
       }
     }
 
+    virtual void clearState()
+    {
+      memset(trimBase, 0, sizeof(trimBase));
+      memset(trimExt, 0, sizeof(trimExt));
+      memset(trimMode, 0, sizeof(trimMode));
+    }
+
     virtual void beforeExport()
     {
       for (int i=0; i<CPN_MAX_STICKS+MAX_AUX_TRIMS(board); i++) {
@@ -1147,6 +1193,17 @@ class MixField: public TransformedField {
       }
     }
 
+    virtual void clearState()
+    {
+      _destCh = 0;
+      _curveMode = false;
+      _curveParam = 0;
+      _weight = 0;
+      _offset = 0;
+      _weightMode = 0;
+      _offsetMode = 0;
+    }
+
     virtual void beforeExport()
     {
       if (mix.destCh && mix.srcRaw.type != SOURCE_TYPE_NONE) {
@@ -1361,6 +1418,14 @@ class InputField: public TransformedField {
       }
     }
 
+    virtual void clearState()
+    {
+      _curveMode = false;
+      _weight = 0;
+      _offset = 0;
+      _curveParam = 0;
+    }
+
     virtual void beforeExport()
     {
       _weight = smallGvarToEEPROM(expo.weight);
@@ -1548,6 +1613,12 @@ class CurvesField: public TransformedField {
       }
     }
 
+    virtual void clearState()
+    {
+      memset(_curves, 0, sizeof(_curves));
+      memset(_points, 0, sizeof(_points));
+    }
+
     virtual void beforeExport()
     {
       memset(_points, 0, sizeof(_points));
@@ -1730,23 +1801,9 @@ class AndSwitchesConversionTable: public ConversionTable {
     static ConversionTable * getInstance(Board::Type board, unsigned int version)
     {
       if (IS_ARM(board) && version >= 216)
-        return new SwitchesConversionTable(board, version);
+        return SwitchesConversionTable::getInstance(board, version);
       else
-        return new AndSwitchesConversionTable(board, version);
-
-#if 0
-      static std::list<Cache> internalCache;
-
-      for (std::list<Cache>::iterator it=internalCache.begin(); it!=internalCache.end(); it++) {
-        Cache element = *it;
-        if (element.board == board && element.version == version && element.flags == flags)
-          return element.table;
-      }
-
-      Cache element(board, version, flags, new SwitchesConversionTable(board, version, flags));
-      internalCache.push_back(element);
-      return element.table;
-#endif
+        return BoardConversionTables<AndSwitchesConversionTable>::getInstance(board, version);
     }
 
 
@@ -1768,7 +1825,7 @@ class LogicalSwitchField: public TransformedField {
       version(version),
       variant(variant),
       model(model),
-      functionsConversionTable(board, version),
+      functionsConversionTable(BoardConversionTables<LogicalSwitchesFunctionsTable>::getInstance(board, version)),
       sourcesConversionTable(SourcesConversionTable::getInstance(board, version, variant, (version >= 214 || (!IS_ARM(board) && version >= 213)) ? 0 : FLAG_NOSWITCHES)),
       switchesConversionTable(SwitchesConversionTable::getInstance(board, version)),
       andswitchesConversionTable(AndSwitchesConversionTable::getInstance(board, version)),
@@ -1777,7 +1834,7 @@ class LogicalSwitchField: public TransformedField {
       v3(0)
     {
       if (IS_ARM(board) && version >= 218) {
-        internalField.Append(new ConversionField< UnsignedField<8> >(this, csw.func, &functionsConversionTable, "Function"));
+        internalField.Append(new ConversionField< UnsignedField<8> >(this, csw.func, functionsConversionTable, "Function"));
         internalField.Append(new SignedField<10>(this, v1));
         internalField.Append(new SignedField<10>(this, v3));
         internalField.Append(new ConversionField< SignedField<9> >(this, (int &)csw.andsw, andswitchesConversionTable, "AND switch"));
@@ -1786,7 +1843,7 @@ class LogicalSwitchField: public TransformedField {
         internalField.Append(new SignedField<16>(this, v2));
       }
       else if (IS_ARM(board) && version >= 217) {
-        internalField.Append(new ConversionField< UnsignedField<6> >(this, csw.func, &functionsConversionTable, "Function"));
+        internalField.Append(new ConversionField< UnsignedField<6> >(this, csw.func, functionsConversionTable, "Function"));
         internalField.Append(new SignedField<10>(this, v1));
         internalField.Append(new SignedField<16>(this, v2));
         internalField.Append(new SignedField<16>(this, v3));
@@ -1795,25 +1852,25 @@ class LogicalSwitchField: public TransformedField {
         internalField.Append(new SignedField<8>(this, v1));
         internalField.Append(new SignedField<16>(this, v2));
         internalField.Append(new SignedField<16>(this, v3));
-        internalField.Append(new ConversionField< UnsignedField<8> >(this, csw.func, &functionsConversionTable, "Function"));
+        internalField.Append(new ConversionField< UnsignedField<8> >(this, csw.func, functionsConversionTable, "Function"));
       }
       else if (IS_ARM(board) && version >= 215) {
         internalField.Append(new SignedField<16>(this, v1));
         internalField.Append(new SignedField<16>(this, v2));
-        internalField.Append(new ConversionField< UnsignedField<8> >(this, csw.func, &functionsConversionTable, "Function"));
+        internalField.Append(new ConversionField< UnsignedField<8> >(this, csw.func, functionsConversionTable, "Function"));
       }
       else if (IS_ARM(board)) {
         internalField.Append(new SignedField<8>(this, v1));
         internalField.Append(new SignedField<8>(this, v2));
-        internalField.Append(new ConversionField< UnsignedField<8> >(this, csw.func, &functionsConversionTable, "Function"));
+        internalField.Append(new ConversionField< UnsignedField<8> >(this, csw.func, functionsConversionTable, "Function"));
       }
       else {
         internalField.Append(new SignedField<8>(this, v1));
         internalField.Append(new SignedField<8>(this, v2));
         if (version >= 213)
-          internalField.Append(new ConversionField< UnsignedField<4> >(this, csw.func, &functionsConversionTable, "Function"));
+          internalField.Append(new ConversionField< UnsignedField<4> >(this, csw.func, functionsConversionTable, "Function"));
         else
-          internalField.Append(new ConversionField< UnsignedField<8> >(this, csw.func, &functionsConversionTable, "Function"));
+          internalField.Append(new ConversionField< UnsignedField<8> >(this, csw.func, functionsConversionTable, "Function"));
       }
 
       if (IS_ARM(board)) {
@@ -1831,9 +1888,11 @@ class LogicalSwitchField: public TransformedField {
       }
     }
 
-    ~LogicalSwitchField()
+    virtual void clearState()
     {
-      delete andswitchesConversionTable;
+      v1 = 0;
+      v2 = 0;
+      v3 = 0;
     }
 
     virtual void beforeExport()
@@ -1965,7 +2024,7 @@ class LogicalSwitchField: public TransformedField {
     unsigned int version;
     unsigned int variant;
     ModelData * model;
-    LogicalSwitchesFunctionsTable functionsConversionTable;
+    LogicalSwitchesFunctionsTable * functionsConversionTable;
     SourcesConversionTable * sourcesConversionTable;
     SwitchesConversionTable * switchesConversionTable;
     ConversionTable * andswitchesConversionTable;
@@ -2135,7 +2194,7 @@ class ArmCustomFunctionField: public TransformedField {
       board(board),
       version(version),
       variant(variant),
-      functionsConversionTable(board, version),
+      functionsConversionTable(BoardConversionTables<CustomFunctionsConversionTable>::getInstance(board, version)),
       sourcesConversionTable(SourcesConversionTable::getInstance(board, version, variant, version >= 216 ? 0 : FLAG_NONONE)),
       _func(0),
       _active(0),
@@ -2145,11 +2204,11 @@ class ArmCustomFunctionField: public TransformedField {
 
       if (version >= 218) {
         internalField.Append(new SwitchField<9>(this, fn.swtch, board, version));
-        internalField.Append(new ConversionField< UnsignedField<7> >(this, _func, &functionsConversionTable, "Function", ::QObject::tr("OpenTX on this board doesn't accept this function")));
+        internalField.Append(new ConversionField< UnsignedField<7> >(this, _func, functionsConversionTable, "Function", ::QObject::tr("OpenTX on this board doesn't accept this function")));
       }
       else {
         internalField.Append(new SwitchField<8>(this, fn.swtch, board, version));
-        internalField.Append(new ConversionField< UnsignedField<8> >(this, _func, &functionsConversionTable, "Function", ::QObject::tr("OpenTX on this board doesn't accept this function")));
+        internalField.Append(new ConversionField< UnsignedField<8> >(this, _func, functionsConversionTable, "Function", ::QObject::tr("OpenTX on this board doesn't accept this function")));
       }
 
       if (IS_TARANIS(board) && version >= 216)
@@ -2177,6 +2236,14 @@ class ArmCustomFunctionField: public TransformedField {
       return (fn.func == FuncPlaySound || fn.func == FuncPlayPrompt || fn.func == FuncPlayValue || fn.func == FuncPlayHaptic);
     }
 
+    virtual void clearState()
+    {
+      _func = 0;
+      _active = 0;
+      _mode = 0;
+      memset(_param, 0, sizeof(_param));
+    }
+
     virtual void beforeExport()
     {
       if (fn.swtch.type != SWITCH_TYPE_NONE) {
@@ -2359,7 +2426,7 @@ class ArmCustomFunctionField: public TransformedField {
     Board::Type board;
     unsigned int version;
     unsigned int variant;
-    CustomFunctionsConversionTable functionsConversionTable;
+    CustomFunctionsConversionTable * functionsConversionTable;
     SourcesConversionTable * sourcesConversionTable;
     unsigned int _func;
     char _param[10];
@@ -2376,7 +2443,7 @@ class AvrCustomFunctionField: public TransformedField {
       board(board),
       version(version),
       variant(variant),
-      functionsConversionTable(board, version),
+      functionsConversionTable(BoardConversionTables<CustomFunctionsConversionTable>::getInstance(board, version)),
       sourcesConversionTable(SourcesConversionTable::getInstance(board, version, variant, version >= 216 ? 0 : FLAG_NONONE)),
       _param(0),
       _mode(0),
@@ -2385,7 +2452,7 @@ class AvrCustomFunctionField: public TransformedField {
     {
       if (version >= 217 && IS_2560(board)) {
         internalField.Append(new SwitchField<8>(this, fn.swtch, board, version));
-        internalField.Append(new ConversionField< UnsignedField<8> >(this, (unsigned int &)fn.func, &functionsConversionTable, "Function", ::QObject::tr("OpenTX on this board doesn't accept this function")));
+        internalField.Append(new ConversionField< UnsignedField<8> >(this, (unsigned int &)fn.func, functionsConversionTable, "Function", ::QObject::tr("OpenTX on this board doesn't accept this function")));
         internalField.Append(new UnsignedField<2>(this, fn.adjustMode));
         internalField.Append(new UnsignedField<4>(this, _union_param));
         internalField.Append(new UnsignedField<1>(this, _active));
@@ -2393,23 +2460,31 @@ class AvrCustomFunctionField: public TransformedField {
       }
       else if (version >= 216) {
         internalField.Append(new SwitchField<6>(this, fn.swtch, board, version));
-        internalField.Append(new ConversionField< UnsignedField<4> >(this, (unsigned int &)fn.func, &functionsConversionTable, "Function", ::QObject::tr("OpenTX on this board doesn't accept this function")));
+        internalField.Append(new ConversionField< UnsignedField<4> >(this, (unsigned int &)fn.func, functionsConversionTable, "Function", ::QObject::tr("OpenTX on this board doesn't accept this function")));
         internalField.Append(new UnsignedField<5>(this, _union_param));
         internalField.Append(new UnsignedField<1>(this, _active));
       }
       else if (version >= 213) {
         internalField.Append(new SwitchField<8>(this, fn.swtch, board, version));
         internalField.Append(new UnsignedField<3>(this, _union_param));
-        internalField.Append(new ConversionField< UnsignedField<5> >(this, (unsigned int &)fn.func, &functionsConversionTable, "Function", ::QObject::tr("OpenTX on this board doesn't accept this function")));
+        internalField.Append(new ConversionField< UnsignedField<5> >(this, (unsigned int &)fn.func, functionsConversionTable, "Function", ::QObject::tr("OpenTX on this board doesn't accept this function")));
       }
       else {
         internalField.Append(new SwitchField<8>(this, fn.swtch, board, version));
-        internalField.Append(new ConversionField< UnsignedField<7> >(this, (unsigned int &)fn.func, &functionsConversionTable, "Function", ::QObject::tr("OpenTX on this board doesn't accept this function")));
+        internalField.Append(new ConversionField< UnsignedField<7> >(this, (unsigned int &)fn.func, functionsConversionTable, "Function", ::QObject::tr("OpenTX on this board doesn't accept this function")));
         internalField.Append(new BoolField<1>(this, (bool &)fn.enabled));
       }
       internalField.Append(new UnsignedField<8>(this, _param));
     }
 
+    virtual void clearState()
+    {
+      _param = 0;
+      _mode = 0;
+      _union_param = 0;
+      _active = 0;
+    }
+
     virtual void beforeExport()
     {
       _param = fn.param;
@@ -2548,7 +2623,7 @@ class AvrCustomFunctionField: public TransformedField {
     Board::Type board;
     unsigned int version;
     unsigned int variant;
-    CustomFunctionsConversionTable functionsConversionTable;
+    CustomFunctionsConversionTable * functionsConversionTable;
     SourcesConversionTable * sourcesConversionTable;
     unsigned int _param;
     unsigned int _mode;
@@ -2612,7 +2687,7 @@ class FrskyScreenField: public DataField {
       }
     }
 
-    virtual void ExportBits(QBitArray & output)
+    virtual void ExportBits(ExportBuffer & output)
     {
       if (IS_ARM(board) && version >= 217) {
         if (screen.type == TELEMETRY_SCREEN_SCRIPT)
@@ -2632,7 +2707,7 @@ class FrskyScreenField: public DataField {
       }
     }
 
-    virtual void ImportBits(const QBitArray & input)
+    virtual void ImportBits(ImportBuffer & input)
     {
       eepromImportDebug() << QString("importing %1: type: %2").arg(name).arg(screen.type);
 
@@ -2676,6 +2751,15 @@ class FrskyScreenField: public DataField {
       }
     }
 
+    virtual bool isFixedSize()
+    {
+      // the size only depends on screen.type when the screen types have different sizes
+      if (IS_ARM(board) && version >= 217)
+        return script.size() == numbers.size() && bars.size() == numbers.size() && none.size() == numbers.size();
+      else
+        return bars.size() == numbers.size();
+    }
+
   protected:
     FrSkyScreenData & screen;
     Board::Type board;
@@ -2954,6 +3038,14 @@ class SensorField: public TransformedField {
       internalField.Append(new UnsignedField<32>(this, _param, "param"));
     }
 
+    virtual void clearState()
+    {
+      _id = 0;
+      _subid = 0;
+      _instance = 0;
+      _param = 0;
+    }
+
     virtual void beforeExport()
     {
       if (sensor.type == SensorData::TELEM_TYPE_CUSTOM) {
@@ -3450,6 +3542,12 @@ void OpenTxModelData::beforeExport()
   }
 }
 
+void OpenTxModelData::clearState()
+{
+  memset(subprotocols, 0, sizeof(subprotocols));
+  _errors.clear();
+}
+
 void OpenTxModelData::afterImport()
 {
   eepromImportDebug() << QString("OpenTxModelData::afterImport()") << modelData.name;
@@ -3823,6 +3921,12 @@ void OpenTxGeneralData::beforeExport()
   chkSum = sum;
 }
 
+void OpenTxGeneralData::clearState()
+{
+  chkSum = 0;
+  _errors.clear();
+}
+
 void OpenTxGeneralData::afterImport()
 {
   if (IS_TARANIS(board) && version < 217) {
@@ -3830,3 +3934,15 @@ void OpenTxGeneralData::afterImport()
     generalData.potConfig[1] = POT_WITH_DETENT;
   }
 }
+
+void OpenTxEepromCleanup(void)
+{
+  OpenTxModelLayout::Cleanup();
+  OpenTxGeneralLayout::Cleanup();
+  SourcesConversionTable::Cleanup();
+  SwitchesConversionTable::Cleanup();
+  BoardConversionTables<TelemetrySourcesConversionTable>::Cleanup();
+  BoardConversionTables<LogicalSwitchesFunctionsTable>::Cleanup();
+  BoardConversionTables<AndSwitchesConversionTable>::Cleanup();
+  BoardConversionTables<CustomFunctionsConversionTable>::Cleanup();
+}
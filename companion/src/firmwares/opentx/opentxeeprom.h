@@ -25,6 +25,7 @@
 #include "eeprominterface.h"
 #include "eepromimportexport.h"
 #include <qbytearray.h>
+#include <list>
 
 #define GVARS_VARIANT                  0x0001
 #define FRSKY_VARIANT                  0x0002
@@ -50,6 +51,7 @@ class OpenTxGeneralData: public TransformedField {
   protected:
     virtual void beforeExport();
     virtual void afterImport();
+    virtual void clearState();
 
     virtual void setError(const QString & error)
     {
@@ -130,6 +132,7 @@ class OpenTxModelData: public TransformedField {
   protected:
     virtual void beforeExport();
     virtual void afterImport();
+    virtual void clearState();
 
     virtual void setError(const QString & error)
     {
@@ -149,5 +152,77 @@ class OpenTxModelData: public TransformedField {
     QStringList _errors;
 };
 
+/*
+ * The fields of the models (or of the radio settings) of a board, version and variant.
+ * They are built once and bound to the layout's own copy of the data: each import or
+ * export copies the data in and out, the fields clear their other values before each use.
+ */
+template <class T, class F>
+class OpenTxLayout {
+  public:
+    static OpenTxLayout * getInstance(Board::Type board, unsigned int version, unsigned int variant=0)
+    {
+      for (typename std::list<OpenTxLayout *>::iterator it=internalCache.begin(); it!=internalCache.end(); it++) {
+        OpenTxLayout * layout = *it;
+        if (layout->board == board && layout->version == version && layout->variant == variant)
+          return layout;
+      }
+
+      OpenTxLayout * layout = new OpenTxLayout(board, version, variant);
+      internalCache.push_back(layout);
+      return layout;
+    }
+
+    static void Cleanup()
+    {
+      for (typename std::list<OpenTxLayout *>::iterator it=internalCache.begin(); it!=internalCache.end(); it++) {
+        delete *it;
+      }
+      internalCache.clear();
+    }
+
+    // returns the errors of the conversion
+    QStringList Export(const T & src, QByteArray & output)
+    {
+      data = src;
+      fields.Export(output);
+      return fields.errors();
+    }
+
+    // the values which are not in this layout are kept from dest
+    int Import(T & dest, const QByteArray & input)
+    {
+      data = dest;
+      int result = fields.Import(input);
+      if (result == 0) {
+        dest = data;
+      }
+      return result;
+    }
+
+  protected:
+    OpenTxLayout(Board::Type board, unsigned int version, unsigned int variant):
+      board(board),
+      version(version),
+      variant(variant),
+      fields(data, board, version, variant)
+    {
+    }
+
+    Board::Type board;
+    unsigned int version;
+    unsigned int variant;
+    T data;
+    F fields;
+
+    static std::list<OpenTxLayout *> internalCache;
+};
+
+template <class T, class F>
+std::list<OpenTxLayout<T, F> *> OpenTxLayout<T, F>::internalCache;
+
+typedef OpenTxLayout<ModelData, OpenTxModelData> OpenTxModelLayout;
+typedef OpenTxLayout<GeneralSettings, OpenTxGeneralData> OpenTxGeneralLayout;
+
 void OpenTxEepromCleanup(void);
 #endif // _OPENTXEEPROM_H_
@@ -122,11 +122,10 @@ uint32_t OpenTxEepromInterface::getFourCC()
 bool OpenTxEepromInterface::loadRadioSettingsFromRLE(GeneralSettings & settings, RleFile * rleFile, uint8_t version)
 {
   QByteArray data(sizeof(settings), 0); // GeneralSettings should be always bigger than the EEPROM struct
-  OpenTxGeneralData open9xSettings(settings, board, version);
   efile->openRd(FILE_GENERAL);
   int size = rleFile->readRlc2((uint8_t *)data.data(), data.size());
   if (size) {
-    open9xSettings.Import(data);
+    OpenTxGeneralLayout::getInstance(board, version)->Import(settings, data);
     return checkVariant(settings.version, settings.variant);
   }
   else {
@@ -158,10 +157,8 @@ bool OpenTxEepromInterface::saveToByteArray(const T & src, QByteArray & data, ui
     version = getLastDataVersion(getBoard());
   }
   QByteArray raw;
-  T srcCopy(src); // work on a copy of radio data, because Export() will modify it!
-  M manager(srcCopy, board, version, 0);
-  // manager.Dump();
-  manager.Export(raw);
+  // the layout exports a copy of the radio data, because Export() modifies it
+  OpenTxLayout<T, M>::getInstance(board, version)->Export(src, raw);
   data.resize(8);
   *((uint32_t*)&data.data()[0]) = getFourCC();
   data[4] = version;
@@ -174,11 +171,9 @@ bool OpenTxEepromInterface::saveToByteArray(const T & src, QByteArray & data, ui
 template <class T, class M>
 bool OpenTxEepromInterface::loadFromByteArray(T & dest, const QByteArray & data, uint8_t version, uint32_t variant)
 {
-  M manager(dest, board, version, variant);
-  if (manager.Import(data) != 0) {
+  if (OpenTxLayout<T, M>::getInstance(board, version, variant)->Import(dest, data) != 0) {
     return false;
   }
-  // manager.Dump(); // Dumps the structure so that it's easy to check with firmware datastructs.h
   return true;
 }
 
@@ -344,25 +339,22 @@ int OpenTxEepromInterface::save(uint8_t * eeprom, const RadioData & radioData, u
     variant |= TARANIS_X7_VARIANT;
   }
 
-  OpenTxGeneralData generator((GeneralSettings &)radioData.generalSettings, board, version, variant);
-  // generator.Dump();
   QByteArray data;
-  generator.Export(data);
+  QStringList errors = OpenTxGeneralLayout::getInstance(board, version, variant)->Export(radioData.generalSettings, data);
   int sz = efile->writeRlc2(FILE_GENERAL, FILE_TYP_GENERAL, (const uint8_t *)data.constData(), data.size());
-  if (sz == 0 || generator.errors().count() > 0) {
-    showErrors(QObject::tr("Cannot write radio settings"), generator.errors());
+  if (sz == 0 || errors.count() > 0) {
+    showErrors(QObject::tr("Cannot write radio settings"), errors);
     return 0;
   }
 
+  OpenTxModelLayout * layout = OpenTxModelLayout::getInstance(board, version, variant);
   for (int i = 0; i < getCurrentFirmware()->getCapability(Models); i++) {
     if (!radioData.models[i].isEmpty()) {
-      OpenTxModelData generator((ModelData &)radioData.models[i], board, version, variant);
-      // generator.Dump();
       QByteArray data;
-      generator.Export(data);
+      QStringList errors = layout->Export(radioData.models[i], data);
       int sz = efile->writeRlc2(FILE_MODEL(i), FILE_TYP_MODEL, (const uint8_t *)data.constData(), data.size());
-      if (sz == 0 || generator.errors().count() > 0) {
-        showErrors(QObject::tr("Cannot write model %1").arg(radioData.models[i].name), generator.errors());
+      if (sz == 0 || errors.count() > 0) {
+        showErrors(QObject::tr("Cannot write model %1").arg(radioData.models[i].name), errors);
         return 0;
       }
     }
@@ -382,10 +374,8 @@ int OpenTxEepromInterface::getSize(const ModelData &model)
   QByteArray tmp(EESIZE_MAX, 0);
   efile->EeFsCreate((uint8_t *) tmp.data(), EESIZE_MAX, board, 255/*version max*/);
 
-  OpenTxModelData open9xModel((ModelData &) model, board, 255/*version max*/, getCurrentFirmware()->getVariantNumber());
-
   QByteArray eeprom;
-  open9xModel.Export(eeprom);
+  OpenTxModelLayout::getInstance(board, 255/*version max*/, getCurrentFirmware()->getVariantNumber())->Export(model, eeprom);
   int sz = efile->writeRlc2(0, FILE_TYP_MODEL, (const uint8_t *) eeprom.constData(), eeprom.size());
   if (sz != eeprom.size()) {
     return -1;
@@ -401,11 +391,8 @@ int OpenTxEepromInterface::getSize(const GeneralSettings &settings)
   QByteArray tmp(EESIZE_MAX, 0);
   efile->EeFsCreate((uint8_t *) tmp.data(), EESIZE_MAX, board, 255);
 
-  OpenTxGeneralData open9xGeneral((GeneralSettings &) settings, board, 255, getCurrentFirmware()->getVariantNumber());
-  // open9xGeneral.Dump();
-
   QByteArray eeprom;
-  open9xGeneral.Export(eeprom);
+  OpenTxGeneralLayout::getInstance(board, 255, getCurrentFirmware()->getVariantNumber())->Export(settings, eeprom);
   int sz = efile->writeRlc2(0, FILE_TYP_GENERAL, (const uint8_t *) eeprom.constData(), eeprom.size());
   if (sz != eeprom.size()) {
     return -1;
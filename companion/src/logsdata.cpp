@@ -0,0 +1,734 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <string.h>
+#include <algorithm>
+#include <functional>
+#include "logsdata.h"
+
+// the text is split in chunks of at least 1MB parsed by different threads
+#define LOG_CHUNK_MIN_SIZE   (1024 * 1024)
+
+class LogsTask : public QRunnable
+{
+  public:
+    LogsTask(const std::function<void()> & function):
+      function(function)
+    {
+    }
+
+    void run() Q_DECL_OVERRIDE
+    {
+      function();
+    }
+
+  private:
+    std::function<void()> function;
+};
+
+static void runInParallel(int count, const std::function<void(int)> & function)
+{
+  QThreadPool pool;
+  for (int i=0; i<count; i++) {
+    pool.start(new LogsTask([&function, i]() { function(i); }));
+  }
+  pool.waitForDone();
+}
+
+static inline bool isLogSpace(char c)
+{
+  return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static bool parseDigits(const char * s, int count, int & value)
+{
+  value = 0;
+  for (int i=0; i<count; i++) {
+    if (s[i] < '0' || s[i] > '9')
+      return false;
+    value = value * 10 + (s[i] - '0');
+  }
+  return true;
+}
+
+// the local time of the start of each hour is cached, the log rows seldom change hour
+struct LogsTimeCache {
+  int key;
+  qint64 base;
+};
+
+// same result than QDateTime::fromString() with the "yyyy-MM-dd HH:mm:ss.zzz" format used to write the logs
+static qint64 parseTimestamp(const char * date, int dateLen, const char * time, int timeLen, LogsTimeCache & cache)
+{
+  int year, month, day, hour, minute, second, fraction = 0;
+  int decimals = timeLen - 9;
+  if (dateLen == 10 && date[4] == '-' && date[7] == '-' &&
+      parseDigits(date, 4, year) && parseDigits(date + 5, 2, month) && parseDigits(date + 8, 2, day) &&
+      timeLen >= 8 && time[2] == ':' && time[5] == ':' &&
+      parseDigits(time, 2, hour) && parseDigits(time + 3, 2, minute) && parseDigits(time + 6, 2, second) &&
+      (timeLen == 8 || (time[8] == '.' && decimals >= 1 && decimals <= 3 && parseDigits(time + 9, decimals, fraction)))) {
+    // the fields packed in the key must not overlap, another date could hit a cached hour otherwise
+    if (month > 12 || day > 31 || hour >= 24 || minute >= 60 || second >= 60)
+      return LOG_INVALID_TIME;
+    int key = (((year << 4) + month) << 5 | day) << 5 | hour;
+    if (key != cache.key) {
+      QDate startDate(year, month, day);
+      if (!startDate.isValid())
+        return LOG_INVALID_TIME;
+      cache.key = key;
+      cache.base = QDateTime(startDate, QTime(hour, 0)).toMSecsSinceEpoch();
+    }
+    for (int i=decimals; i<3; i++) {
+      fraction *= 10;
+    }
+    return cache.base + (minute * 60 + second) * 1000 + fraction;
+  }
+
+  QString timestamp = QString::fromLatin1(date, dateLen) + " " + QString::fromLatin1(time, timeLen);
+  int point = timestamp.indexOf('.');
+  QDateTime result = QDateTime::fromString(timestamp, point >= 0 ? "yyyy-MM-dd HH:mm:ss.zzz" : "yyyy-MM-dd HH:mm:ss");
+  if (!result.isValid())
+    return LOG_INVALID_TIME;
+  qint64 msecs = (qint64)result.toTime_t() * 1000;
+  if (point >= 0) {
+    msecs += qRound64(timestamp.mid(point).toDouble() * 1000);
+  }
+  return msecs;
+}
+
+// same result than QString::toDouble(), with 0 for the values which are not numbers
+static double parseValue(const char * s, int len)
+{
+  static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15 };
+  const char * p = s;
+  const char * end = s + len;
+  bool negative = false;
+  bool point = false;
+  quint64 mantissa = 0;
+  int digits = 0;
+  int decimals = 0;
+
+  if (p < end && (*p == '-' || *p == '+')) {
+    negative = (*p++ == '-');
+  }
+  for (; p < end; p++) {
+    if (*p >= '0' && *p <= '9') {
+      mantissa = mantissa * 10 + (*p - '0');
+      digits++;
+      if (point)
+        decimals++;
+    }
+    else if (*p == '.' && !point) {
+      point = true;
+    }
+    else {
+      break;
+    }
+  }
+
+  if (p == end && digits > 0 && digits <= 15) {
+    // both are exact doubles, the division is correctly rounded
+    double value = mantissa / powers[decimals];
+    return negative ? -value : value;
+  }
+
+  // exponents, spaces, ...
+  bool ok;
+  double value = QString::fromLatin1(s, len).toDouble(&ok);
+  return ok ? value : 0;
+}
+
+// binary logs written by the firmwares built with LOGS_BINARY, see radio/src/logs.cpp
+#define OTL_VERSION          1
+#define OTL_FLAG_RTC         0x01
+#define OTL_RECORD_KEY       0x01
+#define OTL_RECORD_DELTA     0x02
+#define OTL_COLUMN_VALUE     0
+#define OTL_COLUMN_GPS       1
+#define OTL_COLUMN_DATETIME  2
+#define OTL_COLUMN_BITS64    3
+
+class OtlReader
+{
+  public:
+    OtlReader(const QByteArray & data):
+      data(data),
+      offset(0),
+      error(false)
+    {
+    }
+
+    bool atEnd() const
+    {
+      return offset >= data.size();
+    }
+
+    uint8_t byte()
+    {
+      if (atEnd()) {
+        error = true;
+        return 0;
+      }
+      return data.at(offset++);
+    }
+
+    uint32_t varint()
+    {
+      uint32_t value = 0;
+      for (int shift=0; shift<35 && !error; shift+=7) {
+        uint8_t b = byte();
+        value |= (uint32_t)(b & 0x7F) << shift;
+        if (b < 0x80)
+          break;
+      }
+      return value;
+    }
+
+    int32_t signedVarint()
+    {
+      uint32_t value = varint();
+      return (int32_t)((value >> 1) ^ -(value & 1));
+    }
+
+    QByteArray data;
+    int offset;
+    bool error;
+};
+
+struct OtlColumn
+{
+  uint8_t type;
+  uint8_t prec;
+};
+
+static QString otlFormatValue(int32_t value, uint8_t prec)
+{
+  if (prec == 0)
+    return QString::number(value);
+  int32_t divisor = (prec == 1 ? 10 : (prec == 2 ? 100 : 1000000));
+  qint64 absValue = qAbs((qint64)value);
+  return QString("%1%2.%3").arg(value < 0 ? "-" : "").arg(absValue / divisor).arg(absValue % divisor, prec, 10, QChar('0'));
+}
+
+static QString otlFormatColumn(const OtlColumn & column, const int32_t * values)
+{
+  switch (column.type) {
+    case OTL_COLUMN_GPS:
+      if (values[0] == 0 || values[1] == 0)
+        return QString();
+      return otlFormatValue(values[0], 6) + " " + otlFormatValue(values[1], 6);
+    case OTL_COLUMN_DATETIME:
+      return QString("%1-%2-%3 %4:%5:%6").arg(values[0] / 10000, 4, 10, QChar('0')).arg(values[0] / 100 % 100, 2, 10, QChar('0')).arg(values[0] % 100, 2, 10, QChar('0'))
+                                         .arg(values[1] / 10000, 2, 10, QChar('0')).arg(values[1] / 100 % 100, 2, 10, QChar('0')).arg(values[1] % 100, 2, 10, QChar('0'));
+    case OTL_COLUMN_BITS64:
+      return "0x" + QString("%1%2").arg((uint32_t)values[0], 8, 16, QChar('0')).arg((uint32_t)values[1], 8, 16, QChar('0')).toUpper();
+    default:
+      return otlFormatValue(values[0], column.prec);
+  }
+}
+
+LogsData::LogsData():
+  mapping(NULL),
+  data(NULL),
+  size(0),
+  chronological(true)
+{
+}
+
+LogsData::~LogsData()
+{
+  clear();
+}
+
+void LogsData::clear()
+{
+  unmapFile();
+  buffer.clear();
+  data = NULL;
+  size = 0;
+  labels.clear();
+  offsets.clear();
+  timestamps.clear();
+  columns.clear();
+  pyramids.clear();
+  chronological = true;
+}
+
+bool LogsData::mapFile(const QString & filename)
+{
+  file.setFileName(filename);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+
+  size = file.size();
+  mapping = (size > 0 ? file.map(0, size) : NULL);
+  if (mapping) {
+    data = (const char *)mapping;
+  }
+  else {
+    buffer = file.readAll();
+    file.close();
+    data = buffer.constData();
+    size = buffer.size();
+  }
+  return true;
+}
+
+void LogsData::unmapFile()
+{
+  if (mapping) {
+    file.unmap(mapping);
+    mapping = NULL;
+  }
+  if (file.isOpen()) {
+    file.close();
+  }
+}
+
+bool LogsData::load(const QString & filename, int & errors, int & lines)
+{
+  clear();
+  errors = 0;
+  lines = 0;
+
+  if (!mapFile(filename)) {
+    return false;
+  }
+
+  bool result;
+  if (size >= 4 && !memcmp(data, "OTXL", 4))
+    result = parseBinary(errors, lines);
+  else
+    result = parseText(errors, lines);
+
+  if (!result || rowCount() == 0) {
+    clear();
+    return false;
+  }
+
+  return true;
+}
+
+// converts the binary log to the same text than a CSV log, the sessions with other columns than the first one are counted as errors
+bool LogsData::parseBinary(int & errors, int & lines)
+{
+  OtlReader reader(QByteArray::fromRawData(data, size));
+  QByteArray text;
+  QStringList header;
+  QList<OtlColumn> columns;
+  QVector<int32_t> values;
+  bool skipSession = false;
+  uint32_t seconds = 0;
+  uint32_t hundredths = 0;
+
+  while (!reader.atEnd() && !reader.error) {
+    uint8_t tag = reader.byte();
+    if (tag == 'O') {
+      if (reader.byte() != 'T' || reader.byte() != 'X' || reader.byte() != 'L' || reader.byte() != OTL_VERSION) {
+        return false;
+      }
+      // without OTL_FLAG_RTC the times count from the radio start, they are shown from 1970-01-01
+      reader.byte(); // flags
+      reader.byte(); // period
+      reader.byte();
+      QStringList labels;
+      labels << "Date" << "Time";
+      columns.clear();
+      int valuesCount = 0;
+      for (int count=reader.byte(); count>0 && !reader.error; count--) {
+        OtlColumn column;
+        column.type = reader.byte();
+        column.prec = reader.byte();
+        uint8_t len = reader.byte();
+        QByteArray label = reader.data.mid(reader.offset, len);
+        reader.offset += label.size();
+        labels << QString::fromLatin1(label);
+        columns << column;
+        valuesCount += (column.type == OTL_COLUMN_VALUE ? 1 : 2);
+      }
+      if (header.isEmpty()) {
+        header = labels;
+        text += header.join(',').toUtf8() + '\n';
+      }
+      skipSession = (labels != header);
+      values.fill(0, valuesCount);
+      continue;
+    }
+
+    if (columns.isEmpty())
+      return false;
+
+    if (tag == OTL_RECORD_KEY) {
+      seconds = reader.varint();
+      hundredths = reader.varint();
+      for (int i=0; i<values.size(); i++) {
+        values[i] = reader.signedVarint();
+      }
+    }
+    else if (tag == OTL_RECORD_DELTA) {
+      uint32_t elapsed = hundredths + reader.varint();
+      seconds += elapsed / 100;
+      hundredths = elapsed % 100;
+      QByteArray bitmap = reader.data.mid(reader.offset, (values.size() + 7) / 8);
+      reader.offset += bitmap.size();
+      for (int i=0; i<values.size() && i/8<bitmap.size(); i++) {
+        if ((uint8_t)bitmap.at(i/8) & (1 << (i%8))) {
+          values[i] = (int32_t)((uint32_t)values[i] + (uint32_t)reader.signedVarint());
+        }
+      }
+    }
+    else {
+      return false;
+    }
+
+    if (reader.error)
+      break;
+
+    lines++;
+    if (skipSession) {
+      errors++;
+      continue;
+    }
+
+    QDateTime time = QDateTime::fromTime_t(seconds, Qt::UTC);
+    QStringList row;
+    // same time format than the CSV logs
+    row << time.toString("yyyy-MM-dd") << QString("%1.%2").arg(time.toString("HH:mm:ss")).arg(hundredths, 2, 10, QChar('0')) + "0";
+    const int32_t * value = values.constData();
+    foreach(const OtlColumn & column, columns) {
+      row << otlFormatColumn(column, value);
+      value += (column.type == OTL_COLUMN_VALUE ? 1 : 2);
+    }
+    text += row.join(',').toUtf8() + '\n';
+  }
+
+  if (text.isEmpty()) {
+    return false;
+  }
+
+  // the rows are then parsed from the text, the file is not needed anymore
+  unmapFile();
+  buffer = text;
+  data = buffer.constData();
+  size = buffer.size();
+
+  int textErrors, textLines;
+  return parseText(textErrors, textLines);
+}
+
+struct LogsChunk {
+  qint64 begin;
+  qint64 end;
+  QVector<qint64> offsets;
+  int firstRow;
+  int errors;
+  int lines;
+};
+
+bool LogsData::parseText(int & errors, int & lines)
+{
+  const char * eol = (const char *)memchr(data, '\n', size);
+  QByteArray headerLine = QByteArray(data, eol ? eol - data : size).trimmed();
+  if (!headerLine.startsWith("Date,Time")) {
+    return false;
+  }
+  labels = QString::fromUtf8(headerLine).split(',');
+  int fieldsCount = labels.size();
+
+  // each chunk holds the lines starting between its begin and its end
+  qint64 body = (eol ? eol - data + 1 : size);
+  int chunksCount = qBound<qint64>(1, (size - body) / LOG_CHUNK_MIN_SIZE, 4 * QThread::idealThreadCount());
+  QVector<LogsChunk> chunks(chunksCount);
+  for (int i=0; i<chunksCount; i++) {
+    LogsChunk & chunk = chunks[i];
+    chunk.begin = body;
+    if (i > 0) {
+      qint64 position = body + (size - body) * i / chunksCount;
+      const char * previous = (const char *)memchr(data + position - 1, '\n', size - position + 1);
+      chunk.begin = (previous ? previous - data + 1 : size);
+      chunks[i-1].end = chunk.begin;
+    }
+    chunk.end = size;
+    chunk.errors = 0;
+    chunk.lines = 0;
+  }
+
+  // the rows are the lines with as many fields as the header, the others are dropped
+  LogsChunk * chunksData = chunks.data();
+  runInParallel(chunksCount, [&](int index) {
+    LogsChunk & chunk = chunksData[index];
+    qint64 position = chunk.begin;
+    while (position < chunk.end) {
+      const char * line = data + position;
+      const char * end = (const char *)memchr(line, '\n', size - position);
+      const char * stop = (end ? end : data + size);
+      position = stop - data + 1;
+      while (line < stop && isLogSpace(*line))
+        line++;
+      while (stop > line && isLogSpace(stop[-1]))
+        stop--;
+      if (std::count(line, stop, ',') + 1 == fieldsCount)
+        chunk.offsets.append(line - data);
+      else
+        chunk.errors++;
+      chunk.lines++;
+    }
+  });
+
+  int rowsCount = 0;
+  for (int i=0; i<chunksCount; i++) {
+    LogsChunk & chunk = chunks[i];
+    chunk.firstRow = rowsCount;
+    offsets += chunk.offsets;
+    rowsCount += chunk.offsets.size();
+    errors += chunk.errors;
+    lines += chunk.lines;
+  }
+
+  timestamps.resize(rowsCount);
+  columns.resize(fieldsCount);
+  QVector<float *> values(fieldsCount);
+  for (int column=2; column<fieldsCount; column++) {
+    columns[column].resize(rowsCount);
+    values[column] = columns[column].data();
+  }
+  qint64 * times = timestamps.data();
+
+  runInParallel(chunksCount, [&](int index) {
+    const LogsChunk & chunk = chunksData[index];
+    LogsTimeCache cache = { -1, 0 };
+    for (int row=chunk.firstRow; row<chunk.firstRow+chunk.offsets.size(); row++) {
+      const char * field = data + offsets.at(row);
+      const char * stop = rowEnd(row);
+      const char * date = field;
+      int dateLen = 0;
+      int column = 0;
+      for (const char * p=field; ; p++) {
+        if (p == stop || *p == ',') {
+          if (column == 0) {
+            dateLen = p - field;
+          }
+          else if (column == 1) {
+            times[row] = parseTimestamp(date, dateLen, field, p - field, cache);
+          }
+          else {
+            values[column][row] = parseValue(field, p - field);
+          }
+          if (p == stop)
+            break;
+          column++;
+          field = p + 1;
+        }
+      }
+    }
+  });
+
+  qint64 previous = LOG_INVALID_TIME;
+  foreach (qint64 timestamp, timestamps) {
+    if (timestamp == LOG_INVALID_TIME || timestamp < previous) {
+      chronological = false;
+      break;
+    }
+    previous = timestamp;
+  }
+
+  pyramids.resize(fieldsCount);
+  if (rowsCount > 0) {
+    runInParallel(fieldsCount - 2, [&](int index) {
+      buildPyramid(index + 2);
+    });
+  }
+
+  return true;
+}
+
+int LogsData::lowerBound(qint64 timestamp) const
+{
+  return std::lower_bound(timestamps.constBegin(), timestamps.constEnd(), timestamp) - timestamps.constBegin();
+}
+
+const char * LogsData::rowEnd(int row) const
+{
+  qint64 offset = offsets.at(row);
+  const char * eol = (const char *)memchr(data + offset, '\n', size - offset);
+  const char * stop = (eol ? eol : data + size);
+  while (stop > data + offset && isLogSpace(stop[-1]))
+    stop--;
+  return stop;
+}
+
+QString LogsData::cell(int row, int column) const
+{
+  const char * field = data + offsets.at(row);
+  const char * stop = rowEnd(row);
+  for (const char * p=field; p<stop; p++) {
+    if (*p == ',') {
+      if (column-- == 0)
+        return QString::fromUtf8(field, p - field);
+      field = p + 1;
+    }
+  }
+  return column == 0 ? QString::fromUtf8(field, stop - field) : QString();
+}
+
+QStringList LogsData::row(int row) const
+{
+  const char * line = data + offsets.at(row);
+  return QString::fromUtf8(line, rowEnd(row) - line).split(',');
+}
+
+void LogsData::buildPyramid(int column)
+{
+  const float * values = columns.at(column).constData();
+  QVector<QVector<LogExtent> > & pyramid = pyramids[column];
+  int count = rowCount();
+
+  QVector<LogExtent> level((count + LOG_PYRAMID_FANOUT - 1) / LOG_PYRAMID_FANOUT);
+  for (int i=0; i<level.size(); i++) {
+    int first = i * LOG_PYRAMID_FANOUT;
+    int last = qMin(first + LOG_PYRAMID_FANOUT, count);
+    LogExtent & extent = level[i];
+    extent.min = extent.max = first;
+    for (int row=first+1; row<last; row++) {
+      if (values[row] < values[extent.min])
+        extent.min = row;
+      if (values[row] > values[extent.max])
+        extent.max = row;
+    }
+  }
+  pyramid.append(level);
+
+  while (level.size() > 1) {
+    const QVector<LogExtent> & below = pyramid.last();
+    level = QVector<LogExtent>((below.size() + LOG_PYRAMID_FANOUT - 1) / LOG_PYRAMID_FANOUT);
+    for (int i=0; i<level.size(); i++) {
+      int first = i * LOG_PYRAMID_FANOUT;
+      int last = qMin(first + LOG_PYRAMID_FANOUT, below.size());
+      LogExtent & extent = level[i];
+      extent = below.at(first);
+      for (int j=first+1; j<last; j++) {
+        if (values[below.at(j).min] < values[extent.min])
+          extent.min = below.at(j).min;
+        if (values[below.at(j).max] > values[extent.max])
+          extent.max = below.at(j).max;
+      }
+    }
+    pyramid.append(level);
+  }
+}
+
+LogExtent LogsData::extent(int column, const LogRows & rows) const
+{
+  const float * values = columns.at(column).constData();
+  const QVector<QVector<LogExtent> > & pyramid = pyramids.at(column);
+  LogExtent result = { rows.first, rows.first };
+  int first = rows.first;
+  int last = rows.second;
+
+  auto merge = [&](int level, int index) {
+    LogExtent extent = (level < 0 ? LogExtent{ index, index } : pyramid.at(level).at(index));
+    // the first row of the log when there are several, whatever the order the buckets are merged
+    if (values[extent.min] < values[result.min] || (values[extent.min] == values[result.min] && extent.min < result.min))
+      result.min = extent.min;
+    if (values[extent.max] > values[result.max] || (values[extent.max] == values[result.max] && extent.max < result.max))
+      result.max = extent.max;
+  };
+
+  // the rows before the first and after the last complete bucket, then the same with the buckets of each level
+  for (int level=-1; first<last; level++) {
+    while (first < last && first % LOG_PYRAMID_FANOUT)
+      merge(level, first++);
+    while (last > first && last % LOG_PYRAMID_FANOUT)
+      merge(level, --last);
+    first /= LOG_PYRAMID_FANOUT;
+    last /= LOG_PYRAMID_FANOUT;
+  }
+
+  return result;
+}
+
+void LogsData::decimate(int column, const LogRows & rows, int width, QVector<double> & x, QVector<double> & y) const
+{
+  const float * values = columns.at(column).constData();
+  int count = rows.second - rows.first;
+
+  auto append = [&](int row) {
+    if (timestamps.at(row) != LOG_INVALID_TIME) {
+      x.append(timestamps.at(row) / 1000.0);
+      y.append(values[row]);
+    }
+  };
+
+  width = qMax(width, 1);
+  if (count <= 2 * width) {
+    for (int row=rows.first; row<rows.second; row++) {
+      append(row);
+    }
+    return;
+  }
+
+  for (int i=0; i<width; i++) {
+    // both extremes of the rows under this pixel, in the order of the log
+    int first = rows.first + (qint64)count * i / width;
+    int last = rows.first + (qint64)count * (i + 1) / width;
+    LogExtent range = extent(column, LogRows(first, last));
+    append(qMin(range.min, range.max));
+    if (range.min != range.max)
+      append(qMax(range.min, range.max));
+  }
+}
+
+LogsTableModel::LogsTableModel(QObject * parent):
+  QAbstractTableModel(parent),
+  log(NULL)
+{
+}
+
+void LogsTableModel::setLog(const LogsData * log)
+{
+  beginResetModel();
+  this->log = log;
+  endResetModel();
+}
+
+int LogsTableModel::rowCount(const QModelIndex & parent) const
+{
+  return (log && !parent.isValid()) ? log->rowCount() : 0;
+}
+
+int LogsTableModel::columnCount(const QModelIndex & parent) const
+{
+  return (log && !parent.isValid()) ? log->columnCount() : 0;
+}
+
+QVariant LogsTableModel::data(const QModelIndex & index, int role) const
+{
+  if (log && index.isValid() && role == Qt::DisplayRole)
+    return log->cell(index.row(), index.column());
+  return QVariant();
+}
+
+QVariant LogsTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+  if (log && orientation == Qt::Horizontal && role == Qt::DisplayRole && section < log->columnCount())
+    return log->header().at(section);
+  return QAbstractTableModel::headerData(section, orientation, role);
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef _LOGSDATA_H_
+#define _LOGSDATA_H_
+
+#include <limits>
+#include <QtCore>
+
+#define LOG_INVALID_TIME         std::numeric_limits<qint64>::min()
+// each level of the min/max pyramid covers 8 buckets of the level below
+#define LOG_PYRAMID_FANOUT       8
+
+// a range of rows [first, last)
+typedef QPair<int, int> LogRows;
+
+// rows holding the min and the max of a range of rows
+struct LogExtent {
+  qint32 min;
+  qint32 max;
+};
+
+/*
+ * A telemetry log (CSV or binary) with its values parsed into columns.
+ *
+ * The CSV text is memory mapped and kept as is, the table only reads the
+ * cells it displays. The timestamps (ms since the epoch, local time like the
+ * file) and the values of the columns after Date and Time are parsed once,
+ * in parallel. Each value column has a pyramid of the rows holding the
+ * min and the max of 8, 64, 512, ... rows, to decimate the plots at any zoom.
+ */
+class LogsData
+{
+  public:
+    LogsData();
+    ~LogsData();
+
+    // false if the file is not a log, errors is the number of lines dropped
+    bool load(const QString & filename, int & errors, int & lines);
+    void clear();
+
+    int rowCount() const { return timestamps.size(); }
+    int columnCount() const { return labels.size(); }
+    const QStringList & header() const { return labels; }
+    QString cell(int row, int column) const;
+    QStringList row(int row) const;
+
+    qint64 timestamp(int row) const { return timestamps.at(row); }
+    // all the timestamps are valid and never go back in time
+    bool isChronological() const { return chronological; }
+    // the first row at or after timestamp, when the log is chronological
+    int lowerBound(qint64 timestamp) const;
+    float value(int row, int column) const { return columns.at(column).at(row); }
+
+    // first rows of the min and the max value in rows, which must not be empty
+    LogExtent extent(int column, const LogRows & rows) const;
+
+    // the points (seconds, value) to plot the rows in the given width (pixels),
+    // all of them when there are fewer than 2 per pixel, else the min and the max of each pixel
+    void decimate(int column, const LogRows & rows, int width, QVector<double> & x, QVector<double> & y) const;
+
+  protected:
+    bool mapFile(const QString & filename);
+    void unmapFile();
+    bool parseBinary(int & errors, int & lines);
+    bool parseText(int & errors, int & lines);
+    const char * rowEnd(int row) const;
+    void buildPyramid(int column);
+
+    QFile file;
+    uchar * mapping;
+    const char * data;
+    qint64 size;
+    QByteArray buffer;
+
+    QStringList labels;
+    QVector<qint64> offsets;
+    QVector<qint64> timestamps;
+    QVector<QVector<float> > columns;
+    QVector<QVector<QVector<LogExtent> > > pyramids;
+    bool chronological;
+};
+
+class LogsTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+  public:
+    LogsTableModel(QObject * parent = 0);
+
+    void setLog(const LogsData * log);
+
+    int rowCount(const QModelIndex & parent = QModelIndex()) const Q_DECL_OVERRIDE;
+    int columnCount(const QModelIndex & parent = QModelIndex()) const Q_DECL_OVERRIDE;
+    QVariant data(const QModelIndex & index, int role) const Q_DECL_OVERRIDE;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
+
+  private:
+    const LogsData * log;
+};
+
+#endif // _LOGSDATA_H_
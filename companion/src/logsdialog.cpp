@@ -37,11 +37,12 @@ LogsDialog::LogsDialog(QWidget *parent) :
   cursorB(0),
   cursorLine(0)
 {
-  csvlog.clear();
-
   ui->setupUi(this);
   setWindowIcon(CompanionIcon("logs.png"));
 
+  logModel = new LogsTableModel(this);
+  ui->logTable->setModel(logModel);
+
   plotLock=false;
 
   colors.append(Qt::green);
@@ -108,13 +109,15 @@ LogsDialog::LogsDialog(QWidget *parent) :
 
   // make left axes transfer its range to right axes:
   connect(axisRect->axis(QCPAxis::atLeft), SIGNAL(rangeChanged(QCPRange)), this, SLOT(yAxisChangeRanges(QCPRange)));
+  // decimate the graphs again for each zoom:
+  connect(axisRect->axis(QCPAxis::atBottom), SIGNAL(rangeChanged(QCPRange)), this, SLOT(xAxisChangeRanges(QCPRange)));
 
   // connect some interaction slots:
   connect(ui->customPlot, SIGNAL(titleDoubleClick(QMouseEvent*, QCPPlotTitle*)), this, SLOT(titleDoubleClick(QMouseEvent*, QCPPlotTitle*)));
   connect(ui->customPlot, SIGNAL(axisDoubleClick(QCPAxis*,QCPAxis::SelectablePart,QMouseEvent*)), this, SLOT(axisLabelDoubleClick(QCPAxis*,QCPAxis::SelectablePart)));
   connect(ui->customPlot, SIGNAL(legendDoubleClick(QCPLegend*,QCPAbstractLegendItem*,QMouseEvent*)), this, SLOT(legendDoubleClick(QCPLegend*,QCPAbstractLegendItem*)));
   connect(ui->FieldsTW, SIGNAL(itemSelectionChanged()), this, SLOT(plotLogs()));
-  connect(ui->logTable, SIGNAL(itemSelectionChanged()), this, SLOT(plotLogs()));
+  connect(ui->logTable->selectionModel(), SIGNAL(selectionChanged(QItemSelection, QItemSelection)), this, SLOT(plotLogs()));
   connect(ui->Reset_PB, SIGNAL(clicked()), this, SLOT(plotLogs()));
 }
 
@@ -233,18 +236,36 @@ void LogsDialog::selectionChanged()
   }
 }
 
-QList<QStringList> LogsDialog::filterGePoints(const QList<QStringList> & input)
+QVector<LogRows> LogsDialog::getSelectedRows()
+{
+  QVector<LogRows> ranges;
+  foreach (const QItemSelectionRange & range, ui->logTable->selectionModel()->selection()) {
+    ranges.append(LogRows(range.top(), range.bottom() + 1));
+  }
+  qSort(ranges.begin(), ranges.end());
+
+  QVector<LogRows> result;
+  foreach (const LogRows & rows, ranges) {
+    if (!result.isEmpty() && rows.first <= result.last().second)
+      result.last().second = qMax(result.last().second, rows.second);
+    else
+      result.append(rows);
+  }
+  return result;
+}
+
+QList<QStringList> LogsDialog::filterGePoints()
 {
   QList<QStringList> result;
 
-  int n = input.count();
+  int n = logData.rowCount();
   if (n == 0) {
     return result;
   }
 
   int gpscol = 0;
-  for (int i=1; i<input.at(0).count(); i++) {
-    if (input.at(0).at(i) == "GPS") {
+  for (int i=1; i<logData.columnCount(); i++) {
+    if (logData.header().at(i) == "GPS") {
       gpscol=i;
     }
   }
@@ -255,16 +276,18 @@ The columns for altitude \"GAlt\" and for speed \"GSpd\" are optional"));
     return result;
   }
 
-  result.append(input.at(0));
-  bool rangeSelected = ui->logTable->selectionModel()->selectedRows().length() > 0;
+  result.append(logData.header());
+  QVector<LogRows> selection = getSelectedRows();
+  if (selection.isEmpty()) {
+    selection.append(LogRows(0, n));
+  }
 
   GpsGlitchFilter glitchFilter;
   GpsLatLonFilter latLonFilter;
 
-  for (int i = 1; i < n; i++) {
-    if ((ui->logTable->item(i-1, 1)->isSelected() && rangeSelected) || !rangeSelected) {
-
-      GpsCoord coord = extractGpsCoordinates(input.at(i).at(gpscol));
+  foreach (const LogRows & rows, selection) {
+    for (int i = rows.first; i < rows.second; i++) {
+      GpsCoord coord = extractGpsCoordinates(logData.cell(i, gpscol));
 
       // glitch filter
       if ( glitchFilter.isGlitch(coord) ) {
@@ -279,18 +302,18 @@ The columns for altitude \"GAlt\" and for speed \"GSpd\" are optional"));
       }
 
       // qDebug() << "point " << latitude << longitude;
-      result.append(input.at(i));
+      result.append(logData.row(i));
     }
   }
 
-  // qDebug() << "filterGePoints(): filtered from" << input.count() << "to " << result.count() << "points";
+  // qDebug() << "filterGePoints(): filtered from" << n << "to " << result.count() << "points";
   return result;
 }
 
 void LogsDialog::exportToGoogleEarth()
 {
   // filter data points
-  QList<QStringList> dataPoints = filterGePoints(csvlog);
+  QList<QStringList> dataPoints = filterGePoints();
   int n = dataPoints.count(); // number of points to export
   if (n==0) return;
 
@@ -572,38 +595,29 @@ void LogsDialog::on_fileOpen_BT_clicked()
   if (!fileName.isEmpty()) {
     g.logDir(fileName);
     ui->FileName_LE->setText(fileName);
+    ui->FieldsTW->clear();
+    ui->FieldsTW->setRowCount(0);
     if (cvsFileParse()) {
-      ui->FieldsTW->clear();
-      ui->logTable->clear();
       ui->FieldsTW->setShowGrid(false);
       ui->FieldsTW->setContentsMargins(0,0,0,0);
-      ui->FieldsTW->setRowCount(csvlog.at(0).count()-2);
+      ui->FieldsTW->setRowCount(logData.columnCount()-2);
       ui->FieldsTW->setColumnCount(1);
       ui->FieldsTW->setHorizontalHeaderLabels(QStringList(tr("Available fields")));
       ui->logTable->setSelectionBehavior(QAbstractItemView::SelectRows);
-      for (int i=2; i<csvlog.at(0).count(); i++) {
-        QTableWidgetItem* item= new QTableWidgetItem(csvlog.at(0).at(i));
+      for (int i=2; i<logData.columnCount(); i++) {
+        QTableWidgetItem* item= new QTableWidgetItem(logData.header().at(i));
         ui->FieldsTW->setItem(i-2, 0, item);
       }
       ui->FieldsTW->resizeRowsToContents();
-      ui->logTable->setColumnCount(csvlog.at(0).count());
-      ui->logTable->setRowCount(csvlog.count()-1);
-      ui->logTable->setHorizontalHeaderLabels(csvlog.at(0));
-
-      QAbstractItemModel *model = ui->logTable->model();
-      for (int i=1; i<csvlog.count(); i++) {
-        for (int j=0; j<csvlog.at(0).count(); j++) {
-          model->setData(model->index(i - 1, j, QModelIndex()), csvlog.at(i).at(j));
-        }
-      }
 
+      // the rows are read from the log when they are displayed, only the visible ones are measured
       ui->logTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
       QVarLengthArray<int> sizes;
-      for (int i = 0; i < ui->logTable->columnCount(); i++) {
+      for (int i = 0; i < logModel->columnCount(); i++) {
         sizes.append(ui->logTable->columnWidth(i));
       }
       ui->logTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
-      for (int i = 0; i < ui->logTable->columnCount(); i++) {
+      for (int i = 0; i < logModel->columnCount(); i++) {
         ui->logTable->setColumnWidth(i, sizes.at(i));
       }
     }
@@ -612,56 +626,28 @@ void LogsDialog::on_fileOpen_BT_clicked()
 
 bool LogsDialog::cvsFileParse()
 {
-  QFile file(ui->FileName_LE->text());
-  int errors=0;
-  int lines=-1;
-
-  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) { // reading HEX TEXT file
-    return false;
-  }
-  else {
-    csvlog.clear();
-    logFilename.clear();
-    QTextStream inputStream(&file);
-    QString buffer = file.readLine();
+  int errors = 0;
+  int lines = 0;
 
-    if (buffer.startsWith("Date,Time")) {
-      file.reset();
-    }
-    else {
-      return false;
-    }
+  removeAllGraphs();
+  logFilename.clear();
 
-    int numfields=-1;
-    while (!file.atEnd()) {
-      QString line = file.readLine().trimmed();
-      QStringList columns = line.split(',');
-      if (numfields==-1) {
-        numfields=columns.count();
-      }
-      if (columns.count()==numfields) {
-        csvlog.append(columns);
-      }
-      else {
-        errors++;
-      }
-      lines++;
-    }
+  // the table reads the log, it is reset around the load
+  logModel->setLog(NULL);
+  bool result = logData.load(ui->FileName_LE->text(), errors, lines);
+  logModel->setLog(&logData);
 
-    logFilename = QFileInfo(file.fileName()).baseName();
+  if (!result) {
+    ui->sessions_CB->clear();
+    return false;
   }
 
-  file.close();
+  logFilename = QFileInfo(ui->FileName_LE->text()).baseName();
+
   if (errors > 1) {
     QMessageBox::warning(this, "Companion", tr("The selected logfile contains %1 invalid lines out of  %2 total lines").arg(errors).arg(lines));
   }
 
-  int n = csvlog.count();
-  if (n == 1) {
-    csvlog.clear();
-    return false;
-  }
-
   plotLock = true;
   setFlightSessions();
   plotLock = false;
@@ -674,12 +660,12 @@ struct FlightSession {
   QDateTime end;
 };
 
-QDateTime LogsDialog::getRecordTimeStamp(int index) 
+QDateTime LogsDialog::getRecordTimeStamp(int index)
 {
-  QString tstamp = csvlog.at(index).at(0) + " " + csvlog.at(index).at(1);
-  if (csvlog.at(index).at(1).contains(".")) 
-    return QDateTime::fromString(tstamp, "yyyy-MM-dd HH:mm:ss.zzz");
-  return QDateTime::fromString(tstamp, "yyyy-MM-dd HH:mm:ss");
+  qint64 timestamp = logData.timestamp(index);
+  if (timestamp == LOG_INVALID_TIME)
+    return QDateTime();
+  return QDateTime::fromMSecsSinceEpoch(timestamp);
 }
 
 QString LogsDialog::generateDuration(const QDateTime & start, const QDateTime & end)
@@ -698,35 +684,35 @@ void LogsDialog::setFlightSessions()
 {
   ui->sessions_CB->clear();
 
-  int n = csvlog.count();
+  int n = logData.rowCount();
   // qDebug() << "records" << n;
 
   // find session breaks
   QList<int> sessions;
-  QDateTime lastvalue;
-  for (int i = 1; i < n; i++) {
-    QDateTime tmp = getRecordTimeStamp(i);
-    if (!lastvalue.isValid() || lastvalue.secsTo(tmp) > 60) {
-      sessions.push_back(i-1);
-      // qDebug() << "session index" << i-1;
+  qint64 lastvalue = LOG_INVALID_TIME;
+  for (int i = 0; i < n; i++) {
+    qint64 tmp = logData.timestamp(i);
+    if (lastvalue == LOG_INVALID_TIME || (tmp != LOG_INVALID_TIME && (tmp - lastvalue) / 1000 > 60)) {
+      sessions.push_back(i);
+      // qDebug() << "session index" << i;
     }
     lastvalue = tmp;
   }
-  sessions.push_back(n-1);
+  sessions.push_back(n);
 
   //now construct a list of sessions with their times
   //total time
   int noSesions = sessions.size()-1;
   QString label = QString("%1 ").arg(noSesions);
   label += tr(noSesions > 1 ? "sessions" : "session");
-  label += " <" + tr("total duration ") + generateDuration(getRecordTimeStamp(1), getRecordTimeStamp(n-1)) + ">";
+  label += " <" + tr("total duration ") + generateDuration(getRecordTimeStamp(0), getRecordTimeStamp(n-1)) + ">";
   ui->sessions_CB->addItem(label);
 
   // add individual sessions
   if (sessions.size() > 2) {
     for (int i = 1; i < sessions.size(); i++) {
-      QDateTime sessionStart = getRecordTimeStamp(sessions.at(i-1)+1);
-      QDateTime sessionEnd = getRecordTimeStamp(sessions.at(i));
+      QDateTime sessionStart = getRecordTimeStamp(sessions.at(i-1));
+      QDateTime sessionEnd = getRecordTimeStamp(sessions.at(i)-1);
       QString label = sessionStart.toString("HH:mm:ss") + " <" + tr("duration ") + generateDuration(sessionStart, sessionEnd) + ">";
       ui->sessions_CB->addItem(label, sessions.at(i-1));
       // qDebug() << "added label" << label << sessions.at(i-1);
@@ -746,13 +732,13 @@ void LogsDialog::on_sessions_CB_currentIndexChanged(int index)
     if (index < ui->sessions_CB->count() - 1) {
       bottom = ui->sessions_CB->itemData(index + 1, Qt::UserRole).toInt();
     } else {
-      bottom = ui->logTable->rowCount();
+      bottom = logModel->rowCount();
     }
 
     QModelIndex topLeft = ui->logTable->model()->index(
       ui->sessions_CB->itemData(index, Qt::UserRole).toInt(), 0 , QModelIndex());
     QModelIndex bottomRight = ui->logTable->model()->index(
-      bottom - 1, ui->logTable->columnCount() - 1, QModelIndex());
+      bottom - 1, logModel->columnCount() - 1, QModelIndex());
 
     QItemSelection selection(topLeft, bottomRight);
     ui->logTable->selectionModel()->select(selection, QItemSelectionModel::Select);
@@ -771,70 +757,45 @@ void LogsDialog::plotLogs()
     return;
   }
 
-  plotsCollection plots;
-
-  QModelIndexList selection = ui->logTable->selectionModel()->selectedRows();
-  int rowCount = selection.length();
-  bool hasLogSelection;
-  QVarLengthArray<int> selectedRows;
-
-  if (rowCount) {
-    hasLogSelection = true;
-    foreach (QModelIndex index, selection) {
-      selectedRows.append(index.row());
-    }
-    qSort(selectedRows.begin(), selectedRows.end());
-  } else {
-    hasLogSelection = false;
-    rowCount = ui->logTable->rowCount();
+  plotRows = getSelectedRows();
+  if (plotRows.isEmpty()) {
+    plotRows.append(LogRows(0, logData.rowCount()));
   }
 
+  plots.coords.clear();
   plots.min_x = QDateTime::currentDateTime().toTime_t();
   plots.max_x = 0;
 
+  foreach (const LogRows & rows, plotRows) {
+    for (int row = rows.first; row < rows.second; row++) {
+      qint64 timestamp = logData.timestamp(row);
+      if (timestamp != LOG_INVALID_TIME) {
+        double time = timestamp / 1000.0;
+        if (plots.min_x > time) plots.min_x = time;
+        if (plots.max_x < time) plots.max_x = time;
+      }
+    }
+  }
+
   foreach (QTableWidgetItem *plot, ui->FieldsTW->selectedItems()) {
     coords plotCoords;
-    int plotColumn = plot->row() + 2; // Date and Time first
+    plotCoords.column = plot->row() + 2; // Date and Time first
 
     plotCoords.min_y = INVALID_MIN;
     plotCoords.max_y = INVALID_MAX;
     plotCoords.yaxis = firstLeft;
     plotCoords.name = plot->text();
-
-    for (int row = 0; row < rowCount; row++) {
-      QTableWidgetItem *logValue;
-      double y;
-      double time;
-      QString time_str;
-
-      if (hasLogSelection) {
-        logValue = ui->logTable->item(selectedRows.at(row), plotColumn);
-        time_str = ui->logTable->item(selectedRows.at(row), 0)->text() +
-          QString(" ") + ui->logTable->item(selectedRows.at(row), 1)->text();
-      } else {
-        logValue = ui->logTable->item(row, plotColumn);
-        time_str = ui->logTable->item(row, 0)->text() + QString(" ") +
-          ui->logTable->item(row, 1)->text();
+    plotCoords.yOffset = 0;
+    plotCoords.yFactor = 1;
+
+    foreach (const LogRows & rows, plotRows) {
+      if (rows.first < rows.second) {
+        LogExtent extent = logData.extent(plotCoords.column, rows);
+        double min_y = logData.value(extent.min, plotCoords.column);
+        double max_y = logData.value(extent.max, plotCoords.column);
+        if (plotCoords.min_y > min_y) plotCoords.min_y = min_y;
+        if (plotCoords.max_y < max_y) plotCoords.max_y = max_y;
       }
-
-      y = logValue->text().toDouble();
-      plotCoords.y.push_back(y);
-
-      if (plotCoords.min_y > y) plotCoords.min_y = y;
-      if (plotCoords.max_y < y) plotCoords.max_y = y;
-
-      if (time_str.contains('.')) {
-        time = QDateTime::fromString(time_str, "yyyy-MM-dd HH:mm:ss.zzz")
-          .toTime_t();
-        time += time_str.mid(time_str.indexOf('.')).toDouble();
-      } else {
-        time = QDateTime::fromString(time_str, "yyyy-MM-dd HH:mm:ss")
-          .toTime_t();
-      }
-      plotCoords.x.push_back(time);
-
-      if (plots.min_x > time) plots.min_x = time;
-      if (plots.max_x < time) plots.max_x = time;
     }
 
     double range_inc = (plotCoords.max_y - plotCoords.min_y) / 100;
@@ -909,11 +870,8 @@ void LogsDialog::plotLogs()
 
     for (int i = 0; i < plots.coords.size(); i++) {
       plots.coords[i].yaxis = firstLeft;
-
-      double factor = 100 / (plots.coords.at(i).max_y - plots.coords.at(i).min_y);
-      for (int j = 0; j < plots.coords.at(i).y.count(); j++) {
-        plots.coords[i].y[j] = factor * (plots.coords.at(i).y.at(j) - plots.coords.at(i).min_y);
-      }
+      plots.coords[i].yOffset = plots.coords.at(i).min_y;
+      plots.coords[i].yFactor = 100 / (plots.coords.at(i).max_y - plots.coords.at(i).min_y);
     }
   } else {
     for (int i = firstRight; i < AXES_LIMIT; i++) {
@@ -998,8 +956,7 @@ void LogsDialog::plotLogs()
         break;
     }
 
-    ui->customPlot->graph(i)->setData(plots.coords.at(i).x,
-      plots.coords.at(i).y);
+    setGraphData(i);
     pen.setColor(colors.at(i % colors.size()));
     ui->customPlot->graph(i)->setPen(pen);
 
@@ -1019,6 +976,36 @@ void LogsDialog::plotLogs()
   ui->customPlot->replot();
 }
 
+void LogsDialog::setGraphData(int index)
+{
+  const coords & c = plots.coords.at(index);
+  QCPRange range = axisRect->axis(QCPAxis::atBottom)->range();
+  QVector<double> x, y;
+
+  foreach (const LogRows & rows, plotRows) {
+    LogRows visible = rows;
+    if (logData.isChronological()) {
+      // the rows in the range, and one on each side for the lines to the edges
+      visible.first = qMax(rows.first, logData.lowerBound(floor(qBound(-1e15, range.lower * 1000, 1e15))) - 1);
+      visible.second = qMin(rows.second, logData.lowerBound(ceil(qBound(-1e15, range.upper * 1000, 1e15))) + 1);
+    }
+    logData.decimate(c.column, visible, axisRect->width(), x, y);
+  }
+
+  for (int i = 0; i < y.size(); i++) {
+    y[i] = (y.at(i) - c.yOffset) * c.yFactor;
+  }
+
+  ui->customPlot->graph(index)->setData(x, y);
+}
+
+void LogsDialog::xAxisChangeRanges(QCPRange range)
+{
+  for (int i = 0; i < ui->customPlot->graphCount() && i < plots.coords.size(); i++) {
+    setGraphData(i);
+  }
+}
+
 void LogsDialog::yAxisChangeRanges(QCPRange range)
 {
   if (axisRect->axis(QCPAxis::atRight)->visible()) {
@@ -1063,19 +1050,18 @@ void LogsDialog::yAxisChangeRanges(QCPRange range)
 
 
 void LogsDialog::addMaxAltitudeMarker(const coords & c, QCPGraph * graph) {
-  // find max altitude
-  int positionIndex = 0;
-  double maxAlt = -100000;
-
-  for(int i=0; i<c.x.count(); ++i) {
-    double alt = c.y.at(i);
-    if (alt > maxAlt) {
-      maxAlt = alt;
-      positionIndex = i;
-      // qDebug() << "max alt: " << maxAlt << "@" << result;
+  // find max altitude, the decimated graphs always have this point
+  int positionIndex = -1;
+
+  foreach (const LogRows & rows, plotRows) {
+    if (rows.first < rows.second) {
+      int row = logData.extent(c.column, rows).max;
+      if (positionIndex < 0 || logData.value(row, c.column) > logData.value(positionIndex, c.column)) {
+        positionIndex = row;
+      }
     }
   }
-  // qDebug() << "max alt: " << maxAlt << "@" << positionIndex; 
+  // qDebug() << "max alt: " << logData.value(positionIndex, c.column) << "@" << positionIndex;
 
   // add max altitude marker
   tracerMaxAlt = new QCPItemTracer(ui->customPlot);
@@ -1086,7 +1072,7 @@ void LogsDialog::addMaxAltitudeMarker(const coords & c, QCPGraph * graph) {
   tracerMaxAlt->setPen(QPen(Qt::blue));
   tracerMaxAlt->setBrush(Qt::NoBrush);
   tracerMaxAlt->setSize(7);
-  tracerMaxAlt->setGraphKey(c.x.at(positionIndex));
+  tracerMaxAlt->setGraphKey(logData.timestamp(positionIndex) / 1000.0);
   tracerMaxAlt->updatePosition();
 }
 
@@ -24,6 +24,7 @@
 #include <QtCore>
 #include <QtGui>
 #include "qcustomplot.h"
+#include "logsdata.h"
 
 #define INVALID_MIN 999999
 #define INVALID_MAX -999999
@@ -37,11 +38,14 @@ enum yaxes_t {
 };
 
 struct coords {
-  QVector<double> x, y;
+  int column;
   double min_y;
   double max_y;
   yaxes_t yaxis;
   QString name;
+  // the plotted values are (value - yOffset) * yFactor
+  double yOffset;
+  double yFactor;
 };
 
 struct minMax {
@@ -80,10 +84,12 @@ private slots:
   void on_fileOpen_BT_clicked();
   void on_sessions_CB_currentIndexChanged(int index);
   void on_mapsButton_clicked();
+  void xAxisChangeRanges(QCPRange range);
   void yAxisChangeRanges(QCPRange range);
 
 private:
-  QList<QStringList> csvlog;
+  LogsData logData;
+  LogsTableModel *logModel;
   Ui::LogsDialog *ui;
   QCPAxisRect *axisRect;
   QCPLegend *rightLegend;
@@ -96,17 +102,22 @@ private:
   double yAxesRatios[AXES_LIMIT];
   minMax yAxesRanges[AXES_LIMIT];
 
+  plotsCollection plots;
+  QVector<LogRows> plotRows;
+
   QCPItemTracer * tracerMaxAlt;
   QCPItemTracer * cursorA;
   QCPItemTracer * cursorB;
   QCPItemStraightLine * cursorLine;
 
   bool cvsFileParse();
-  QList<QStringList> filterGePoints(const QList<QStringList> & input);
+  QVector<LogRows> getSelectedRows();
+  QList<QStringList> filterGePoints();
   void exportToGoogleEarth();
   QDateTime getRecordTimeStamp(int index);
   QString generateDuration(const QDateTime & start, const QDateTime & end);
   void setFlightSessions();
+  void setGraphData(int index);
 
   void addMaxAltitudeMarker(const coords & c, QCPGraph * graph);
   void countNumberOfThrows(const coords & c, QCPGraph * graph);
@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <gtest/gtest.h>
+#include "eepromimportexport.h"
+#include "eeprominterface.h"
+#include "firmwares/opentx/opentxeeprom.h"
+
+struct Layout {
+  const char * firmware;
+  Board::Type board;
+  unsigned int version;
+};
+
+// the OpenTX boards in their last data version, and a few older ones still imported
+static const Layout layouts[] = {
+  { "opentx-x9d+",     BOARD_TARANIS_X9DP, 218 },
+  { "opentx-x9d",      BOARD_TARANIS_X9D,  218 },
+  { "opentx-x9d",      BOARD_TARANIS_X9D,  217 },
+  { "opentx-x9d",      BOARD_TARANIS_X9D,  216 },
+  { "opentx-x9e",      BOARD_TARANIS_X9E,  218 },
+  { "opentx-x9e",      BOARD_TARANIS_X9E,  217 },
+  { "opentx-x7",       BOARD_TARANIS_X7,   218 },
+  { "opentx-x12s",     BOARD_X12S,         218 },
+  { "opentx-x10",      BOARD_X10,          218 },
+  { "opentx-9xrpro",   BOARD_9XRPRO,       218 },
+  { "opentx-sky9x",    BOARD_SKY9X,        218 },
+  { "opentx-sky9x",    BOARD_SKY9X,        217 },
+  { "opentx-ar9x",     BOARD_AR9X,         218 },
+  { "opentx-9x128",    BOARD_M128,         217 },
+  { "opentx-gruvin9x", BOARD_GRUVIN9X,     217 },
+  { "opentx-mega2560", BOARD_MEGA2560,     217 },
+  { "opentx-9x",       BOARD_STOCK,        216 },
+};
+
+TEST(EepromImportExport, wideUnsignedField)
+{
+  unsigned int before = 5, after = 0x15;
+  uint64_t value = 0x8123456789ABCDEFull;
+
+  StructField structure(NULL);
+  structure.Append(new UnsignedField<3>(&structure, before));
+  structure.Append(new BaseUnsignedField<uint64_t, 64>(&structure, value));
+  structure.Append(new UnsignedField<5>(&structure, after));
+
+  QByteArray data;
+  structure.Export(data);
+  ASSERT_EQ(9, data.size());
+
+  ImportBuffer buffer(data);
+  EXPECT_EQ(5u, buffer.readBits(3));
+  EXPECT_EQ(0x89ABCDEFu, buffer.readBits(32));
+  EXPECT_EQ(0x81234567u, buffer.readBits(32));
+  EXPECT_EQ(0x15u, buffer.readBits(5));
+
+  before = after = 0;
+  value = 0;
+  ASSERT_EQ(0, structure.Import(data));
+  EXPECT_EQ(5u, before);
+  EXPECT_EQ(0x8123456789ABCDEFull, value);
+  EXPECT_EQ(0x15u, after);
+}
+
+// export, import and export again must give the same bytes
+TEST(EepromImportExport, modelRoundTrip)
+{
+  for (const Layout & layout : layouts) {
+    SCOPED_TRACE(QString("%1 %2").arg(layout.firmware).arg(layout.version).toStdString());
+    current_firmware_variant = getFirmware(layout.firmware);
+
+    ModelData model;
+    model.used = true;
+    strcpy(model.name, "ROUNDTRIP");
+    model.switchWarningStates = 0x0123456789ABCDEFull;
+
+    QByteArray first, second;
+    OpenTxModelData(model, layout.board, layout.version, 0).Export(first);
+    ModelData imported;
+    ASSERT_EQ(0, OpenTxModelData(imported, layout.board, layout.version, 0).Import(first));
+    OpenTxModelData(imported, layout.board, layout.version, 0).Export(second);
+    EXPECT_EQ(first, second);
+  }
+}
+
+TEST(EepromImportExport, radioSettingsRoundTrip)
+{
+  for (const Layout & layout : layouts) {
+    SCOPED_TRACE(QString("%1 %2").arg(layout.firmware).arg(layout.version).toStdString());
+    current_firmware_variant = getFirmware(layout.firmware);
+
+    GeneralSettings settings;
+    QByteArray first, second;
+    OpenTxGeneralData(settings, layout.board, layout.version).Export(first);
+    GeneralSettings imported;
+    ASSERT_EQ(0, OpenTxGeneralData(imported, layout.board, layout.version).Import(first));
+    OpenTxGeneralData(imported, layout.board, layout.version).Export(second);
+    EXPECT_EQ(first, second);
+  }
+}
+
+// a model with the values the fields only compute for some functions and sensor types
+static void fillSharedLayoutModel(ModelData & model)
+{
+  model.used = true;
+  strcpy(model.name, "FIRST");
+  model.customFn[0].swtch = RawSwitch(SWITCH_TYPE_VIRTUAL, 1);
+  model.customFn[0].func = FuncPlayPrompt;
+  strcpy(model.customFn[0].paramarm, "PROMPT");
+  model.logicalSw[0].func = LS_FN_EDGE;
+  model.logicalSw[0].val1 = RawSwitch(SWITCH_TYPE_VIRTUAL, 2).toValue();
+  model.logicalSw[0].val2 = 10;
+  model.logicalSw[0].val3 = 20;
+  model.sensorData[0].type = SensorData::TELEM_TYPE_CUSTOM;
+  model.sensorData[0].id = 0x5678;
+  model.sensorData[0].subid = 3;
+  model.sensorData[0].ratio = 1234;
+}
+
+// a model exported or imported through a layout after another one must give the same
+// bytes as through its own fields
+TEST(EepromImportExport, sharedLayout)
+{
+  for (const Layout & layout : layouts) {
+    SCOPED_TRACE(QString("%1 %2").arg(layout.firmware).arg(layout.version).toStdString());
+    current_firmware_variant = getFirmware(layout.firmware);
+    OpenTxModelLayout * modelLayout = OpenTxModelLayout::getInstance(layout.board, layout.version);
+    ASSERT_EQ(modelLayout, OpenTxModelLayout::getInstance(layout.board, layout.version));
+
+    ModelData first;
+    fillSharedLayoutModel(first);
+    ModelData second;
+    second.used = true;
+    strcpy(second.name, "SECOND");
+    second.customFn[0].swtch = RawSwitch(SWITCH_TYPE_VIRTUAL, 1);
+    second.customFn[0].func = FuncTrainer;
+    second.sensorData[0].type = SensorData::TELEM_TYPE_CALCULATED;
+    second.sensorData[0].formula = SensorData::TELEM_FORMULA_ADD;
+
+    QByteArray firstData, secondData, expected;
+    modelLayout->Export(first, firstData);
+    modelLayout->Export(second, secondData);
+    OpenTxModelData(second, layout.board, layout.version, 0).Export(expected);
+    EXPECT_EQ(expected, secondData);
+
+    ModelData firstImport, imported, expectedImport;
+    ASSERT_EQ(0, modelLayout->Import(firstImport, firstData));
+    ASSERT_EQ(0, modelLayout->Import(imported, secondData));
+    ASSERT_EQ(0, OpenTxModelData(expectedImport, layout.board, layout.version, 0).Import(secondData));
+    QByteArray importedData;
+    OpenTxModelData(expectedImport, layout.board, layout.version, 0).Export(expected);
+    OpenTxModelData(imported, layout.board, layout.version, 0).Export(importedData);
+    EXPECT_EQ(expected, importedData);
+  }
+}
+
+TEST(EepromImportExport, x9eSwitchesWarningStates)
+{
+  // 18 switches, their warning states need more than 32 bits
+  current_firmware_variant = getFirmware("opentx-x9e");
+
+  ModelData model;
+  model.switchWarningStates = 0x0000000F00000001ull;
+
+  QByteArray data;
+  OpenTxModelData(model, BOARD_TARANIS_X9E, 218, 0).Export(data);
+  ModelData imported;
+  ASSERT_EQ(0, OpenTxModelData(imported, BOARD_TARANIS_X9E, 218, 0).Import(data));
+  EXPECT_EQ(0x0000000F00000001ull, imported.switchWarningStates);
+}
@@ -488,6 +488,10 @@ AudioQueue::AudioQueue()
   priorityContext(),
   varioContext(),
   fragmentsFifo()
+#if defined(PROMPT_CACHE)
+  , promptsToPreload(0),
+  promptsInvalid(false)
+#endif
 {
 }
 
@@ -531,99 +535,373 @@ inline void mixSample(audio_data_t * result, int sample, unsigned int fade)
 #if defined(SDCARD)
 
 #define RIFF_CHUNK_SIZE 12
-uint8_t wavBuffer[AUDIO_BUFFER_SIZE*2] __DMA;
 
-int WavContext::mixBuffer(AudioBuffer *buffer, int volume, unsigned int fade)
+// the samples are decoded once, then mixed resampleRatio times
+inline audio_data_t * mixWavSamples(audio_data_t * samples, int sample, uint8_t resampleRatio, unsigned int fade)
 {
-  FRESULT result = FR_OK;
+  int value = (sample >> fade) >> (16-AUDIO_BITS_PER_SAMPLE);
+  for (uint8_t j=0; j<resampleRatio; j++) {
+    *samples = limit<int>(AUDIO_DATA_MIN, *samples + value, AUDIO_DATA_MAX);
+    samples++;
+  }
+  return samples;
+}
+
+audio_data_t * mixWavPcm(audio_data_t * samples, const int16_t * data, uint32_t count, uint8_t resampleRatio, unsigned int fade)
+{
+  for (uint32_t i=0; i<count; i++) {
+    samples = mixWavSamples(samples, data[i], resampleRatio, fade);
+  }
+  return samples;
+}
+
+audio_data_t * mixWavLaw(audio_data_t * samples, const uint8_t * data, uint32_t count, const int16_t * table, uint8_t resampleRatio, unsigned int fade)
+{
+  for (uint32_t i=0; i<count; i++) {
+    samples = mixWavSamples(samples, table[data[i]], resampleRatio, fade);
+  }
+  return samples;
+}
+
+#if defined(PROMPT_CACHE)
+// The short prompts, decoded to 16 bits samples at their own rate. The least recently used
+// prompts are freed, except those being played.
+PromptCacheEntry promptCacheEntries[PROMPT_CACHE_ENTRIES];
+uint32_t promptCacheUses = 0;
+PromptCacheStats promptCacheStats;
+
+const PromptCacheEntry * getPromptCacheEntry(const char * filename)
+{
+  for (int i=0; i<PROMPT_CACHE_ENTRIES; i++) {
+    PromptCacheEntry & entry = promptCacheEntries[i];
+    if (entry.samples && entry.loaded == entry.count && !strcmp(entry.file, filename)) {
+      entry.lastUse = ++promptCacheUses;
+      promptCacheStats.noHits++;
+      return &entry;
+    }
+  }
+  promptCacheStats.noMisses++;
+  return NULL;
+}
+
+void freePromptCacheEntry(PromptCacheEntry & entry)
+{
+  if (entry.samples) {
+    promptCacheStats.size -= entry.count * sizeof(int16_t);
+    free(entry.samples);
+    entry.samples = NULL;
+  }
+  entry.file[0] = '\0';
+}
+
+// a prompt being played is freed later, as the first one to be evicted
+void dropPromptCacheEntry(PromptCacheEntry & entry)
+{
+  if (audioQueue.isPromptPlaying(&entry)) {
+    entry.file[0] = '\0';
+    entry.lastUse = 0;
+  }
+  else {
+    freePromptCacheEntry(entry);
+  }
+}
+
+PromptCacheEntry * allocatePromptCacheEntry(uint32_t count)
+{
+  uint32_t size = count * sizeof(int16_t);
+
+  // free the least recently used prompts until there is room for this one
+  while (true) {
+    PromptCacheEntry * result = NULL;
+    PromptCacheEntry * oldest = NULL;
+    for (int i=0; i<PROMPT_CACHE_ENTRIES; i++) {
+      PromptCacheEntry & entry = promptCacheEntries[i];
+      if (!entry.samples)
+        result = &entry;
+      else if (!audioQueue.isPromptPlaying(&entry) && (!oldest || entry.lastUse < oldest->lastUse))
+        oldest = &entry;
+    }
+    if (result && promptCacheStats.size + size <= PROMPT_CACHE_MAX_SIZE) {
+      result->samples = (int16_t *)malloc(size);
+      if (!result->samples) {
+        return NULL;
+      }
+      result->file[0] = '\0';
+      result->count = count;
+      result->loaded = 0;
+      result->lastUse = 0;
+      promptCacheStats.size += size;
+      return result;
+    }
+    if (!oldest) {
+      return NULL;
+    }
+    freePromptCacheEntry(*oldest);
+    promptCacheStats.noEvictions++;
+  }
+}
+#endif
+
+// parses the header, then reads ahead the first samples
+FRESULT WavContext::open()
+{
+  uint8_t * buffer = state.data;
   UINT read = 0;
 
-  if (fragment.file[1]) {
-    result = f_open(&state.file, fragment.file, FA_OPEN_EXISTING | FA_READ);
+#if defined(PROMPT_CACHE)
+  char filename[AUDIO_FILENAME_MAXLEN+1];
+  strcpy(filename, fragment.file);
+  state.loading = NULL;
+  state.prompt = getPromptCacheEntry(filename);
+  if (state.prompt) {
     fragment.file[1] = 0;
-    if (result == FR_OK) {
-      result = f_read(&state.file, wavBuffer, RIFF_CHUNK_SIZE+8, &read);
-      if (result == FR_OK && read == RIFF_CHUNK_SIZE+8 && !memcmp(wavBuffer, "RIFF", 4) && !memcmp(wavBuffer+8, "WAVEfmt ", 8)) {
-        uint32_t size = *((uint32_t *)(wavBuffer+16));
-        result = (size < 256 ? f_read(&state.file, wavBuffer, size+8, &read) : FR_DENIED);
-        if (result == FR_OK && read == size+8) {
-          state.codec = ((uint16_t *)wavBuffer)[0];
-          state.freq = ((uint16_t *)wavBuffer)[2];
-          uint32_t *wavSamplesPtr = (uint32_t *)(wavBuffer + size);
-          uint32_t size = wavSamplesPtr[1];
-          if (state.freq != 0 && state.freq * (AUDIO_SAMPLE_RATE / state.freq) == AUDIO_SAMPLE_RATE) {
-            state.resampleRatio = (AUDIO_SAMPLE_RATE / state.freq);
-            state.readSize = (state.codec == CODEC_ID_PCM_S16LE ? 2*AUDIO_BUFFER_SIZE : AUDIO_BUFFER_SIZE) / state.resampleRatio;
-          }
-          else {
-            result = FR_DENIED;
-          }
-          while (result == FR_OK && memcmp(wavSamplesPtr, "data", 4) != 0) {
-            result = f_lseek(&state.file, f_tell(&state.file)+size);
-            if (result == FR_OK) {
-              result = f_read(&state.file, wavBuffer, 8, &read);
-              if (read != 8) result = FR_DENIED;
-              wavSamplesPtr = (uint32_t *)wavBuffer;
-              size = wavSamplesPtr[1];
-            }
-          }
-          state.size = size;
-        }
-        else {
-          result = FR_DENIED;
-        }
-      }
-      else {
-        result = FR_DENIED;
-      }
+    state.resampleRatio = state.prompt->resampleRatio;
+    state.readPos = 0;
+    state.dataEnd = state.prompt->count;
+    return FR_OK;
+  }
+#endif
+
+  FRESULT result = f_open(&state.file, fragment.file, FA_OPEN_EXISTING | FA_READ);
+  fragment.file[1] = 0;
+  if (result != FR_OK) {
+    return result;
+  }
+
+  result = f_read(&state.file, buffer, RIFF_CHUNK_SIZE+8, &read);
+  if (result != FR_OK || read != RIFF_CHUNK_SIZE+8 || memcmp(buffer, "RIFF", 4) || memcmp(buffer+8, "WAVEfmt ", 8)) {
+    return FR_DENIED;
+  }
+
+  uint32_t size = *((uint32_t *)(buffer+16));
+  result = (size < 256 ? f_read(&state.file, buffer, size+8, &read) : FR_DENIED);
+  if (result != FR_OK || read != size+8) {
+    return FR_DENIED;
+  }
+
+  state.codec = ((uint16_t *)buffer)[0];
+  state.freq = ((uint16_t *)buffer)[2];
+  uint32_t * wavSamplesPtr = (uint32_t *)(buffer + size);
+  size = wavSamplesPtr[1];
+  if (state.freq != 0 && state.freq * (AUDIO_SAMPLE_RATE / state.freq) == AUDIO_SAMPLE_RATE) {
+    state.resampleRatio = (AUDIO_SAMPLE_RATE / state.freq);
+    state.readSize = (state.codec == CODEC_ID_PCM_S16LE ? 2*AUDIO_BUFFER_SIZE : AUDIO_BUFFER_SIZE) / state.resampleRatio;
+  }
+  else {
+    return FR_DENIED;
+  }
+
+  while (memcmp(wavSamplesPtr, "data", 4) != 0) {
+    result = f_lseek(&state.file, f_tell(&state.file)+size);
+    if (result != FR_OK) {
+      return result;
+    }
+    result = f_read(&state.file, buffer, 8, &read);
+    if (result != FR_OK || read != 8) {
+      return FR_DENIED;
     }
+    wavSamplesPtr = (uint32_t *)buffer;
+    size = wavSamplesPtr[1];
   }
 
-  if (result == FR_OK) {
-    read = 0;
-    result = f_read(&state.file, wavBuffer, state.readSize, &read);
-    if (result == FR_OK) {
-      if (read > state.size) {
-        read = state.size;
-      }
-      state.size -= read;
+  state.readPos = state.fillPos = f_tell(&state.file);
+  state.dataEnd = state.readPos + size;
 
-      if (read != state.readSize) {
-        f_close(&state.file);
-        fragment.clear();
-      }
+#if defined(PROMPT_CACHE)
+  if (state.codec == CODEC_ID_PCM_S16LE || state.codec == CODEC_ID_PCM_ALAW || state.codec == CODEC_ID_PCM_MULAW) {
+    uint32_t count = (state.codec == CODEC_ID_PCM_S16LE ? size / 2 : size);
+    if (count > 0 && count * sizeof(int16_t) <= PROMPT_CACHE_MAX_FILE_SIZE) {
+      startLoad(filename, count);
+    }
+  }
+#endif
 
-      audio_data_t * samples = buffer->data;
-      if (state.codec == CODEC_ID_PCM_S16LE) {
-        read /= 2;
-        for (uint32_t i=0; i<read; i++) {
-          for (uint8_t j=0; j<state.resampleRatio; j++) {
-            mixSample(samples++, ((int16_t *)wavBuffer)[i], fade+2-volume);
-          }
-        }
-      }
-      else if (state.codec == CODEC_ID_PCM_ALAW) {
-        for (uint32_t i=0; i<read; i++) {
-          for (uint8_t j=0; j<state.resampleRatio; j++) {
-            mixSample(samples++, alawTable[wavBuffer[i]], fade+2-volume);
-          }
-        }
-      }
-      else if (state.codec == CODEC_ID_PCM_MULAW) {
-        for (uint32_t i=0; i<read; i++) {
-          for (uint8_t j=0; j<state.resampleRatio; j++) {
-            mixSample(samples++, ulawTable[wavBuffer[i]], fade+2-volume);
-          }
-        }
-      }
+  return fill();
+}
 
-      return samples - buffer->data;
+#if defined(PROMPT_CACHE)
+// allocates a cache entry for the file, its samples are decoded in it while they are played,
+// so that a miss costs no more SD reads than an uncached file
+void WavContext::startLoad(const char * filename, uint32_t count)
+{
+  FILINFO info;
+
+  if (f_stat(filename, &info) == FR_OK) {
+    state.loading = allocatePromptCacheEntry(count);
+    if (state.loading) {
+      strcpy(state.loading->file, filename);
+      state.loading->fdate = info.fdate;
+      state.loading->ftime = info.ftime;
+      state.loading->resampleRatio = state.resampleRatio;
     }
   }
+}
 
-  if (result != FR_OK) {
+void WavContext::cacheSamples(const uint8_t * data, uint32_t size)
+{
+  PromptCacheEntry * entry = state.loading;
+  int16_t * samples = entry->samples + entry->loaded;
+
+  if (state.codec == CODEC_ID_PCM_S16LE) {
+    uint32_t count = min<uint32_t>(size / 2, entry->count - entry->loaded);
+    memcpy(samples, data, count * sizeof(int16_t));
+    entry->loaded += count;
+  }
+  else {
+    const int16_t * table = (state.codec == CODEC_ID_PCM_ALAW ? alawTable : ulawTable);
+    uint32_t count = min<uint32_t>(size, entry->count - entry->loaded);
+    for (uint32_t i=0; i<count; i++) {
+      samples[i] = table[data[i]];
+    }
+    entry->loaded += count;
+  }
+}
+
+// the entry is left unused (and evicted first) when the file is not played until its end
+void WavContext::finishLoad()
+{
+  PromptCacheEntry * entry = state.loading;
+  state.loading = NULL;
+
+  if (entry->loaded == 0) {
+    freePromptCacheEntry(*entry);
+    return;
+  }
+
+  // the file may be shorter than its header says
+  promptCacheStats.size -= (entry->count - entry->loaded) * sizeof(int16_t);
+  entry->count = entry->loaded;
+  if (entry->file[0]) {
+    entry->lastUse = ++promptCacheUses;
+  }
+}
+
+// decodes in the cache the samples read ahead, without playing them. The context is cleared
+// once the whole file is in the cache, or when it cannot be cached
+void WavContext::preload()
+{
+  FRESULT result = (fragment.file[1] ? open() : fill());
+
+  if (result != FR_OK || state.prompt) {
     clear();
+    return;
   }
+
+  if (state.loading) {
+    while (state.readPos < state.fillPos) {
+      uint32_t offset = state.readPos % WAV_BUFFER_SIZE;
+      uint32_t count = min<uint32_t>(state.fillPos - state.readPos, WAV_BUFFER_SIZE - offset);
+      cacheSamples(state.data + offset, count);
+      state.readPos += count;
+    }
+    if (state.readPos < state.dataEnd) {
+      return;
+    }
+    finishLoad();
+  }
+
+  f_close(&state.file);
+  clear();
+}
+#endif
+
+// reads ahead as much as the buffer can take. Apart from the first one, the reads are whole
+// sectors, which FatFs transfers directly in the buffer instead of going through the file sector
+FRESULT WavContext::fill()
+{
+  while (state.fillPos < state.dataEnd) {
+    uint32_t offset = state.fillPos % WAV_BUFFER_SIZE;
+    uint32_t count = min<uint32_t>(WAV_BUFFER_SIZE - (state.fillPos - state.readPos), WAV_BUFFER_SIZE - offset);
+    if (state.fillPos + count < state.dataEnd) {
+      count -= (state.fillPos + count) % 512;
+    }
+    else {
+      count = state.dataEnd - state.fillPos;
+    }
+    if (count == 0) {
+      break;
+    }
+
+    UINT read = 0;
+    FRESULT result = f_read(&state.file, state.data + offset, count, &read);
+    if (result != FR_OK) {
+      return result;
+    }
+    state.fillPos += read;
+    if (read != count) {
+      // the file is shorter than its header says
+      state.dataEnd = state.fillPos;
+    }
+  }
+  return FR_OK;
+}
+
+int WavContext::mixBuffer(AudioBuffer *buffer, int volume, unsigned int fade)
+{
+  FRESULT result = FR_OK;
+
+  if (fragment.file[1]) {
+    result = open();
+  }
+#if defined(PROMPT_CACHE)
+  else if (state.prompt) {
+    result = FR_OK;
+  }
+#endif
+  else {
+    result = fill();
+  }
+
+  if (result == FR_OK) {
+    audio_data_t * samples = buffer->data;
+
+#if defined(PROMPT_CACHE)
+    if (state.prompt) {
+      uint32_t count = min<uint32_t>(AUDIO_BUFFER_SIZE / state.resampleRatio, state.dataEnd - state.readPos);
+      samples = mixWavPcm(samples, state.prompt->samples + state.readPos, count, state.resampleRatio, fade+2-volume);
+      state.readPos += count;
+      if (state.readPos >= state.dataEnd) {
+        fragment.clear();
+      }
+      return samples - buffer->data;
+    }
+#endif
+    uint32_t size = min<uint32_t>(state.readSize, state.fillPos - state.readPos);
+
+    // at most 2 segments when the samples wrap around the end of the buffer
+    while (size > 0) {
+      uint32_t offset = state.readPos % WAV_BUFFER_SIZE;
+      uint32_t count = min<uint32_t>(size, WAV_BUFFER_SIZE - offset);
+      const uint8_t * data = state.data + offset;
+      if (state.codec == CODEC_ID_PCM_S16LE)
+        samples = mixWavPcm(samples, (const int16_t *)data, count / 2, state.resampleRatio, fade+2-volume);
+      else if (state.codec == CODEC_ID_PCM_ALAW)
+        samples = mixWavLaw(samples, data, count, alawTable, state.resampleRatio, fade+2-volume);
+      else if (state.codec == CODEC_ID_PCM_MULAW)
+        samples = mixWavLaw(samples, data, count, ulawTable, state.resampleRatio, fade+2-volume);
+#if defined(PROMPT_CACHE)
+      if (state.loading) {
+        cacheSamples(data, count);
+      }
+#endif
+      state.readPos += count;
+      size -= count;
+    }
+
+    if (state.readPos >= state.dataEnd) {
+#if defined(PROMPT_CACHE)
+      if (state.loading) {
+        finishLoad();
+      }
+#endif
+      f_close(&state.file);
+      fragment.clear();
+    }
+
+    return samples - buffer->data;
+  }
+
+  clear();
   return 0;
 }
 #else
@@ -734,6 +1012,15 @@ void AudioQueue::wakeup()
   audioConsumeCurrentBuffer();
   DEBUG_TIMER_STOP(debugTimerAudioConsume);
 
+#if defined(PROMPT_CACHE)
+  if (promptsInvalid) {
+    promptsInvalid = false;
+    for (int i=0; i<PROMPT_CACHE_ENTRIES; i++) {
+      dropPromptCacheEntry(promptCacheEntries[i]);
+    }
+  }
+#endif
+
   AudioBuffer * buffer;
   while ((buffer = buffersFifo.getEmptyBuffer()) != 0) {
     int result;
@@ -757,6 +1044,9 @@ void AudioQueue::wakeup()
       CoEnterMutexSection(audioMutex);
       normalContext.setFragment(fragmentsFifo.get());
       CoLeaveMutexSection(audioMutex);
+#if defined(SDCARD)
+      takeNextFile();
+#endif
     }
     result = normalContext.mixBuffer(buffer, g_eeGeneral.beepVolume, g_eeGeneral.wavVolume, fade);
     if (result > 0) {
@@ -799,7 +1089,88 @@ void AudioQueue::wakeup()
     audioConsumeCurrentBuffer();
     DEBUG_TIMER_STOP(debugTimerAudioConsume);
   }
+
+#if defined(SDCARD)
+  // the buffers are filled, there is time to open the next file
+  prefetchNextFile();
+#endif
+
+#if defined(PROMPT_CACHE)
+  if (promptsToPreload || preloadContext.isFile()) {
+    preloadNextPrompt();
+  }
+#endif
+}
+
+#if defined(SDCARD)
+void AudioQueue::prefetchNextFile()
+{
+  AudioFragment fragment;
+
+  CoEnterMutexSection(audioMutex);
+  const AudioFragment * next = fragmentsFifo.peek();
+  if (next && next->type == FRAGMENT_FILE) {
+    fragment = *next;
+  }
+  CoLeaveMutexSection(audioMutex);
+
+  if (fragment.type != FRAGMENT_FILE) {
+    nextContext.clear();
+    nextFragment.clear();
+  }
+  else if (nextFragment.type != FRAGMENT_FILE || strcmp(nextFragment.file, fragment.file)) {
+    nextFragment = fragment;
+    nextContext.setFragment(fragment.file, fragment.repeat, fragment.id);
+    if (nextContext.open() != FR_OK) {
+      nextContext.clear();
+    }
+  }
+}
+
+// the fragment just taken from the queue may have been opened by prefetchNextFile()
+void AudioQueue::takeNextFile()
+{
+  if (nextContext.isFile() && normalContext.isFile(nextFragment.file)) {
+    normalContext.setWav(nextContext);
+    nextContext.clear();
+    nextFragment.clear();
+  }
+}
+#endif
+
+#if defined(PROMPT_CACHE)
+bool AudioQueue::isPromptPlaying(const PromptCacheEntry * entry) const
+{
+  return normalContext.usesPrompt(entry) || backgroundContext.usesPrompt(entry) || nextContext.usesPrompt(entry) || preloadContext.usesPrompt(entry);
+}
+
+// one step per call: first the cached files are checked against their date on the SD card,
+// then the number prompts are loaded, one read ahead buffer at a time
+void AudioQueue::preloadNextPrompt()
+{
+  if (preloadContext.isFile()) {
+    preloadContext.preload();
+    return;
+  }
+
+  if (promptsToPreload > PROMPT_CACHE_NUMBERS) {
+    FILINFO info;
+    for (int i=0; i<PROMPT_CACHE_ENTRIES; i++) {
+      PromptCacheEntry & entry = promptCacheEntries[i];
+      if (entry.file[0] && (f_stat(entry.file, &info) != FR_OK || info.fdate != entry.fdate || info.ftime != entry.ftime)) {
+        dropPromptCacheEntry(entry);
+      }
+    }
+  }
+  else {
+    char filename[AUDIO_FILENAME_MAXLEN+1];
+    getNumberPromptFile(filename, PROMPT_CACHE_NUMBERS - promptsToPreload);
+    preloadContext.setFragment(filename, 0, 0);
+    preloadContext.preload();
+  }
+  promptsToPreload--;
 }
+#endif
 
 inline unsigned int getToneLength(uint16_t len)
 {
@@ -915,6 +1286,9 @@ void AudioQueue::stopPlay(uint8_t id)
 void AudioQueue::stopSD()
 {
   sdAvailableSystemAudioFiles.reset();
+#if defined(PROMPT_CACHE)
+  invalidatePrompts();
+#endif
   stopAll();
   playTone(0, 0, 100, PLAY_NOW);        // insert a 100ms pause
 }
@@ -1210,16 +1584,23 @@ void pushUnit(uint8_t unit, uint8_t idx, uint8_t id)
 }
 #endif
 
-void pushPrompt(uint16_t prompt, uint8_t id)
-{
 #if defined(SDCARD)
-  char filename[AUDIO_FILENAME_MAXLEN+1];
+void getNumberPromptFile(char * filename, uint16_t prompt)
+{
   char * str = strAppendSystemAudioPath(filename);
   strcpy(str, "0000" SOUNDS_EXT);
   for (int8_t i=3; i>=0; i--) {
     str[i] = '0' + (prompt%10);
     prompt /= 10;
   }
+}
+#endif
+
+void pushPrompt(uint16_t prompt, uint8_t id)
+{
+#if defined(SDCARD)
+  char filename[AUDIO_FILENAME_MAXLEN+1];
+  getNumberPromptFile(filename, prompt);
   audioQueue.playFile(filename, 0, id);
 #endif
 }
@@ -80,6 +80,25 @@ template <unsigned int NUM_BITS> class BitField {
   #define AUDIO_BUFFER_COUNT           (3)
 #endif
 
+// read-ahead of each wav file, in SD sectors. It must hold one sector more than a 10ms buffer
+// of 32kHz PCM (640 bytes). Each WavContext has its own: the normal and background channels,
+// the next file of the queue (its first samples are read while the current file plays) and the
+// prompts preload on Horus. This is 4.5kB on Taranis and 8kB on Horus, in the AudioQueue
+#if defined(PCBHORUS)
+  #define WAV_BUFFER_SIZE              (4*512)
+#else
+  #define WAV_BUFFER_SIZE              (3*512)
+#endif
+
+// the short prompts are kept decoded in SDRAM, they are not read again from the SD card
+#if defined(PCBHORUS) && defined(SDCARD)
+  #define PROMPT_CACHE
+  #define PROMPT_CACHE_ENTRIES         (48)
+  #define PROMPT_CACHE_MAX_SIZE        (1024*1024)  // in bytes
+  #define PROMPT_CACHE_MAX_FILE_SIZE   (64*1024)    // decoded size of the biggest cached prompt
+  #define PROMPT_CACHE_NUMBERS         (21)         // 0000.wav to 0020.wav are loaded with the model
+#endif
+
 #define BEEP_MIN_FREQ                  (150)
 #define BEEP_MAX_FREQ                  (15000)
 #define BEEP_DEFAULT_FREQ              (2250)
@@ -203,12 +222,36 @@ class ToneContext {
 
 };
 
+#if defined(PROMPT_CACHE)
+struct PromptCacheEntry {
+  char     file[AUDIO_FILENAME_MAXLEN+1];   // empty when the entry must not be used anymore
+  uint16_t fdate;
+  uint16_t ftime;
+  uint8_t  resampleRatio;
+  uint32_t count;                           // number of samples
+  uint32_t loaded;                          // number of samples decoded, the entry is used once it reaches count
+  uint32_t lastUse;
+  int16_t * samples;
+};
+
+struct PromptCacheStats {
+  uint32_t noHits;
+  uint32_t noMisses;
+  uint32_t noEvictions;
+  uint32_t size;
+};
+
+extern PromptCacheStats promptCacheStats;
+#endif
+
 class WavContext {
   public:
 
     inline void clear() { fragment.clear(); };
 
     int mixBuffer(AudioBuffer *buffer, int volume, unsigned int fade);
+    FRESULT open();
+    bool isFile() const { return fragment.type == FRAGMENT_FILE; };
     bool hasId(uint8_t id) const { return fragment.id == id; };
 
     void setFragment(const char * filename, uint8_t repeat, uint8_t id)
@@ -223,17 +266,39 @@ class WavContext {
       }
     }
 
+#if defined(PROMPT_CACHE)
+    bool usesPrompt(const PromptCacheEntry * entry) const { return isFile() && (state.prompt == entry || state.loading == entry); };
+    void preload();
+#endif
+
   private:
     AudioFragment fragment;
 
     struct {
+#if defined(PROMPT_CACHE)
+      // when set, the samples are read from the cache (readPos and dataEnd are then sample indexes)
+      const PromptCacheEntry * prompt;
+      // when set, the samples read from the file are also decoded in this entry
+      PromptCacheEntry * loading;
+#endif
       FIL      file;
       uint8_t  codec;
       uint32_t freq;
-      uint32_t size;
       uint8_t  resampleRatio;
       uint16_t readSize;
+      // file offsets: the samples from readPos to fillPos are in data, at offset % WAV_BUFFER_SIZE
+      uint32_t readPos;
+      uint32_t fillPos;
+      uint32_t dataEnd;
+      uint8_t  data[WAV_BUFFER_SIZE] __attribute__((aligned(4)));
     } state;
+
+    FRESULT fill();
+#if defined(PROMPT_CACHE)
+    void startLoad(const char * filename, uint32_t count);
+    void cacheSamples(const uint8_t * data, uint32_t size);
+    void finishLoad();
+#endif
 };
 
 class MixedContext {
@@ -256,13 +321,23 @@ class MixedContext {
 
     inline void clear()
     {
-      tone.clear();   // the biggest member of the uninon
+      tone.clear();   // clears the fragment shared by tone and wav, the wav state is set by open() or setWav()
     }
 
     bool isEmpty() const { return fragment.type == FRAGMENT_EMPTY; };
     bool isTone() const { return fragment.type == FRAGMENT_TONE; };
     bool isFile() const { return fragment.type == FRAGMENT_FILE; };
+    bool isFile(const char * filename) const { return isFile() && !strcmp(fragment.file, filename); };
     bool hasId(uint8_t id) const { return fragment.id == id; };
+#if defined(PROMPT_CACHE)
+    bool usesPrompt(const PromptCacheEntry * entry) const { return isFile() && wav.usesPrompt(entry); };
+#endif
+
+    // takes a wav already opened
+    void setWav(const WavContext & context)
+    {
+      wav = context;
+    }
 
     int mixBuffer(AudioBuffer *buffer, int toneVolume, int wavVolume, unsigned int fade)
     {
@@ -440,6 +515,11 @@ class AudioFragmentFifo
       widx = ridx;                      // clean the queue
     }
 
+    const AudioFragment * peek() const
+    {
+      return empty() ? 0 : &fragments[ridx];
+    }
+
     const AudioFragment * get()
     {
       if (!empty()) {
@@ -486,6 +566,11 @@ class AudioQueue {
     bool isEmpty() const { return fragmentsFifo.empty(); };
     void wakeup();
     bool started() const { return _started; };
+#if defined(PROMPT_CACHE)
+    void preloadPrompts() { promptsToPreload = PROMPT_CACHE_NUMBERS + 1; };
+    void invalidatePrompts() { promptsInvalid = true; };
+    bool isPromptPlaying(const PromptCacheEntry * entry) const;
+#endif
 
     AudioBufferFifo buffersFifo;
 
@@ -496,6 +581,23 @@ class AudioQueue {
     ToneContext  priorityContext;
     ToneContext  varioContext;
     AudioFragmentFifo fragmentsFifo;
+#if defined(SDCARD)
+    // the next file of the queue, opened while the current fragment plays
+    AudioFragment nextFragment;
+    WavContext    nextContext;
+
+    void prefetchNextFile();
+    void takeNextFile();
+#endif
+#if defined(PROMPT_CACHE)
+    // these requests come from other tasks, the cache is only changed by the audio task
+    volatile uint8_t promptsToPreload;
+    volatile bool promptsInvalid;
+    // the number prompt being decoded in the cache
+    WavContext preloadContext;
+
+    void preloadNextPrompt();
+#endif
 };
 
 extern uint8_t currentSpeakerVolume;
@@ -580,6 +682,7 @@ enum AutomaticPromptsEvents {
   AUDIO_EVENT_MID,
 };
 
+void getNumberPromptFile(char * filename, uint16_t prompt);
 void pushPrompt(uint16_t prompt, uint8_t id=0);
 void pushUnit(uint8_t unit, uint8_t idx, uint8_t id);
 void playModelName();
@@ -610,6 +713,11 @@ void playModelName();
   #define PLAY_LOGICAL_SWITCH_ON(sw)    playModelEvent(LOGICAL_SWITCH_AUDIO_CATEGORY, sw, AUDIO_EVENT_ON)
   #define PLAY_MODEL_NAME()             playModelName()
   #define START_SILENCE_PERIOD()        timeAutomaticPromptsSilence = get_tmr10ms()
+#if defined(PROMPT_CACHE)
+  #define PRELOAD_PROMPTS()             audioQueue.preloadPrompts()
+#else
+  #define PRELOAD_PROMPTS()
+#endif
   #define IS_SILENCE_PERIOD_ELAPSED()   (get_tmr10ms()-timeAutomaticPromptsSilence > 50)
 #else
   #define PLAY_PHASE_OFF(phase)
@@ -619,6 +727,7 @@ void playModelName();
   #define PLAY_LOGICAL_SWITCH_ON(sw)
   #define PLAY_MODEL_NAME()
   #define START_SILENCE_PERIOD()
+  #define PRELOAD_PROMPTS()
 #endif
 
 char * getAudioPath(char * path);
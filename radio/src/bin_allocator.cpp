@@ -26,6 +26,9 @@
 
 BinAllocator_slots1 slots1;
 BinAllocator_slots2 slots2;
+BinAllocator_slots3 slots3;
+BinAllocator_slots4 slots4;
+BinAllocatorStats binAllocatorStats;
 
 #if defined(DEBUG)
 int SimulateMallocFailure = 0;    //set this to simulate allocation failure
@@ -34,64 +37,109 @@ int SimulateMallocFailure = 0;    //set this to simulate allocation failure
 bool bin_free(void * ptr)
 {
   //return TRUE if ours
-  return slots1.free(ptr) || slots2.free(ptr);
+  return slots1.free(ptr) || slots2.free(ptr) || slots3.free(ptr) || slots4.free(ptr);
 }
 
 void * bin_malloc(size_t size) {
-  //try to allocate from our space
+  //try to allocate from our space, the smallest slot first
   void * res = slots1.malloc(size);
-  return res ? res : slots2.malloc(size);
+  if (!res) res = slots2.malloc(size);
+  if (!res) res = slots3.malloc(size);
+  if (!res) res = slots4.malloc(size);
+  return res;
 }
 
-void * bin_realloc(void * ptr, size_t size)
+size_t bin_size(void * ptr)
+{
+  return slots1.size(ptr) + slots2.size(ptr) + slots3.size(ptr) + slots4.size(ptr);
+}
+
+static void * bin_alloc_new(size_t size)
+{
+  void * res = bin_malloc(size);
+  if (res) {
+    ++binAllocatorStats.noMallocs;
+    binAllocatorStats.wastedBytes += bin_size(res) - size;
+  }
+  return res;
+}
+
+static void bin_free_old(void * ptr, size_t osize)
+{
+  binAllocatorStats.wastedBytes -= bin_size(ptr) - osize;
+  bin_free(ptr);
+}
+
+void * bin_realloc(void * ptr, size_t osize, size_t size)
 {
   if (ptr == 0) {
     //no previous data, try our malloc
-    return bin_malloc(size);
+    return bin_alloc_new(size);
   }
-  else {
-    if (! (slots1.is_member(ptr) || slots2.is_member(ptr)) ) {
-      // not our data, leave it to libc realloc
-      return 0;
+
+  size_t slot = bin_size(ptr);
+  if (slot == 0) {
+    // not our data, move it to our space if it fits now, otherwise leave it to libc realloc
+    void * res = bin_alloc_new(size);
+    if (res) {
+      memcpy(res, ptr, min(osize, size));
+      free(ptr);
     }
+    return res;
+  }
 
-    //we have existing data
-    // if it fits in current slot, return it
-    // TODO if new size is smaller, try to relocate in smaller slot
-    if ( slots1.can_fit(ptr, size) ) {
-      // TRACE("OUR realloc %p[%lu] fits in slot1", ptr, size);
-      return ptr;
+  //we have existing data
+  if (size <= slot) {
+    // if it shrinks enough to fit in a smaller slot, move it there
+    void * res = (size < osize ? bin_malloc(size) : 0);
+    if (res && bin_size(res) < slot) {
+      ++binAllocatorStats.noMoves;
+      binAllocatorStats.wastedBytes += bin_size(res) - size;
+      memcpy(res, ptr, size);
+      bin_free_old(ptr, osize);
+      return res;
     }
-    if ( slots2.can_fit(ptr, size) ) {
-      // TRACE("OUR realloc %p[%lu] fits in slot2", ptr, size);
-      return ptr;
+    if (res) {
+      bin_free(res);
     }
+    // otherwise it stays in the current slot
+    binAllocatorStats.wastedBytes += osize;
+    binAllocatorStats.wastedBytes -= size;
+    return ptr;
+  }
 
-    //we need a bigger slot
-    void * res = bin_malloc(size);
+  //we need a bigger slot
+  void * res = bin_malloc(size);
+  if (res) {
+    ++binAllocatorStats.noMoves;
+    binAllocatorStats.wastedBytes += bin_size(res) - size;
+  }
+  else {
+    // we don't have the space, use libc malloc
+    // TRACE("bin_malloc [%lu] FAILURE", size);
+    ++binAllocatorStats.noFallbacks;
+    res = malloc(size);
     if (res == 0) {
-      // we don't have the space, use libc malloc
-      // TRACE("bin_malloc [%lu] FAILURE", size);
-      res = malloc(size);
-      if (res == 0) {
-        TRACE("libc malloc [%lu] FAILURE", size);  
-        return 0;
-      }
+      TRACE("libc malloc [%lu] FAILURE", size);
+      return 0;
     }
-    //copy data
-    memcpy(res, ptr, slots1.size(ptr) + slots2.size(ptr));
-    bin_free(ptr);
-    return res;
   }
+  //copy data
+  memcpy(res, ptr, osize);
+  bin_free_old(ptr, osize);
+  return res;
 }
 
 
 void *bin_l_alloc (void *ud, void *ptr, size_t osize, size_t nsize)
 {
-  (void)ud; (void)osize;  /* not used */
+  (void)ud;  /* not used */
   if (nsize == 0) {
     if (ptr) {   // avoid a bunch of NULL pointer free calls
-      if (!bin_free(ptr)) {
+      if (bin_size(ptr)) {
+        bin_free_old(ptr, osize);
+      }
+      else {
         // not our range, use libc allocator
         // TRACE("libc free %p", ptr);
         free(ptr);
@@ -113,12 +161,18 @@ void *bin_l_alloc (void *ud, void *ptr, size_t osize, size_t nsize)
       return 0;
     }
 #endif // #if defined(DEBUG)
+    // when ptr is NULL, osize is the type of the Lua object, not a size
+    if (!ptr) {
+      osize = 0;
+    }
+    binAllocatorStats.sizes[min<size_t>(nsize / BIN_ALLOCATOR_HISTOGRAM_STEP, BIN_ALLOCATOR_HISTOGRAM_SIZE - 1)]++;
     // try our allocator, if it fails use libc allocator
-    void * res = bin_realloc(ptr, nsize);
+    void * res = bin_realloc(ptr, osize, nsize);
     if (res && ptr) {
       // TRACE("OUR realloc %p[%lu] -> %p[%lu]", ptr, osize, res, nsize); 
     }
-    if (res == 0) {
+    if (res == 0 && bin_size(ptr) == 0) {
+      ++binAllocatorStats.noFallbacks;
       res = realloc(ptr, nsize);
       // TRACE("libc realloc %p[%lu] -> %p[%lu]", ptr, osize, res, nsize);
       // if (res == 0 ){
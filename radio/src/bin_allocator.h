@@ -23,28 +23,41 @@
 
 #include "debug.h"
 
+// Fixed size slots with an intrusive free list: malloc() and free() are O(1)
 template <int SIZE_SLOT, int NUM_BINS> class BinAllocator {
 private:
-  PACK(struct Bin {
+  // a free slot holds the index of the next free one, slots are aligned like malloc() results
+  union Bin {
     char data[SIZE_SLOT];
-    bool Used;
-  });
-  struct Bin Bins[NUM_BINS];
-  int NoUsedBins;
+    uint16_t next;
+    double align;
+  };
+  union Bin Bins[NUM_BINS];
+  uint16_t FirstFree;
+  uint16_t NoUsedBins;
+  uint16_t MaxUsedBins;
 public:
-  BinAllocator() : NoUsedBins(0) {
-    memclear(Bins, sizeof(Bins));
+  BinAllocator() {
+    reset();
+  }
+  void reset() {
+    for (int n = 0; n < NUM_BINS; ++n) {
+      Bins[n].next = n + 1;
+    }
+    FirstFree = 0;
+    NoUsedBins = 0;
+    MaxUsedBins = 0;
   }
   bool free(void * ptr) {
-    for (size_t n = 0; n < NUM_BINS; ++n) {
-      if (ptr == Bins[n].data) {
-        Bins[n].Used = false;
-        --NoUsedBins;
-        // TRACE("\tBinAllocator<%d> free %lu ------", SIZE_SLOT, n);
-        return true;
-      }
+    if (!is_member(ptr)) {
+      return false;
     }
-    return false;
+    union Bin * bin = (union Bin *)ptr;
+    bin->next = FirstFree;
+    FirstFree = bin - Bins;
+    --NoUsedBins;
+    // TRACE("\tBinAllocator<%d> free %d ------", SIZE_SLOT, FirstFree);
+    return true;
   }
   bool is_member(void * ptr) {
     return (ptr >= Bins[0].data && ptr <= Bins[NUM_BINS-1].data);
@@ -54,20 +67,17 @@ public:
       // TRACE("BinAllocator<%d> malloc [%lu] size > SIZE_SLOT", SIZE_SLOT, size);
       return 0;
     }
-    if (NoUsedBins >= NUM_BINS) {
+    if (FirstFree >= NUM_BINS) {
       // TRACE("BinAllocator<%d> malloc [%lu] no free slots", SIZE_SLOT, size);
       return 0;
     }
-    for (size_t n = 0; n < NUM_BINS; ++n) {
-      if (!Bins[n].Used) {
-        Bins[n].Used = true;
-        ++NoUsedBins;
-        // TRACE("\tBinAllocator<%d> malloc %lu[%lu]", SIZE_SLOT, n, size);
-        return Bins[n].data;
-      }
+    union Bin * bin = &Bins[FirstFree];
+    FirstFree = bin->next;
+    if (++NoUsedBins > MaxUsedBins) {
+      MaxUsedBins = NoUsedBins;
     }
-    // TRACE("BinAllocator<%d> malloc [%lu] no free slots", SIZE_SLOT , size);
-    return 0;
+    // TRACE("\tBinAllocator<%d> malloc %d[%lu]", SIZE_SLOT, (int)(bin - Bins), size);
+    return bin->data;
   }
   size_t size(void * ptr) {
     return is_member(ptr) ? SIZE_SLOT : 0;
@@ -77,19 +87,41 @@ public:
   }
   unsigned int capacity() { return NUM_BINS; }
   unsigned int size() { return NoUsedBins; }
+  unsigned int maxSize() { return MaxUsedBins; }
+  unsigned int slotSize() { return SIZE_SLOT; }
 };
 
+// the size classes follow the sizes of the Lua objects (Node / UpVal / small closures and
+// strings, Table, Node[2], Node[4] / Proto), the histogram in BinAllocatorStats helps to tune them
 #if defined(SIMU)
-typedef BinAllocator<39,300> BinAllocator_slots1;
-typedef BinAllocator<79,100> BinAllocator_slots2;
+typedef BinAllocator<40,256> BinAllocator_slots1;
+typedef BinAllocator<64,192> BinAllocator_slots2;
+typedef BinAllocator<96,96> BinAllocator_slots3;
+typedef BinAllocator<160,48> BinAllocator_slots4;
 #else
-typedef BinAllocator<29,200> BinAllocator_slots1;
-typedef BinAllocator<91,50> BinAllocator_slots2;
+typedef BinAllocator<24,128> BinAllocator_slots1;
+typedef BinAllocator<32,96> BinAllocator_slots2;
+typedef BinAllocator<48,48> BinAllocator_slots3;
+typedef BinAllocator<96,20> BinAllocator_slots4;
 #endif
 
+#define BIN_ALLOCATOR_HISTOGRAM_STEP   8   // bytes
+#define BIN_ALLOCATOR_HISTOGRAM_SIZE   21  // the last one counts the allocations bigger than 160 bytes
+
+struct BinAllocatorStats {
+  uint32_t noMallocs;       // allocations done in the slots
+  uint32_t noFallbacks;     // allocations left to libc (too big or no free slot)
+  uint32_t noMoves;         // reallocations moved to another slot
+  uint32_t wastedBytes;     // unused space at the end of the used slots (fragmentation)
+  uint32_t sizes[BIN_ALLOCATOR_HISTOGRAM_SIZE];  // requested sizes
+};
+
 #if defined(USE_BIN_ALLOCATOR)
 extern BinAllocator_slots1 slots1;
 extern BinAllocator_slots2 slots2;
+extern BinAllocator_slots3 slots3;
+extern BinAllocator_slots4 slots4;
+extern BinAllocatorStats binAllocatorStats;
 
 // wrapper for our BinAllocator for Lua
 void *bin_l_alloc (void *ud, void *ptr, size_t osize, size_t nsize);
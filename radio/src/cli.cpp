@@ -23,6 +23,7 @@
 #include <ctype.h>
 #include <malloc.h>
 #include <new>
+#include "bin_allocator.h"
 
 #define CLI_COMMAND_MAX_ARGS           8
 #define CLI_COMMAND_MAX_LEN            256
@@ -380,6 +381,9 @@ int cliStackInfo(const char ** argv)
   serialPrint("[MENUS] %d available / %d", menusStack.available(), menusStack.size());
   serialPrint("[MIXER] %d available / %d", mixerStack.available(), mixerStack.size());
   serialPrint("[AUDIO] %d available / %d", audioStack.available(), audioStack.size());
+#if defined(LOGS_BINARY)
+  serialPrint("[LOGS] %d available / %d", logsStack.available(), logsStack.size());
+#endif
   serialPrint("[CLI] %d available / %d", cliStack.available(), cliStack.size());
   return 0;
 }
@@ -429,6 +433,20 @@ int cliMemoryInfo(const char ** argv)
   serialPrint("------------");
   serialPrint("\tTotal   %u", s + w + e);
 #endif
+#endif
+
+#if defined(USE_BIN_ALLOCATOR)
+  serialPrint("\nLua slots:");
+  serialPrint("\t%3u bytes: %u/%u used, max %u", slots1.slotSize(), slots1.size(), slots1.capacity(), slots1.maxSize());
+  serialPrint("\t%3u bytes: %u/%u used, max %u", slots2.slotSize(), slots2.size(), slots2.capacity(), slots2.maxSize());
+  serialPrint("\t%3u bytes: %u/%u used, max %u", slots3.slotSize(), slots3.size(), slots3.capacity(), slots3.maxSize());
+  serialPrint("\t%3u bytes: %u/%u used, max %u", slots4.slotSize(), slots4.size(), slots4.capacity(), slots4.maxSize());
+  serialPrint("\tmallocs %u, fallbacks %u, moves %u, wasted %u bytes", binAllocatorStats.noMallocs, binAllocatorStats.noFallbacks, binAllocatorStats.noMoves, binAllocatorStats.wastedBytes);
+  serialPrintf("\tsizes");
+  for (int n = 0; n < BIN_ALLOCATOR_HISTOGRAM_SIZE; n++) {
+    serialPrintf(" %u", binAllocatorStats.sizes[n]);
+  }
+  serialCrlf();
 #endif
   return 0;
 }
@@ -624,6 +642,23 @@ void printDebugTimers()
 }
 #endif
 
+#if defined(DEBUG_TIMERS)
+int cliProfile(const char ** argv)
+{
+  if (!strcmp(argv[1], "dump")) {
+    // binary stream, decoded on the host by radio/util/profile-decode.py
+    debugProfileDump();
+  }
+  else if (!strcmp(argv[1], "reset")) {
+    debugProfileReset();
+  }
+  else {
+    serialPrint("%s: Invalid arguments", argv[0]);
+  }
+  return 0;
+}
+#endif
+
 #include "OsMutex.h"
 extern OS_MutexID audioMutex;
 
@@ -648,9 +683,44 @@ void printAudioVars()
 
   serialPrint("normalContext: %u", (uint32_t)audioQueue.normalContext.fragment.type);
 
+#if defined(PROMPT_CACHE)
+  serialPrint("promptCache: h: %u, m: %u, e: %u, size: %u", promptCacheStats.noHits, promptCacheStats.noMisses, promptCacheStats.noEvictions, promptCacheStats.size);
+#endif
+
   serialPrint("audioMutex[%u] = %u", (uint32_t)audioMutex, (uint32_t)MutexTbl[audioMutex].mutexFlag);
 }
 
+#if defined(LUA)
+void printLuaScriptStats(const char * name, const ScriptStats & stats)
+{
+  serialPrint("  %-10s last %uus, max %uus, runs %u, skips %u, alloc %u bytes, gc %uus, credit %dus", name, stats.lastDuration, stats.maxDuration, stats.runs, stats.skips, stats.allocated, stats.gcDuration, stats.credit);
+}
+
+void printLuaStats()
+{
+  serialPrint("Lua GC: steps %u, cycles %u (pressure %u), full %u, max pause %uus", luaGcStats.steps, luaGcStats.cycles, luaGcStats.pressureCycles, luaGcStats.fullCollections, maxLuaGcDuration);
+  serialPrintf("\tpauses");
+  for (int n = 0; n < LUA_GC_HISTOGRAM_SIZE; n++) {
+    serialPrintf(" %u", luaGcStats.histogram[n]);
+  }
+  serialCrlf();
+  serialPrint("Lua scripts:");
+  for (int i = 0; i < luaScriptsCount; i++) {
+    const ScriptInternalData & sid = scriptInternalData[i];
+    char name[8];
+    snprintf(name, sizeof(name), "#%u", sid.reference);
+    serialPrint("  %-10s state %u, cpu %u%%", name, sid.state, sid.instructions);
+    printLuaScriptStats(name, sid.stats);
+  }
+  if (luaState & INTERPRETER_RUNNING_STANDALONE_SCRIPT) {
+    printLuaScriptStats("standalone", standaloneScript.stats);
+  }
+#if defined(COLORLCD)
+  serialPrint("Lua widgets:");
+  luaForEachWidgetStats(printLuaScriptStats);
+#endif
+}
+#endif
 
 int cliDisplay(const char ** argv)
 {
@@ -809,11 +879,22 @@ int cliDisplay(const char ** argv)
   else if (!strcmp(argv[1], "audio")) {
     printAudioVars();
   }
+#if defined(LUA)
+  else if (!strcmp(argv[1], "lua")) {
+    printLuaStats();
+  }
+#endif
 #if defined(DISK_CACHE)
   else if (!strcmp(argv[1], "dc")) {
     DiskCacheStats stats = diskCache.getStats();
     uint32_t hitRate = diskCache.getHitRate();
-    serialPrint("Disk Cache stats: w:%u r: %u, h: %u(%0.1f%%), m: %u", stats.noWrites, (stats.noHits + stats.noMisses), stats.noHits, hitRate*0.1f, stats.noMisses);
+    serialPrint("Disk Cache stats: w:%u r: %u, h: %u(%0.1f%%), m: %u, p: %u, f: %u", stats.noWrites, (stats.noHits + stats.noMisses), stats.noHits, hitRate*0.1f, stats.noMisses, stats.noPrefetches, stats.noFlushes);
+    static const char * const CONSUMERS[DISK_CACHE_CONSUMERS_COUNT] = { "other", "audio", "logs", "lua", "models" };
+    for (int n = 0; n < DISK_CACHE_CONSUMERS_COUNT; n++) {
+      const DiskCacheConsumerStats & consumerStats = stats.consumers[n];
+      hitRate = diskCache.getHitRate((DiskCacheConsumer)n);
+      serialPrint("  %s: w:%u r: %u, h: %u(%0.1f%%), m: %u", CONSUMERS[n], consumerStats.noWrites, (consumerStats.noHits + consumerStats.noMisses), consumerStats.noHits, hitRate*0.1f, consumerStats.noMisses);
+    }
   }
 #endif
   else if (toLongLongInt(argv, 1, &address) > 0) {
@@ -833,8 +914,21 @@ int cliDebugVars(const char ** argv)
   serialPrint("ioMutexReq=%d", ioMutexReq);
   serialPrint("ioMutexRel=%d", ioMutexRel);
   serialPrint("sdReadRetries=%d", sdReadRetries);
+  extern Fifo<uint8_t, TELEMETRY_FIFO_SIZE> telemetryNoDMAFifo;
+  serialPrint("telemetryFifo: overflows=%d highWater=%d", telemetryNoDMAFifo.getOverflows(), telemetryNoDMAFifo.getHighWater());
+#if defined(PCBX12S)
+  extern DMAFifo<TELEMETRY_FIFO_SIZE> telemetryDMAFifo;
+  serialPrint("telemetryDMAFifo: highWater=%d", telemetryDMAFifo.getHighWater());
+#endif
 #elif defined(PCBTARANIS)
   serialPrint("telemetryErrors=%d", telemetryErrors);
+  serialPrint("telemetryFifo: overflows=%d highWater=%d", telemetryFifo.getOverflows(), telemetryFifo.getHighWater());
+#endif
+  serialPrint("mixer: maxDuration=%dus deadlineMisses=%d", maxMixerDuration/2, mixerDeadlineMisses);
+#if defined(LUA)
+  if (luaInputTelemetryFifo) {
+    serialPrint("luaInputTelemetryFifo: overflows=%d highWater=%d", luaInputTelemetryFifo->getOverflows(), luaInputTelemetryFifo->getHighWater());
+  }
 #endif
 
   return 0;
@@ -965,6 +1059,9 @@ const CliCommand cliCommands[] = {
   { "help", cliHelp, "[<command>]" },
   { "debugvars", cliDebugVars, "" },
   { "repeat", cliRepeat, "<interval> <command>" },
+#if defined(DEBUG_TIMERS)
+  { "profile", cliProfile, "dump | reset" },
+#endif
 #if defined(JITTER_MEASURE)
   { "jitter", cliShowJitter, "" },
 #endif
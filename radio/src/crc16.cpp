@@ -56,9 +56,8 @@ static const unsigned short crc16tab[256] = {
   0x6e17,0x7e36,0x4e55,0x5e74,0x2e93,0x3eb2,0x0ed1,0x1ef0
 };
 
-uint16_t crc16(const uint8_t * buf, uint32_t len)
+uint16_t crc16(const uint8_t * buf, uint32_t len, uint16_t crc)
 {
-  uint16_t crc = 0;
   for (uint32_t i=0; i<len; i++) {
     crc = (crc<<8) ^ crc16tab[((crc>>8) ^ *buf++) & 0x00FF];
   }
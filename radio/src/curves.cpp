@@ -26,6 +26,7 @@ uint8_t s_curveChan;
 int8_t * curveEnd[MAX_CURVES];
 void loadCurves()
 {
+  invalidateCurvesCache();
   int8_t * tmp = g_model.points;
   for (int i=0; i<MAX_CURVES; i++) {
     switch (g_model.curves[i].type) {
@@ -64,7 +65,7 @@ bool moveCurve(uint8_t index, int8_t shift) // TODO bool?
     curveEnd[index++] += shift;
   }
   
-  storageDirty(EE_MODEL);
+  storageModelChanged();
   return true;
 }
 
@@ -126,7 +127,7 @@ bool moveCurve(uint8_t index, int8_t shift, int8_t custom) // TODO move?
     crv[custom + i] = -100 + ((200 * (i + 1) + custom / 2) / (custom - 1));
   }
 
-  storageDirty(EE_MODEL);
+  storageModelChanged();
   return true;
 }
 #endif
@@ -197,12 +198,68 @@ int32_t compute_tangent(CurveInfo * crv, int8_t * points, int i)
     return m;
 }
 
+// The compiled curves: for each 128 wide bucket of the input range, the
+// first segment which may contain it, and the tangents of the smooth curves
+// points. They are compiled by the menus task, where the curves are edited,
+// until then the mixer evaluates the curves directly from the model.
+#define CURVE_BUCKET_SHIFT     7
+#define CURVE_BUCKETS          ((2*RESX >> CURVE_BUCKET_SHIFT) + 1)
+#if defined(CURVES_LUT)
+// the smooth curves are then interpolated between 65 points of their spline
+#define CURVE_LUT_SHIFT        5
+#define CURVE_LUT_SIZE         ((2*RESX >> CURVE_LUT_SHIFT) + 1)
+#endif
+
+struct CurveCache {
+  bool valid;
+  uint8_t first[CURVE_BUCKETS];
+#if defined(CURVES_LUT)
+  int16_t lut[CURVE_LUT_SIZE];
+#endif
+};
+
+static CurveCache curvesCache[MAX_CURVES];
+static int32_t curvesTangents[MAX_CURVE_POINTS]; // at the same offset as the points in g_model.points
+static bool curvesCacheUpdated = false;
+
+void invalidateCurvesCache()
+{
+  curvesCacheUpdated = false;
+  for (int i=0; i<MAX_CURVES; i++) {
+    curvesCache[i].valid = false;
+  }
+}
+
+static inline const CurveCache * getCurveCache(uint8_t idx)
+{
+  return curvesCache[idx].valid ? &curvesCache[idx] : NULL;
+}
+
+// the X of a point, between 0 and 2*RESX
+static inline int getCurvePointX(const int8_t * points, uint8_t count, bool custom, int i)
+{
+  if (custom)
+    return (i==0 ? 0 : (i==count-1 ? 2*RESX : RESX + calc100toRESX(points[count+i-1])));
+  else
+    return (i*2*RESX)/(count-1);
+}
+
+// the first segment containing x (between 0 and 2*RESX)
+static inline int findCurveSegment(const CurveCache * cache, const int8_t * points, uint8_t count, bool custom, int x)
+{
+  int i = (cache ? cache->first[x >> CURVE_BUCKET_SHIFT] : 0);
+  while (i < count-2 && x > getCurvePointX(points, count, custom, i+1)) {
+    i++;
+  }
+  return i;
+}
+
 /* The following is a hermite cubic spline.
    The basis functions can be found here:
    http://en.wikipedia.org/wiki/Cubic_Hermite_spline
    The tangents are computed via the 'cubic monotone' rules (allowing for local-maxima)
 */
-int16_t hermite_spline(int16_t x, uint8_t idx)
+static int16_t evalHermiteSpline(const CurveCache * cache, uint8_t idx, int16_t x)
 {
   CurveInfo &crv = g_model.curves[idx];
   int8_t *points = curveAddress(idx);
@@ -214,39 +271,98 @@ int16_t hermite_spline(int16_t x, uint8_t idx)
   else if (x > RESX)
     x = RESX;
 
-  for (int i=0; i<count-1; i++) {
-    int32_t p0x, p3x;
-    if (custom) {
-      p0x = (i>0 ? calc100toRESX(points[count+i-1]) : -RESX);
-      p3x = (i<count-2 ? calc100toRESX(points[count+i]) : RESX);
+  int i = findCurveSegment(cache, points, count, custom, x+RESX);
+  int32_t p0x = getCurvePointX(points, count, custom, i) - RESX;
+  int32_t p3x = getCurvePointX(points, count, custom, i+1) - RESX;
+  int32_t p0y = calc100toRESX(points[i]);
+  int32_t p3y = calc100toRESX(points[i+1]);
+  int32_t m0, m3;
+  if (cache) {
+    const int32_t * tangents = &curvesTangents[points - g_model.points];
+    m0 = tangents[i];
+    m3 = tangents[i+1];
+  }
+  else {
+    m0 = compute_tangent(&crv, points, i);
+    m3 = compute_tangent(&crv, points, i+1);
+  }
+  int32_t y;
+  int32_t h = p3x - p0x;
+  int32_t t = (h > 0 ? (MMULT * (x - p0x)) / h : 0);
+  int32_t t2 = t * t / MMULT;
+  int32_t t3 = t2 * t / MMULT;
+  int32_t h00 = 2*t3 - 3*t2 + MMULT;
+  int32_t h10 = t3 - 2*t2 + t;
+  int32_t h01 = -2*t3 + 3*t2;
+  int32_t h11 = t3 - t2;
+  y = p0y * h00 + h * (m0 * h10 / MMULT) + p3y * h01 + h * (m3 * h11 / MMULT);
+  y /= MMULT;
+  return y;
+}
+
+static void compileCurve(uint8_t idx)
+{
+  CurveCache & cache = curvesCache[idx];
+  CurveInfo & crv = g_model.curves[idx];
+  int8_t * points = curveAddress(idx);
+  uint8_t count = crv.points+5;
+  bool custom = (crv.type == CURVE_TYPE_CUSTOM);
+
+  int i = 0;
+  for (int bucket=0; bucket<CURVE_BUCKETS; bucket++) {
+    int x = bucket << CURVE_BUCKET_SHIFT;
+    while (i < count-2 && x > getCurvePointX(points, count, custom, i+1)) {
+      i++;
     }
-    else {
-      p0x = -RESX + (i*2*RESX)/(count-1);
-      p3x = -RESX + ((i+1)*2*RESX)/(count-1);
+    cache.first[bucket] = i;
+  }
+
+  if (crv.smooth) {
+    int32_t * tangents = &curvesTangents[points - g_model.points];
+    for (i=0; i<count; i++) {
+      tangents[i] = compute_tangent(&crv, points, i);
+    }
+#if defined(CURVES_LUT)
+    for (i=0; i<CURVE_LUT_SIZE; i++) {
+      cache.lut[i] = evalHermiteSpline(&cache, idx, -RESX + (i << CURVE_LUT_SHIFT));
     }
+#endif
+  }
+
+  cache.valid = true;
+}
 
-    if (x >= p0x && x <= p3x) {
-      int32_t p0y = calc100toRESX(points[i]);
-      int32_t p3y = calc100toRESX(points[i+1]);
-      int32_t m0 = compute_tangent(&crv, points, i);
-      int32_t m3 = compute_tangent(&crv, points, i+1);
-      int32_t y;
-      int32_t h = p3x - p0x;
-      int32_t t = (h > 0 ? (MMULT * (x - p0x)) / h : 0);
-      int32_t t2 = t * t / MMULT;
-      int32_t t3 = t2 * t / MMULT;
-      int32_t h00 = 2*t3 - 3*t2 + MMULT;
-      int32_t h10 = t3 - 2*t2 + t;
-      int32_t h01 = -2*t3 + 3*t2;
-      int32_t h11 = t3 - t2;
-      y = p0y * h00 + h * (m0 * h10 / MMULT) + p3y * h01 + h * (m3 * h11 / MMULT);
-      y /= MMULT;
-      return y;
+// called by the menus task, once the model edits of the previous cycle are done
+void updateCurvesCache()
+{
+  if (!curvesCacheUpdated) {
+    curvesCacheUpdated = true;
+    for (int i=0; i<MAX_CURVES; i++) {
+      if (!curvesCache[i].valid) {
+        compileCurve(i);
+      }
     }
   }
-  return 0;
+}
+
+int16_t hermite_spline(int16_t x, uint8_t idx)
+{
+  return evalHermiteSpline(getCurveCache(idx), idx, x);
+}
+
+#if defined(CURVES_LUT)
+static int evalCurveLut(const CurveCache * cache, int x)
+{
+  x = limit<int>(-RESX, x, RESX) + RESX;
+  int i = x >> CURVE_LUT_SHIFT;
+  if (i == CURVE_LUT_SIZE-1) {
+    return cache->lut[i];
+  }
+  int dx = x & ((1 << CURVE_LUT_SHIFT) - 1);
+  return cache->lut[i] + (cache->lut[i+1] - cache->lut[i]) * dx / (1 << CURVE_LUT_SHIFT);
 }
 #endif
+#endif
 
 int intpol(int x, uint8_t idx) // -100, -75, -50, -25, 0 ,25 ,50, 75, 100
 {
@@ -275,11 +391,17 @@ int intpol(int x, uint8_t idx) // -100, -75, -50, -25, 0 ,25 ,50, 75, 100
     uint16_t a=0, b=0;
     uint8_t i;
     if (custom) {
+#if defined(CPUARM)
+      i = findCurveSegment(getCurveCache(idx), points, count, true, x);
+      a = getCurvePointX(points, count, true, i);
+      b = getCurvePointX(points, count, true, i+1);
+#else
       for (i=0; i<count-1; i++) {
         a = b;
         b = (i==count-2 ? 2*RESX : RESX + calc100toRESX(points[count+i]));
         if ((uint16_t)x<=b) break;
       }
+#endif
     }
     else {
       uint16_t d = (RESX * 2) / (count-1);
@@ -355,10 +477,15 @@ int applyCustomCurve(int x, uint8_t idx)
     return 0;
 
   CurveInfo & crv = g_model.curves[idx];
-  if (crv.smooth)
-    return hermite_spline(x, idx);
-  else
+  if (!crv.smooth)
     return intpol(x, idx);
+
+#if defined(CURVES_LUT)
+  const CurveCache * cache = getCurveCache(idx);
+  if (cache)
+    return evalCurveLut(cache, x);
+#endif
+  return hermite_spline(x, idx);
 }
 #else
 int applyCurve(int x, int8_t idx)
@@ -21,6 +21,7 @@
 #include "opentx.h"
 #include "stamp.h"
 #include <stdarg.h>
+#include <new>
 
 #if defined(SIMU)
 traceCallbackFunc traceCallback = 0;
@@ -262,7 +263,138 @@ const char * const debugTimerNames[DEBUG_TIMERS_COUNT] = {
   ,"Audio int. "   // debugTimerAudioIterval
   ,"Audio dur. "   // debugTimerAudioDuration
   ," A. consume"   // debugTimerAudioConsume,
+  ,"SD read    "   // debugTimerSdRead,
+  ,"SD write   "   // debugTimerSdWrite,
+};
 
+const uint8_t debugMixerCycleStages[DEBUG_MIXER_CYCLE_STAGES] = {
+  debugTimerGetAdc,
+  debugTimerGetSwitches,
+  debugTimerEvalMixes,
+  debugTimerMixes10ms,
+  debugTimerTelemetryWakeup,
 };
 
+DebugMixerCycle debugMixerCycles[DEBUG_MIXER_CYCLES_LOG_SIZE];
+uint16_t debugMixerCyclesPos;
+
+void debugMixerCycleStart()
+{
+  DebugMixerCycle & cycle = debugMixerCycles[debugMixerCyclesPos];
+  cycle.tmr10ms = get_tmr10ms();
+  cycle.start = getTmr2MHz();
+  for (uint8_t i=0; i<DEBUG_MIXER_CYCLE_STAGES; i++) {
+    debugTimers[debugMixerCycleStages[i]].resetLast();
+  }
+}
+
+void debugMixerCycleStop()
+{
+  DebugMixerCycle & cycle = debugMixerCycles[debugMixerCyclesPos];
+  cycle.duration = getTmr2MHz() - cycle.start;
+  for (uint8_t i=0; i<DEBUG_MIXER_CYCLE_STAGES; i++) {
+    debug_timer_t last = debugTimers[debugMixerCycleStages[i]].getLast();
+    cycle.stages[i] = (last > 0xFFFF ? 0xFFFF : last);
+  }
+  if (++debugMixerCyclesPos >= DEBUG_MIXER_CYCLES_LOG_SIZE) {
+    debugMixerCyclesPos = 0;
+  }
+}
+
+void debugProfileReset()
+{
+  for (uint8_t n=0; n<DEBUG_TIMERS_COUNT; n++) {
+    debugTimers[n].reset();
+  }
+  memclear(debugMixerCycles, sizeof(debugMixerCycles));
+  debugMixerCyclesPos = 0;
+}
+
+/*
+  Binary profile stream, little endian, decoded by radio/util/profile-decode.py
+    "OTXP", version (1), timers count, histogram size, stages count, cycles count (16 bits)
+    for each timer: name length, name, min, max, last (32 bits), histogram (16 bits each)
+    for each stage: timer index
+    cycles, the oldest first
+    sum of all the previous bytes (16 bits)
+*/
+#define DEBUG_PROFILE_VERSION  1
+
+static uint16_t debugProfileChecksum;
+
+static void debugProfileWrite(const void * data, uint16_t size)
+{
+  const uint8_t * p = (const uint8_t *)data;
+  while (size--) {
+    debugProfileChecksum += *p;
+    serialPutc(*p++);
+  }
+}
+
+static void debugProfileWrite8(uint8_t value)
+{
+  debugProfileWrite(&value, sizeof(value));
+}
+
+static void debugProfileWrite16(uint16_t value)
+{
+  uint8_t data[] = { uint8_t(value), uint8_t(value >> 8) };
+  debugProfileWrite(data, sizeof(data));
+}
+
+static void debugProfileWrite32(uint32_t value)
+{
+  debugProfileWrite16(value);
+  debugProfileWrite16(value >> 16);
+}
+
+void debugProfileDump()
+{
+  // the cycles log is copied first, the mixer keeps on running
+  DebugMixerCycle * cycles = new (std::nothrow) DebugMixerCycle[DEBUG_MIXER_CYCLES_LOG_SIZE];
+  if (!cycles) {
+    return;
+  }
+  uint16_t pos = debugMixerCyclesPos;
+  memcpy(cycles, debugMixerCycles, sizeof(debugMixerCycles));
+
+  debugProfileChecksum = 0;
+  debugProfileWrite("OTXP", 4);
+  debugProfileWrite8(DEBUG_PROFILE_VERSION);
+  debugProfileWrite8(DEBUG_TIMERS_COUNT);
+  debugProfileWrite8(DEBUG_TIMER_HISTOGRAM_SIZE);
+  debugProfileWrite8(DEBUG_MIXER_CYCLE_STAGES);
+  debugProfileWrite16(DEBUG_MIXER_CYCLES_LOG_SIZE);
+
+  for (uint8_t n=0; n<DEBUG_TIMERS_COUNT; n++) {
+    const DebugTimer & timer = debugTimers[n];
+    uint8_t len = strlen(debugTimerNames[n]);
+    debugProfileWrite8(len);
+    debugProfileWrite(debugTimerNames[n], len);
+    debugProfileWrite32(timer.getMin());
+    debugProfileWrite32(timer.getMax());
+    debugProfileWrite32(timer.getLast());
+    for (uint8_t bin=0; bin<DEBUG_TIMER_HISTOGRAM_SIZE; bin++) {
+      debugProfileWrite16(timer.getHistogram(bin));
+    }
+  }
+
+  debugProfileWrite(debugMixerCycleStages, DEBUG_MIXER_CYCLE_STAGES);
+
+  for (uint16_t n=0; n<DEBUG_MIXER_CYCLES_LOG_SIZE; n++) {
+    const DebugMixerCycle & cycle = cycles[(pos + n) % DEBUG_MIXER_CYCLES_LOG_SIZE];
+    debugProfileWrite16(cycle.tmr10ms);
+    debugProfileWrite16(cycle.start);
+    debugProfileWrite16(cycle.duration);
+    for (uint8_t i=0; i<DEBUG_MIXER_CYCLE_STAGES; i++) {
+      debugProfileWrite16(cycle.stages[i]);
+    }
+  }
+
+  uint16_t checksum = debugProfileChecksum;
+  debugProfileWrite16(checksum);
+
+  delete[] cycles;
+}
+
 #endif
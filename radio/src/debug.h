@@ -326,6 +326,9 @@ extern void CoTaskSwitchHook(uint8_t taskID);
 #if defined(__cplusplus)
 typedef uint32_t debug_timer_t;
 
+// bin n counts the durations from 2^n to 2^(n+1)-1 us, the first bin also counts 0us and the last one everything above
+#define DEBUG_TIMER_HISTOGRAM_SIZE  16
+
 class DebugTimer
 {
 private:
@@ -337,24 +340,31 @@ private:
   uint16_t _start_hiprec;
   uint32_t _start_loprec;
 
+  uint16_t histogram[DEBUG_TIMER_HISTOGRAM_SIZE];
+
   void evalStats() {
     if (min > last) min = last;
     if (max < last) max = last;
     //todo avg
+    uint8_t bin = (last < 2 ? 0 : 31 - __builtin_clz(last));
+    if (bin >= DEBUG_TIMER_HISTOGRAM_SIZE) bin = DEBUG_TIMER_HISTOGRAM_SIZE - 1;
+    if (histogram[bin] < 0xFFFF) histogram[bin]++;
   }
 
 public:
-  DebugTimer(): min(-1), max(0), /*avg(0),*/ last(0), _start_hiprec(0), _start_loprec(0) {};
+  DebugTimer(): min(-1), max(0), /*avg(0),*/ last(0), _start_hiprec(0), _start_loprec(0), histogram() {};
 
   void start();
   void stop();
   void sample() { stop(); start(); }
 
-  void reset() { min = -1;  max = last = 0; }
+  void reset() { min = -1;  max = last = 0; memset(histogram, 0, sizeof(histogram)); }
+  void resetLast() { last = 0; }
 
   debug_timer_t getMin() const { return min; }
   debug_timer_t getMax() const { return max; }
   debug_timer_t getLast() const { return last; }
+  uint16_t getHistogram(uint8_t bin) const { return histogram[bin]; }
 };
 
 enum DebugTimers {
@@ -393,17 +403,42 @@ enum DebugTimers {
   debugTimerAudioDuration,
   debugTimerAudioConsume,
 
+  debugTimerSdRead,
+  debugTimerSdWrite,
+
   DEBUG_TIMERS_COUNT
 };
 
 extern DebugTimer debugTimers[DEBUG_TIMERS_COUNT];
 extern const char * const debugTimerNames[DEBUG_TIMERS_COUNT];
 
+// the last mixer cycles, with the duration of each stage
+#define DEBUG_MIXER_CYCLES_LOG_SIZE    128
+#define DEBUG_MIXER_CYCLE_STAGES       5
+
+PACK(struct DebugMixerCycle {
+  uint16_t tmr10ms;    // low bits of get_tmr10ms() at the start of the cycle
+  uint16_t start;      // getTmr2MHz() at the start of the cycle
+  uint16_t duration;   // unit 0.5us
+  uint16_t stages[DEBUG_MIXER_CYCLE_STAGES]; // unit 1us, 0 when the stage didn't run
+});
+
+extern const uint8_t debugMixerCycleStages[DEBUG_MIXER_CYCLE_STAGES];
+extern DebugMixerCycle debugMixerCycles[DEBUG_MIXER_CYCLES_LOG_SIZE];
+extern uint16_t debugMixerCyclesPos;
+
+void debugMixerCycleStart();
+void debugMixerCycleStop();
+void debugProfileReset();
+void debugProfileDump();
+
 #endif // #if defined(__cplusplus)
 
 #define DEBUG_TIMER_START(timer)  debugTimers[timer].start()
 #define DEBUG_TIMER_STOP(timer)   debugTimers[timer].stop()
 #define DEBUG_TIMER_SAMPLE(timer) debugTimers[timer].sample()
+#define DEBUG_MIXER_CYCLE_START() debugMixerCycleStart()
+#define DEBUG_MIXER_CYCLE_STOP()  debugMixerCycleStop()
 
 
 #else //#if defined(DEBUG_TIMERS)
@@ -411,6 +446,8 @@ extern const char * const debugTimerNames[DEBUG_TIMERS_COUNT];
 #define DEBUG_TIMER_START(timer)
 #define DEBUG_TIMER_STOP(timer)
 #define DEBUG_TIMER_SAMPLE(timer)
+#define DEBUG_MIXER_CYCLE_START()
+#define DEBUG_MIXER_CYCLE_STOP()
 
 #endif //#if defined(DEBUG_TIMERS)
 
@@ -24,6 +24,8 @@
 #if defined(SIMU) && !defined(SIMU_DISKIO)
   #define __disk_read(...)    (RES_OK)
   #define __disk_write(...)   (RES_OK)
+  #define ff_req_grant(...)   (1)
+  #define ff_rel_grant(...)
 #endif
 
 #if 0     // set to 1 to enable traces
@@ -34,131 +36,381 @@
 
 DiskCache diskCache;
 
+static inline uint32_t sectorsMask(UINT first, UINT count)
+{
+  return (count >= 32 ? 0xFFFFFFFF : ((1u << count) - 1)) << first;
+}
+
+#define DISK_CACHE_ALL_SECTORS   sectorsMask(0, DISK_CACHE_BLOCK_SECTORS)
+
 DiskCacheBlock::DiskCacheBlock():
-  startSector(0),
-  endSector(0) 
+  block(DISK_CACHE_NO_BLOCK),
+  valid(0),
+  dirtySectors(0),
+  lastUse(0)
 {
 }
 
 bool DiskCacheBlock::read(BYTE * buff, DWORD sector, UINT count)
 {
-  if (sector >= startSector && (sector+count) <= endSector) {
+  UINT first = sector - block * DISK_CACHE_BLOCK_SECTORS;
+  uint32_t mask = sectorsMask(first, count);
+  if ((valid & mask) == mask) {
     TRACE_DISK_CACHE("\tcache read(%u, %u) from %p", (uint32_t)sector, (uint32_t)count, this);
-    memcpy(buff, data + ((sector - startSector) * BLOCK_SIZE), count * BLOCK_SIZE);
+    memcpy(buff, data + first * BLOCK_SIZE, count * BLOCK_SIZE);
     return true;
   }
   return false;
 }
 
-DRESULT DiskCacheBlock::fill(BYTE drv, BYTE * buff, DWORD sector, UINT count)
+void DiskCacheBlock::write(const BYTE * buff, DWORD sector, UINT count)
+{
+  UINT first = sector - block * DISK_CACHE_BLOCK_SECTORS;
+  uint32_t mask = sectorsMask(first, count);
+  TRACE_DISK_CACHE("\tcache write(%u, %u) to %p", (uint32_t)sector, (uint32_t)count, this);
+  memcpy(data + first * BLOCK_SIZE, buff, count * BLOCK_SIZE);
+  valid |= mask;
+  dirtySectors |= mask;
+}
+
+DRESULT DiskCacheBlock::fill(BYTE drv, DWORD newBlock)
 {
-  DRESULT res = __disk_read(drv, data, sector, DISK_CACHE_BLOCK_SECTORS);
+  // the sectors written and not yet flushed would be lost otherwise
+  DRESULT res = flush(drv);
   if (res != RES_OK) {
     return res;
   }
-  startSector = sector;
-  endSector = sector + DISK_CACHE_BLOCK_SECTORS;
-  memcpy(buff, data, count * BLOCK_SIZE);
-  TRACE_DISK_CACHE("\tcache %p FILLED from read(%u, %u)", this, (uint32_t)sector, (uint32_t)count);
+  res = __disk_read(drv, data, newBlock * DISK_CACHE_BLOCK_SECTORS, DISK_CACHE_BLOCK_SECTORS);
+  if (res != RES_OK) {
+    free();
+    return res;
+  }
+  block = newBlock;
+  valid = DISK_CACHE_ALL_SECTORS;
+  TRACE_DISK_CACHE("\tcache %p FILLED with block %u", this, (uint32_t)newBlock);
   return RES_OK;
 }
 
-void DiskCacheBlock::free(DWORD sector, UINT count) 
+// writes the dirty sectors, each run of consecutive sectors with one multi-block write
+DRESULT DiskCacheBlock::flush(BYTE drv)
 {
-  if (sector < endSector && (sector+count) > startSector) {
-    TRACE_DISK_CACHE("\tINVALIDATING disk cache block %p (%u)", this, startSector);
-    endSector = 0;
+  UINT first = 0;
+  while (dirtySectors) {
+    while (!(dirtySectors & (1u << first))) {
+      first++;
+    }
+    UINT count = 1;
+    while (first + count < DISK_CACHE_BLOCK_SECTORS && (dirtySectors & (1u << (first + count)))) {
+      count++;
+    }
+    TRACE_DISK_CACHE("\tcache %p FLUSH(%u, %u)", this, (uint32_t)(block * DISK_CACHE_BLOCK_SECTORS + first), (uint32_t)count);
+    DRESULT res = __disk_write(drv, data + first * BLOCK_SIZE, block * DISK_CACHE_BLOCK_SECTORS + first, count);
+    if (res != RES_OK) {
+      return res;
+    }
+    dirtySectors &= ~sectorsMask(first, count);
+    first += count;
   }
+  return RES_OK;
+}
+
+void DiskCacheBlock::reset(DWORD newBlock)
+{
+  block = newBlock;
+  valid = 0;
+  dirtySectors = 0;
 }
 
 void DiskCacheBlock::free()
 {
-  endSector = 0;
+  reset(DISK_CACHE_NO_BLOCK);
 }
 
 bool DiskCacheBlock::empty() const
 {
-  return (endSector == 0);
+  return (block == DISK_CACHE_NO_BLOCK);
+}
+
+bool DiskCacheBlock::dirty() const
+{
+  return (dirtySectors != 0);
 }
 
-DiskCache::DiskCache():
-  lastBlock(0)
+DiskCache::DiskCache()
 {
-  stats.noHits = 0;
-  stats.noMisses = 0;
-  stats.noWrites = 0;
   blocks = new DiskCacheBlock[DISK_CACHE_BLOCKS_NUM];
+  clear();
 }
 
 void DiskCache::clear()
 {
-  lastBlock = 0;
-  stats.noHits = 0;
-  stats.noMisses = 0;
-  stats.noWrites = 0;
+  memset(&stats, 0, sizeof(stats));
+  accessCounter = 0;
+  consumer = DISK_CACHE_OTHER;
+  lastStream = 0;
+  for (int n=0; n<DISK_CACHE_STREAMS; ++n) {
+    streams[n] = DISK_CACHE_NO_BLOCK;
+    prefetchBlocks[n] = DISK_CACHE_NO_BLOCK;
+  }
   for (int n=0; n<DISK_CACHE_BLOCKS_NUM; ++n) {
     blocks[n].free();
   }
 }
 
-DRESULT DiskCache::read(BYTE drv, BYTE * buff, DWORD sector, UINT count)
+// the audio and logs tasks are recognized by their task id, the consumer scopes are only used by the menus task
+DiskCacheConsumer DiskCache::getConsumer() const
 {
-  // TODO: check if not caching first sectors would improve anything
-  // if (sector < 1000) {
-  //   ++stats.noMisses;
-  //   return __disk_read(drv, buff, sector, count);  
-  // }
+#if !defined(SIMU)
+  if (CoGetCurTaskID() == audioTaskId) {
+    return DISK_CACHE_AUDIO;
+  }
+#endif
+#if defined(LOGS_BINARY)
+  if (CoGetCurTaskID() == logsTaskId) {
+    return DISK_CACHE_LOGS;
+  }
+#endif
+  return consumer;
+}
 
-  // if read is bigger than cache block, then read it directly without using cache
-  if (count > DISK_CACHE_BLOCK_SECTORS) {
-    TRACE_DISK_CACHE("\t\t big read(%u, %u)",  (uint32_t)sector, (uint32_t)count);
-    return __disk_read(drv, buff, sector, count);
+DiskCacheBlock * DiskCache::find(DWORD block)
+{
+  DiskCacheBlock * set = &blocks[(block % DISK_CACHE_SETS) * DISK_CACHE_WAYS];
+  for (int n=0; n<DISK_CACHE_WAYS; ++n) {
+    if (set[n].block == block) {
+      return &set[n];
+    }
   }
-  
-  // if block + cache block size is beyond the end of the disk, then read it directly without using cache
-  if (sector+DISK_CACHE_BLOCK_SECTORS >= sdGetNoSectors()) {
-    TRACE_DISK_CACHE("\t\t cache would be beyond end of disk %u (%u)", (uint32_t)sector, sdGetNoSectors());
-    return __disk_read(drv, buff, sector, count);
+  return NULL;
+}
+
+// takes an empty block or the least recently used one of the set
+DiskCacheBlock * DiskCache::allocate(BYTE drv, DWORD block)
+{
+  DiskCacheBlock * set = &blocks[(block % DISK_CACHE_SETS) * DISK_CACHE_WAYS];
+  DiskCacheBlock * result = &set[0];
+  for (int n=0; n<DISK_CACHE_WAYS; ++n) {
+    if (set[n].empty()) {
+      result = &set[n];
+      break;
+    }
+    if (set[n].lastUse < result->lastUse) {
+      result = &set[n];
+    }
   }
 
-  for (int n=0; n<DISK_CACHE_BLOCKS_NUM; ++n) {
-    if (blocks[n].read(buff, sector, count)) {
-      ++stats.noHits;
-      return RES_OK;
+  if (result->dirty()) {
+    ++stats.noFlushes;
+    if (result->flush(drv) != RES_OK) {
+      return NULL;
     }
   }
 
-  ++stats.noMisses;
+  TRACE_DISK_CACHE("\t\t block %u in %p", (uint32_t)block, result);
+  result->reset(block);
+  return result;
+}
 
-  // find free block
+// when a read enters the block following the one read just before, the next block is read ahead
+void DiskCache::followStream(DWORD block)
+{
+  for (int n=0; n<DISK_CACHE_STREAMS; ++n) {
+    if (streams[n] == block + 1) {
+      return;
+    }
+  }
+  for (int n=0; n<DISK_CACHE_STREAMS; ++n) {
+    if (streams[n] == block) {
+      streams[n] = block + 1;
+      prefetchBlocks[n] = block + 1;
+      return;
+    }
+  }
+  if (++lastStream >= DISK_CACHE_STREAMS) {
+    lastStream = 0;
+  }
+  streams[lastStream] = block + 1;
+  prefetchBlocks[lastStream] = DISK_CACHE_NO_BLOCK;
+}
+
+// flushes the blocks overlapping the sectors, before they are accessed without the cache
+DRESULT DiskCache::flush(BYTE drv, DWORD sector, UINT count, bool invalidate)
+{
+  DWORD first = sector / DISK_CACHE_BLOCK_SECTORS;
+  DWORD last = (sector + count - 1) / DISK_CACHE_BLOCK_SECTORS;
   for (int n=0; n<DISK_CACHE_BLOCKS_NUM; ++n) {
-    if (blocks[n].empty()) {
-      TRACE_DISK_CACHE("\t\t using free block");
-      return blocks[n].fill(drv, buff, sector, count);
+    DiskCacheBlock & block = blocks[n];
+    if (!block.empty() && block.block >= first && block.block <= last) {
+      if (block.dirty()) {
+        ++stats.noFlushes;
+        DRESULT res = block.flush(drv);
+        if (res != RES_OK) {
+          return res;
+        }
+      }
+      if (invalidate) {
+        TRACE_DISK_CACHE("\tINVALIDATING disk cache block %p (%u)", &block, (uint32_t)block.block);
+        block.free();
+      }
     }
   }
+  return RES_OK;
+}
 
-  // use next block (round robin)
-  // TODO: use better strategy to select which used block gets used here
-  if (++lastBlock >= DISK_CACHE_BLOCKS_NUM) {
-    lastBlock = 0;
+DRESULT DiskCache::flush(BYTE drv)
+{
+  for (int n=0; n<DISK_CACHE_BLOCKS_NUM; ++n) {
+    if (blocks[n].dirty()) {
+      ++stats.noFlushes;
+      DRESULT res = blocks[n].flush(drv);
+      if (res != RES_OK) {
+        return res;
+      }
+    }
   }
-  
-  return blocks[lastBlock].fill(drv, buff, sector, count);
+  return RES_OK;
 }
 
-DRESULT DiskCache::write(BYTE drv, const BYTE* buff, DWORD sector, UINT count)
+DRESULT DiskCache::read(BYTE drv, BYTE * buff, DWORD sector, UINT count)
+{
+  DiskCacheConsumerStats & consumerStats = stats.consumers[getConsumer()];
+
+  // if read is bigger than cache block, or if a cache block would be beyond the end of the disk,
+  // then read it directly without using cache
+  if (count > DISK_CACHE_BLOCK_SECTORS || sector+count+DISK_CACHE_BLOCK_SECTORS >= sdGetNoSectors()) {
+    TRACE_DISK_CACHE("\t\t direct read(%u, %u)",  (uint32_t)sector, (uint32_t)count);
+    ++stats.noMisses;
+    ++consumerStats.noMisses;
+    DRESULT res = flush(drv, sector, count, false);
+    if (res != RES_OK) {
+      return res;
+    }
+    return __disk_read(drv, buff, sector, count);
+  }
+
+  bool hit = true;
+
+  // the read covers at most 2 cache blocks
+  while (count > 0) {
+    DWORD block = sector / DISK_CACHE_BLOCK_SECTORS;
+    UINT chunk = min<UINT>(count, (block + 1) * DISK_CACHE_BLOCK_SECTORS - sector);
+
+    followStream(block);
+
+    DiskCacheBlock * cacheBlock = find(block);
+    if (!cacheBlock || !cacheBlock->read(buff, sector, chunk)) {
+      hit = false;
+      if (!cacheBlock) {
+        cacheBlock = allocate(drv, block);
+        if (!cacheBlock) {
+          return RES_ERROR;
+        }
+      }
+      DRESULT res = cacheBlock->fill(drv, block);
+      if (res != RES_OK) {
+        return res;
+      }
+      cacheBlock->read(buff, sector, chunk);
+    }
+    cacheBlock->lastUse = ++accessCounter;
+
+    buff += chunk * BLOCK_SIZE;
+    sector += chunk;
+    count -= chunk;
+  }
+
+  if (hit) {
+    ++stats.noHits;
+    ++consumerStats.noHits;
+  }
+  else {
+    ++stats.noMisses;
+    ++consumerStats.noMisses;
+  }
+
+  return RES_OK;
+}
+
+// write-behind: the sectors stay in the cache until flush() (on CTRL_SYNC) or until their block gets evicted.
+// The reserved sectors, the FATs and the FAT12/16 root directory are written through: the card always has
+// the allocation tables of the sectors written behind, whatever the order of the evictions or a power loss
+DRESULT DiskCache::write(BYTE drv, const BYTE * buff, DWORD sector, UINT count)
 {
   ++stats.noWrites;
-  for(int n=0; n < DISK_CACHE_BLOCKS_NUM; ++n) {
-    blocks[n].free(sector, count);
+  ++stats.consumers[getConsumer()].noWrites;
+
+  if (count > DISK_CACHE_BLOCK_SECTORS || sector+count+DISK_CACHE_BLOCK_SECTORS >= sdGetNoSectors()) {
+    TRACE_DISK_CACHE("\t\t direct write(%u, %u)",  (uint32_t)sector, (uint32_t)count);
+    DRESULT res = flush(drv, sector, count, true);
+    if (res != RES_OK) {
+      return res;
+    }
+    return __disk_write(drv, buff, sector, count);
+  }
+
+  while (count > 0) {
+    DWORD block = sector / DISK_CACHE_BLOCK_SECTORS;
+    UINT chunk = min<UINT>(count, (block + 1) * DISK_CACHE_BLOCK_SECTORS - sector);
+
+    DiskCacheBlock * cacheBlock = find(block);
+    if (!cacheBlock) {
+      cacheBlock = allocate(drv, block);
+      if (!cacheBlock) {
+        return RES_ERROR;
+      }
+    }
+    cacheBlock->write(buff, sector, chunk);
+    cacheBlock->lastUse = ++accessCounter;
+
+    if (sector < g_FATFS_Obj.database) {
+      DRESULT res = cacheBlock->flush(drv);
+      if (res != RES_OK) {
+        return res;
+      }
+    }
+
+    buff += chunk * BLOCK_SIZE;
+    sector += chunk;
+    count -= chunk;
   }
-  return __disk_write(drv, buff, sector, count);  
+
+  return RES_OK;
 }
 
-const DiskCacheStats & DiskCache::getStats() const 
-{ 
-  return stats; 
+// the read-ahead requested by read() is done here, outside of the reader task
+void DiskCache::prefetch(BYTE drv)
+{
+  if (!sdMounted()) {
+    return;
+  }
+
+  if (!ff_req_grant(g_FATFS_Obj.sobj)) {
+    return;
+  }
+
+  for (int n=0; n<DISK_CACHE_STREAMS; ++n) {
+    DWORD block = prefetchBlocks[n];
+    if (block == DISK_CACHE_NO_BLOCK) {
+      continue;
+    }
+    prefetchBlocks[n] = DISK_CACHE_NO_BLOCK;
+    if ((block + 2) * DISK_CACHE_BLOCK_SECTORS >= sdGetNoSectors() || find(block)) {
+      continue;
+    }
+    DiskCacheBlock * cacheBlock = allocate(drv, block);
+    if (cacheBlock && cacheBlock->fill(drv, block) == RES_OK) {
+      TRACE_DISK_CACHE("\t\t read-ahead of block %u", (uint32_t)block);
+      cacheBlock->lastUse = ++accessCounter;
+      ++stats.noPrefetches;
+    }
+  }
+
+  ff_rel_grant(g_FATFS_Obj.sobj);
+}
+
+const DiskCacheStats & DiskCache::getStats() const
+{
+  return stats;
 }
 
 int DiskCache::getHitRate() const
@@ -168,6 +420,14 @@ int DiskCache::getHitRate() const
   return (stats.noHits * 1000) / all;
 }
 
+int DiskCache::getHitRate(DiskCacheConsumer consumer) const
+{
+  const DiskCacheConsumerStats & consumerStats = stats.consumers[consumer];
+  uint32_t all = consumerStats.noHits + consumerStats.noMisses;
+  if (all == 0) return 0;
+  return (consumerStats.noHits * 1000) / all;
+}
+
 DRESULT disk_read(BYTE drv, BYTE * buff, DWORD sector, UINT count)
 {
   return diskCache.read(drv, buff, sector, count);
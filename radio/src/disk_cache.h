@@ -26,24 +26,54 @@
 
 // tunable parameters
 #define DISK_CACHE_BLOCKS_NUM      32   // no cache blocks
-#define DISK_CACHE_BLOCK_SECTORS   16   // no sectors
+#define DISK_CACHE_BLOCK_SECTORS   16   // no sectors (32 max)
+#define DISK_CACHE_WAYS            4    // no blocks in each set
+#define DISK_CACHE_STREAMS         4    // no sequential reads followed for read-ahead
 
 #define DISK_CACHE_BLOCK_SIZE   (DISK_CACHE_BLOCK_SECTORS * BLOCK_SIZE)
+#define DISK_CACHE_SETS         (DISK_CACHE_BLOCKS_NUM / DISK_CACHE_WAYS)
 
+#define DISK_CACHE_NO_BLOCK     ((DWORD)-1)
+
+enum DiskCacheConsumer
+{
+  DISK_CACHE_OTHER,
+  DISK_CACHE_AUDIO,
+  DISK_CACHE_LOGS,
+  DISK_CACHE_LUA,
+  DISK_CACHE_MODELS,
+  DISK_CACHE_CONSUMERS_COUNT
+};
+
+// cache blocks are aligned on DISK_CACHE_BLOCK_SECTORS, with one bit per sector in the valid / dirty masks
 class DiskCacheBlock
 {
 public:
   DiskCacheBlock();
   bool read(BYTE* buff, DWORD sector, UINT count);
-  DRESULT fill(BYTE drv, BYTE* buff, DWORD sector, UINT count);
-  void free(DWORD sector, UINT count);
+  void write(const BYTE* buff, DWORD sector, UINT count);
+  DRESULT fill(BYTE drv, DWORD block);
+  DRESULT flush(BYTE drv);
+  void reset(DWORD block);
   void free();
   bool empty() const;
+  bool dirty() const;
+  DWORD getBlock() const { return block; }
 
 private:
+  friend class DiskCache;
   uint8_t data[DISK_CACHE_BLOCK_SIZE];
-  DWORD startSector;
-  DWORD endSector;
+  DWORD block;
+  uint32_t valid;
+  uint32_t dirtySectors;
+  uint32_t lastUse;
+};
+
+struct DiskCacheConsumerStats
+{
+  uint32_t noHits;
+  uint32_t noMisses;
+  uint32_t noWrites;
 };
 
 struct DiskCacheStats
@@ -51,6 +81,9 @@ struct DiskCacheStats
   uint32_t noHits;
   uint32_t noMisses;
   uint32_t noWrites;
+  uint32_t noPrefetches;
+  uint32_t noFlushes;
+  DiskCacheConsumerStats consumers[DISK_CACHE_CONSUMERS_COUNT];
 };
 
 class DiskCache
@@ -59,16 +92,57 @@ class DiskCache
     DiskCache();
     DRESULT read(BYTE drv, BYTE* buff, DWORD sector, UINT count);
     DRESULT write(BYTE drv, const BYTE* buff, DWORD sector, UINT count);
+    DRESULT flush(BYTE drv);
+    void prefetch(BYTE drv);
     const DiskCacheStats & getStats() const;
     int getHitRate() const;
+    int getHitRate(DiskCacheConsumer consumer) const;
     void clear();
 
+    DiskCacheConsumer setConsumer(DiskCacheConsumer value)
+    {
+      DiskCacheConsumer previous = consumer;
+      consumer = value;
+      return previous;
+    }
+
   private:
     DiskCacheStats stats;
-    uint32_t lastBlock;
+    uint32_t accessCounter;
+    DiskCacheConsumer consumer;
+    DWORD streams[DISK_CACHE_STREAMS];         // next block expected by each sequential read
+    DWORD prefetchBlocks[DISK_CACHE_STREAMS];  // read-ahead requests, done by prefetch()
+    uint8_t lastStream;
     DiskCacheBlock * blocks;
+
+    DiskCacheConsumer getConsumer() const;
+    DiskCacheBlock * find(DWORD block);
+    DiskCacheBlock * allocate(BYTE drv, DWORD block);
+    void followStream(DWORD block);
+    DRESULT flush(BYTE drv, DWORD sector, UINT count, bool invalidate);
 };
 
 extern DiskCache diskCache;
 
+// SD card accesses done in this scope are accounted to consumer. Only for the menus task, the scopes of
+// different tasks would overwrite each other (the audio and logs tasks are detected automatically)
+class DiskCacheConsumerScope
+{
+  public:
+    explicit DiskCacheConsumerScope(DiskCacheConsumer consumer):
+      previous(diskCache.setConsumer(consumer))
+    {
+    }
+
+    ~DiskCacheConsumerScope()
+    {
+      diskCache.setConsumer(previous);
+    }
+
+  private:
+    DiskCacheConsumer previous;
+};
+
+#define DISK_CACHE_CONSUMER(consumer)  DiskCacheConsumerScope diskCacheConsumerScope(consumer)
+
 #endif // _DISK_CACHE_H_
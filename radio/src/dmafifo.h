@@ -22,14 +22,21 @@
 #define _DMA_FIFO_H_
 
 #include "definitions.h"
+#include "fifo.h"
 
+// Same consumer side than Fifo, the producer is a DMA stream in circular mode.
+// The DMA overwrites the oldest data when the consumer is too late, this can't be
+// detected here, the high water mark tells how close the fifo was to overflow.
 template <int N>
 class DMAFifo
 {
+  static_assert((N > 1) & !(N & (N - 1)), "DMAFifo size must be a power of two!");
+
   public:
     DMAFifo(DMA_Stream_TypeDef * stream):
       stream(stream),
-      ridx(0)
+      ridx(0),
+      highWater(0)
     {
     }
 
@@ -53,7 +60,7 @@ class DMAFifo
 #if defined(SIMU)
       return true;
 #endif
-      return (ridx == N - stream->NDTR);
+      return (available() == 0);
     }
 
     bool pop(uint8_t & element)
@@ -68,6 +75,55 @@ class DMAFifo
       }
     }
 
+    // returns the number of bytes popped
+    uint32_t popN(uint8_t * elements, uint32_t count)
+    {
+      const uint8_t * data;
+      uint32_t result = 0;
+      while (result < count) {
+        uint32_t span = readSpan(data);
+        if (span == 0)
+          break;
+        if (span > count - result)
+          span = count - result;
+        memcpy(&elements[result], data, span);
+        skip(span);
+        result += span;
+      }
+      return result;
+    }
+
+    // contiguous bytes available without copy, to be released with skip()
+    uint32_t readSpan(const uint8_t * & data)
+    {
+#if defined(SIMU)
+      return 0;
+#endif
+      uint32_t count = available();
+      data = &fifo[ridx];
+      return (count < N - ridx) ? count : N - ridx;
+    }
+
+    void skip(uint32_t count)
+    {
+      ridx = (ridx+count) & (N-1);
+    }
+
+    uint32_t getOverflows() const
+    {
+      return 0;
+    }
+
+    uint32_t getHighWater() const
+    {
+      return highWater;
+    }
+
+    void resetStats()
+    {
+      highWater = 0;
+    }
+
     uint8_t * buffer()
     {
       return fifo;
@@ -77,6 +133,18 @@ class DMAFifo
     uint8_t fifo[N];
     DMA_Stream_TypeDef * stream;
     volatile uint32_t ridx;
+    uint32_t highWater;
+
+    uint32_t available()
+    {
+      uint32_t count = (N - stream->NDTR - ridx) & (N-1);
+      // the bytes written by the DMA before NDTR was read must not be read earlier
+      FIFO_ACQUIRE_FENCE();
+      if (count > highWater) {
+        highWater = count;
+      }
+      return count;
+    }
 };
 
 #endif // _DMA_FIFO_H_
@@ -21,6 +21,21 @@
 #ifndef _FIFO_H_
 #define _FIFO_H_
 
+// Single producer / single consumer: the producer only writes widx, the
+// consumer only writes ridx. Each side publishes its accesses to the buffer
+// with a release store of its own index, and reads the other index with an
+// acquire load before touching the buffer.
+#if defined(__GNUC__)
+  #define FIFO_LOAD_ACQUIRE(x)       __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+  #define FIFO_STORE_RELEASE(x, v)   __atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+  #define FIFO_ACQUIRE_FENCE()       __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#else
+  // MSVC volatile accesses have acquire / release semantics
+  #define FIFO_LOAD_ACQUIRE(x)       (x)
+  #define FIFO_STORE_RELEASE(x, v)   ((x) = (v))
+  #define FIFO_ACQUIRE_FENCE()
+#endif
+
 template <class T, int N>
 class Fifo
 {
@@ -29,45 +44,125 @@ class Fifo
   public:
     Fifo():
       widx(0),
-      ridx(0)
+      ridx(0),
+      overflows(0),
+      highWater(0)
     {
     }
 
+    // only when neither the producer nor the consumer are running
     void clear()
     {
       widx = ridx = 0;
     }
 
-    void push(T element)
+    // producer side
+
+    bool push(T element)
+    {
+      uint32_t w = widx;
+      uint32_t next = (w+1) & (N-1);
+      if (next == FIFO_LOAD_ACQUIRE(ridx)) {
+        overflows++;
+        return false;
+      }
+      fifo[w] = element;
+      FIFO_STORE_RELEASE(widx, next);
+      updateHighWater();
+      return true;
+    }
+
+    // all the elements are pushed, or none of them when there is not enough space
+    bool pushN(const T * elements, uint32_t count)
     {
-      uint32_t next = (widx+1) & (N-1);
-      if (next != ridx) {
-        fifo[widx] = element;
-        widx = next;
+      uint32_t w = widx;
+      if (freeSpace(w) < count) {
+        overflows += count;
+        return false;
+      }
+      for (uint32_t i=0; i<count; i++) {
+        fifo[(w+i) & (N-1)] = elements[i];
       }
+      FIFO_STORE_RELEASE(widx, (w+count) & (N-1));
+      updateHighWater();
+      return true;
     }
 
+    // contiguous free space, to be filled in place before commit()
+    uint32_t writeSpan(T * & data)
+    {
+      uint32_t w = widx;
+      uint32_t space = freeSpace(w);
+      data = &fifo[w];
+      return (space < N - w) ? space : N - w;
+    }
+
+    void commit(uint32_t count)
+    {
+      FIFO_STORE_RELEASE(widx, (widx+count) & (N-1));
+      updateHighWater();
+    }
+
+    bool isFull() const
+    {
+      return freeSpace(widx) == 0;
+    }
+
+    uint32_t hasSpace(uint32_t n) const
+    {
+      return freeSpace(widx) >= n;
+    }
+
+    // consumer side
+
     bool pop(T & element)
     {
-      if (isEmpty()) {
+      uint32_t r = ridx;
+      if (r == FIFO_LOAD_ACQUIRE(widx)) {
         return false;
       }
-      else {
-        element = fifo[ridx];
-        ridx = (ridx+1) & (N-1);
-        return true;
+      element = fifo[r];
+      FIFO_STORE_RELEASE(ridx, (r+1) & (N-1));
+      return true;
+    }
+
+    // returns the number of elements popped
+    uint32_t popN(T * elements, uint32_t count)
+    {
+      uint32_t r = ridx;
+      uint32_t available = (FIFO_LOAD_ACQUIRE(widx) - r) & (N-1);
+      if (count > available) {
+        count = available;
+      }
+      for (uint32_t i=0; i<count; i++) {
+        elements[i] = fifo[(r+i) & (N-1)];
       }
+      FIFO_STORE_RELEASE(ridx, (r+count) & (N-1));
+      return count;
     }
 
-    bool isEmpty() const
+    // contiguous elements available without copy, to be released with skip()
+    uint32_t readSpan(const T * & data) const
     {
-      return (ridx == widx);
+      uint32_t r = ridx;
+      uint32_t count = (FIFO_LOAD_ACQUIRE(widx) - r) & (N-1);
+      data = &fifo[r];
+      return (count < N - r) ? count : N - r;
     }
 
-    bool isFull()
+    void skip(uint32_t count)
     {
-      uint32_t next = (widx+1) & (N-1);
-      return (next == ridx);
+      FIFO_STORE_RELEASE(ridx, (ridx+count) & (N-1));
+    }
+
+    bool probe(T & element) const
+    {
+      uint32_t r = ridx;
+      if (r == FIFO_LOAD_ACQUIRE(widx)) {
+        return false;
+      }
+      element = fifo[r];
+      return true;
     }
 
     void flush()
@@ -75,31 +170,54 @@ class Fifo
       while (!isEmpty()) {};
     }
 
+    // both sides
+
+    bool isEmpty() const
+    {
+      return FIFO_LOAD_ACQUIRE(ridx) == FIFO_LOAD_ACQUIRE(widx);
+    }
+
     uint32_t size() const
     {
-      return (N + widx - ridx) & (N-1);
+      return (N + FIFO_LOAD_ACQUIRE(widx) - FIFO_LOAD_ACQUIRE(ridx)) & (N-1);
     }
 
-    uint32_t hasSpace(uint32_t n) const
+    // diagnostics, updated by the producer
+    uint32_t getOverflows() const
     {
-      return (N > (size() + n));
+      return overflows;
     }
 
-    bool probe(T & element) const
+    uint32_t getHighWater() const
     {
-      if (isEmpty()) {
-        return false;
-      }
-      else {
-        element = fifo[ridx];
-        return true;
-      }
+      return highWater;
+    }
+
+    void resetStats()
+    {
+      overflows = 0;
+      highWater = 0;
     }
 
   protected:
     T fifo[N];
     volatile uint32_t widx;
     volatile uint32_t ridx;
+    uint32_t overflows;  // elements dropped because the fifo was full
+    uint32_t highWater;  // max number of elements seen in the fifo
+
+    uint32_t freeSpace(uint32_t w) const
+    {
+      return (FIFO_LOAD_ACQUIRE(ridx) - w - 1) & (N-1);
+    }
+
+    void updateHighWater()
+    {
+      uint32_t count = (widx - ridx) & (N-1);
+      if (count > highWater) {
+        highWater = count;
+      }
+    }
 };
 
 #endif // _FIFO_H_
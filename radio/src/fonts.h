@@ -27,7 +27,12 @@ extern const uint16_t * const fontspecsTable[16];
 extern const uint8_t * const fontsTable[16];
 
 #if defined(PCBHORUS)
-extern BitmapBuffer * fontCache[2];
+#define FONT_CACHE_ENTRIES             8
+#define FONT_CACHE_MAX_SIZE            (1024*1024) // bytes of pre-rendered glyph strips
+#define FONT_CACHE_CANDIDATES          8
+#define FONT_CACHE_ADMISSION_MISSES    3           // misses of a font and colors before their strip is built
+
+const BitmapBuffer * getFontCache(uint8_t fontindex, display_t fgColor, display_t bgColor);
 void loadFontCache();
 #endif
 
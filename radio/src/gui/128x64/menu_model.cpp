@@ -116,7 +116,7 @@ void editName(coord_t x, coord_t y, char * name, uint8_t size, event_t event, ui
 
       if (c != v) {
         name[cur] = v;
-        storageDirty(EE_MODEL);
+        storageModelChanged();
       }
 
       lcdDrawChar(x+editNameCursorPos*FW, y, idx2char(v), ERASEBG|INVERS|FIXEDWIDTH);
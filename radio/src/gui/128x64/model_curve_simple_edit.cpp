@@ -49,7 +49,7 @@ void menuModelCurveOne(event_t event)
           menuHorizontalPosition = -4;
         for (uint8_t i=0; i<crv.points; i++)
           crv.crv[i] = (i-(crv.points/2)) * int8_t(menuHorizontalPosition) * 50 / (crv.points-1);
-        storageDirty(EE_MODEL);
+        storageModelChanged();
         killEvents(event);
       }
       break;
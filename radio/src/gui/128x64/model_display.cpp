@@ -76,7 +76,7 @@ void onTelemetryScriptFileSelectionMenu(const char *result)
   else {
     // The user choosed a file in the list
     memcpy(g_model.frsky.screens[screenIndex].script.file, result, sizeof(g_model.frsky.screens[screenIndex].script.file));
-    storageDirty(EE_MODEL);
+    storageModelChanged();
     LUA_LOAD_MODEL_SCRIPTS();
   }
 }
@@ -47,7 +47,7 @@ FlightModesType editFlightModes(coord_t x, coord_t y, event_t event, FlightModes
     if (s_editMode && ((event==EVT_KEY_BREAK(KEY_ENTER) || p1valdiff))) {
       s_editMode = 0;
       value ^= (1<<posHorz);
-      storageDirty(EE_MODEL);
+      storageModelChanged();
     }
   }
 
@@ -93,7 +93,7 @@ void deleteExpoMix(uint8_t expo, uint8_t idx)
     memclear(&g_model.mixData[MAX_MIXERS-1], sizeof(MixData));
   }
   resumeMixerCalculations();
-  storageDirty(EE_MODEL);
+  storageModelChanged();
 }
 
 // TODO avoid this global s_currCh on ARM boards ...
@@ -118,7 +118,7 @@ void insertExpoMix(uint8_t expo, uint8_t idx)
     mix->weight = 100;
   }
   resumeMixerCalculations();
-  storageDirty(EE_MODEL);
+  storageModelChanged();
 }
 
 void copyExpoMix(uint8_t expo, uint8_t idx)
@@ -133,7 +133,7 @@ void copyExpoMix(uint8_t expo, uint8_t idx)
     memmove(mix+1, mix, (MAX_MIXERS-(idx+1))*sizeof(MixData));
   }
   resumeMixerCalculations();
-  storageDirty(EE_MODEL);
+  storageModelChanged();
 }
 
 bool swapExpoMix(uint8_t expo, uint8_t &idx, uint8_t up)
@@ -691,7 +691,7 @@ void menuModelExpoMix(uint8_t expo, event_t event)
               swapExpoMix(expo, s_currIdx, s_copyTgtOfs > 0);
               s_copyTgtOfs += (s_copyTgtOfs < 0 ? +1 : -1);
             } while (s_copyTgtOfs != 0);
-            storageDirty(EE_MODEL);
+            storageModelChanged();
           }
           menuVerticalPosition = s_copySrcRow;
           s_copyTgtOfs = 0;
@@ -797,7 +797,7 @@ void menuModelExpoMix(uint8_t expo, event_t event)
         else {
           // only swap the mix with its neighbor
           if (!swapExpoMix(expo, s_currIdx, IS_ROTARY_LEFT(event) || key==KEY_UP)) break;
-          storageDirty(EE_MODEL);
+          storageModelChanged();
         }
 
         s_copyTgtOfs = next_ofs;
@@ -170,7 +170,7 @@ void menuModelLogicalSwitchOne(event_t event)
             INCDEC_SET_FLAG(EE_MODEL | INCDEC_REP10 | NO_INCDEC_MARKS);
             if (cs->v2 < v2_min || cs->v2 > v2_max) {
               cs->v2 = 0;
-              storageDirty(EE_MODEL);
+              storageModelChanged();
             }
           }
           else
@@ -241,11 +241,11 @@ void onLogicalSwitchesMenu(const char *result)
   }
   else if (result == STR_PASTE) {
     *cs = clipboard.data.csw;
-    storageDirty(EE_MODEL);
+    storageModelChanged();
   }
   else if (result == STR_CLEAR) {
     memset(cs, 0, sizeof(LogicalSwitchData));
-    storageDirty(EE_MODEL);
+    storageModelChanged();
   }
 }
 
@@ -405,7 +405,7 @@ void menuModelLogicalSwitches(event_t event)
         }
         if (cs->v2 > v2_max) {
           cs->v2 = v2_max;
-          storageDirty(EE_MODEL);
+          storageModelChanged();
         }
       }
       else {
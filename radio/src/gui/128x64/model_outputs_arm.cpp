@@ -234,7 +234,7 @@ void menuModelLimits(event_t event)
     warningResult = 0;
     LimitData * ld = limitAddress(sub);
     ld->revert = !ld->revert;
-    storageDirty(EE_MODEL);
+    storageModelChanged();
   }
 
   for (uint8_t i=0; i<LCD_LINES-1; i++) {
@@ -275,7 +275,7 @@ void menuModelSetup(event_t event)
                 int8_t switchVal = checkIncDecMovedSwitch(val);
                 if (val != switchVal) {
                   timer->mode = switchVal + (TMRMODE_COUNT-1);
-                  storageDirty(EE_MODEL);
+                  storageModelChanged();
                 }
               }
 #endif
@@ -403,7 +403,7 @@ void menuModelSetup(event_t event)
             for (uint8_t i=0; i<MAX_FLIGHT_MODES; i++) {
               memclear(&g_model.flightModeData[i], TRIMS_ARRAY_SIZE);
             }
-            storageDirty(EE_MODEL);
+            storageModelChanged();
             AUDIO_WARNING1();
           }
         }
@@ -468,11 +468,11 @@ void menuModelSetup(event_t event)
               case EVT_KEY_BREAK(KEY_ENTER):
 #if defined(CPUM64)
                 g_model.switchWarningEnable ^= (1 << menuHorizontalPosition);
-                storageDirty(EE_MODEL);
+                storageModelChanged();
 #else
                 if (menuHorizontalPosition < NUM_SWITCHES-1) {
                   g_model.switchWarningEnable ^= (1 << menuHorizontalPosition);
-                  storageDirty(EE_MODEL);
+                  storageModelChanged();
                 }
 #endif
                 break;
@@ -482,19 +482,19 @@ void menuModelSetup(event_t event)
                 getMovedSwitch();
                 g_model.switchWarningState = switches_states;
                 AUDIO_WARNING1();
-                storageDirty(EE_MODEL);
+                storageModelChanged();
 #elif defined(PCBX7)
                 getMovedSwitch();
                 g_model.switchWarningState = switches_states;
                 AUDIO_WARNING1();
-                storageDirty(EE_MODEL);
+                storageModelChanged();
 #else
                 if (menuHorizontalPosition == NUM_SWITCHES-1) {
                   START_NO_HIGHLIGHT();
                   getMovedSwitch();
                   g_model.switchWarningState = switches_states;
                   AUDIO_WARNING1();
-                  storageDirty(EE_MODEL);
+                  storageModelChanged();
                 }
 #endif
                 killEvents(event);
@@ -559,7 +559,7 @@ void menuModelSetup(event_t event)
             if (READ_ONLY_UNLOCKED()) {
               s_editMode = 0;
               g_model.beepANACenter ^= ((BeepANACenter)1<<menuHorizontalPosition);
-              storageDirty(EE_MODEL);
+              storageModelChanged();
             }
           }
         }
@@ -1074,7 +1074,7 @@ void menuModelFailsafe(event_t event)
     event = 0;
     if (s_editMode) {
       g_model.moduleData[g_moduleIdx].failsafeChannels[menuVerticalPosition] = channelOutputs[menuVerticalPosition+channelStart];
-      storageDirty(EE_MODEL);
+      storageModelChanged();
       AUDIO_WARNING1();
       s_editMode = 0;
       SEND_FAILSAFE_NOW(g_moduleIdx);
@@ -1087,7 +1087,7 @@ void menuModelFailsafe(event_t event)
         failsafe = FAILSAFE_CHANNEL_NOPULSE;
       else
         failsafe = 0;
-      storageDirty(EE_MODEL);
+      storageModelChanged();
       AUDIO_WARNING1();
       SEND_FAILSAFE_NOW(g_moduleIdx);
     }
@@ -207,6 +207,12 @@ int checkIncDec(event_t event, int val, int i_min, int i_max, unsigned int i_fla
 
   if (newval != val) {
     storageDirty(i_flags & (EE_GENERAL|EE_MODEL));
+#if defined(CPUARM)
+    if (i_flags & EE_MODEL) {
+      // not now, the new value is stored by the caller
+      mainRequestFlags |= (1 << REQUEST_MODEL_CACHES_INVALIDATION);
+    }
+#endif
     checkIncDec_Ret = (newval > val ? 1 : -1);
   }
   else {
@@ -402,6 +408,12 @@ int checkIncDec(event_t event, int val, int i_min, int i_max, unsigned int i_fla
     }
     AUDIO_KEY_PRESS();
     storageDirty(i_flags & (EE_GENERAL|EE_MODEL));
+#if defined(CPUARM)
+    if (i_flags & EE_MODEL) {
+      // not now, the new value is stored by the caller
+      mainRequestFlags |= (1 << REQUEST_MODEL_CACHES_INVALIDATION);
+    }
+#endif
     checkIncDec_Ret = (newval > val ? 1 : -1);
   }
   else {
@@ -501,6 +513,12 @@ int16_t checkIncDec(event_t event, int16_t val, int16_t i_min, int16_t i_max, ui
       AUDIO_KEY_PRESS();
     }
     storageDirty(i_flags & (EE_GENERAL|EE_MODEL));
+#if defined(CPUARM)
+    if (i_flags & EE_MODEL) {
+      // not now, the new value is stored by the caller
+      mainRequestFlags |= (1 << REQUEST_MODEL_CACHES_INVALIDATION);
+    }
+#endif
     checkIncDec_Ret = (newval > val ? 1 : -1);
   }
   else {
@@ -103,6 +103,8 @@ void menuStatisticsDebug(event_t event)
 #if !defined(CPUARM)
       g_tmr1Latency_min = 0xff;
       g_tmr1Latency_max = 0;
+#else
+      mixerDeadlineMisses = 0;
 #endif
       maxMixerDuration  = 0;
       break;
@@ -172,6 +174,9 @@ void menuStatisticsDebug(event_t event)
   lcdDrawTextAlignedLeft(MENU_DEBUG_Y_MIXMAX, STR_TMIXMAXMS);
   lcdDrawNumber(MENU_DEBUG_COL1_OFS, MENU_DEBUG_Y_MIXMAX, DURATION_MS_PREC2(maxMixerDuration), PREC2|LEFT);
   lcdDrawText(lcdLastPos, MENU_DEBUG_Y_MIXMAX, "ms");
+  // deadline misses
+  lcdDrawText(MENU_DEBUG_COL2_OFS, MENU_DEBUG_Y_MIXMAX+1, "M", SMLSIZE);
+  lcdDrawNumber(lcdLastPos+1, MENU_DEBUG_Y_MIXMAX, mixerDeadlineMisses, LEFT);
 #endif
 
 #if defined(CPUARM)
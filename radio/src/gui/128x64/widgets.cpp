@@ -129,7 +129,7 @@ int16_t editGVarFieldValue(coord_t x, coord_t y, int16_t value, int16_t min, int
       value = (GV_IS_GV_VALUE(value, min, max) ? GET_GVAR(value, min, max, mixerCurrentFlightMode)*10 : delta);
     else
       value = (GV_IS_GV_VALUE(value, min, max) ? GET_GVAR(value, min, max, mixerCurrentFlightMode) : delta);
-    storageDirty(EE_MODEL);
+    storageModelChanged();
   }
 
   if (GV_IS_GV_VALUE(value, min, max)) {
@@ -163,7 +163,7 @@ int16_t editGVarFieldValue(coord_t x, coord_t y, int16_t value, int16_t min, int
   if (invers && event == EVT_KEY_LONG(KEY_ENTER)) {
     s_editMode = !s_editMode;
     value = (GV_IS_GV_VALUE(value, min, max) ? GET_GVAR(value, min, max, mixerCurrentFlightMode) : delta);
-    storageDirty(EE_MODEL);
+    storageModelChanged();
   }
   if (GV_IS_GV_VALUE(value, min, max)) {
     if (attr & LEFT)
@@ -39,6 +39,7 @@ void displayPresetChoice(event_t event)
     if (crv.type == CURVE_TYPE_CUSTOM) {
       resetCustomCurveX(points, 5+crv.points);
     }
+    storageModelChanged();
   }
 }
 
@@ -52,6 +53,7 @@ void onCurveOneMenu(const char * result)
     int8_t * points = curveAddress(s_curveChan);
     for (int i=0; i<5+crv.points; i++)
       points[i] = -points[i];
+    storageModelChanged();
   }
   else if (result == STR_CLEAR) {
     CurveInfo & crv = g_model.curves[s_curveChan];
@@ -61,6 +63,7 @@ void onCurveOneMenu(const char * result)
     if (crv.type == CURVE_TYPE_CUSTOM) {
       resetCustomCurveX(points, 5+crv.points);
     }
+    storageModelChanged();
   }
 }
 
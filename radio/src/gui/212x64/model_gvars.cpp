@@ -41,7 +41,7 @@ void editGVarValue(coord_t x, coord_t y, event_t event, uint8_t gvar, uint8_t fl
   if (flags & INVERS) {
     if (event == EVT_KEY_LONG(KEY_ENTER)) {
       v = (v > GVAR_MAX ? 0 : GVAR_MAX+1);
-      storageDirty(EE_MODEL);
+      storageModelChanged();
     }
     else if (s_editMode > 0) {
       v = checkIncDec(event, v, vmin, vmax, EE_MODEL);
@@ -126,7 +126,7 @@ void onGVARSMenu(const char *result)
     for (int i=0; i<MAX_FLIGHT_MODES; i++) {
       g_model.flightModeData[i].gvars[sub] = 0;
     }
-    storageDirty(EE_MODEL);
+    storageModelChanged();
   }
 }
 
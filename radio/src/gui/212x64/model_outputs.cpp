@@ -120,7 +120,7 @@ void menuModelLimits(event_t event)
     warningResult = 0;
     LimitData *ld = limitAddress(sub);
     ld->revert = !ld->revert;
-    storageDirty(EE_MODEL);
+    storageModelChanged();
   }
 
   for (int i=0; i<NUM_BODY_LINES; i++) {
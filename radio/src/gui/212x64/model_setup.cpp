@@ -120,7 +120,7 @@ void onModelSetupBitmapMenu(const char * result)
     // The user choosed a bmp file in the list
     copySelection(g_model.header.bitmap, result, sizeof(g_model.header.bitmap));
     memcpy(modelHeaders[g_eeGeneral.currModel].bitmap, g_model.header.bitmap, sizeof(g_model.header.bitmap));
-    storageDirty(EE_MODEL);
+    storageModelChanged();
   }
 }
 
@@ -149,7 +149,7 @@ void editTimerMode(int timerIdx, coord_t y, LcdFlags attr, event_t event)
           swsrc_t switchVal = checkIncDecMovedSwitch(val);
           if (val != switchVal) {
             timer.mode = switchVal + (TMRMODE_COUNT-1);
-            storageDirty(EE_MODEL);
+            storageModelChanged();
           }
         }
 #endif
@@ -411,7 +411,7 @@ void menuModelSetup(event_t event)
             for (uint8_t i=0; i<MAX_FLIGHT_MODES; i++) {
               memclear(&g_model.flightModeData[i], TRIMS_ARRAY_SIZE);
             }
-            storageDirty(EE_MODEL);
+            storageModelChanged();
             AUDIO_WARNING1();
           }
         }
@@ -502,7 +502,7 @@ void menuModelSetup(event_t event)
                   getMovedSwitch();
                   g_model.switchWarningState = switches_states;
                   AUDIO_WARNING1();
-                  storageDirty(EE_MODEL);
+                  storageModelChanged();
                 }
                 killEvents(event);
                 break;
@@ -518,7 +518,7 @@ void menuModelSetup(event_t event)
             div_t qr = div(current, 8);
             if (!READ_ONLY() && event==EVT_KEY_BREAK(KEY_ENTER) && line && l_posHorz==current) {
               g_model.switchWarningEnable ^= (1 << i);
-              storageDirty(EE_MODEL);
+              storageModelChanged();
             }
             uint8_t swactive = !(g_model.switchWarningEnable & (1<<i));
             c = "\300-\301"[states & 0x03];
@@ -553,7 +553,7 @@ void menuModelSetup(event_t event)
         lcdDrawTextAtIndex(MODEL_SETUP_2ND_COLUMN, y, PSTR("\004""OFF\0""Man\0""Auto"), g_model.potsWarnMode, (menuHorizontalPosition == 0) ? attr : 0);
         if (attr && (menuHorizontalPosition == 0)) {
           CHECK_INCDEC_MODELVAR(event, g_model.potsWarnMode, POTS_WARN_OFF, POTS_WARN_AUTO);
-          storageDirty(EE_MODEL);
+          storageModelChanged();
         }
 
         if (attr) {
@@ -565,12 +565,12 @@ void menuModelSetup(event_t event)
                 if (g_model.potsWarnMode == POTS_WARN_MANUAL) {
                   SAVE_POT_POSITION(menuHorizontalPosition-1);
                   AUDIO_WARNING1();
-                  storageDirty(EE_MODEL);
+                  storageModelChanged();
                 }
                 break;
               case EVT_KEY_BREAK(KEY_ENTER):
                 g_model.potsWarnEnabled ^= (1 << (menuHorizontalPosition-1));
-                storageDirty(EE_MODEL);
+                storageModelChanged();
                 break;
             }
           }
@@ -625,7 +625,7 @@ void menuModelSetup(event_t event)
             if (READ_ONLY_UNLOCKED()) {
               s_editMode = 0;
               g_model.beepANACenter ^= ((BeepANACenter)1<<menuHorizontalPosition);
-              storageDirty(EE_MODEL);
+              storageModelChanged();
             }
           }
         }
@@ -1009,7 +1009,7 @@ void menuModelFailsafe(event_t event)
     event = 0;
     if (s_editMode) {
       g_model.moduleData[g_moduleIdx].failsafeChannels[menuVerticalPosition] = channelOutputs[menuVerticalPosition+channelStart];
-      storageDirty(EE_MODEL);
+      storageModelChanged();
       AUDIO_WARNING1();
       s_editMode = 0;
       SEND_FAILSAFE_NOW(g_moduleIdx);
@@ -1022,7 +1022,7 @@ void menuModelFailsafe(event_t event)
         failsafe = FAILSAFE_CHANNEL_NOPULSE;
       else
         failsafe = 0;
-      storageDirty(EE_MODEL);
+      storageModelChanged();
       AUDIO_WARNING1();
       SEND_FAILSAFE_NOW(g_moduleIdx);
     }
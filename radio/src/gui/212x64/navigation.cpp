@@ -232,6 +232,10 @@ int checkIncDec(event_t event, int val, int i_min, int i_max, unsigned int i_fla
     }
 #endif
     storageDirty(i_flags & (EE_GENERAL|EE_MODEL));
+    if (i_flags & EE_MODEL) {
+      // not now, the new value is stored by the caller
+      mainRequestFlags |= (1 << REQUEST_MODEL_CACHES_INVALIDATION);
+    }
     checkIncDec_Ret = (newval > val ? 1 : -1);
   }
   else {
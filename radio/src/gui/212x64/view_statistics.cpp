@@ -123,8 +123,11 @@ void menuStatisticsDebug(event_t event)
 #if defined(LUA)
       maxLuaInterval = 0;
       maxLuaDuration = 0;
+      maxLuaGcDuration = 0;
+      memclear(&luaGcStats, sizeof(luaGcStats));
 #endif
       maxMixerDuration  = 0;
+      mixerDeadlineMisses = 0;
       break;
 
 #if defined(DEBUG_TRACE_BUFFER)
@@ -160,11 +163,15 @@ void menuStatisticsDebug(event_t event)
   lcdDrawNumber(lcdLastPos, MENU_DEBUG_Y_LUA, 10*maxLuaDuration, LEFT);
   lcdDrawText(lcdLastPos+2, MENU_DEBUG_Y_LUA+1, "[Interval]", SMLSIZE);
   lcdDrawNumber(lcdLastPos, MENU_DEBUG_Y_LUA, 10*maxLuaInterval, LEFT);
+  lcdDrawText(lcdLastPos+2, MENU_DEBUG_Y_LUA+1, "[GC]", SMLSIZE);
+  lcdDrawNumber(lcdLastPos, MENU_DEBUG_Y_LUA, maxLuaGcDuration/100, PREC1|LEFT);
 #endif
 
   lcdDrawTextAlignedLeft(MENU_DEBUG_Y_MIXMAX, STR_TMIXMAXMS);
   lcdDrawNumber(MENU_DEBUG_COL1_OFS, MENU_DEBUG_Y_MIXMAX, DURATION_MS_PREC2(maxMixerDuration), PREC2|LEFT);
   lcdDrawText(lcdLastPos, MENU_DEBUG_Y_MIXMAX, "ms");
+  lcdDrawText(lcdLastPos+2, MENU_DEBUG_Y_MIXMAX+1, "[Misses]", SMLSIZE);
+  lcdDrawNumber(lcdLastPos, MENU_DEBUG_Y_MIXMAX, mixerDeadlineMisses, LEFT);
 
 #if !defined(SIMU) && defined(USB_SERIAL)
   lcdDrawTextAlignedLeft(MENU_DEBUG_Y_USB, "Usb");
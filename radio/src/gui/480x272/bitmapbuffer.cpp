@@ -20,6 +20,54 @@
 
 #include <math.h>
 #include "opentx.h"
+#include "blend.h"
+
+// when all the rects are used, the new one is merged with the rect which grows the least
+void BitmapBuffer::damage(coord_t x, coord_t y, coord_t w, coord_t h)
+{
+  if (!damageTracked) return;
+  if (x < 0) { w += x; x = 0; }
+  if (y < 0) { h += y; y = 0; }
+  if (x + w > width) w = width - x;
+  if (y + h > height) h = height - y;
+  if (w <= 0 || h <= 0) return;
+
+  int best = -1;
+  int bestGrowth = 0;
+  for (int i=0; i<damagedRectsCount; i++) {
+    DamagedRect & rect = damagedRects[i];
+    coord_t left = min(rect.x, x);
+    coord_t top = min(rect.y, y);
+    coord_t right = max(rect.x + rect.w, x + w);
+    coord_t bottom = max(rect.y + rect.h, y + h);
+    int growth = (right - left) * (bottom - top) - rect.w * rect.h;
+    if (right - left == rect.w && bottom - top == rect.h) {
+      // already damaged
+      return;
+    }
+    if (best < 0 || growth < bestGrowth) {
+      best = i;
+      bestGrowth = growth;
+    }
+  }
+
+  if (damagedRectsCount < MAX_DAMAGED_RECTS) {
+    DamagedRect & rect = damagedRects[damagedRectsCount++];
+    rect.x = x;
+    rect.y = y;
+    rect.w = w;
+    rect.h = h;
+  }
+  else {
+    DamagedRect & rect = damagedRects[best];
+    coord_t right = max(rect.x + rect.w, x + w);
+    coord_t bottom = max(rect.y + rect.h, y + h);
+    rect.x = min(rect.x, x);
+    rect.y = min(rect.y, y);
+    rect.w = right - rect.x;
+    rect.h = bottom - rect.y;
+  }
+}
 
 void BitmapBuffer::drawAlphaPixel(display_t * p, uint8_t opacity, uint16_t color)
 {
@@ -27,13 +75,7 @@ void BitmapBuffer::drawAlphaPixel(display_t * p, uint8_t opacity, uint16_t color
     drawPixel(p, color);
   }
   else if (opacity != 0) {
-    uint8_t bgWeight = OPACITY_MAX - opacity;
-    RGB_SPLIT(color, red, green, blue);
-    RGB_SPLIT(*p, bgRed, bgGreen, bgBlue);
-    uint16_t r = (bgRed * bgWeight + red * opacity) / OPACITY_MAX;
-    uint16_t g = (bgGreen * bgWeight + green * opacity) / OPACITY_MAX;
-    uint16_t b = (bgBlue * bgWeight + blue * opacity) / OPACITY_MAX;
-    drawPixel(p, RGB_JOIN(r, g, b));
+    drawPixel(p, blendRGB565(*p, color, opacity));
   }
 }
 
@@ -47,9 +89,20 @@ void BitmapBuffer::drawHorizontalLine(coord_t x, coord_t y, coord_t w, uint8_t p
   uint8_t opacity = 0x0F - (att >> 24);
 
   if (pat == SOLID) {
-    while (w--) {
-      drawAlphaPixel(p, opacity, color);
-      MOVE_TO_NEXT_RIGHT_PIXEL(p);
+    if (opacity == OPACITY_MAX || opacity == 0) {
+      while (w--) {
+        drawAlphaPixel(p, opacity, color);
+        MOVE_TO_NEXT_RIGHT_PIXEL(p);
+      }
+    }
+    else {
+      // the color part of the blend is the same for the whole line
+      uint32_t weightedColor = spreadRGB565(color) * opacity;
+      uint8_t weight = OPACITY_MAX - opacity;
+      while (w--) {
+        drawPixel(p, joinRGB565(weightedColor + spreadRGB565(*p) * weight));
+        MOVE_TO_NEXT_RIGHT_PIXEL(p);
+      }
     }
   }
   else {
@@ -278,16 +331,37 @@ void BitmapBuffer::drawBitmapPattern(coord_t x, coord_t y, const uint8_t * bmp,
 
   display_t color = lcdColorTable[COLOR_IDX(flags)];
 
+  if (flags & VERTICAL) {
+    for (coord_t row=0; row<height; row++) {
+      const uint8_t * q = bmp + 4 + row*w + offset;
+      for (coord_t col=0; col<width; col++) {
+        drawAlphaPixel(getPixelPtr(x+row, y-col), *q, color);
+        q++;
+      }
+    }
+    return;
+  }
+
+  // each row is drawn by runs: the transparent pixels are skipped, the opaque ones written
   for (coord_t row=0; row<height; row++) {
     const uint8_t * q = bmp + 4 + row*w + offset;
-    for (coord_t col=0; col<width; col++) {
-      display_t * p;
-      if (flags & VERTICAL)
-        p = getPixelPtr(x+row, y-col);
-      else
-        p = getPixelPtr(x+col, y+row);
-      drawAlphaPixel(p, *q, color);
-      q++;
+    const uint8_t * end = q + width;
+    display_t * p = getPixelPtr(x, y+row);
+    while (q < end) {
+      while (q < end && *q == 0) {
+        q++;
+        MOVE_TO_NEXT_RIGHT_PIXEL(p);
+      }
+      while (q < end && *q == OPACITY_MAX) {
+        drawPixel(p, color);
+        q++;
+        MOVE_TO_NEXT_RIGHT_PIXEL(p);
+      }
+      if (q < end && *q != 0 && *q != OPACITY_MAX) {
+        drawPixel(p, blendRGB565(*p, color, *q));
+        q++;
+        MOVE_TO_NEXT_RIGHT_PIXEL(p);
+      }
     }
   }
 }
@@ -318,7 +392,7 @@ void BitmapBuffer::drawSizedText(coord_t x, coord_t y, const char * s, uint8_t l
   uint32_t fontindex = FONTINDEX(flags);
   const pm_uchar * font = fontsTable[fontindex];
   const uint16_t * fontspecs = fontspecsTable[fontindex];
-  BitmapBuffer * fontcache = NULL;
+  const BitmapBuffer * fontcache = NULL;
 
   if (flags & RIGHT)
     INCREMENT_POS(-width);
@@ -334,9 +408,12 @@ void BitmapBuffer::drawSizedText(coord_t x, coord_t y, const char * s, uint8_t l
     }
     if (fontindex == STDSIZE_INDEX) {
       if (fgColor == lcdColorTable[TEXT_COLOR_INDEX]) {
+        fontcache = getFontCache(STDSIZE_INDEX, lcdColorTable[TEXT_INVERTED_COLOR_INDEX], lcdColorTable[TEXT_INVERTED_BGCOLOR_INDEX]);
+      }
+      if (fontcache) {
+        // the opaque glyph strip draws the background between the margins
         drawSolidFilledRect(x-INVERT_HORZ_MARGIN, y, INVERT_HORZ_MARGIN-1, INVERT_LINE_HEIGHT, TEXT_INVERTED_BGCOLOR);
         drawSolidFilledRect(x+width-1, y, INVERT_HORZ_MARGIN, INVERT_LINE_HEIGHT, TEXT_INVERTED_BGCOLOR);
-        fontcache = fontCache[1];
       }
       else {
         drawSolidFilledRect(x-INVERT_HORZ_MARGIN, y, width+2*INVERT_HORZ_MARGIN-1, INVERT_LINE_HEIGHT, TEXT_INVERTED_BGCOLOR);
@@ -352,18 +429,14 @@ void BitmapBuffer::drawSizedText(coord_t x, coord_t y, const char * s, uint8_t l
       drawSolidFilledRect(x-INVERT_HORZ_MARGIN, y, width+2*INVERT_HORZ_MARGIN, INVERT_LINE_HEIGHT, TEXT_INVERTED_BGCOLOR);
     }
   }
-  else if (!(flags & NO_FONTCACHE)) {
-    if (fontindex == STDSIZE_INDEX) {
-      uint16_t fgColor = lcdColorTable[COLOR_IDX(flags)];
-      uint16_t bgColor = *getPixelPtr(x, y);
-      if (fgColor == lcdColorTable[TEXT_COLOR_INDEX] && bgColor == lcdColorTable[TEXT_BGCOLOR_INDEX]) {
-        fontcache = fontCache[0];
-      }
-      else if (fgColor == lcdColorTable[TEXT_INVERTED_COLOR_INDEX] && bgColor == lcdColorTable[TEXT_INVERTED_BGCOLOR_INDEX]) {
-        fontcache = fontCache[1];
-      }
-      else {
-        // TRACE("No cache for \"%s\"", s);
+  else if (!(flags & (NO_FONTCACHE | VERTICAL)) && width > 0) {
+    // the glyph strips are opaque, they are only used when the background looks uniform
+    coord_t right = x - 1 + width - 1;
+    coord_t bottom = y + *(((uint16_t *)font)+1) - 1;
+    if (x >= 1 && y >= 0 && right < this->width && bottom < this->height) {
+      display_t bgColor = *getPixelPtr(x, y);
+      if (*getPixelPtr(x-1, y) == bgColor && *getPixelPtr(right, y) == bgColor && *getPixelPtr(x-1, bottom) == bgColor && *getPixelPtr(right, bottom) == bgColor) {
+        fontcache = getFontCache(fontindex, lcdColorTable[COLOR_IDX(flags)], bgColor);
       }
     }
   }
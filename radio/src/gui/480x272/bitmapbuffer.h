@@ -103,6 +103,13 @@ class BitmapBufferBase
 
 typedef BitmapBufferBase<const uint16_t> Bitmap;
 
+#define MAX_DAMAGED_RECTS              8
+
+struct DamagedRect
+{
+  coord_t x, y, w, h;
+};
+
 class BitmapBuffer: public BitmapBufferBase<uint16_t>
 {
   private:
@@ -110,15 +117,22 @@ class BitmapBuffer: public BitmapBufferBase<uint16_t>
 #if defined(DEBUG)
     bool leakReported;
 #endif
+    bool damageTracked;
+    bool synchronized;
+    uint8_t damagedRectsCount;
+    DamagedRect damagedRects[MAX_DAMAGED_RECTS];
 
   public:
 
     BitmapBuffer(uint8_t format, uint16_t width, uint16_t height):
       BitmapBufferBase<uint16_t>(format, width, height, NULL),
-      dataAllocated(true)
+      dataAllocated(true),
 #if defined(DEBUG)
-      , leakReported(false)
+      leakReported(false),
 #endif
+      damageTracked(false),
+      synchronized(false),
+      damagedRectsCount(0)
     {
       data = (uint16_t *)malloc(width*height*sizeof(uint16_t));
       data_end = data + (width * height);
@@ -126,10 +140,13 @@ class BitmapBuffer: public BitmapBufferBase<uint16_t>
 
     BitmapBuffer(uint8_t format, uint16_t width, uint16_t height, uint16_t * data):
       BitmapBufferBase<uint16_t>(format, width, height, data),
-      dataAllocated(false)
+      dataAllocated(false),
 #if defined(DEBUG)
-      , leakReported(false)
+      leakReported(false),
 #endif
+      damageTracked(false),
+      synchronized(false),
+      damagedRectsCount(0)
     {
     }
 
@@ -150,6 +167,55 @@ class BitmapBuffer: public BitmapBufferBase<uint16_t>
       drawSolidFilledRect(0, 0, width, height, flags);
     }
 
+    // Damage tracking: the drawing code declares the areas it changed, the LCD driver
+    // then only copies these areas to the other layer instead of redrawing everything
+    inline void startDamageTracking()
+    {
+      if (!damageTracked) {
+        damageTracked = true;
+        damagedRectsCount = 0;
+      }
+    }
+
+    inline void stopDamageTracking()
+    {
+      damageTracked = false;
+      damagedRectsCount = 0;
+    }
+
+    inline bool isDamageTracked() const
+    {
+      return damageTracked;
+    }
+
+    void damage(coord_t x, coord_t y, coord_t w, coord_t h);
+
+    inline bool isDamaged() const
+    {
+      return damagedRectsCount > 0;
+    }
+
+    inline uint8_t getDamagedRectsCount() const
+    {
+      return damagedRectsCount;
+    }
+
+    inline const DamagedRect & getDamagedRect(uint8_t index) const
+    {
+      return damagedRects[index];
+    }
+
+    // true when the buffer holds the last frame displayed, which was drawn with damage tracking
+    inline bool isSynchronized() const
+    {
+      return synchronized;
+    }
+
+    inline void setSynchronized(bool value)
+    {
+      synchronized = value;
+    }
+
     inline void drawPixel(display_t * p, display_t value)
     {
       if (data && (data <= p || p < data_end)) {
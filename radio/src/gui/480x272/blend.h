@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef _BLEND_H_
+#define _BLEND_H_
+
+#include <inttypes.h>
+#include <string.h>
+#include "colors.h"
+
+#if defined(__SSE2__)
+  // the CMSIS headers included by the simulator define __I, which the intrinsics headers use
+  #pragma push_macro("__I")
+  #undef __I
+  #include <emmintrin.h>
+  #pragma pop_macro("__I")
+#endif
+
+// Pixel kernels: opacities go from 0 to OPACITY_MAX (15), the results are the same as the
+// (fg * opacity + bg * (15 - opacity)) / 15 computed for each channel, without the divides
+
+// exact x / 15 for x < 65536
+inline uint32_t divOpacity(uint32_t x)
+{
+  return (x * 0x8889) >> 19;
+}
+
+// RGB565 with the green moved to the upper half-word, each channel then has room for
+// a product by an opacity, and the 3 channels are multiplied at once
+inline uint32_t spreadRGB565(uint16_t color)
+{
+  return (color & 0xF81F) | ((uint32_t)(color & 0x07E0) << 16);
+}
+
+// ARGB4444 spread the same way, with the channels scaled to RGB565
+inline uint32_t spreadARGB4444(uint16_t color)
+{
+  return ((uint32_t)(color & 0x0F00) << 4) | ((uint32_t)(color & 0x00F0) << 19) | ((uint32_t)(color & 0x000F) << 1);
+}
+
+// the sum of spread colors weighted by opacities adding up to OPACITY_MAX, back to RGB565
+inline uint16_t joinRGB565(uint32_t weighted)
+{
+  return (divOpacity((weighted >> 11) & 0x1FF) << 11) + (divOpacity(weighted >> 21) << 5) + divOpacity(weighted & 0x1FF);
+}
+
+inline uint16_t blendRGB565(uint16_t background, uint16_t color, uint8_t opacity)
+{
+  return joinRGB565(spreadRGB565(color) * opacity + spreadRGB565(background) * (OPACITY_MAX - opacity));
+}
+
+inline uint16_t blendARGB4444(uint16_t background, uint16_t color)
+{
+  uint8_t alpha = color >> 12;
+  if (alpha == OPACITY_MAX)
+    return joinRGB565(spreadARGB4444(color) * OPACITY_MAX);
+  else if (alpha == 0)
+    return background;
+  else
+    return joinRGB565(spreadARGB4444(color) * alpha + spreadRGB565(background) * (OPACITY_MAX - alpha));
+}
+
+// 2 pixels per word, the buffers are only aligned on pixels
+inline void fillRGB565(uint16_t * dest, uint16_t color, int count)
+{
+  if (count > 0 && ((uintptr_t)dest & 2)) {
+    *dest++ = color;
+    count--;
+  }
+  uint32_t pair = color | ((uint32_t)color << 16);
+  for (; count >= 2; count -= 2, dest += 2) {
+    memcpy(dest, &pair, sizeof(pair));
+  }
+  if (count > 0) {
+    *dest = color;
+  }
+}
+
+inline void blendARGB4444(uint16_t * dest, const uint16_t * src, int count)
+{
+#if defined(__SSE2__)
+  const __m128i mask4 = _mm_set1_epi16(0x0F);
+  const __m128i mask5 = _mm_set1_epi16(0x1F);
+  const __m128i mask6 = _mm_set1_epi16(0x3F);
+  const __m128i opacityMax = _mm_set1_epi16(OPACITY_MAX);
+  const __m128i inverse15 = _mm_set1_epi16((short)0x8889);
+
+  for (; count >= 8; count -= 8, dest += 8, src += 8) {
+    __m128i q = _mm_loadu_si128((const __m128i *)src);
+    __m128i p = _mm_loadu_si128((const __m128i *)dest);
+    __m128i alpha = _mm_srli_epi16(q, 12);
+    __m128i weight = _mm_sub_epi16(opacityMax, alpha);
+
+    __m128i red = _mm_add_epi16(_mm_mullo_epi16(_mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(q, 8), mask4), 1), alpha),
+                                _mm_mullo_epi16(_mm_srli_epi16(p, 11), weight));
+    __m128i green = _mm_add_epi16(_mm_mullo_epi16(_mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(q, 4), mask4), 2), alpha),
+                                  _mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(p, 5), mask6), weight));
+    __m128i blue = _mm_add_epi16(_mm_mullo_epi16(_mm_slli_epi16(_mm_and_si128(q, mask4), 1), alpha),
+                                 _mm_mullo_epi16(_mm_and_si128(p, mask5), weight));
+
+    // x / 15 = (x * 0x8889) >> 19
+    red = _mm_srli_epi16(_mm_mulhi_epu16(red, inverse15), 3);
+    green = _mm_srli_epi16(_mm_mulhi_epu16(green, inverse15), 3);
+    blue = _mm_srli_epi16(_mm_mulhi_epu16(blue, inverse15), 3);
+
+    __m128i result = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(red, 11), _mm_slli_epi16(green, 5)), blue);
+    _mm_storeu_si128((__m128i *)dest, result);
+  }
+#endif
+
+  for (; count > 0; count--, dest++, src++) {
+    *dest = blendARGB4444(*dest, *src);
+  }
+}
+
+// the ARGB8888 bytes (a, r, g, b) of the decoded images, 2 pixels per word
+inline void convertARGB8888(uint16_t * dest, const uint8_t * src, int count, bool alpha)
+{
+  #define CONVERT_PIXEL(src) (alpha ? ARGB((src)[0], (src)[1], (src)[2], (src)[3]) : RGB((src)[1], (src)[2], (src)[3]))
+
+  if (count > 0 && ((uintptr_t)dest & 2)) {
+    *dest++ = CONVERT_PIXEL(src);
+    src += 4;
+    count--;
+  }
+  for (; count >= 2; count -= 2, dest += 2, src += 8) {
+    uint32_t pair = CONVERT_PIXEL(src) | ((uint32_t)CONVERT_PIXEL(src + 4) << 16);
+    memcpy(dest, &pair, sizeof(pair));
+  }
+  if (count > 0) {
+    *dest = CONVERT_PIXEL(src);
+  }
+
+  #undef CONVERT_PIXEL
+}
+
+#endif // _BLEND_H_
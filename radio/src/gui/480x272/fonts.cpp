@@ -19,6 +19,7 @@
  */
 
 #include "opentx.h"
+#include "blend.h"
 
 const uint16_t font_tinsize_specs[] = {
 #include "font_tinsize.specs"
@@ -86,25 +87,157 @@ const uint8_t * const fontsTable[16] = {
   font_stdsizebold, font_tinsize, font_smlsize, font_midsize, font_dblsize, font_xxlsize, font_stdsize, font_stdsize
 };
 
-BitmapBuffer * fontCache[2] = { NULL, NULL };
+// The glyphs of a font pre-rendered in one color on one background, drawn with a DMA copy
+// instead of blending each pixel. The least recently used strips are freed.
+struct FontCacheEntry {
+  BitmapBuffer * buffer;
+  uint8_t fontindex;
+  display_t fgColor;
+  display_t bgColor;
+  uint32_t lastUse;
+};
+
+FontCacheEntry fontCacheEntries[FONT_CACHE_ENTRIES];
+uint32_t fontCacheUses = 0;
+uint32_t fontCacheSize = 0;
+
+// The fonts and colors which recently missed the cache. Building a strip blends the whole
+// font, it is only done for the texts drawn again and again, the others are blended glyph
+// by glyph, so that a few one-off colors don't evict the strips in use.
+struct FontCacheCandidate {
+  uint8_t fontindex;
+  display_t fgColor;
+  display_t bgColor;
+  uint8_t misses;
+  uint32_t lastMiss;
+};
+
+FontCacheCandidate fontCacheCandidates[FONT_CACHE_CANDIDATES];
 
-BitmapBuffer * createFontCache(const uint8_t * font, LcdFlags fg, LcdFlags bg)
+BitmapBuffer * createFontCache(const uint8_t * font, display_t fgColor, display_t bgColor)
 {
   coord_t width = *((uint16_t *)font);
   coord_t height = *(((uint16_t *)font)+1);
 
   BitmapBuffer * buffer = new BitmapBuffer(BMP_RGB565, width, height);
-  if (buffer) {
-    buffer->clear(bg);
-    buffer->drawBitmapPattern(0, 0, font, fg);
+  if (buffer && buffer->getData()) {
+    const uint8_t * q = font + 4;
+    for (coord_t y=0; y<height; y++) {
+      for (coord_t x=0; x<width; x++) {
+        buffer->drawPixel(x, y, blendRGB565(bgColor, fgColor, *q++));
+      }
+    }
+  }
+  else {
+    delete buffer;
+    buffer = NULL;
   }
   return buffer;
 }
 
+void freeFontCache(FontCacheEntry & entry)
+{
+  if (entry.buffer) {
+    fontCacheSize -= entry.buffer->getDataSize();
+    delete entry.buffer;
+    entry.buffer = NULL;
+  }
+}
+
+// counts a miss, returns true when the strip should be built
+bool admitFontCache(uint8_t fontindex, display_t fgColor, display_t bgColor)
+{
+  FontCacheCandidate * candidate = NULL;
+  for (int i=0; i<FONT_CACHE_CANDIDATES; i++) {
+    FontCacheCandidate & entry = fontCacheCandidates[i];
+    if (entry.misses && entry.fontindex == fontindex && entry.fgColor == fgColor && entry.bgColor == bgColor) {
+      candidate = &entry;
+      break;
+    }
+  }
+
+  if (!candidate) {
+    // replace the candidate which missed the least recently
+    candidate = &fontCacheCandidates[0];
+    for (int i=1; i<FONT_CACHE_CANDIDATES; i++) {
+      if (fontCacheCandidates[i].lastMiss < candidate->lastMiss)
+        candidate = &fontCacheCandidates[i];
+    }
+    candidate->fontindex = fontindex;
+    candidate->fgColor = fgColor;
+    candidate->bgColor = bgColor;
+    candidate->misses = 0;
+  }
+
+  candidate->lastMiss = ++fontCacheUses;
+  if (++candidate->misses < FONT_CACHE_ADMISSION_MISSES) {
+    return false;
+  }
+  candidate->misses = 0;
+  return true;
+}
+
+const BitmapBuffer * buildFontCache(uint8_t fontindex, display_t fgColor, display_t bgColor)
+{
+  FontCacheEntry * result = NULL;
+  const uint8_t * font = fontsTable[fontindex];
+  uint32_t size = *((uint16_t *)font) * *(((uint16_t *)font)+1) * sizeof(display_t);
+  if (size > FONT_CACHE_MAX_SIZE / 2) {
+    return NULL;
+  }
+
+  // free the least recently used strips until there is room for this one
+  while (true) {
+    FontCacheEntry * oldest = NULL;
+    result = NULL;
+    for (int i=0; i<FONT_CACHE_ENTRIES; i++) {
+      FontCacheEntry & entry = fontCacheEntries[i];
+      if (!entry.buffer)
+        result = &entry;
+      else if (!oldest || entry.lastUse < oldest->lastUse)
+        oldest = &entry;
+    }
+    if (result && fontCacheSize + size <= FONT_CACHE_MAX_SIZE)
+      break;
+    freeFontCache(*oldest);
+  }
+
+  result->buffer = createFontCache(font, fgColor, bgColor);
+  if (result->buffer) {
+    result->fontindex = fontindex;
+    result->fgColor = fgColor;
+    result->bgColor = bgColor;
+    result->lastUse = ++fontCacheUses;
+    fontCacheSize += size;
+  }
+  return result->buffer;
+}
+
+// NULL when the text has to be blended glyph by glyph
+const BitmapBuffer * getFontCache(uint8_t fontindex, display_t fgColor, display_t bgColor)
+{
+  for (int i=0; i<FONT_CACHE_ENTRIES; i++) {
+    FontCacheEntry & entry = fontCacheEntries[i];
+    if (entry.buffer && entry.fontindex == fontindex && entry.fgColor == fgColor && entry.bgColor == bgColor) {
+      entry.lastUse = ++fontCacheUses;
+      return entry.buffer;
+    }
+  }
+
+  if (!admitFontCache(fontindex, fgColor, bgColor)) {
+    return NULL;
+  }
+  return buildFontCache(fontindex, fgColor, bgColor);
+}
+
+// the theme colors changed
 void loadFontCache()
 {
-  delete fontCache[0];
-  delete fontCache[1];
-  fontCache[0] = createFontCache(fontsTable[0], TEXT_COLOR, TEXT_BGCOLOR);
-  fontCache[1] = createFontCache(fontsTable[0], TEXT_INVERTED_COLOR, TEXT_INVERTED_BGCOLOR);
+  for (int i=0; i<FONT_CACHE_ENTRIES; i++) {
+    freeFontCache(fontCacheEntries[i]);
+  }
+  memclear(fontCacheCandidates, sizeof(fontCacheCandidates));
+  // the standard font in the text colors is always used
+  buildFontCache(STDSIZE_INDEX, lcdColorTable[TEXT_COLOR_INDEX], lcdColorTable[TEXT_BGCOLOR_INDEX]);
+  buildFontCache(STDSIZE_INDEX, lcdColorTable[TEXT_INVERTED_COLOR_INDEX], lcdColorTable[TEXT_INVERTED_BGCOLOR_INDEX]);
 }
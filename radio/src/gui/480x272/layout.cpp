@@ -68,3 +68,45 @@ void loadCustomScreens()
 
   topbar->load();
 }
+
+void Layout::drawBackground(coord_t x, coord_t y, coord_t w, coord_t h) const
+{
+  theme->drawBackground(x, y, w, h);
+}
+
+// The main view only redraws the zones which changed since its previous frame, and declares them
+// to the LCD driver. Everything is redrawn when asked or when the layout decorations changed.
+void Layout::refreshChanged(bool full)
+{
+  lcd->startDamageTracking();
+
+  // each of them remembers what it will draw now
+  bool topbarChanged = hasTopBar() && isTopBarChanged();
+  bool decorationChanged = isDecorationChanged();
+  unsigned int count = getZonesCount();
+  bool zoneChanged[MAX_LAYOUT_ZONES];
+  for (unsigned int i=0; i<count; i++) {
+    zoneChanged[i] = (widgets && widgets[i] && widgets[i]->isChanged());
+  }
+
+  if (full || decorationChanged) {
+    refresh();
+    lcd->damage(0, 0, LCD_W, LCD_H);
+    return;
+  }
+
+  if (topbarChanged) {
+    drawBackground(0, 0, LCD_W, MENU_HEADER_HEIGHT);
+    drawTopBar();
+    lcd->damage(0, 0, LCD_W, MENU_HEADER_HEIGHT);
+  }
+
+  for (unsigned int i=0; i<count; i++) {
+    if (zoneChanged[i]) {
+      Zone zone = getZone(i);
+      drawBackground(zone.x, zone.y, zone.w, zone.h);
+      widgets[i]->refresh();
+      lcd->damage(zone.x, zone.y, zone.w, zone.h);
+    }
+  }
+}
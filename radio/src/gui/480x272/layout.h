@@ -50,6 +50,22 @@ class Layout: public WidgetsContainer<MAX_LAYOUT_ZONES, MAX_LAYOUT_OPTIONS>
     {
     }
 
+    // all the layouts have the top bar as first option
+    bool hasTopBar() const
+    {
+      return persistentData->options[0].boolValue;
+    }
+
+    // the layout decorations outside of the zones (trims, sliders, flight mode, ...)
+    virtual bool isDecorationChanged()
+    {
+      return false;
+    }
+
+    virtual void drawBackground(coord_t x, coord_t y, coord_t w, coord_t h) const;
+
+    void refreshChanged(bool full);
+
   protected:
     const LayoutFactory * factory;
 };
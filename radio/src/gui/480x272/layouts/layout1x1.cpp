@@ -65,6 +65,11 @@ class Layout1x1: public Layout
       return zone;
     }
 
+    virtual bool isDecorationChanged()
+    {
+      return persistentData->options[1].boolValue && isMainDecorationChanged();
+    }
+
     virtual void refresh();
 };
 
@@ -65,6 +65,11 @@ class Layout2P1: public Layout
       return ZONES_LAYOUT_2P1[index];
     }
 
+    virtual bool isDecorationChanged()
+    {
+      return (persistentData->options[1].boolValue || persistentData->options[2].boolValue || persistentData->options[3].boolValue) && isMainDecorationChanged();
+    }
+
     virtual void refresh();
 };
 
@@ -72,6 +72,35 @@ class Layout2x4: public Layout
       return zone;
     }
 
+    virtual bool isDecorationChanged()
+    {
+      return (persistentData->options[1].boolValue || persistentData->options[2].boolValue || persistentData->options[3].boolValue) && isMainDecorationChanged();
+    }
+
+    virtual void drawBackground(coord_t x, coord_t y, coord_t w, coord_t h) const
+    {
+      Layout::drawBackground(x, y, w, h);
+      if (persistentData->options[4].boolValue) {
+        drawPanel(50, persistentData->options[5].unsignedValue, x, y, w, h);
+      }
+      if (persistentData->options[6].boolValue) {
+        drawPanel(250, persistentData->options[7].unsignedValue, x, y, w, h);
+      }
+    }
+
+    // the part of a panel inside the (x, y, w, h) area
+    void drawPanel(coord_t panelX, uint32_t color, coord_t x, coord_t y, coord_t w, coord_t h) const
+    {
+      coord_t left = max<coord_t>(x, panelX);
+      coord_t top = max<coord_t>(y, 50);
+      coord_t right = min<coord_t>(x + w, panelX + 180);
+      coord_t bottom = min<coord_t>(y + h, 50 + 170);
+      if (right > left && bottom > top) {
+        lcdSetColor(color);
+        lcdDrawSolidFilledRect(left, top, right - left, bottom - top, CUSTOM_COLOR);
+      }
+    }
+
     virtual void refresh();
 };
 
@@ -104,13 +133,11 @@ void Layout2x4::refresh()
   }
 
   if (persistentData->options[4].boolValue) {
-    lcdSetColor(persistentData->options[5].unsignedValue);
-    lcdDrawSolidFilledRect(50, 50, 180, 170, CUSTOM_COLOR);
+    drawPanel(50, persistentData->options[5].unsignedValue, 0, 0, LCD_W, LCD_H);
   }
 
   if (persistentData->options[6].boolValue) {
-    lcdSetColor(persistentData->options[7].unsignedValue);
-    lcdDrawSolidFilledRect(250, 50, 180, 170, CUSTOM_COLOR);
+    drawPanel(250, persistentData->options[7].unsignedValue, 0, 0, LCD_W, LCD_H);
   }
 
   Layout::refresh();
@@ -21,6 +21,7 @@
 #include <math.h>
 #include <stdio.h>
 #include "opentx.h"
+#include "blend.h"
 
 #if defined(SIMU)
 display_t displayBuf[DISPLAY_BUFFER_SIZE];
@@ -419,9 +420,7 @@ void DMAFillRect(uint16_t * dest, uint16_t destw, uint16_t desth, uint16_t x, ui
 #endif
 
   for (int i=0; i<h; i++) {
-    for (int j=0; j<w; j++) {
-      dest[(y+i)*destw+x+j] = color;
-    }
+    fillRGB565(dest+(y+i)*destw+x, color, w);
   }
 }
 
@@ -449,38 +448,12 @@ void DMACopyAlphaBitmap(uint16_t * dest, uint16_t destw, uint16_t desth, uint16_
 #endif
 
   for (coord_t line=0; line<h; line++) {
-    uint16_t * p = dest + (y+line)*destw + x;
-    const uint16_t * q = src + (srcy+line)*srcw + srcx;
-    for (coord_t col=0; col<w; col++) {
-      uint8_t alpha = *q >> 12;
-      uint8_t red = ((((*q >> 8) & 0x0f) << 1) * alpha + (*p >> 11) * (0x0f-alpha)) / 0x0f;
-      uint8_t green = ((((*q >> 4) & 0x0f) << 2) * alpha + ((*p >> 5) & 0x3f) * (0x0f-alpha)) / 0x0f;
-      uint8_t blue = ((((*q >> 0) & 0x0f) << 1) * alpha + ((*p >> 0) & 0x1f) * (0x0f-alpha)) / 0x0f;
-      *p = (red << 11) + (green << 5) + (blue << 0);
-      p++; q++;
-    }
+    blendARGB4444(dest + (y+line)*destw + x, src + (srcy+line)*srcw + srcx, w);
   }
 }
 
 void DMABitmapConvert(uint16_t * dest, const uint8_t * src, uint16_t w, uint16_t h, uint32_t format)
 {
-  if (format == DMA2D_ARGB4444) {
-    for (int row = 0; row < h; ++row) {
-      for (int col = 0; col < w; ++col) {
-        *dest = ARGB(src[0], src[1], src[2], src[3]);
-        ++dest;
-        src += 4;
-      }
-    }
-  }
-  else {
-    for (int row = 0; row < h; ++row) {
-      for(int col = 0; col < w; ++col) {
-        *dest = RGB(src[1], src[2], src[3]);
-        ++dest;
-        src += 4;
-      }
-    }
-  }
+  convertARGB8888(dest, src, w * h, format == DMA2D_ARGB4444);
 }
 #endif
@@ -33,7 +33,7 @@ void onModelCustomScriptMenu(const char *result)
     // The user choosed a lua file in the list
     copySelection(sd.file, result, sizeof(sd.file));
     memset(sd.inputs, 0, sizeof(sd.inputs));
-    storageDirty(EE_MODEL);
+    storageModelChanged();
     LUA_LOAD_MODEL_SCRIPT(s_currIdx);
   }
 }
@@ -26,17 +26,17 @@ void onGVARSMenu(const char * result)
 
   if (result == STR_ENABLE_POPUP) {
     g_model.gvars[sub].popup = true;
-    storageDirty(EE_MODEL);
+    storageModelChanged();
   }
   else if (result == STR_DISABLE_POPUP) {
     g_model.gvars[sub].popup = false;
-    storageDirty(EE_MODEL);
+    storageModelChanged();
   }
   else if (result == STR_CLEAR) {
     for (int i=0; i<MAX_FLIGHT_MODES; i++) {
       g_model.flightModeData[i].gvars[sub] = 0;
     }
-    storageDirty(EE_MODEL);
+    storageModelChanged();
   }
 }
 
@@ -92,7 +92,7 @@ bool menuModelGVars(event_t event)
           if (attr) {
             if (event == EVT_KEY_LONG(KEY_ENTER)) {
               v = (v > GVAR_MAX ? 0 : GVAR_MAX+1);
-              storageDirty(EE_MODEL);
+              storageModelChanged();
             }
             else if (s_editMode>0) {
               v = checkIncDec(event, v, vmin, vmax, EE_MODEL);
@@ -84,7 +84,7 @@ void deleteExpo(uint8_t idx)
     memclear(&g_model.inputNames[input], LEN_INPUT_NAME);
   }
   resumeMixerCalculations();
-  storageDirty(EE_MODEL);
+  storageModelChanged();
 }
 
 // TODO avoid this global s_currCh on ARM boards ...
@@ -101,7 +101,7 @@ void insertExpo(uint8_t idx)
   expo->chn = s_currCh - 1;
   expo->weight = 100;
   resumeMixerCalculations();
-  storageDirty(EE_MODEL);
+  storageModelChanged();
 }
 
 void copyExpo(uint8_t idx)
@@ -110,7 +110,7 @@ void copyExpo(uint8_t idx)
   ExpoData * expo = expoAddress(idx);
   memmove(expo+1, expo, (MAX_EXPOS-(idx+1))*sizeof(ExpoData));
   resumeMixerCalculations();
-  storageDirty(EE_MODEL);
+  storageModelChanged();
 }
 
 bool swapExpos(uint8_t & idx, uint8_t up)
@@ -410,7 +410,7 @@ bool menuModelExposAll(event_t event)
               swapExpos(s_currIdx, s_copyTgtOfs > 0);
               s_copyTgtOfs += (s_copyTgtOfs < 0 ? +1 : -1);
             } while (s_copyTgtOfs != 0);
-            storageDirty(EE_MODEL);
+            storageModelChanged();
           }
           menuVerticalPosition = s_copySrcRow;
           s_copyTgtOfs = 0;
@@ -484,7 +484,7 @@ bool menuModelExposAll(event_t event)
         else {
           // only swap the mix with its neighbor
           if (!swapExpos(s_currIdx, event==EVT_ROTARY_LEFT)) break;
-          storageDirty(EE_MODEL);
+          storageModelChanged();
         }
 
         s_copyTgtOfs = next_ofs;
@@ -64,11 +64,11 @@ void onLogicalSwitchesMenu(const char * result)
   }
   else if (result == STR_PASTE) {
     *cs = clipboard.data.csw;
-    storageDirty(EE_MODEL);
+    storageModelChanged();
   }
   else if (result == STR_CLEAR) {
     memset(cs, 0, sizeof(LogicalSwitchData));
-    storageDirty(EE_MODEL);
+    storageModelChanged();
   }
 }
 
@@ -226,7 +226,7 @@ bool menuModelLogicalSwitches(event_t event)
             getvalue_t x = getValue(v1_val);
             if (v1_val <= MIXSRC_LAST_CH)
               cs->v2 = calcRESXto100(x);
-            storageDirty(EE_MODEL);
+            storageModelChanged();
           }
           break;
         case LS_FIELD_V3:
@@ -72,7 +72,7 @@ void deleteMix(uint8_t idx)
   memmove(mix, mix+1, (MAX_MIXERS-(idx+1))*sizeof(MixData));
   memclear(&g_model.mixData[MAX_MIXERS-1], sizeof(MixData));
   resumeMixerCalculations();
-  storageDirty(EE_MODEL);
+  storageModelChanged();
 }
 
 void insertMix(uint8_t idx)
@@ -91,7 +91,7 @@ void insertMix(uint8_t idx)
   }
   mix->weight = 100;
   resumeMixerCalculations();
-  storageDirty(EE_MODEL);
+  storageModelChanged();
 }
 
 void copyMix(uint8_t idx)
@@ -100,7 +100,7 @@ void copyMix(uint8_t idx)
   MixData * mix = mixAddress(idx);
   memmove(mix+1, mix, (MAX_MIXERS-(idx+1))*sizeof(MixData));
   resumeMixerCalculations();
-  storageDirty(EE_MODEL);
+  storageModelChanged();
 }
 
 bool swapMixes(uint8_t & idx, uint8_t up)
@@ -430,7 +430,7 @@ bool menuModelMixAll(event_t event)
               swapMixes(s_currIdx, s_copyTgtOfs > 0);
               s_copyTgtOfs += (s_copyTgtOfs < 0 ? +1 : -1);
             } while (s_copyTgtOfs != 0);
-            storageDirty(EE_MODEL);
+            storageModelChanged();
           }
           menuVerticalPosition = s_copySrcRow;
           s_copyTgtOfs = 0;
@@ -506,7 +506,7 @@ bool menuModelMixAll(event_t event)
         else {
           // only swap the mix with its neighbor
           if (!swapMixes(s_currIdx, event==EVT_ROTARY_LEFT)) break;
-          storageDirty(EE_MODEL);
+          storageModelChanged();
         }
 
         s_copyTgtOfs = next_ofs;
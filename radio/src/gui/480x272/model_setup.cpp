@@ -104,7 +104,7 @@ void onModelSetupBitmapMenu(const char * result)
   else {
     // The user choosed a bmp file in the list
     copySelection(g_model.header.bitmap, result, sizeof(g_model.header.bitmap));
-    storageDirty(EE_MODEL);
+    storageModelChanged();
   }
 }
 
@@ -132,7 +132,7 @@ void editTimerMode(int timerIdx, coord_t y, LcdFlags attr, event_t event)
           int8_t switchVal = checkIncDecMovedSwitch(val);
           if (val != switchVal) {
             timer.mode = switchVal + (TMRMODE_COUNT-1);
-            storageDirty(EE_MODEL);
+            storageModelChanged();
           }
         }
 #endif
@@ -367,7 +367,7 @@ bool menuModelSetup(event_t event)
             for (uint8_t i=0; i<MAX_FLIGHT_MODES; i++) {
               memclear(&g_model.flightModeData[i], TRIMS_ARRAY_SIZE);
             }
-            storageDirty(EE_MODEL);
+            storageModelChanged();
             AUDIO_WARNING1();
           }
         }
@@ -440,7 +440,7 @@ bool menuModelSetup(event_t event)
             }
           }
           AUDIO_WARNING1();
-          storageDirty(EE_MODEL);
+          storageModelChanged();
         }
 
         if (attr && menuHorizontalPosition < 0) {
@@ -476,7 +476,7 @@ bool menuModelSetup(event_t event)
         lcdDrawTextAtIndex(MODEL_SETUP_2ND_COLUMN, y, PSTR("\004""OFF\0""Man\0""Auto"), g_model.potsWarnMode, attr);
         if (attr) {
           CHECK_INCDEC_MODELVAR(event, g_model.potsWarnMode, POTS_WARN_OFF, POTS_WARN_AUTO);
-          storageDirty(EE_MODEL);
+          storageModelChanged();
         }
         break;
 
@@ -489,14 +489,14 @@ bool menuModelSetup(event_t event)
             if (g_model.potsWarnMode == POTS_WARN_MANUAL) {
               SAVE_POT_POSITION(menuHorizontalPosition);
               AUDIO_WARNING1();
-              storageDirty(EE_MODEL);
+              storageModelChanged();
             }
           }
 
           if (!READ_ONLY() &&  menuHorizontalPosition >= 0 && s_editMode && event==EVT_KEY_BREAK(KEY_ENTER)) {
             s_editMode = 0;
             g_model.potsWarnEnabled ^= (1 << (menuHorizontalPosition));
-            storageDirty(EE_MODEL);
+            storageModelChanged();
           }
         }
 
@@ -527,14 +527,14 @@ bool menuModelSetup(event_t event)
             if (g_model.potsWarnMode == POTS_WARN_MANUAL) {
               SAVE_POT_POSITION(menuHorizontalPosition+NUM_POTS);
               AUDIO_WARNING1();
-              storageDirty(EE_MODEL);
+              storageModelChanged();
             }
           }
 
           if (!READ_ONLY() && menuHorizontalPosition+1 && s_editMode && event==EVT_KEY_BREAK(KEY_ENTER)) {
             s_editMode = 0;
             g_model.potsWarnEnabled ^= (1 << (menuHorizontalPosition+NUM_POTS));
-            storageDirty(EE_MODEL);
+            storageModelChanged();
           }
         }
 
@@ -570,7 +570,7 @@ bool menuModelSetup(event_t event)
             if (READ_ONLY_UNLOCKED()) {
               s_editMode = 0;
               g_model.beepANACenter ^= ((BeepANACenter)1<<menuHorizontalPosition);
-              storageDirty(EE_MODEL);
+              storageModelChanged();
             }
           }
         }
@@ -914,7 +914,7 @@ bool menuModelFailsafe(event_t event)
     event = 0;
     if (s_editMode) {
       g_model.moduleData[g_moduleIdx].failsafeChannels[menuVerticalPosition] = channelOutputs[menuVerticalPosition+channelStart];
-      storageDirty(EE_MODEL);
+      storageModelChanged();
       AUDIO_WARNING1();
       s_editMode = 0;
       SEND_FAILSAFE_NOW(g_moduleIdx);
@@ -927,7 +927,7 @@ bool menuModelFailsafe(event_t event)
         failsafe = FAILSAFE_CHANNEL_NOPULSE;
       else
         failsafe = 0;
-      storageDirty(EE_MODEL);
+      storageModelChanged();
       AUDIO_WARNING1();
       SEND_FAILSAFE_NOW(g_moduleIdx);
     }
@@ -111,22 +111,22 @@ void onAdjustGvarSourceLongEnterPress(const char * result)
   if (result == STR_CONSTANT) {
     CFN_GVAR_MODE(cfn) = FUNC_ADJUST_GVAR_CONSTANT;
     CFN_PARAM(cfn) = 0;
-    storageDirty(EE_MODEL);
+    storageModelChanged();
   }
   else if (result == STR_MIXSOURCE) {
     CFN_GVAR_MODE(cfn) = FUNC_ADJUST_GVAR_SOURCE;
     CFN_PARAM(cfn) = 0;
-    storageDirty(EE_MODEL);
+    storageModelChanged();
   }
   else if (result == STR_GLOBALVAR) {
     CFN_GVAR_MODE(cfn) = FUNC_ADJUST_GVAR_GVAR;
     CFN_PARAM(cfn) = 0;
-    storageDirty(EE_MODEL);
+    storageModelChanged();
   }
   else if (result == STR_INCDEC) {
     CFN_GVAR_MODE(cfn) = FUNC_ADJUST_GVAR_INCDEC;
     CFN_PARAM(cfn) = 0;
-    storageDirty(EE_MODEL);
+    storageModelChanged();
   }
   else {
     onSourceLongEnterPress(result);
@@ -392,7 +392,7 @@ void onSensorMenu(const char * result)
         TelemetryItem & sourceItem = telemetryItems[index];
         TelemetryItem & newItem = telemetryItems[newIndex];
         newItem = sourceItem;
-        storageDirty(EE_MODEL);
+        storageModelChanged();
       }
       else {
         POPUP_WARNING(STR_TELEMETRYFULL);
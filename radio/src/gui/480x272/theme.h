@@ -71,6 +71,9 @@ class Theme
 
     virtual void drawBackground() const;
 
+    // redraws only a part of the background, under a widget which changed
+    virtual void drawBackground(coord_t x, coord_t y, coord_t w, coord_t h) const;
+
     virtual void drawTopbarBackground(uint8_t icon) const = 0;
 
     virtual void drawMenuIcon(uint8_t index, uint8_t position, bool selected) const { }
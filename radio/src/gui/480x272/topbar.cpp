@@ -51,6 +51,57 @@ void drawTopbarDatetime()
   lcdDrawText(DATETIME_MIDDLE, DATETIME_LINE2, str, SMLSIZE|TEXT_INVERTED_COLOR|CENTERED);
 }
 
+const uint8_t rssiBarsValue[] = {30, 40, 50, 60, 80};
+const uint8_t rssiBarsHeight[] = {5, 10, 15, 21, 31};
+
+uint8_t getRssiBars()
+{
+  uint8_t bars = 0;
+  while (bars < DIM(rssiBarsValue) && TELEMETRY_RSSI() >= rssiBarsValue[bars]) {
+    bars++;
+  }
+  return bars;
+}
+
+uint8_t getVolumeLevel()
+{
+  if (requiredSpeakerVolume == 0 || g_eeGeneral.beepMode == e_mode_quiet)
+    return 0;
+  else if (requiredSpeakerVolume < 7)
+    return 1;
+  else if (requiredSpeakerVolume < 13)
+    return 2;
+  else if (requiredSpeakerVolume < 19)
+    return 3;
+  else
+    return 4;
+}
+
+uint8_t getTxBatteryBars()
+{
+  return limit<int8_t>(0, 6 * (g_vbat100mV - g_eeGeneral.vBatMin - 90) / (30 + g_eeGeneral.vBatMax - g_eeGeneral.vBatMin), 5);
+}
+
+// what drawTopBar() depends on, the main view only redraws the top bar when it changed
+bool isTopBarChanged()
+{
+  int32_t state[] = {
+    usbPlugged(),
+    getRssiBars(),
+    getVolumeLevel(),
+    getTxBatteryBars(),
+    getValue(MIXSRC_TX_TIME)
+  };
+  static int32_t lastState[DIM(state)];
+
+  bool result = topbar->isChanged();
+  if (memcmp(state, lastState, sizeof(state)) != 0) {
+    memcpy(lastState, state, sizeof(state));
+    result = true;
+  }
+  return result;
+}
+
 void drawTopBar()
 {
   theme->drawTopbarBackground(0);
@@ -61,28 +112,19 @@ void drawTopBar()
   }
 
   // RSSI
-  const uint8_t rssiBarsValue[] = {30, 40, 50, 60, 80};
-  const uint8_t rssiBarsHeight[] = {5, 10, 15, 21, 31};
+  uint8_t rssiBars = getRssiBars();
   for (unsigned int i = 0; i < DIM(rssiBarsHeight); i++) {
     uint8_t height = rssiBarsHeight[i];
-    lcdDrawSolidFilledRect(LCD_W-90 + i * 6, 38 - height, 4, height, TELEMETRY_RSSI() >= rssiBarsValue[i] ? MENU_TITLE_COLOR : MENU_TITLE_DISABLE_COLOR);
+    lcdDrawSolidFilledRect(LCD_W-90 + i * 6, 38 - height, 4, height, i < rssiBars ? MENU_TITLE_COLOR : MENU_TITLE_DISABLE_COLOR);
   }
 
   /* Audio volume */
+  static const uint8_t * const volumeBitmaps[] = { LBM_TOPMENU_VOLUME_0, LBM_TOPMENU_VOLUME_1, LBM_TOPMENU_VOLUME_2, LBM_TOPMENU_VOLUME_3, LBM_TOPMENU_VOLUME_4 };
   lcdDrawBitmapPattern(LCD_W-130, 4, LBM_TOPMENU_VOLUME_SCALE, MENU_TITLE_DISABLE_COLOR);
-  if (requiredSpeakerVolume == 0 || g_eeGeneral.beepMode == e_mode_quiet)
-    lcdDrawBitmapPattern(LCD_W-130, 4, LBM_TOPMENU_VOLUME_0, MENU_TITLE_COLOR);
-  else if (requiredSpeakerVolume < 7)
-    lcdDrawBitmapPattern(LCD_W-130, 4, LBM_TOPMENU_VOLUME_1, MENU_TITLE_COLOR);
-  else if (requiredSpeakerVolume < 13)
-    lcdDrawBitmapPattern(LCD_W-130, 4, LBM_TOPMENU_VOLUME_2, MENU_TITLE_COLOR);
-  else if (requiredSpeakerVolume < 19)
-    lcdDrawBitmapPattern(LCD_W-130, 4, LBM_TOPMENU_VOLUME_3, MENU_TITLE_COLOR);
-  else
-    lcdDrawBitmapPattern(LCD_W-130, 4, LBM_TOPMENU_VOLUME_4, MENU_TITLE_COLOR);
+  lcdDrawBitmapPattern(LCD_W-130, 4, volumeBitmaps[getVolumeLevel()], MENU_TITLE_COLOR);
 
   /* Tx battery */
-  uint8_t bars = limit<int8_t>(0, 6 * (g_vbat100mV - g_eeGeneral.vBatMin - 90) / (30 + g_eeGeneral.vBatMax - g_eeGeneral.vBatMin), 5);
+  uint8_t bars = getTxBatteryBars();
   lcdDrawBitmapPattern(LCD_W-130, 24, LBM_TOPMENU_TXBATT, MENU_TITLE_COLOR);
   for (unsigned int i = 0; i < 5; i++) {
     lcdDrawSolidFilledRect(LCD_W-122+4*i, 30, 2, 8, i >= bars ? MENU_TITLE_DISABLE_COLOR : MENU_TITLE_COLOR);
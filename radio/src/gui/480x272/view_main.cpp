@@ -84,6 +84,35 @@ void drawTrims(uint8_t flightMode)
   }
 }
 
+#define SLIDER_POSITION(value)         divRoundClosest(160 * (limit<int>(-RESX, value, RESX) + RESX), 2 * RESX)
+
+// what the flight mode name, drawMainPots() and drawTrims() depend on, the layouts
+// redraw the whole screen when it changed
+bool isMainDecorationChanged()
+{
+  int16_t state[] = {
+    mixerCurrentFlightMode,
+    (int16_t)SLIDER_POSITION(calibratedAnalogs[CALIBRATED_POT1]),
+    (int16_t)(potsPos[1] & 0x0f),
+    (int16_t)SLIDER_POSITION(calibratedAnalogs[CALIBRATED_POT3]),
+    (int16_t)SLIDER_POSITION(calibratedAnalogs[CALIBRATED_SLIDER_REAR_LEFT]),
+    (int16_t)SLIDER_POSITION(calibratedAnalogs[CALIBRATED_SLIDER_REAR_RIGHT]),
+    (int16_t)getTrimValue(mixerCurrentFlightMode, 0),
+    (int16_t)getTrimValue(mixerCurrentFlightMode, 1),
+    (int16_t)getTrimValue(mixerCurrentFlightMode, 2),
+    (int16_t)getTrimValue(mixerCurrentFlightMode, 3),
+    (int16_t)(trimsDisplayTimer > 0 ? trimsDisplayMask : 0),
+    g_model.displayTrims
+  };
+  static int16_t lastState[DIM(state)];
+
+  if (memcmp(state, lastState, sizeof(state)) == 0) {
+    return false;
+  }
+  memcpy(lastState, state, sizeof(state));
+  return true;
+}
+
 void onMainViewMenu(const char *result)
 {
   if (result == STR_MODEL_SELECT) {
@@ -206,16 +235,33 @@ bool menuMainView(event_t event)
     g_model.view = 0;
   }
 
+  // the screen is fully redrawn when it doesn't hold our previous frame, otherwise only what changed
+  static uint8_t lastView = 0xFF;
+  bool full = (event == EVT_ENTRY || event == EVT_ENTRY_UP || g_model.view != lastView || !lcd->isSynchronized());
+  lastView = g_model.view;
+
+  bool refreshNeeded = true;
   for (uint8_t i=0; i<MAX_CUSTOM_SCREENS; i++) {
     if (customScreens[i]) {
-      if (i == g_model.view)
-        customScreens[i]->refresh();
-      else
+      if (i != g_model.view) {
         customScreens[i]->background();
+      }
+      else if (event == EVT_REFRESH) {
+        // drawn under a popup
+        lcd->stopDamageTracking();
+        customScreens[i]->refresh();
+      }
+      else {
+        customScreens[i]->refreshChanged(full);
+        if (!lcd->isDamaged()) {
+          lcd->stopDamageTracking();
+          refreshNeeded = false;
+        }
+      }
     }
   }
 
-  return true;
+  return refreshNeeded;
 }
 
 #if 0
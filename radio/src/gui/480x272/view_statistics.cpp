@@ -94,15 +94,27 @@ bool menuStatsGraph(event_t event)
   return true;
 }
 
+#if defined(LUA)
+static uint32_t luaSkips;
+
+static void addLuaSkips(const char * name, const ScriptStats & stats)
+{
+  luaSkips += stats.skips;
+}
+#endif
+
 bool menuStatsDebug(event_t event)
 {
   switch(event)
   {
     case EVT_KEY_FIRST(KEY_ENTER):
       maxMixerDuration  = 0;
+      mixerDeadlineMisses = 0;
 #if defined(LUA)
       maxLuaInterval = 0;
       maxLuaDuration = 0;
+      maxLuaGcDuration = 0;
+      memclear(&luaGcStats, sizeof(luaGcStats));
 #endif
       break;
   }
@@ -114,6 +126,8 @@ bool menuStatsDebug(event_t event)
 
   lcdDrawText(MENUS_MARGIN_LEFT, MENU_CONTENT_TOP+FH, STR_TMIXMAXMS);
   lcdDrawNumber(MENU_STATS_COLUMN1, MENU_CONTENT_TOP+FH, DURATION_MS_PREC2(maxMixerDuration), PREC2|LEFT, 0, NULL, "ms");
+  lcdDrawText(lcdNextPos+20, MENU_CONTENT_TOP+FH+1, "[Misses]", HEADER_COLOR|SMLSIZE);
+  lcdDrawNumber(lcdNextPos+5, MENU_CONTENT_TOP+FH, mixerDeadlineMisses, LEFT);
 
   lcdDrawText(MENUS_MARGIN_LEFT, MENU_CONTENT_TOP+2*FH, STR_FREESTACKMINB);
   lcdDrawText(MENU_STATS_COLUMN1, MENU_CONTENT_TOP+2*FH+1, "[Menus]", HEADER_COLOR|SMLSIZE);
@@ -149,6 +163,19 @@ bool menuStatsDebug(event_t event)
   lcdDrawNumber(lcdNextPos+5, MENU_CONTENT_TOP+line*FH, luaExtraMemoryUsage, LEFT);
   ++line;
 
+  uint32_t skips = 0;
+  for (int i=0; i<luaScriptsCount; i++) {
+    skips += scriptInternalData[i].stats.skips;
+  }
+  luaSkips = 0;
+  luaForEachWidgetStats(addLuaSkips);
+  skips += luaSkips;
+  lcdDrawText(MENUS_MARGIN_LEFT, MENU_CONTENT_TOP+line*FH, "Lua GC pause");
+  lcdDrawNumber(MENU_STATS_COLUMN1, MENU_CONTENT_TOP+line*FH, maxLuaGcDuration/10, PREC2|LEFT, 0, NULL, "ms");
+  lcdDrawText(lcdNextPos+20, MENU_CONTENT_TOP+line*FH+1, "[Skips]", HEADER_COLOR|SMLSIZE);
+  lcdDrawNumber(lcdNextPos+5, MENU_CONTENT_TOP+line*FH, skips, LEFT);
+  ++line;
+
 #endif
 
   lcdDrawText(LCD_W/2, MENU_FOOTER_TOP+2, STR_MENUTORESET, CENTERED);
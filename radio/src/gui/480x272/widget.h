@@ -68,6 +68,13 @@ class Widget
 
     virtual void refresh() = 0;
 
+    // called before each refresh() of the main view, false when the widget would draw exactly
+    // the same thing as on the screen already, its zone is then left untouched
+    virtual bool isChanged()
+    {
+      return true;
+    }
+
     virtual void background()
     {
     }
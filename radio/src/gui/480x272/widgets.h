@@ -75,5 +75,7 @@ void drawShutdownAnimation(uint32_t index);
 void drawTopBar();
 void drawMainPots();
 void drawTrims(uint8_t flightMode);
+bool isTopBarChanged();
+bool isMainDecorationChanged();
 
 #endif // _WIDGETS_H_
@@ -24,13 +24,26 @@ class GaugeWidget: public Widget
 {
   public:
     GaugeWidget(const WidgetFactory * factory, const Zone & zone, Widget::PersistentData * persistentData):
-      Widget(factory, zone, persistentData)
+      Widget(factory, zone, persistentData),
+      lastValue(0)
     {
     }
 
     virtual void refresh();
 
+    virtual bool isChanged()
+    {
+      int32_t value = getValue(persistentData->options[0].unsignedValue);
+      if (value == lastValue)
+        return false;
+      lastValue = value;
+      return true;
+    }
+
     static const ZoneOption options[];
+
+  protected:
+    int32_t lastValue;
 };
 
 const ZoneOption GaugeWidget::options[] = {
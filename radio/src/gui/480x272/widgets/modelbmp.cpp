@@ -63,6 +63,12 @@ class ModelBitmapWidget: public Widget
       }
     }
 
+    virtual bool isChanged()
+    {
+      return memcmp(bitmapFilename, g_model.header.bitmap, sizeof(g_model.header.bitmap)) != 0 ||
+             memcmp(modelName, g_model.header.name, sizeof(g_model.header.name)) != 0;
+    }
+
     virtual void refresh()
     {
       if (memcmp(bitmapFilename, g_model.header.bitmap, sizeof(g_model.header.bitmap)) != 0 ||
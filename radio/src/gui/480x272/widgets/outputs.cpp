@@ -30,10 +30,24 @@ class OutputsWidget: public Widget
     OutputsWidget(const WidgetFactory * factory, const Zone & zone, Widget::PersistentData * persistentData):
       Widget(factory, zone, persistentData)
     {
+      memset(lastValues, 0, sizeof(lastValues));
     }
 
     virtual void refresh();
 
+    virtual bool isChanged()
+    {
+      bool result = false;
+      for (uint8_t i = persistentData->options[0].unsignedValue - 1; i < MAX_OUTPUT_CHANNELS; i++) {
+        int16_t value = calcRESXto100(channelOutputs[i]);
+        if (value != lastValues[i]) {
+          lastValues[i] = value;
+          result = true;
+        }
+      }
+      return result;
+    }
+
     uint8_t drawChannels(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t firstChan, bool bg_shown, uint16_t bg_color)
     {
       char chanString[] = "CH32";
@@ -85,6 +99,9 @@ class OutputsWidget: public Widget
     }
 
     static const ZoneOption options[];
+
+  protected:
+    int16_t lastValues[MAX_OUTPUT_CHANNELS];
 };
 
 const ZoneOption OutputsWidget::options[] = {
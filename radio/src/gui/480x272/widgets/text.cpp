@@ -32,6 +32,12 @@ class TextWidget: public Widget
 
     virtual void refresh();
 
+    virtual bool isChanged()
+    {
+      // the options are only changed from the setup screens
+      return false;
+    }
+
     static const ZoneOption options[];
 };
 
@@ -24,13 +24,26 @@ class TimerWidget: public Widget
 {
   public:
     TimerWidget(const WidgetFactory * factory, const Zone & zone, Widget::PersistentData * persistentData):
-      Widget(factory, zone, persistentData)
+      Widget(factory, zone, persistentData),
+      lastValue(0)
     {
     }
 
     virtual void refresh();
 
+    virtual bool isChanged()
+    {
+      tmrval_t value = timersStates[persistentData->options[0].unsignedValue].val;
+      if (value == lastValue)
+        return false;
+      lastValue = value;
+      return true;
+    }
+
     static const ZoneOption options[];
+
+  protected:
+    tmrval_t lastValue;
 };
 
 const ZoneOption TimerWidget::options[] = {
@@ -26,11 +26,54 @@ class ValueWidget: public Widget
     ValueWidget(const WidgetFactory * factory, const Zone & zone, Widget::PersistentData * persistentData):
       Widget(factory, zone, persistentData)
     {
+      memset(&lastDrawn, 0, sizeof(lastDrawn));
     }
 
     virtual void refresh();
 
+    virtual bool isChanged()
+    {
+      mixsrc_t field = persistentData->options[0].unsignedValue;
+      DrawnValue drawn;
+      memset(&drawn, 0, sizeof(drawn));
+
+      if (field >= MIXSRC_FIRST_TELEM) {
+        unsigned int index = (field-MIXSRC_FIRST_TELEM)/3;
+        TelemetryItem & telemetryItem = telemetryItems[index];
+        drawn.value = telemetryItem.value;
+        drawn.valueMin = telemetryItem.valueMin;
+        drawn.valueMax = telemetryItem.valueMax;
+        drawn.status = (telemetryItem.isAvailable() ? 1 : 0) + (telemetryItem.isOld() ? 2 : 0);
+        if (g_model.telemetrySensors[index].unit >= UNIT_FIRST_VIRTUAL) {
+          memcpy(drawn.details, telemetryItem.text, sizeof(drawn.details));
+        }
+      }
+#if defined(INTERNAL_GPS)
+      else if (field == MIXSRC_TX_GPS) {
+        return true;
+      }
+#endif
+      else {
+        drawn.value = getValue(field);
+      }
+
+      if (memcmp(&drawn, &lastDrawn, sizeof(drawn)) == 0)
+        return false;
+      lastDrawn = drawn;
+      return true;
+    }
+
     static const ZoneOption options[];
+
+  protected:
+    struct DrawnValue {
+      int32_t value;
+      int32_t valueMin;
+      int32_t valueMax;
+      uint8_t status;
+      char details[sizeof(TelemetryItem::text)]; // cells, GPS, date and time or text sensors
+    };
+    DrawnValue lastDrawn;
 };
 
 const ZoneOption ValueWidget::options[] = {
@@ -136,6 +136,20 @@ class WidgetsContainer: public WidgetsContainerInterface
       }
     }
 
+    // every widget is asked, so that they all see the state about to be drawn
+    virtual bool isChanged()
+    {
+      bool result = false;
+      if (widgets) {
+        for (int i=0; i<N; i++) {
+          if (widgets[i] && widgets[i]->isChanged()) {
+            result = true;
+          }
+        }
+      }
+      return result;
+    }
+
     virtual void background()
     {
       if (widgets) {
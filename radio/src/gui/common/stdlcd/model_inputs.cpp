@@ -60,7 +60,7 @@ void insertExpo(uint8_t idx)
   expo->chn = s_currCh - 1;
   expo->weight = 100;
   resumeMixerCalculations();
-  storageDirty(EE_MODEL);
+  storageModelChanged();
 }
 
 void copyExpo(uint8_t idx)
@@ -69,7 +69,7 @@ void copyExpo(uint8_t idx)
   ExpoData * expo = expoAddress(idx);
   memmove(expo+1, expo, (MAX_EXPOS-(idx+1))*sizeof(ExpoData));
   resumeMixerCalculations();
-  storageDirty(EE_MODEL);
+  storageModelChanged();
 }
 
 bool swapExpos(uint8_t & idx, uint8_t up)
@@ -125,7 +125,7 @@ void deleteExpo(uint8_t idx)
     memclear(&g_model.inputNames[input], LEN_INPUT_NAME);
   }
   resumeMixerCalculations();
-  storageDirty(EE_MODEL);
+  storageModelChanged();
 }
 
 void onExposMenu(const char * result)
@@ -260,7 +260,7 @@ void menuModelExposAll(event_t event)
               swapExpos(s_currIdx, s_copyTgtOfs > 0);
               s_copyTgtOfs += (s_copyTgtOfs < 0 ? +1 : -1);
             } while (s_copyTgtOfs != 0);
-            storageDirty(EE_MODEL);
+            storageModelChanged();
           }
           menuVerticalPosition = s_copySrcRow;
           s_copyTgtOfs = 0;
@@ -354,7 +354,7 @@ void menuModelExposAll(event_t event)
           // only swap the mix with its neighbor
           if (!swapExpos(s_currIdx, IS_PREVIOUS_EVENT(event)))
             break;
-          storageDirty(EE_MODEL);
+          storageModelChanged();
         }
         
         s_copyTgtOfs = next_ofs;
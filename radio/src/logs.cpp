@@ -26,6 +26,7 @@ const pm_char * g_logError = NULL;
 uint8_t logDelay;
 
 void writeHeader();
+uint32_t getLogicalSwitchesStates(uint8_t first);
 
 #if defined(PCBTARANIS) || defined(PCBFLAMENCO) || defined(PCBHORUS)
   #define GET_2POS_STATE(sw) (switchState(SW_ ## sw ## 0) ? -1 : 1)
@@ -36,6 +37,384 @@ void writeHeader();
 #define GET_3POS_STATE(sw) (switchState(SW_ ## sw ## 0) ? -1 : (switchState(SW_ ## sw ## 2) ? 1 : 0))
 
 
+#if defined(LOGS_BINARY)
+// Binary logs: the menus task encodes the records in logsBuffer, the logs task
+// writes them to the SD card one whole sector at a time. Each logging session
+// starts with a header:
+//   "OTXL", u8 version, u8 flags, u16 period (10ms), u8 columns count,
+//   then for each column: u8 type, u8 prec, u8 label length, label
+// followed by records, all numbers are LEB128 varints (zigzag for the values):
+//   key record:   LOGS_RECORD_KEY, time seconds, time 1/100s, all values
+//   delta record: LOGS_RECORD_DELTA, elapsed 1/100s, bitmap of the changed values,
+//                 then the difference with the previous record for each changed value
+// radio/util/otl2csv.py and Companion convert these files to CSV
+
+#define LOGS_BINARY_VERSION      1
+#define LOGS_FLAG_RTC            0x01
+#define LOGS_RECORD_KEY          0x01
+#define LOGS_RECORD_DELTA        0x02
+#define LOGS_KEY_RECORD_PERIOD   64    // delta records between two key records
+#define LOGS_SECTOR_SIZE         512
+#if defined(PCBHORUS)
+  #define LOGS_BUFFER_SIZE       (8 * LOGS_SECTOR_SIZE)
+#else
+  #define LOGS_BUFFER_SIZE       (4 * LOGS_SECTOR_SIZE)
+#endif
+#define LOGS_HEADER_MAX_SIZE     (LOGS_BUFFER_SIZE / 2)
+#define LOGS_MAX_VALUES          (2*MAX_TELEMETRY_SENSORS + NUM_STICKS+NUM_POTS+NUM_SLIDERS + NUM_SWITCHES + 3)
+
+#if defined(PCBFLAMENCO)
+  #define LOGS_SWITCHES_LABELS   "SA,SB,SE,SF"
+#elif defined(PCBX7)
+  #define LOGS_SWITCHES_LABELS   "SA,SB,SC,SD,SF,SH"
+#elif defined(PCBTARANIS) || defined(PCBHORUS)
+  #define LOGS_SWITCHES_LABELS   "SA,SB,SC,SD,SE,SF,SG,SH"
+#else
+  #define LOGS_SWITCHES_LABELS   "THR,RUD,ELE,3POS,AIL,GEA,TRN"
+#endif
+
+enum LogsColumnType {
+  LOGS_COLUMN_VALUE,     // 1 value
+  LOGS_COLUMN_GPS,       // latitude, longitude
+  LOGS_COLUMN_DATETIME,  // yyyymmdd, hhmmss
+  LOGS_COLUMN_BITS64,    // high 32 bits, low 32 bits
+};
+
+uint8_t logsBuffer[LOGS_BUFFER_SIZE];
+// positions in the log file, logsBuffer is indexed by these positions modulo LOGS_BUFFER_SIZE
+volatile uint32_t logsBufferWrite;
+volatile uint32_t logsBufferRead;
+const pm_char * volatile logsFlushError = NULL;
+
+static uint32_t logsPos;               // end of the record being encoded, published in logsBufferWrite when complete
+static uint32_t logsBitmapPos;
+static bool logsKeyRecord;
+static uint8_t logsRecordsCount;       // before the next key record
+static uint8_t logsColumnsCount;
+static uint8_t logsValuesCount;
+static uint8_t logsValueIndex;
+static int32_t logsValues[LOGS_MAX_VALUES];
+static uint32_t logsSeconds;
+static uint8_t logsHundredths;
+static uint32_t logsSensors[(MAX_TELEMETRY_SENSORS+31)/32];
+static bool logsHeaderPending;
+
+static inline uint32_t logsBufferSpace()
+{
+  return LOGS_BUFFER_SIZE - (logsPos - logsBufferRead);
+}
+
+// the bytes of the record must be in logsBuffer before logsBufferWrite lets the logs task write them.
+// The compiler barrier is enough on the single core Cortex-M, which does not reorder its stores
+static inline void logsPublish()
+{
+  asm volatile("" ::: "memory");
+  logsBufferWrite = logsPos;
+}
+
+static inline void logsPutByte(uint8_t value)
+{
+  logsBuffer[logsPos++ & (LOGS_BUFFER_SIZE-1)] = value;
+}
+
+static void logsPutVarint(uint32_t value)
+{
+  while (value >= 0x80) {
+    logsPutByte(value | 0x80);
+    value >>= 7;
+  }
+  logsPutByte(value);
+}
+
+static void logsPutSigned(int32_t value)
+{
+  logsPutVarint(((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+}
+
+static void logsPutColumn(uint8_t type, uint8_t prec, const char * label, uint8_t len)
+{
+  logsPutByte(type);
+  logsPutByte(prec);
+  logsPutByte(len);
+  for (uint8_t i=0; i<len; i++) {
+    logsPutByte(label[i]);
+  }
+  logsColumnsCount++;
+  logsValuesCount += (type == LOGS_COLUMN_VALUE ? 1 : 2);
+}
+
+// one column for each label of a comma separated list
+static void logsPutColumns(const char * labels)
+{
+  while (*labels) {
+    uint8_t len = 0;
+    while (labels[len] && labels[len] != ',') {
+      len++;
+    }
+    logsPutColumn(LOGS_COLUMN_VALUE, 0, labels, len);
+    labels += len;
+    if (*labels) {
+      labels++;
+    }
+  }
+}
+
+static inline bool isSensorLogged(int index)
+{
+  return isTelemetryFieldAvailable(index) && g_model.telemetrySensors[index].logs;
+}
+
+// returns true if the logged sensors changed since the last header
+static bool logsCheckSensors()
+{
+  bool changed = false;
+  for (int i=0; i<MAX_TELEMETRY_SENSORS; i++) {
+    uint32_t mask = 1 << (i & 31);
+    uint32_t value = (isSensorLogged(i) ? mask : 0);
+    if ((logsSensors[i/32] & mask) != value) {
+      logsSensors[i/32] ^= mask;
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+void writeHeader()
+{
+  // when the buffer is too full, the header is written before the next record
+  logsHeaderPending = (logsBufferSpace() < LOGS_HEADER_MAX_SIZE);
+  if (logsHeaderPending) {
+    return;
+  }
+
+  logsCheckSensors();
+
+  logsPutByte('O');
+  logsPutByte('T');
+  logsPutByte('X');
+  logsPutByte('L');
+  logsPutByte(LOGS_BINARY_VERSION);
+#if defined(RTCLOCK)
+  logsPutByte(LOGS_FLAG_RTC);
+#else
+  logsPutByte(0);
+#endif
+  logsPutByte(logDelay * 10);
+  logsPutByte((logDelay * 10) >> 8);
+  uint32_t columnsCountPos = logsPos;
+  logsPutByte(0);
+
+  logsColumnsCount = 0;
+  logsValuesCount = 0;
+
+  char label[TELEM_LABEL_LEN+5];
+  for (int i=0; i<MAX_TELEMETRY_SENSORS; i++) {
+    if (isSensorLogged(i)) {
+      TelemetrySensor & sensor = g_model.telemetrySensors[i];
+      uint8_t len = zchar2str(label, sensor.label, TELEM_LABEL_LEN);
+      uint8_t unit = sensor.unit;
+      if (unit == UNIT_CELLS) unit = UNIT_VOLTS;
+      if (UNIT_RAW < unit && unit < UNIT_FIRST_VIRTUAL) {
+        label[len++] = '(';
+        for (uint8_t j=0; j<3 && STR_VTELEMUNIT[1+3*unit+j]; j++) {
+          label[len++] = STR_VTELEMUNIT[1+3*unit+j];
+        }
+        label[len++] = ')';
+      }
+      if (sensor.unit == UNIT_GPS)
+        logsPutColumn(LOGS_COLUMN_GPS, 6, label, len);
+      else if (sensor.unit == UNIT_DATETIME)
+        logsPutColumn(LOGS_COLUMN_DATETIME, 0, label, len);
+      else
+        logsPutColumn(LOGS_COLUMN_VALUE, sensor.prec, label, len);
+    }
+  }
+
+  for (uint8_t i=1; i<NUM_STICKS+NUM_POTS+NUM_SLIDERS+1; i++) {
+    const char * p = STR_VSRCRAW + i * STR_VSRCRAW[0] + 2;
+    uint8_t len = 0;
+    while (len < STR_VSRCRAW[0]-1 && p[len] && p[len] != ' ') {
+      len++;
+    }
+    logsPutColumn(LOGS_COLUMN_VALUE, 0, p, len);
+  }
+
+  logsPutColumns(LOGS_SWITCHES_LABELS);
+#if defined(PCBTARANIS) || defined(PCBHORUS)
+  logsPutColumn(LOGS_COLUMN_BITS64, 0, "LSW", 3);
+#endif
+  logsPutColumn(LOGS_COLUMN_VALUE, 1, "TxBat(V)", 8);
+
+  logsBuffer[columnsCountPos & (LOGS_BUFFER_SIZE-1)] = logsColumnsCount;
+  logsRecordsCount = 0;
+  logsPublish();
+}
+
+static void logsPutValue(int32_t value)
+{
+  int32_t & previous = logsValues[logsValueIndex];
+  if (logsKeyRecord) {
+    logsPutSigned(value);
+  }
+  else if (value != previous) {
+    logsPutSigned(value - previous);
+    logsBuffer[(logsBitmapPos + logsValueIndex/8) & (LOGS_BUFFER_SIZE-1)] |= (1 << (logsValueIndex & 7));
+  }
+  previous = value;
+  logsValueIndex++;
+}
+
+// the values are in the same order than the columns written by writeHeader()
+static void logsWriteRecord()
+{
+  if (logsCheckSensors() || logsHeaderPending) {
+    writeHeader();
+  }
+
+  uint8_t bitmapSize = (logsValuesCount + 7) / 8;
+  if (logsHeaderPending || logsBufferSpace() < 11u + bitmapSize + 5*logsValuesCount) {
+    // the SD card is too slow, this record is lost
+    return;
+  }
+
+#if defined(RTCLOCK)
+  uint32_t seconds = g_rtcTime;
+  uint8_t hundredths = g_ms100;
+#else
+  tmr10ms_t tmr10ms = get_tmr10ms();
+  uint32_t seconds = tmr10ms / 100;
+  uint8_t hundredths = tmr10ms % 100;
+#endif
+  int32_t elapsed = (int32_t)(seconds - logsSeconds) * 100 + hundredths - logsHundredths;
+  logsSeconds = seconds;
+  logsHundredths = hundredths;
+
+  logsKeyRecord = (logsRecordsCount == 0 || elapsed < 0);
+  if (logsKeyRecord) {
+    logsPutByte(LOGS_RECORD_KEY);
+    logsPutVarint(seconds);
+    logsPutVarint(hundredths);
+    logsRecordsCount = LOGS_KEY_RECORD_PERIOD;
+  }
+  else {
+    logsPutByte(LOGS_RECORD_DELTA);
+    logsPutVarint(elapsed);
+    logsBitmapPos = logsPos;
+    for (uint8_t i=0; i<bitmapSize; i++) {
+      logsPutByte(0);
+    }
+    logsRecordsCount--;
+  }
+
+  logsValueIndex = 0;
+
+  for (int i=0; i<MAX_TELEMETRY_SENSORS; i++) {
+    if (isSensorLogged(i)) {
+      TelemetrySensor & sensor = g_model.telemetrySensors[i];
+      TelemetryItem & telemetryItem = telemetryItems[i];
+      if (sensor.unit == UNIT_GPS) {
+        logsPutValue(telemetryItem.gps.latitude);
+        logsPutValue(telemetryItem.gps.longitude);
+      }
+      else if (sensor.unit == UNIT_DATETIME) {
+        logsPutValue(telemetryItem.datetime.year*10000 + telemetryItem.datetime.month*100 + telemetryItem.datetime.day);
+        logsPutValue(telemetryItem.datetime.hour*10000 + telemetryItem.datetime.min*100 + telemetryItem.datetime.sec);
+      }
+      else {
+        logsPutValue(telemetryItem.value);
+      }
+    }
+  }
+
+  for (uint8_t i=0; i<NUM_STICKS+NUM_POTS+NUM_SLIDERS; i++) {
+    logsPutValue(calibratedAnalogs[i]);
+  }
+
+#if defined(PCBFLAMENCO)
+  logsPutValue(GET_3POS_STATE(SA));
+  logsPutValue(GET_3POS_STATE(SB));
+  logsPutValue(GET_2POS_STATE(SE));
+  logsPutValue(GET_3POS_STATE(SF));
+#elif defined(PCBX7)
+  logsPutValue(GET_3POS_STATE(SA));
+  logsPutValue(GET_3POS_STATE(SB));
+  logsPutValue(GET_3POS_STATE(SC));
+  logsPutValue(GET_3POS_STATE(SD));
+  logsPutValue(GET_2POS_STATE(SF));
+  logsPutValue(GET_2POS_STATE(SH));
+#elif defined(PCBTARANIS) || defined(PCBHORUS)
+  logsPutValue(GET_3POS_STATE(SA));
+  logsPutValue(GET_3POS_STATE(SB));
+  logsPutValue(GET_3POS_STATE(SC));
+  logsPutValue(GET_3POS_STATE(SD));
+  logsPutValue(GET_3POS_STATE(SE));
+  logsPutValue(GET_2POS_STATE(SF));
+  logsPutValue(GET_3POS_STATE(SG));
+  logsPutValue(GET_2POS_STATE(SH));
+#else
+  logsPutValue(GET_2POS_STATE(THR));
+  logsPutValue(GET_2POS_STATE(RUD));
+  logsPutValue(GET_2POS_STATE(ELE));
+  logsPutValue(GET_3POS_STATE(ID));
+  logsPutValue(GET_2POS_STATE(AIL));
+  logsPutValue(GET_2POS_STATE(GEA));
+  logsPutValue(GET_2POS_STATE(TRN));
+#endif
+
+#if defined(PCBTARANIS) || defined(PCBHORUS)
+  logsPutValue(getLogicalSwitchesStates(32));
+  logsPutValue(getLogicalSwitchesStates(0));
+#endif
+
+  logsPutValue(g_vbat100mV);
+
+  logsPublish();
+}
+
+// called with logsMutex taken, writes the complete sectors, or everything when all is true
+static void logsWriteBuffer(bool all)
+{
+  while (g_oLogFile.obj.fs && !logsFlushError) {
+    uint32_t read = logsBufferRead;
+    uint32_t count = logsBufferWrite - read;
+    uint32_t chunk = LOGS_SECTOR_SIZE - (read & (LOGS_SECTOR_SIZE-1));
+    if (count < chunk) {
+      if (!all || count == 0)
+        break;
+      chunk = count;
+    }
+    UINT written;
+    FRESULT result = f_write(&g_oLogFile, &logsBuffer[read & (LOGS_BUFFER_SIZE-1)], chunk, &written);
+    if (result != FR_OK || written != chunk) {
+      logsFlushError = SDCARD_ERROR(result);
+      break;
+    }
+    logsBufferRead = read + chunk;
+  }
+}
+
+void logsFlush()
+{
+  CoEnterMutexSection(logsMutex);
+  logsWriteBuffer(false);
+  CoLeaveMutexSection(logsMutex);
+}
+
+#define LOGS_TASK_PERIOD_TICKS   50    // 100ms
+
+void logsTask(void * pdata)
+{
+  while (1) {
+    CoTickDelay(LOGS_TASK_PERIOD_TICKS);
+    logsFlush();
+#if defined(SIMU)
+    if (main_thread_running == 0)
+      break;
+#endif
+  }
+}
+#endif
+
 void logsInit()
 {
   memset(&g_oLogFile, 0, sizeof(g_oLogFile));
@@ -104,9 +483,16 @@ const pm_char * logsOpen()
     return SDCARD_ERROR(result);
   }
 
+#if defined(LOGS_BINARY)
+  // each session has its own header, the sensors may have changed since the last one
+  logsBufferRead = logsBufferWrite = logsPos = f_size(&g_oLogFile);
+  logsFlushError = NULL;
+  writeHeader();
+#else
   if (f_size(&g_oLogFile) == 0) {
     writeHeader();
   }
+#endif
 
   return NULL;
 }
@@ -115,11 +501,20 @@ tmr10ms_t lastLogTime = 0;
 
 void logsClose()
 {
+  DISK_CACHE_CONSUMER(DISK_CACHE_LOGS);
+
   if (sdMounted()) {
+#if defined(LOGS_BINARY)
+    CoEnterMutexSection(logsMutex);
+    logsWriteBuffer(true);
+#endif
     if (f_close(&g_oLogFile) != FR_OK) {
       // close failed, forget file
       g_oLogFile.obj.fs = 0;
     }
+#if defined(LOGS_BINARY)
+    CoLeaveMutexSection(logsMutex);
+#endif
     lastLogTime = 0;
   }
 }
@@ -132,6 +527,7 @@ getvalue_t getConvertedTelemetryValue(getvalue_t val, uint8_t unit)
 }
 #endif
 
+#if !defined(LOGS_BINARY)
 void writeHeader()
 {
 #if defined(RTCLOCK)
@@ -202,6 +598,7 @@ void writeHeader()
 
   f_puts("TxBat(V)\n", &g_oLogFile);
 }
+#endif
 
 uint32_t getLogicalSwitchesStates(uint8_t first)
 {
@@ -216,13 +613,21 @@ void logsWrite()
 {
   static const pm_char * error_displayed = NULL;
 
+  DISK_CACHE_CONSUMER(DISK_CACHE_LOGS);
+
   if (isFunctionActive(FUNCTION_LOGS) && logDelay > 0) {
     tmr10ms_t tmr10ms = get_tmr10ms();
     if (lastLogTime == 0 || (tmr10ms_t)(tmr10ms - lastLogTime) >= (tmr10ms_t)logDelay*10) {
       lastLogTime = tmr10ms;
 
       if (!g_oLogFile.obj.fs) {
+#if defined(LOGS_BINARY)
+        CoEnterMutexSection(logsMutex);
         const pm_char * result = logsOpen();
+        CoLeaveMutexSection(logsMutex);
+#else
+        const pm_char * result = logsOpen();
+#endif
         if (result != NULL) {
           if (result != error_displayed) {
             error_displayed = result;
@@ -232,6 +637,18 @@ void logsWrite()
         }
       }
 
+#if defined(LOGS_BINARY)
+      if (logsFlushError) {
+        if (!error_displayed) {
+          error_displayed = logsFlushError;
+          POPUP_WARNING(logsFlushError);
+        }
+        logsClose();
+      }
+      else {
+        logsWriteRecord();
+      }
+#else
 #if defined(RTCLOCK)
       {
         static struct gtm utm;
@@ -390,6 +807,7 @@ void logsWrite()
         POPUP_WARNING(STR_SDCARD_ERROR);
         logsClose();
       }
+#endif
     }
   }
   else {
@@ -325,9 +325,7 @@ static int luaSportTelemetryPop(lua_State * L)
 
   if (luaInputTelemetryFifo->size() >= sizeof(SportTelemetryPacket)) {
     SportTelemetryPacket packet;
-    for (uint8_t i=0; i<sizeof(packet); i++) {
-      luaInputTelemetryFifo->pop(packet.raw[i]);
-    }
+    luaInputTelemetryFifo->popN(packet.raw, sizeof(packet));
     lua_pushnumber(L, packet.physicalId);
     lua_pushnumber(L, packet.primId);
     lua_pushnumber(L, packet.dataId);
@@ -1047,10 +1045,8 @@ static int luaSetTelemetryValue(lua_State * L)
   if (id | subId | instance) {
     int index = setTelemetryValue(TELEM_PROTO_LUA, id, subId, instance, value, unit, prec);
     if (index >= 0) {
+      // setTelemetryValue() has already set id, subId and instance of a new sensor
       TelemetrySensor &telemetrySensor = g_model.telemetrySensors[index];
-      telemetrySensor.id = id;
-      telemetrySensor.subId = subId;
-      telemetrySensor.instance = instance;
       telemetrySensor.init(zname, unit, prec);
       lua_pushboolean(L, true);
     } else {
@@ -645,6 +645,7 @@ static int luaModelInsertMix(lua_State *L)
         mix->speedDown = luaL_checkinteger(L, -1);
       }
     }
+    storageModelChanged();
   }
 
   return 0;
@@ -686,6 +687,7 @@ Remove all mixers
 static int luaModelDeleteMixes(lua_State *L)
 {
   memset(g_model.mixData, 0, sizeof(g_model.mixData));
+  storageModelChanged();
   return 0;
 }
 
@@ -778,7 +780,7 @@ static int luaModelSetLogicalSwitch(lua_State *L)
         sw->duration = luaL_checkinteger(L, -1);
       }
     }
-    storageDirty(EE_MODEL);
+    storageModelChanged();
   }
 
   return 0;
@@ -22,6 +22,9 @@
 
 #include <ctype.h>
 #include <stdio.h>
+#if !defined(SIMU)
+#include <malloc.h>
+#endif
 #include "opentx.h"
 #include "bin_allocator.h"
 #include "lua_api.h"
@@ -43,6 +46,8 @@ ScriptInputsOutputs scriptInputsOutputs[MAX_SCRIPTS];
 ScriptInternalData standaloneScript;
 uint16_t maxLuaInterval = 0;
 uint16_t maxLuaDuration = 0;
+uint16_t maxLuaGcDuration = 0;
+uint32_t luaAllocatedBytes = 0;
 bool luaLcdAllowed;
 int instructionsPercent = 0;
 char lua_warning_info[LUA_WARNING_INFO_LEN+1];
@@ -79,6 +84,71 @@ void luaSetInstructionsLimit(lua_State * L, int count)
   lua_sethook(L, luaHook, LUA_MASKCOUNT, count);
 }
 
+// Lua allocator of both states, counting the allocated bytes to charge them to the running script
+void * luaAlloc(void * ud, void * ptr, size_t osize, size_t nsize)
+{
+  // when ptr is NULL, osize is the type of the Lua object, not a size
+  size_t oldSize = (ptr ? osize : 0);
+  if (nsize > oldSize) {
+    luaAllocatedBytes += nsize - oldSize;
+  }
+#if defined(USE_BIN_ALLOCATOR)
+  return bin_l_alloc(ud, ptr, osize, nsize);   //we use our own allocator!
+#else
+  return l_alloc(ud, ptr, osize, nsize);   //we use Lua default allocator
+#endif
+}
+
+void luaStartTimer(LuaCallAccounting & call)
+{
+  call.start2MHz = getTmr2MHz();
+  call.start10ms = get_tmr10ms();
+}
+
+uint32_t luaGetElapsedTime(const LuaCallAccounting & call)
+{
+  // the 2MHz timer wraps after 32ms, the 10ms one takes over for the longer calls
+  tmr10ms_t elapsed10ms = get_tmr10ms() - call.start10ms;
+  if (elapsed10ms >= 3) {
+    return elapsed10ms * 10000;
+  }
+  return (uint16_t)(getTmr2MHz() - call.start2MHz) / 2;
+}
+
+void luaStartCall(LuaCallAccounting & call)
+{
+  call.startAllocated = luaAllocatedBytes;
+  luaStartTimer(call);
+}
+
+void luaStopCall(const LuaCallAccounting & call, ScriptStats & stats)
+{
+  uint32_t duration = luaGetElapsedTime(call);
+  stats.lastDuration = min<uint32_t>(duration, 0xFFFF);
+  if (stats.lastDuration > stats.maxDuration) {
+    stats.maxDuration = stats.lastDuration;
+  }
+  stats.allocated += luaAllocatedBytes - call.startAllocated;
+  stats.runs++;
+  stats.credit = max<int32_t>(stats.credit - duration, -LUA_SCRIPT_MAX_DEBT_US);
+}
+
+// called once per menu cycle for each script
+void luaRefillBudget(ScriptStats & stats)
+{
+  stats.credit = min<int32_t>(stats.credit + LUA_SCRIPT_BUDGET_US, LUA_SCRIPT_BUDGET_US);
+}
+
+// returns false (and counts a skip) when the background() call of a script over its budget has to be skipped
+bool luaCheckBudget(ScriptStats & stats)
+{
+  if (stats.credit >= 0) {
+    return true;
+  }
+  stats.skips++;
+  return false;
+}
+
 int luaGetInputs(lua_State * L, ScriptInputsOutputs & sid)
 {
   if (!lua_istable(L, -1))
@@ -194,15 +264,18 @@ void luaRegisterLibraries(lua_State * L)
 
 #define GC_REPORT_TRESHOLD    (2*1024)
 
-void luaDoGc(lua_State * L, bool full)
+// returns true when a step finished the GC cycle
+bool luaDoGc(lua_State * L, bool full)
 {
+  bool finished = true;
   if (L) {
     PROTECT_LUA() {
       if (full) {
         lua_gc(L, LUA_GCCOLLECT, 0);
       }
       else {
-        lua_gc(L, LUA_GCSTEP, 10);
+        // a single basic step, the idle GC calls it as many times as its time slice allows
+        finished = lua_gc(L, LUA_GCSTEP, 0);
       }
 #if defined(SIMU) || defined(DEBUG)
       if (L == lsScripts) {
@@ -234,6 +307,162 @@ void luaDoGc(lua_State * L, bool full)
     }
     UNPROTECT_LUA();
   }
+  return finished;
+}
+
+LuaGcStats luaGcStats;
+
+#define LUA_GC_MAX_SLICE_US           10000
+#define LUA_GC_IDLE_GROWTH            8       // an idle GC cycle starts once the memory grew by 1/8 since the last one
+#if (LUA_MEM_MAX > 0)
+  #define LUA_GC_PRESSURE_THRESHOLD   (LUA_MEM_MAX / 4 * 3)
+#else
+  #define LUA_GC_MIN_FREE_MEMORY      (16*1024)
+#endif
+#if defined(COLORLCD)
+  #define LUA_GC_STATES               2
+#else
+  #define LUA_GC_STATES               1
+#endif
+
+static uint32_t gcCycleEndMem[LUA_GC_STATES];
+
+static lua_State * luaGetGcState(int index)
+{
+#if defined(COLORLCD)
+  if (index == 1) {
+    return lsWidgets;
+  }
+#endif
+  return lsScripts;
+}
+
+#if (LUA_MEM_MAX > 0)
+static uint32_t luaGetTotalMemUsed()
+{
+  uint32_t totalMemUsed = luaGetMemUsed(lsScripts);
+#if defined(COLORLCD)
+  totalMemUsed += luaGetMemUsed(lsWidgets);
+  totalMemUsed += luaExtraMemoryUsage;
+#endif
+  return totalMemUsed;
+}
+#endif
+
+// under pressure, a GC cycle starts as soon as the Lua memory grew since the last one
+static bool isLuaMemoryPressure()
+{
+#if (LUA_MEM_MAX > 0)
+  return luaGetTotalMemUsed() > LUA_GC_PRESSURE_THRESHOLD;
+#elif !defined(SIMU)
+  // the heap top never goes down, the memory freed below it (mostly by the Lua GC) is counted by mallinfo()
+  return availableMemory() + mallinfo().fordblks < LUA_GC_MIN_FREE_MEMORY;
+#else
+  return false;
+#endif
+}
+
+static void luaRecordGcPause(uint32_t duration)
+{
+  uint8_t bin = (duration < 2 ? 0 : 31 - __builtin_clz(duration));
+  if (bin >= LUA_GC_HISTOGRAM_SIZE) bin = LUA_GC_HISTOGRAM_SIZE - 1;
+  if (luaGcStats.histogram[bin] < 0xFFFF) luaGcStats.histogram[bin]++;
+  maxLuaGcDuration = max<uint32_t>(maxLuaGcDuration, min<uint32_t>(duration, 0xFFFF));
+}
+
+static void luaFullGc()
+{
+  for (int i=0; i<LUA_GC_STATES; i++) {
+    lua_State * L = luaGetGcState(i);
+    if (L) {
+      LuaCallAccounting gc;
+      luaStartTimer(gc);
+      luaDoGc(L, true);
+      luaRecordGcPause(luaGetElapsedTime(gc));
+      gcCycleEndMem[i] = luaGetMemUsed(luaGetGcState(i));
+    }
+  }
+  luaGcStats.fullCollections++;
+}
+
+// the GC of the scripts state is charged to the scripts which produced the garbage, pro rata of their allocations
+static void luaChargeGc(uint32_t duration)
+{
+  uint32_t totalAllocated = 0;
+  for (int i=0; i<luaScriptsCount; i++) {
+    const ScriptStats & stats = scriptInternalData[i].stats;
+    totalAllocated += stats.allocated - stats.gcAllocated;
+  }
+  if (totalAllocated > 0) {
+    for (int i=0; i<luaScriptsCount; i++) {
+      ScriptStats & stats = scriptInternalData[i].stats;
+      uint32_t share = (uint64_t)duration * (stats.allocated - stats.gcAllocated) / totalAllocated;
+      stats.gcAllocated = stats.allocated;
+      stats.gcDuration += share;
+      stats.credit = max<int32_t>(stats.credit - share, -LUA_SCRIPT_MAX_DEBT_US);
+    }
+  }
+}
+
+static bool isLuaGcPending(int index, bool pressure)
+{
+  lua_State * L = luaGetGcState(index);
+  if (!L) {
+    return false;
+  }
+  if (G(L)->gcstate != GCSpause) {
+    return true;
+  }
+  uint32_t growth = (pressure ? 0 : gcCycleEndMem[index] / LUA_GC_IDLE_GROWTH);
+  return luaGetMemUsed(L) > gcCycleEndMem[index] + growth;
+}
+
+// runs GC steps during (at most) budget us, called in the idle tail of the menus task period
+void luaIdleGc(uint32_t budget)
+{
+  if (luaState == INTERPRETER_PANIC) return;
+
+  LuaCallAccounting slice;
+  luaStartTimer(slice);
+  budget = min<uint32_t>(budget, LUA_GC_MAX_SLICE_US);
+
+  bool pressure = isLuaMemoryPressure();
+  bool pending[LUA_GC_STATES];
+  bool anyPending = false;
+  for (int i=0; i<LUA_GC_STATES; i++) {
+    pending[i] = isLuaGcPending(i, pressure);
+    anyPending |= pending[i];
+  }
+
+  uint32_t scriptsGcDuration = 0;
+  while (anyPending && luaGetElapsedTime(slice) < budget) {
+    anyPending = false;
+    for (int i=0; i<LUA_GC_STATES; i++) {
+      lua_State * L = luaGetGcState(i);
+      if (pending[i] && L) {
+        LuaCallAccounting step;
+        luaStartTimer(step);
+        bool finished = luaDoGc(L, false);
+        uint32_t duration = luaGetElapsedTime(step);
+        luaRecordGcPause(duration);
+        luaGcStats.steps++;
+        if (i == 0) {
+          scriptsGcDuration += duration;
+        }
+        if (finished) {
+          pending[i] = false;
+          gcCycleEndMem[i] = luaGetMemUsed(luaGetGcState(i));
+          luaGcStats.cycles++;
+          if (pressure) {
+            luaGcStats.pressureCycles++;
+          }
+        }
+        anyPending |= pending[i];
+      }
+    }
+  }
+
+  luaChargeGc(scriptsGcDuration);
 }
 
 void luaFree(lua_State * L, ScriptInternalData & sid)
@@ -326,6 +555,8 @@ static void luaDumpState(lua_State * L, const char * filename, const FILINFO * f
 */
 int luaLoadScriptFileToState(lua_State * L, const char * filename, const char * mode)
 {
+  DISK_CACHE_CONSUMER(DISK_CACHE_LUA);
+
   if (luaState == INTERPRETER_PANIC) {
     return SCRIPT_PANIC;
   } else if (filename == NULL) {
@@ -364,6 +595,13 @@ int luaLoadScriptFileToState(lua_State * L, const char * filename, const char *
   }
   strncat(filenameFull, filename, fnamelen);
 
+  // a script compiled from its source is loaded from the scripts cache, after a single check of the source
+  bool scriptCacheable = strpbrk(lmode, "tT") && !strpbrk(lmode, "cx");
+  if (scriptCacheable && luaLoadCachedScript(L, filenameFull, strpbrk(lmode, "Td") != NULL) == LUA_OK) {
+    TRACE("luaLoadScriptFileToState(%s, %s): loaded from cache", filename, lmode);
+    return SCRIPT_OK;
+  }
+
   // check if binary version exists
   strcpy(filenameFull + fnamelen, SCRIPT_BIN_EXT);
   frLuaC = f_stat(filenameFull, &fnoLuaC);
@@ -446,6 +684,10 @@ int luaLoadScriptFileToState(lua_State * L, const char * filename, const char *
       strcpy(filenameFull + fnamelen, SCRIPT_BIN_EXT);
       luaDumpState(L, filenameFull, &fnoLuaS, (strchr(lmode, 'd') ? 0 : 1));
     }
+    if (scriptCacheable && loadFileType == 1) {
+      filenameFull[fnamelen] = '\0';
+      luaSaveCachedScript(L, filenameFull, fnoLuaS, (strpbrk(lmode, "Td") ? 0 : 1));
+    }
     ret = SCRIPT_OK;
   }
 #else
@@ -473,6 +715,7 @@ static int luaLoad(lua_State * L, const char * filename, ScriptInternalData & si
   int lstatus = 0;
 
   sid.instructions = 0;
+  memclear(&sid.stats, sizeof(sid.stats));
   sid.state = SCRIPT_OK;
 
   if (luaState == INTERPRETER_PANIC) {
@@ -855,7 +1098,7 @@ bool luaDoOneRunPermanentScript(event_t evt, int i, uint32_t scriptType)
 #endif
     if (getSwitch(fn.swtch))
       lua_rawgeti(lsScripts, LUA_REGISTRYINDEX, sid.run);
-    else if (sid.background)
+    else if (sid.background && luaCheckBudget(sid.stats))
       lua_rawgeti(lsScripts, LUA_REGISTRYINDEX, sid.background);
     else
       return false;
@@ -871,7 +1114,7 @@ bool luaDoOneRunPermanentScript(event_t evt, int i, uint32_t scriptType)
       lua_pushunsigned(lsScripts, evt);
       inputsCount = 1;
     }
-    else if ((scriptType & RUN_TELEM_BG_SCRIPT) && (sid.background)) {
+    else if ((scriptType & RUN_TELEM_BG_SCRIPT) && (sid.background) && luaCheckBudget(sid.stats)) {
       lua_rawgeti(lsScripts, LUA_REGISTRYINDEX, sid.background);
     }
     else {
@@ -882,6 +1125,8 @@ bool luaDoOneRunPermanentScript(event_t evt, int i, uint32_t scriptType)
 #endif
   }
 
+  LuaCallAccounting call;
+  luaStartCall(call);
   if (lua_pcall(lsScripts, inputsCount, sio ? sio->outputsCount : 0, 0) == 0) {
     if (sio) {
       for (int j=sio->outputsCount-1; j>=0; j--) {
@@ -905,6 +1150,7 @@ bool luaDoOneRunPermanentScript(event_t evt, int i, uint32_t scriptType)
       sid.state = SCRIPT_SYNTAX_ERROR;
     }
   }
+  luaStopCall(call, sid.stats);
 
   if (sid.state != SCRIPT_OK) {
     luaFree(lsScripts, sid);
@@ -920,6 +1166,7 @@ bool luaDoOneRunPermanentScript(event_t evt, int i, uint32_t scriptType)
 bool luaTask(event_t evt, uint8_t scriptType, bool allowLcdUsage)
 {
   if (luaState == INTERPRETER_PANIC) return false;
+  DISK_CACHE_CONSUMER(DISK_CACHE_LUA);
   luaLcdAllowed = allowLcdUsage;
   bool scriptWasRun = false;
 
@@ -928,7 +1175,10 @@ bool luaTask(event_t evt, uint8_t scriptType, bool allowLcdUsage)
     // run standalone script
     if ((scriptType & RUN_STNDAL_SCRIPT) == 0) return false;
     PROTECT_LUA() {
+      LuaCallAccounting call;
+      luaStartCall(call);
       luaDoOneRunStandalone(evt);
+      luaStopCall(call, standaloneScript.stats);
       scriptWasRun = true;
     }
     else {
@@ -944,9 +1194,19 @@ bool luaTask(event_t evt, uint8_t scriptType, bool allowLcdUsage)
       luaInit();
       if (luaState == INTERPRETER_PANIC) return false;
       luaLoadPermanentScripts();
+#if defined(LUA_COMPILER)
+      luaCloseScriptsCache();
+#endif
       if (luaState == INTERPRETER_PANIC) return false;
     }
 
+    // the background pass runs once per menu cycle
+    if (scriptType & RUN_MIX_SCRIPT) {
+      for (int i=0; i<luaScriptsCount; i++) {
+        luaRefillBudget(scriptInternalData[i].stats);
+      }
+    }
+
     for (int i=0; i<luaScriptsCount; i++) {
       PROTECT_LUA() {
         scriptWasRun |= luaDoOneRunPermanentScript(evt, i, scriptType);
@@ -956,24 +1216,20 @@ bool luaTask(event_t evt, uint8_t scriptType, bool allowLcdUsage)
         break;
       }
       UNPROTECT_LUA();
-      //todo gc step between scripts
     }
   }
-  luaDoGc(lsScripts, false);
-#if defined(COLORLCD)
-  luaDoGc(lsWidgets, false);
-#endif
   return scriptWasRun;
 }
 
 void checkLuaMemoryUsage()
 {
 #if (LUA_MEM_MAX > 0)
-  uint32_t totalMemUsed = luaGetMemUsed(lsScripts);
-#if defined(COLORLCD)
-  totalMemUsed += luaGetMemUsed(lsWidgets);
-  totalMemUsed += luaExtraMemoryUsage;
-#endif
+  uint32_t totalMemUsed = luaGetTotalMemUsed();
+  if (totalMemUsed > LUA_MEM_MAX) {
+    // the idle GC may be late, see what a full collection gives before giving up
+    luaFullGc();
+    totalMemUsed = luaGetTotalMemUsed();
+  }
   if (totalMemUsed > LUA_MEM_MAX) {
     TRACE("checkLuaMemoryUsage(): max limit reached (%u), killing Lua", totalMemUsed);
     // disable Lua scripts
@@ -998,13 +1254,12 @@ void luaInit()
   TRACE("luaInit");
 
   luaClose(&lsScripts);
+#if defined(LUA_COMPILER)
+  luaResetScriptsCache();
+#endif
 
   if (luaState != INTERPRETER_PANIC) {
-#if defined(USE_BIN_ALLOCATOR)
-    lsScripts = lua_newstate(bin_l_alloc, NULL);   //we use our own allocator!
-#else
-    lsScripts = lua_newstate(l_alloc, NULL);   //we use Lua default allocator
-#endif
+    lsScripts = lua_newstate(luaAlloc, NULL);
     if (lsScripts) {
       // install our panic handler
       lua_atpanic(lsScripts, &custom_lua_atpanic);
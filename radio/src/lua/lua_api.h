@@ -102,12 +102,27 @@ enum ScriptReference {
   SCRIPT_TELEMETRY_FIRST,
   SCRIPT_TELEMETRY_LAST=SCRIPT_TELEMETRY_FIRST+MAX_SCRIPTS, // telem0 and telem1 .. telem7
 };
+// CPU time a script may use on average per menu cycle before its background() calls are skipped,
+// and the debt it may accumulate at most (a script over its budget runs every few cycles only)
+#define LUA_SCRIPT_BUDGET_US      4000
+#define LUA_SCRIPT_MAX_DEBT_US    (8*LUA_SCRIPT_BUDGET_US)
+struct ScriptStats {
+  uint16_t lastDuration;    // us, last call
+  uint16_t maxDuration;     // us
+  uint32_t allocated;       // bytes allocated by all the calls
+  uint32_t gcDuration;      // us, share of the GC steps charged to the script
+  uint32_t gcAllocated;     // allocated when the GC was last charged
+  uint16_t runs;
+  uint16_t skips;           // background() calls skipped because the script was over its budget
+  int32_t credit;           // us, negative when the script is in debt
+};
 struct ScriptInternalData {
   uint8_t reference;
   uint8_t state;
   int run;
   int background;
   uint8_t instructions;
+  ScriptStats stats;
 };
 struct ScriptInputsOutputs {
   uint8_t inputsCount;
@@ -127,9 +142,11 @@ void luaClose(lua_State ** L);
 bool luaTask(event_t evt, uint8_t scriptType, bool allowLcdUsage);
 void checkLuaMemoryUsage();
 void luaExec(const char * filename);
-void luaDoGc(lua_State * L, bool full);
+bool luaDoGc(lua_State * L, bool full);
+void luaIdleGc(uint32_t budget);
 void luaError(lua_State * L, uint8_t error, bool acknowledge=true);
 uint32_t luaGetMemUsed(lua_State * L);
+void * luaAlloc(void * ud, void * ptr, size_t osize, size_t nsize);
 void luaGetValueAndPush(lua_State * L, int src);
 #define luaGetCpuUsed(idx) scriptInternalData[idx].instructions
 uint8_t isTelemetryScriptAvailable(uint8_t index);
@@ -151,6 +168,36 @@ extern struct our_longjmp * global_lj;
 
 extern uint16_t maxLuaInterval;
 extern uint16_t maxLuaDuration;
+extern uint16_t maxLuaGcDuration;
+
+// bin n counts the GC pauses from 2^n to 2^(n+1)-1 us, the first bin also counts 0us and the last one everything above
+#define LUA_GC_HISTOGRAM_SIZE  16
+struct LuaGcStats {
+  uint32_t steps;
+  uint32_t cycles;            // cycles finished by the idle GC
+  uint32_t pressureCycles;    // of which started early because of the memory pressure
+  uint32_t fullCollections;   // done when over LUA_MEM_MAX, before killing Lua
+  uint16_t histogram[LUA_GC_HISTOGRAM_SIZE];
+};
+extern LuaGcStats luaGcStats;
+extern uint32_t luaAllocatedBytes;
+
+// per script accounting of one call
+struct LuaCallAccounting {
+  uint16_t start2MHz;
+  tmr10ms_t start10ms;
+  uint32_t startAllocated;
+};
+void luaStartTimer(LuaCallAccounting & call);
+uint32_t luaGetElapsedTime(const LuaCallAccounting & call);
+void luaStartCall(LuaCallAccounting & call);
+void luaStopCall(const LuaCallAccounting & call, ScriptStats & stats);
+void luaRefillBudget(ScriptStats & stats);
+bool luaCheckBudget(ScriptStats & stats);
+#if defined(COLORLCD)
+void luaForEachWidgetStats(void (* callback)(const char * name, const ScriptStats & stats));
+void luaRefillWidgetsBudget();
+#endif
 
 #if defined(PCBTARANIS)
   #define IS_MASKABLE(key) ((key) != KEY_EXIT && (key) != KEY_ENTER && ((luaState & INTERPRETER_RUNNING_STANDALONE_SCRIPT) || (key) != KEY_PAGE))
@@ -167,6 +214,13 @@ void luaRegisterLibraries(lua_State * L);
 void registerBitmapClass(lua_State * L);
 void luaSetInstructionsLimit(lua_State* L, int count);
 int luaLoadScriptFileToState(lua_State * L, const char * filename, const char * mode);
+#if defined(LUA_COMPILER)
+int luaLoadCachedScript(lua_State * L, const char * path, bool debug);
+void luaSaveCachedScript(lua_State * L, const char * path, const FILINFO & finfo, int stripDebug);
+void luaCloseScriptsCache();
+void luaResetScriptsCache();
+void luaPrecompileScripts();
+#endif
 #else  // defined(LUA)
 #define luaInit()
 #define LUA_INIT_THEMES_AND_WIDGETS()
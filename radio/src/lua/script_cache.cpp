@@ -0,0 +1,550 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+/** @file Cache of the compiled Lua scripts, shared by all scripts. */
+
+#include <ctype.h>
+#include "opentx.h"
+#include "lua_api.h"
+#include "sdcard.h"
+
+extern "C" {
+  #include <lundump.h>
+}
+
+#if defined(LUA_COMPILER)
+
+#if defined(SIMU_USE_SDCARD)
+  #include <atomic>
+  #include <string>
+  #include <thread>
+  #include <vector>
+#endif
+
+/*
+  The bytecode of all scripts compiled from their source is appended to a single data file.
+  The index file maps the path of each script (without extension) and the date and size of its
+  source to a blob of the data file. A blob is the path, null terminated, followed by the
+  bytecode. Its CRC is checked before the bytecode is loaded, Lua does not verify bytecode.
+
+  The index is read once after luaResetScriptsCache() and rewritten after each new blob. Both
+  files are deleted when the index is full or the data file is too large, the scripts are
+  then compiled again as they are loaded.
+*/
+
+#define LUA_CACHE_VERSION         1
+#define LUA_CACHE_ENTRIES         64
+#define LUA_CACHE_MAX_SIZE        (512*1024)
+#define LUA_CACHE_STRIPPED        0x01  // no debug info in the bytecode
+
+PACK(struct LuaCacheHeader {
+  char     magic[3];
+  uint8_t  version;
+  uint8_t  bytecode[LUAC_HEADERSIZE];   // Lua bytecode header, identifies the platform
+  uint16_t count;
+  uint16_t crc;                         // of the entries
+});
+
+PACK(struct LuaCacheEntry {
+  uint32_t hash;      // of the script path
+  uint16_t fdate;     // of the source
+  uint16_t ftime;
+  uint32_t fsize;
+  uint32_t offset;    // of the blob in the data file
+  uint32_t size;
+  uint16_t crc;       // of the blob
+  uint8_t  flags;
+  uint8_t  spare;
+});
+
+LuaCacheEntry luaCacheEntries[LUA_CACHE_ENTRIES];
+uint8_t luaCacheCount = 0;
+bool luaCacheLoaded = false;
+
+#if defined(SIMU_USE_SDCARD)
+const uint8_t * luaCacheData = NULL;
+uint32_t luaCacheDataSize = 0;
+#else
+FIL luaCacheFile;
+bool luaCacheFileOpened = false;
+uint8_t luaCacheBuffer[256];
+#endif
+
+// FNV-1a, case insensitive as the FAT file names
+static uint32_t luaCacheHash(const char * path)
+{
+  uint32_t hash = 2166136261u;
+  while (*path) {
+    hash = (hash ^ (uint8_t)tolower(*path++)) * 16777619u;
+  }
+  return hash;
+}
+
+static void luaCacheHeader(LuaCacheHeader & header)
+{
+  memcpy(header.magic, "LCI", sizeof(header.magic));
+  header.version = LUA_CACHE_VERSION;
+  luaU_header(header.bytecode);
+  header.count = luaCacheCount;
+  header.crc = crc16((const uint8_t *)luaCacheEntries, luaCacheCount * sizeof(LuaCacheEntry));
+}
+
+static void luaCacheLoadIndex()
+{
+  if (luaCacheLoaded) {
+    return;
+  }
+
+  luaCacheLoaded = true;
+  luaCacheCount = 0;
+
+  FIL file;
+  if (f_open(&file, SCRIPTS_CACHE_INDEX, FA_OPEN_EXISTING | FA_READ) != FR_OK) {
+    return;
+  }
+
+  LuaCacheHeader header, expected;
+  UINT read;
+  if (f_read(&file, &header, sizeof(header), &read) == FR_OK && read == sizeof(header) && header.count <= LUA_CACHE_ENTRIES) {
+    luaCacheCount = header.count;
+    luaCacheHeader(expected);
+    uint32_t size = header.count * sizeof(LuaCacheEntry);
+    if (memcmp(&header, &expected, offsetof(LuaCacheHeader, count)) || f_read(&file, luaCacheEntries, size, &read) != FR_OK || read != size) {
+      luaCacheCount = 0;
+    }
+    else if (crc16((const uint8_t *)luaCacheEntries, size) != header.crc) {
+      TRACE_ERROR("luaCacheLoadIndex(): corrupted index");
+      luaCacheCount = 0;
+    }
+  }
+  f_close(&file);
+}
+
+static void luaCacheSaveIndex()
+{
+  FIL file;
+  if (f_open(&file, SCRIPTS_CACHE_INDEX, FA_CREATE_ALWAYS | FA_WRITE) == FR_OK) {
+    LuaCacheHeader header;
+    luaCacheHeader(header);
+    UINT written;
+    f_write(&file, &header, sizeof(header), &written);
+    f_write(&file, luaCacheEntries, luaCacheCount * sizeof(LuaCacheEntry), &written);
+    f_close(&file);
+  }
+}
+
+static LuaCacheEntry * luaCacheFind(uint32_t hash)
+{
+  for (int i=0; i<luaCacheCount; i++) {
+    if (luaCacheEntries[i].hash == hash) {
+      return &luaCacheEntries[i];
+    }
+  }
+  return NULL;
+}
+
+static void luaCacheRemove(LuaCacheEntry * entry)
+{
+  *entry = luaCacheEntries[--luaCacheCount];
+  luaCacheSaveIndex();
+}
+
+// the data file is read through a file kept opened, or a mapping on the simulator
+void luaCloseScriptsCache()
+{
+#if defined(SIMU_USE_SDCARD)
+  if (luaCacheData) {
+    simuUnmapFile(luaCacheData, luaCacheDataSize);
+    luaCacheData = NULL;
+  }
+#else
+  if (luaCacheFileOpened) {
+    f_close(&luaCacheFile);
+    luaCacheFileOpened = false;
+  }
+#endif
+}
+
+void luaResetScriptsCache()
+{
+  luaCloseScriptsCache();
+  luaCacheLoaded = false;
+}
+
+static bool luaCacheCheckPath(const uint8_t * blob, uint32_t size, const char * path)
+{
+  uint32_t len = strlen(path) + 1;
+  return size > len && !strncasecmp((const char *)blob, path, len);
+}
+
+#if defined(SIMU_USE_SDCARD)
+static int luaCacheLoadBlob(lua_State * L, const LuaCacheEntry & entry, const char * path, const char * chunkname)
+{
+  if (!luaCacheData) {
+    luaCacheData = simuMapFile(SCRIPTS_CACHE_DATA, &luaCacheDataSize);
+    if (!luaCacheData) {
+      return LUA_ERRFILE;
+    }
+  }
+
+  if (entry.offset + entry.size > luaCacheDataSize) {
+    return LUA_ERRFILE;
+  }
+
+  const uint8_t * blob = luaCacheData + entry.offset;
+  if (crc16(blob, entry.size) != entry.crc || !luaCacheCheckPath(blob, entry.size, path)) {
+    return LUA_ERRFILE;
+  }
+
+  uint32_t len = strlen(path) + 1;
+  return luaL_loadbufferx(L, (const char *)blob + len, entry.size - len, chunkname, "b");
+}
+#else
+struct LuaCacheReader {
+  uint32_t remaining;
+};
+
+static const char * luaCacheRead(lua_State * L, void * ud, size_t * size)
+{
+  LuaCacheReader * reader = (LuaCacheReader *)ud;
+  UINT read = 0;
+  if (reader->remaining == 0 || f_read(&luaCacheFile, luaCacheBuffer, min<uint32_t>(reader->remaining, sizeof(luaCacheBuffer)), &read) != FR_OK) {
+    *size = 0;
+    return NULL;
+  }
+  reader->remaining -= read;
+  *size = read;
+  return (const char *)luaCacheBuffer;
+}
+
+static int luaCacheLoadBlob(lua_State * L, const LuaCacheEntry & entry, const char * path, const char * chunkname)
+{
+  if (!luaCacheFileOpened) {
+    if (f_open(&luaCacheFile, SCRIPTS_CACHE_DATA, FA_OPEN_EXISTING | FA_READ) != FR_OK) {
+      return LUA_ERRFILE;
+    }
+    luaCacheFileOpened = true;
+  }
+
+  if (entry.offset + entry.size > f_size(&luaCacheFile) || f_lseek(&luaCacheFile, entry.offset) != FR_OK) {
+    return LUA_ERRFILE;
+  }
+
+  // first pass for the CRC, the second one comes from the disk cache
+  uint16_t crc = 0;
+  bool pathChecked = false;
+  for (uint32_t remaining = entry.size; remaining > 0; ) {
+    UINT read = 0;
+    if (f_read(&luaCacheFile, luaCacheBuffer, min<uint32_t>(remaining, sizeof(luaCacheBuffer)), &read) != FR_OK || read == 0) {
+      return LUA_ERRFILE;
+    }
+    if (!pathChecked) {
+      if (!luaCacheCheckPath(luaCacheBuffer, read, path)) {
+        return LUA_ERRFILE;
+      }
+      pathChecked = true;
+    }
+    crc = crc16(luaCacheBuffer, read, crc);
+    remaining -= read;
+  }
+  if (crc != entry.crc) {
+    return LUA_ERRFILE;
+  }
+
+  uint32_t len = strlen(path) + 1;
+  if (f_lseek(&luaCacheFile, entry.offset + len) != FR_OK) {
+    return LUA_ERRFILE;
+  }
+  LuaCacheReader reader = { entry.size - len };
+  return lua_load(L, luaCacheRead, &reader, chunkname, "b");
+}
+#endif
+
+/**
+  @fn luaLoadCachedScript(lua_State * L, const char * path, bool debug)
+
+  Load the cached bytecode of a script, when it was compiled from its current source.
+
+  @param path full path and file name of the script, without extension.
+  @param debug the bytecode must have debug info.
+
+  @retval LUA_OK on success, with the chunk pushed on the stack. Otherwise nothing is pushed.
+*/
+int luaLoadCachedScript(lua_State * L, const char * path, bool debug)
+{
+  luaCacheLoadIndex();
+
+  LuaCacheEntry * entry = luaCacheFind(luaCacheHash(path));
+  if (!entry || (debug && (entry->flags & LUA_CACHE_STRIPPED))) {
+    return LUA_ERRFILE;
+  }
+
+  char source[LEN_FILE_PATH_MAX + _MAX_LFN + sizeof(SCRIPT_EXT) + 1];
+  source[0] = '@';    // the chunk name of a file, as given by luaL_loadfilex()
+  strcpy(source+1, path);
+  strcat(source+1, SCRIPT_EXT);
+
+  FILINFO info;
+  if (f_stat(source+1, &info) != FR_OK || info.fdate != entry->fdate || info.ftime != entry->ftime || info.fsize != entry->fsize) {
+    return LUA_ERRFILE;
+  }
+
+  int result = luaCacheLoadBlob(L, *entry, path, source);
+  if (result != LUA_OK) {
+    TRACE_ERROR("luaLoadCachedScript(%s): invalid cache entry", path);
+    if (result != LUA_ERRFILE) {
+      lua_pop(L, 1);    // the error message
+    }
+    luaCacheRemove(entry);
+  }
+  return result;
+}
+
+struct LuaCacheWriter {
+  FIL file;
+  uint32_t size;
+  uint16_t crc;
+  bool error;
+};
+
+/// callback for luaU_dump()
+static int luaCacheWrite(lua_State * L, const void * p, size_t size, void * u)
+{
+  UNUSED(L);
+  LuaCacheWriter * writer = (LuaCacheWriter *)u;
+  UINT written = 0;
+  if (f_write(&writer->file, p, size, &written) != FR_OK || written != size) {
+    writer->error = true;
+    return 1;
+  }
+  writer->crc = crc16((const uint8_t *)p, size, writer->crc);
+  writer->size += size;
+  return 0;
+}
+
+static LuaCacheEntry * luaCacheBeginBlob(LuaCacheWriter & writer, const char * path)
+{
+  luaCacheLoadIndex();
+  luaCloseScriptsCache();
+
+  uint32_t hash = luaCacheHash(path);
+  LuaCacheEntry * entry = luaCacheFind(hash);
+  if (!entry) {
+    if (luaCacheCount >= LUA_CACHE_ENTRIES) {
+      luaCacheCount = 0;
+      f_unlink(SCRIPTS_CACHE_DATA);
+    }
+    entry = &luaCacheEntries[luaCacheCount];
+  }
+
+  if (f_open(&writer.file, SCRIPTS_CACHE_DATA, FA_OPEN_ALWAYS | FA_WRITE | FA_OPEN_APPEND) != FR_OK) {
+    return NULL;
+  }
+
+  if (f_size(&writer.file) > LUA_CACHE_MAX_SIZE) {
+    f_close(&writer.file);
+    luaCacheCount = 0;
+    entry = &luaCacheEntries[0];
+    if (f_open(&writer.file, SCRIPTS_CACHE_DATA, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK) {
+      return NULL;
+    }
+  }
+
+  entry->hash = 0;    // not valid until the blob is written
+  entry->offset = f_size(&writer.file);
+  writer.size = 0;
+  writer.crc = 0;
+  writer.error = false;
+  luaCacheWrite(NULL, path, strlen(path) + 1, &writer);
+  return entry;
+}
+
+static void luaCacheEndBlob(LuaCacheWriter & writer, LuaCacheEntry * entry, const char * path, const FILINFO & finfo, int stripDebug)
+{
+  if (f_close(&writer.file) != FR_OK || writer.error) {
+    TRACE_ERROR("luaSaveCachedScript(%s): write error", path);
+    return;
+  }
+
+  entry->hash = luaCacheHash(path);
+  entry->fdate = finfo.fdate;
+  entry->ftime = finfo.ftime;
+  entry->fsize = finfo.fsize;
+  entry->size = writer.size;
+  entry->crc = writer.crc;
+  entry->flags = (stripDebug ? LUA_CACHE_STRIPPED : 0);
+  entry->spare = 0;
+  if (entry == &luaCacheEntries[luaCacheCount]) {
+    luaCacheCount++;
+  }
+  luaCacheSaveIndex();
+}
+
+/**
+  @fn luaSaveCachedScript(lua_State * L, const char * path, const FILINFO & finfo, int stripDebug)
+
+  Save the bytecode of the chunk on top of the stack in the cache.
+
+  @param path full path and file name of the script, without extension.
+  @param finfo date and size of the source it was compiled from.
+  @param stripDebug passed directly to luaU_dump().
+*/
+void luaSaveCachedScript(lua_State * L, const char * path, const FILINFO & finfo, int stripDebug)
+{
+  LuaCacheWriter writer;
+  LuaCacheEntry * entry = luaCacheBeginBlob(writer, path);
+  if (entry) {
+    lua_lock(L);
+    luaU_dump(L, getproto(L->top - 1), luaCacheWrite, &writer, stripDebug);
+    lua_unlock(L);
+    luaCacheEndBlob(writer, entry, path, finfo, stripDebug);
+  }
+}
+
+#if defined(SIMU_USE_SDCARD)
+struct LuaPrecompiledScript {
+  std::string path;
+  FILINFO info;
+  std::string source;
+  std::string bytecode;
+  bool compiled;
+};
+
+static int luaPrecompileWrite(lua_State * L, const void * p, size_t size, void * u)
+{
+  UNUSED(L);
+  ((std::string *)u)->append((const char *)p, size);
+  return 0;
+}
+
+static void luaPrecompileFind(std::vector<LuaPrecompiledScript> & scripts, const char * directory, int depth)
+{
+  DIR dir;
+  FILINFO info;
+
+  if (f_opendir(&dir, directory) != FR_OK) {
+    return;
+  }
+
+  while (f_readdir(&dir, &info) == FR_OK && info.fname[0]) {
+    std::string path = std::string(directory) + "/" + info.fname;
+    if (info.fattrib & AM_DIR) {
+      if (depth > 0 && info.fname[0] != '.') {
+        luaPrecompileFind(scripts, path.c_str(), depth - 1);
+      }
+      continue;
+    }
+    int len = path.size() - (sizeof(SCRIPT_EXT) - 1);
+    if (len <= 0 || strcasecmp(path.c_str() + len, SCRIPT_EXT)) {
+      continue;
+    }
+    LuaPrecompiledScript script;
+    script.path = path.substr(0, len);
+    script.compiled = false;
+    if (f_stat(path.c_str(), &script.info) == FR_OK) {
+      scripts.push_back(script);
+    }
+  }
+  f_closedir(&dir);
+}
+
+/*
+  Compile all scripts of the SD card which are not in the cache yet, on all host cores, before
+  the simulated radio starts. Each thread has its own Lua state, the files are read and the cache
+  is written by the calling thread.
+*/
+void luaPrecompileScripts()
+{
+  std::vector<LuaPrecompiledScript> scripts;
+  luaPrecompileFind(scripts, SCRIPTS_PATH, 2);
+#if defined(COLORLCD)
+  luaPrecompileFind(scripts, WIDGETS_PATH, 1);
+  luaPrecompileFind(scripts, THEMES_PATH, 1);
+#endif
+
+  luaResetScriptsCache();
+  luaCacheLoadIndex();
+
+  int stripDebug = (strpbrk(LUA_SCRIPT_LOAD_MODE, "Td") ? 0 : 1);
+  std::vector<LuaPrecompiledScript *> jobs;
+  for (LuaPrecompiledScript & script : scripts) {
+    LuaCacheEntry * entry = luaCacheFind(luaCacheHash(script.path.c_str()));
+    if (entry && entry->fdate == script.info.fdate && entry->ftime == script.info.ftime && entry->fsize == script.info.fsize) {
+      continue;
+    }
+    FIL file;
+    if (f_open(&file, (script.path + SCRIPT_EXT).c_str(), FA_OPEN_EXISTING | FA_READ) == FR_OK) {
+      UINT read = 0;
+      script.source.resize(f_size(&file));
+      if (f_read(&file, &script.source[0], script.source.size(), &read) == FR_OK && read == script.source.size()) {
+        jobs.push_back(&script);
+      }
+      f_close(&file);
+    }
+  }
+
+  if (jobs.empty()) {
+    return;
+  }
+
+  std::atomic<unsigned> next(0);
+  auto worker = [&]() {
+    for (unsigned i = next++; i < jobs.size(); i = next++) {
+      LuaPrecompiledScript & script = *jobs[i];
+      lua_State * L = luaL_newstate();
+      if (!L) {
+        continue;
+      }
+      std::string chunkname = "@" + script.path + SCRIPT_EXT;
+      if (luaL_loadbufferx(L, script.source.data(), script.source.size(), chunkname.c_str(), "t") == LUA_OK) {
+        lua_lock(L);
+        luaU_dump(L, getproto(L->top - 1), luaPrecompileWrite, &script.bytecode, stripDebug);
+        lua_unlock(L);
+        script.compiled = true;
+      }
+      lua_close(L);
+    }
+  };
+
+  unsigned count = std::max(1u, std::min<unsigned>(std::thread::hardware_concurrency(), jobs.size()));
+  std::vector<std::thread> threads;
+  for (unsigned i = 1; i < count; i++) {
+    threads.push_back(std::thread(worker));
+  }
+  worker();
+  for (std::thread & thread : threads) {
+    thread.join();
+  }
+
+  for (LuaPrecompiledScript * script : jobs) {
+    if (script->compiled) {
+      LuaCacheWriter writer;
+      LuaCacheEntry * entry = luaCacheBeginBlob(writer, script->path.c_str());
+      if (entry) {
+        luaCacheWrite(NULL, script->bytecode.data(), script->bytecode.size(), &writer);
+        luaCacheEndBlob(writer, entry, script->path.c_str(), script->info, stripDebug);
+      }
+    }
+  }
+  TRACE("luaPrecompileScripts(): %d scripts compiled", (int)jobs.size());
+}
+#endif
+
+#endif // defined(LUA_COMPILER)
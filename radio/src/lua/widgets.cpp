@@ -271,6 +271,8 @@ void l_pushtableint(const char * key, int value)
 class LuaWidgetFactory: public WidgetFactory
 {
   friend void luaLoadWidgetCallback();
+  friend void luaForEachWidgetStats(void (* callback)(const char * name, const ScriptStats & stats));
+  friend void luaRefillWidgetsBudget();
   friend class LuaWidget;
 
   public:
@@ -281,6 +283,7 @@ class LuaWidgetFactory: public WidgetFactory
       refreshFunction(0),
       backgroundFunction(0)
     {
+      memclear(&stats, sizeof(stats));
     }
 
     virtual Widget * create(const Zone & zone, Widget::PersistentData * persistentData, bool init=true) const
@@ -318,8 +321,26 @@ class LuaWidgetFactory: public WidgetFactory
     int updateFunction;
     int refreshFunction;
     int backgroundFunction;
+    ScriptStats stats;    // shared by all the instances of the widget
 };
 
+static std::list<LuaWidgetFactory *> luaWidgetFactories;
+
+void luaForEachWidgetStats(void (* callback)(const char * name, const ScriptStats & stats))
+{
+  for (std::list<LuaWidgetFactory *>::const_iterator it = luaWidgetFactories.begin(); it != luaWidgetFactories.end(); ++it) {
+    callback((*it)->getName(), (*it)->stats);
+  }
+}
+
+// called once per menu cycle, the instances of a widget share its budget
+void luaRefillWidgetsBudget()
+{
+  for (std::list<LuaWidgetFactory *>::const_iterator it = luaWidgetFactories.begin(); it != luaWidgetFactories.end(); ++it) {
+    luaRefillBudget((*it)->stats);
+  }
+}
+
 void LuaWidget::update()
 {
   if (lsWidgets == 0 || errorMessage) return;
@@ -359,6 +380,7 @@ const char * LuaWidget::getErrorMessage() const
 void LuaWidget::refresh()
 {
   if (lsWidgets == 0) return;
+  DISK_CACHE_CONSUMER(DISK_CACHE_LUA);
 
   if (errorMessage) {
     lcdSetColor(RED);
@@ -370,23 +392,30 @@ void LuaWidget::refresh()
   LuaWidgetFactory * factory = (LuaWidgetFactory *)this->factory;
   lua_rawgeti(lsWidgets, LUA_REGISTRYINDEX, factory->refreshFunction);
   lua_rawgeti(lsWidgets, LUA_REGISTRYINDEX, widgetData);
+  LuaCallAccounting call;
+  luaStartCall(call);
   if (lua_pcall(lsWidgets, 1, 0, 0) != 0) {
     setErrorMessage("refresh()");
   }
+  luaStopCall(call, factory->stats);
 }
 
 void LuaWidget::background()
 {
   if (lsWidgets == 0 || errorMessage) return;
+  DISK_CACHE_CONSUMER(DISK_CACHE_LUA);
 
   luaSetInstructionsLimit(lsWidgets, WIDGET_SCRIPTS_MAX_INSTRUCTIONS);
   LuaWidgetFactory * factory = (LuaWidgetFactory *)this->factory;
-  if (factory->backgroundFunction) {
+  if (factory->backgroundFunction && luaCheckBudget(factory->stats)) {
     lua_rawgeti(lsWidgets, LUA_REGISTRYINDEX, factory->backgroundFunction);
     lua_rawgeti(lsWidgets, LUA_REGISTRYINDEX, widgetData);
+    LuaCallAccounting call;
+    luaStartCall(call);
     if (lua_pcall(lsWidgets, 1, 0, 0) != 0) {
       setErrorMessage("background()");
     }
+    luaStopCall(call, factory->stats);
   }
 }
 
@@ -432,6 +461,7 @@ void luaLoadWidgetCallback()
       factory->updateFunction = updateFunction;
       factory->refreshFunction = refreshFunction;
       factory->backgroundFunction = backgroundFunction;
+      luaWidgetFactories.push_back(factory);
       TRACE("Loaded Lua widget %s", name);
     }
   }
@@ -502,11 +532,7 @@ void luaInitThemesAndWidgets()
 {
   TRACE("luaInitThemesAndWidgets");
 
-#if defined(USE_BIN_ALLOCATOR)
-  lsWidgets = lua_newstate(bin_l_alloc, NULL);   //we use our own allocator!
-#else
-  lsWidgets = lua_newstate(l_alloc, NULL);   //we use Lua default allocator
-#endif
+  lsWidgets = lua_newstate(luaAlloc, NULL);
   if (lsWidgets) {
     // install our panic handler
     lua_atpanic(lsWidgets, &custom_lua_atpanic);
@@ -526,6 +552,9 @@ void luaInitThemesAndWidgets()
     TRACE("lsWidgets %p", lsWidgets);
     luaLoadFiles(THEMES_PATH, luaLoadThemeCallback);
     luaLoadFiles(WIDGETS_PATH, luaLoadWidgetCallback);
+#if defined(LUA_COMPILER)
+    luaCloseScriptsCache();
+#endif
     luaDoGc(lsWidgets, true);
   }
 }
@@ -175,6 +175,7 @@ void guiMain(event_t evt)
   DEBUG_TIMER_START(debugTimerLuaBg);
   luaTask(0, RUN_MIX_SCRIPT | RUN_FUNC_SCRIPT | RUN_TELEM_BG_SCRIPT, false);
   DEBUG_TIMER_STOP(debugTimerLuaBg);
+  luaRefillWidgetsBudget();
   // wait for LCD DMA to finish before continuing, because code from this point
   // is allowed to change the contents of LCD buffer
   //
@@ -386,6 +387,7 @@ void perMain()
   handleUsbConnection();
   checkTrainerSettings();
   periodicTick();
+  updateCurvesCache();
   DEBUG_TIMER_STOP(debugTimerPerMain1);
 
   if (mainRequestFlags & (1 << REQUEST_FLIGHT_RESET)) {
@@ -394,6 +396,11 @@ void perMain()
     mainRequestFlags &= ~(1 << REQUEST_FLIGHT_RESET);
   }
 
+  if (mainRequestFlags & (1 << REQUEST_MODEL_CACHES_INVALIDATION)) {
+    invalidateModelCaches();
+    mainRequestFlags &= ~(1 << REQUEST_MODEL_CACHES_INVALIDATION);
+  }
+
   event_t evt = getEvent(false);
   if (evt && (g_eeGeneral.backlightMode & e_backlight_mode_keys)) {
     // on keypress turn the light on
@@ -582,6 +582,410 @@ int getSourceTrimValue(int source, int stickValue=0)
 }
 #endif
 
+#if defined(CPUARM)
+#define MIXER_PLAN_MULTIPASS  0xFF // the lines of this flight mode can't be ordered, use the multi-pass evaluation
+
+struct MixerPlan {
+  bool valid;
+  uint8_t count[MAX_FLIGHT_MODES];
+  uint8_t lines[MAX_FLIGHT_MODES][MAX_MIXERS]; // mixer lines grouped by channel, channels sources first
+};
+
+static MixerPlan mixerPlan;
+
+void invalidateMixerPlan()
+{
+  mixerPlan.valid = false;
+}
+
+// a line disabled by the flight mode has no effect unless a delay or a slow down is pending on it
+static bool isMixerLineActiveInFlightMode(const MixData * md, uint8_t fm)
+{
+  if (!(md->flightModes & (1 << fm)))
+    return true;
+  if (md->delayUp || md->delayDown)
+    return true;
+  return (md->speedUp || md->speedDown) && md->mltpx != MLTPX_REP;
+}
+
+static uint8_t compileFlightModeMixerPlan(uint8_t fm, uint8_t linesCount, const uint8_t * firstLine, uint8_t * lines)
+{
+  bitfield_channels_t activeChannels = 0;
+  bitfield_channels_t dependencies[MAX_OUTPUT_CHANNELS];
+  memclear(dependencies, sizeof(dependencies));
+
+  for (uint8_t i=0; i<linesCount; i++) {
+    MixData * md = mixAddress(i);
+    if (isMixerLineActiveInFlightMode(md, fm)) {
+      activeChannels |= (bitfield_channels_t)1 << md->destCh;
+      if (md->srcRaw >= MIXSRC_CH1 && md->srcRaw <= MIXSRC_LAST_CH && md->srcRaw-MIXSRC_CH1 != md->destCh) {
+        dependencies[md->destCh] |= (bitfield_channels_t)1 << (md->srcRaw-MIXSRC_CH1);
+      }
+    }
+  }
+
+  // channels without any active line stay at 0, they are ready from the start
+  bitfield_channels_t done = ~activeChannels;
+  uint8_t count = 0;
+
+  while (activeChannels & ~done) {
+    bool progress = false;
+    for (uint8_t ch=0; ch<MAX_OUTPUT_CHANNELS; ch++) {
+      bitfield_channels_t mask = (bitfield_channels_t)1 << ch;
+      if ((done & mask) || (dependencies[ch] & ~done)) {
+        continue;
+      }
+      for (uint8_t i=firstLine[ch]; i<linesCount && mixAddress(i)->destCh==ch; i++) {
+        if (isMixerLineActiveInFlightMode(mixAddress(i), fm)) {
+          lines[count++] = i;
+        }
+      }
+      done |= mask;
+      progress = true;
+    }
+    if (!progress) {
+      // channels loop
+      return MIXER_PLAN_MULTIPASS;
+    }
+  }
+
+  return count;
+}
+
+void compileMixerPlan()
+{
+  uint8_t firstLine[MAX_OUTPUT_CHANNELS];
+  bitfield_channels_t usedChannels = 0;
+  uint8_t linesCount = 0;
+  bool contiguous = true;
+
+  // set first, a model change during the compilation will invalidate the plan again
+  mixerPlan.valid = true;
+
+  for (; linesCount<MAX_MIXERS; linesCount++) {
+    MixData * md = mixAddress(linesCount);
+    if (md->srcRaw == 0) break;
+    bitfield_channels_t mask = (bitfield_channels_t)1 << md->destCh;
+    if (linesCount == 0 || md->destCh != (md-1)->destCh) {
+      if (usedChannels & mask) {
+        contiguous = false;
+      }
+      usedChannels |= mask;
+      firstLine[md->destCh] = linesCount;
+    }
+  }
+
+  for (uint8_t fm=0; fm<MAX_FLIGHT_MODES; fm++) {
+    if (contiguous)
+      mixerPlan.count[fm] = compileFlightModeMixerPlan(fm, linesCount, firstLine, mixerPlan.lines[fm]);
+    else
+      mixerPlan.count[fm] = MIXER_PLAN_MULTIPASS;
+  }
+}
+#endif
+
+// freshChannels: channels whose chans[] value is final for this pass, other channel sources are read from ex_chans
+static void evalMixerLine(uint8_t i, uint8_t mode, uint8_t tick10ms, bitfield_channels_t freshChannels, bitfield_channels_t dirtyChannels, bitfield_channels_t & passDirtyChannels, uint8_t & lv_mixWarning)
+{
+  MixData * md = mixAddress(i);
+
+  mixsrc_t stickIndex = md->srcRaw - MIXSRC_Rud;
+
+  // if this is the first calculation for the destination channel, initialize it with 0 (otherwise would be random)
+  if (i == 0 || md->destCh != (md-1)->destCh) {
+    chans[md->destCh] = 0;
+  }
+
+  //========== PHASE && SWITCH =====
+  bool mixCondition = (md->flightModes != 0 || md->swtch);
+  delayval_t mixEnabled = (!(md->flightModes & (1 << mixerCurrentFlightMode)) && getSwitch(md->swtch)) ? DELAY_POS_MARGIN+1 : 0;
+
+#define MIXER_LINE_DISABLE()   (mixCondition = true, mixEnabled = 0)
+
+  if (mixEnabled && md->srcRaw >= MIXSRC_FIRST_TRAINER && md->srcRaw <= MIXSRC_LAST_TRAINER && !IS_TRAINER_INPUT_VALID()) {
+    MIXER_LINE_DISABLE();
+  }
+
+#if defined(LUA_MODEL_SCRIPTS)
+  // disable mixer if Lua script is used as source and script was killed
+  if (mixEnabled && md->srcRaw >= MIXSRC_FIRST_LUA && md->srcRaw <= MIXSRC_LAST_LUA) {
+    div_t qr = div(md->srcRaw-MIXSRC_FIRST_LUA, MAX_SCRIPT_OUTPUTS);
+    if (scriptInternalData[qr.quot].state != SCRIPT_OK) {
+      MIXER_LINE_DISABLE();
+    }
+  }
+#endif
+
+  //========== VALUE ===============
+  getvalue_t v = 0;
+  if (mode > e_perout_mode_inactive_flight_mode) {
+#if defined(VIRTUAL_INPUTS)
+    if (!mixEnabled) {
+      return;
+    }
+    else {
+      v = getValue(md->srcRaw);
+    }
+#else
+    if (!mixEnabled || stickIndex >= NUM_STICKS || (stickIndex == THR_STICK && g_model.thrTrim)) {
+      return;
+    }
+    else {
+      if (!(mode & e_perout_mode_nosticks)) v = anas[stickIndex];
+    }
+#endif
+  }
+  else {
+#if !defined(VIRTUAL_INPUTS)
+    if (stickIndex < NUM_STICKS) {
+      v = md->noExpo ? rawAnas[stickIndex] : anas[stickIndex];
+    }
+    else
+#endif
+    {
+      mixsrc_t srcRaw = MIXSRC_Rud + stickIndex;
+      v = getValue(srcRaw);
+      srcRaw -= MIXSRC_CH1;
+      if (srcRaw<=MIXSRC_LAST_CH-MIXSRC_CH1 && md->destCh != srcRaw) {
+        if (dirtyChannels & ((bitfield_channels_t)1 << srcRaw) & (passDirtyChannels|~(((bitfield_channels_t) 1 << md->destCh)-1)))
+          passDirtyChannels |= (bitfield_channels_t) 1 << md->destCh;
+        if (freshChannels & ((bitfield_channels_t)1 << srcRaw))
+          v = chans[srcRaw] >> 8;
+      }
+    }
+    if (!mixCondition) {
+      mixEnabled = v >> DELAY_POS_SHIFT;
+    }
+  }
+
+  bool apply_offset_and_curve = true;
+
+  //========== DELAYS ===============
+  delayval_t _swOn = swOn[i].now;
+  delayval_t _swPrev = swOn[i].prev;
+  bool swTog = (mixEnabled > _swOn+DELAY_POS_MARGIN || mixEnabled < _swOn-DELAY_POS_MARGIN);
+  if (mode==e_perout_mode_normal && swTog) {
+    if (!swOn[i].delay) _swPrev = _swOn;
+    swOn[i].delay = (mixEnabled > _swOn ? md->delayUp : md->delayDown) * (100/DELAY_STEP);
+    swOn[i].now = mixEnabled;
+    swOn[i].prev = _swPrev;
+  }
+  if (mode==e_perout_mode_normal && swOn[i].delay > 0) {
+    swOn[i].delay = max<int16_t>(0, (int16_t)swOn[i].delay - tick10ms);
+    if (!mixCondition)
+      v = _swPrev << DELAY_POS_SHIFT;
+    else if (mixEnabled)
+      return;
+  }
+  else {
+    if (mode==e_perout_mode_normal) {
+      swOn[i].now = swOn[i].prev = mixEnabled;
+    }
+    if (!mixEnabled) {
+      if ((md->speedDown || md->speedUp) && md->mltpx!=MLTPX_REP) {
+        if (mixCondition) {
+          v = (md->mltpx == MLTPX_ADD ? 0 : RESX);
+          apply_offset_and_curve = false;
+        }
+      }
+      else if (mixCondition) {
+        return;
+      }
+    }
+  }
+
+  if (mode==e_perout_mode_normal && (!mixCondition || mixEnabled || swOn[i].delay)) {
+    if (md->mixWarn) lv_mixWarning |= 1 << (md->mixWarn - 1);
+#if defined(BOLD_FONT)
+    swOn[i].activeMix = true;
+#endif
+  }
+
+  if (apply_offset_and_curve) {
+
+    //========== TRIMS ================
+    if (!(mode & e_perout_mode_notrims)) {
+#if defined(VIRTUAL_INPUTS)
+      if (md->carryTrim == 0) {
+        v += getSourceTrimValue(md->srcRaw, v);
+      }
+#else
+      int8_t mix_trim = md->carryTrim;
+      if (mix_trim < TRIM_ON)
+        mix_trim = -mix_trim - 1;
+      else if (mix_trim == TRIM_ON && stickIndex < NUM_STICKS)
+        mix_trim = stickIndex;
+      else
+        mix_trim = -1;
+      if (mix_trim >= 0) {
+        int16_t trim = trims[mix_trim];
+        if (mix_trim == THR_STICK && g_model.throttleReversed)
+          v -= trim;
+        else
+          v += trim;
+      }
+#endif
+    }
+  }
+
+#if defined(CPUARM)
+  int32_t weight = GET_GVAR_PREC1(MD_WEIGHT(md), GV_RANGELARGE_NEG, GV_RANGELARGE, mixerCurrentFlightMode);
+  weight = calc100to256_16Bits(weight);
+#else
+  // saves 12 bytes code if done here and not together with weight; unknown reason
+  int16_t weight = GET_GVAR(MD_WEIGHT(md), GV_RANGELARGE_NEG, GV_RANGELARGE, mixerCurrentFlightMode);
+  weight = calc100to256_16Bits(weight);
+#endif
+  //========== SPEED ===============
+  // now its on input side, but without weight compensation. More like other remote controls
+  // lower weight causes slower movement
+
+  if (mode <= e_perout_mode_inactive_flight_mode && (md->speedUp || md->speedDown)) { // there are delay values
+#define DEL_MULT_SHIFT 8
+    // we recale to a mult 256 higher value for calculation
+    int32_t tact = act[i];
+    int16_t diff = v - (tact>>DEL_MULT_SHIFT);
+    if (diff) {
+      // open.20.fsguruh: speed is defined in % movement per second; In menu we specify the full movement (-100% to 100%) = 200% in total
+      // the unit of the stored value is the value from md->speedUp or md->speedDown divide SLOW_STEP seconds; e.g. value 4 means 4/SLOW_STEP = 2 seconds for CPU64
+      // because we get a tick each 10msec, we need 100 ticks for one second
+      // the value in md->speedXXX gives the time it should take to do a full movement from -100 to 100 therefore 200%. This equals 2048 in recalculated internal range
+      if (tick10ms || !s_mixer_first_run_done) {
+        // only if already time is passed add or substract a value according the speed configured
+        int32_t rate = (int32_t) tick10ms << (DEL_MULT_SHIFT+11);  // = DEL_MULT*2048*tick10ms
+        // rate equals a full range for one second; if less time is passed rate is accordingly smaller
+        // if one second passed, rate would be 2048 (full motion)*256(recalculated weight)*100(100 ticks needed for one second)
+        int32_t currentValue = ((int32_t) v<<DEL_MULT_SHIFT);
+        if (diff > 0) {
+          if (s_mixer_first_run_done && md->speedUp > 0) {
+            // if a speed upwards is defined recalculate the new value according configured speed; the higher the speed the smaller the add value is
+            int32_t newValue = tact+rate/((int16_t)(100/SLOW_STEP)*md->speedUp);
+            if (newValue<currentValue) currentValue = newValue; // Endposition; prevent toggling around the destination
+          }
+        }
+        else {  // if is <0 because ==0 is not possible
+          if (s_mixer_first_run_done && md->speedDown > 0) {
+            // see explanation in speedUp
+            int32_t newValue = tact-rate/((int16_t)(100/SLOW_STEP)*md->speedDown);
+            if (newValue>currentValue) currentValue = newValue; // Endposition; prevent toggling around the destination
+          }
+        }
+        act[i] = tact = currentValue;
+        // open.20.fsguruh: this implementation would save about 50 bytes code
+      } // endif tick10ms ; in case no time passed assign the old value, not the current value from source
+      v = (tact >> DEL_MULT_SHIFT);
+    }
+  }
+
+  //========== CURVES ===============
+#if defined(CPUARM)
+  if (apply_offset_and_curve && md->curve.type != CURVE_REF_DIFF && md->curve.value) {
+    v = applyCurve(v, md->curve);
+  }
+#else
+  if (apply_offset_and_curve && md->curveParam && md->curveMode == MODE_CURVE) {
+    v = applyCurve(v, md->curveParam);
+  }
+#endif
+
+  //========== WEIGHT ===============
+  int32_t dv = (int32_t)v * weight;
+#if defined(CPUARM)
+  dv = div_and_round(dv, 10);
+#endif
+
+  //========== OFFSET / AFTER ===============
+  if (apply_offset_and_curve) {
+#if defined(CPUARM)
+    int32_t offset = GET_GVAR_PREC1(MD_OFFSET(md), GV_RANGELARGE_NEG, GV_RANGELARGE, mixerCurrentFlightMode);
+    if (offset) dv += div_and_round(calc100toRESX_16Bits(offset), 10) << 8;
+#else
+    int16_t offset = GET_GVAR(MD_OFFSET(md), GV_RANGELARGE_NEG, GV_RANGELARGE, mixerCurrentFlightMode);
+    if (offset) dv += int32_t(calc100toRESX_16Bits(offset)) << 8;
+#endif
+  }
+
+  //========== DIFFERENTIAL =========
+#if defined(CPUARM)
+  if (md->curve.type == CURVE_REF_DIFF && md->curve.value) {
+    dv = applyCurve(dv, md->curve);
+  }
+#else
+  if (md->curveMode == MODE_DIFFERENTIAL) {
+    // @@@2 also recalculate curveParam to a 256 basis which ease the calculation later a lot
+    int16_t curveParam = calc100to256(GET_GVAR(md->curveParam, -100, 100, mixerCurrentFlightMode));
+    if (curveParam > 0 && dv < 0)
+      dv = (dv * (256 - curveParam)) >> 8;
+    else if (curveParam < 0 && dv > 0)
+      dv = (dv * (256 + curveParam)) >> 8;
+  }
+#endif
+
+  int32_t * ptr = &chans[md->destCh]; // Save calculating address several times
+
+  switch (md->mltpx) {
+    case MLTPX_REP:
+      *ptr = dv;
+#if defined(BOLD_FONT)
+      if (mode==e_perout_mode_normal) {
+        for (uint8_t m=i-1; m<MAX_MIXERS && mixAddress(m)->destCh==md->destCh; m--)
+          swOn[m].activeMix = false;
+      }
+#endif
+      break;
+    case MLTPX_MUL:
+      // @@@2 we have to remove the weight factor of 256 in case of 100%; now we use the new base of 256
+      dv >>= 8;
+      dv *= *ptr;
+      dv >>= RESX_SHIFT;   // same as dv /= RESXl;
+      *ptr = dv;
+      break;
+    default: // MLTPX_ADD
+      *ptr += dv; //Mixer output add up to the line (dv + (dv>0 ? 100/2 : -100/2))/(100);
+      break;
+  } //endswitch md->mltpx
+#ifdef PREVENT_ARITHMETIC_OVERFLOW
+/*
+  // a lot of assumptions must be true, for this kind of check; not really worth for only 4 bytes flash savings
+  // this solution would save again 4 bytes flash
+  int8_t testVar=(*ptr<<1)>>24;
+  if ( (testVar!=-1) && (testVar!=0 ) ) {
+    // this devices by 64 which should give a good balance between still over 100% but lower then 32x100%; should be OK
+    *ptr >>= 6;  // this is quite tricky, reduces the value a lot but should be still over 100% and reduces flash need
+  } */
+
+
+  PACK( union u_int16int32_t {
+    struct {
+      int16_t lo;
+      int16_t hi;
+    } words_t;
+    int32_t dword;
+  });
+
+  u_int16int32_t tmp;
+  tmp.dword=*ptr;
+
+  if (tmp.dword<0) {
+    if ((tmp.words_t.hi&0xFF80)!=0xFF80) tmp.words_t.hi=0xFF86; // set to min nearly
+  }
+  else {
+    if ((tmp.words_t.hi|0x007F)!=0x007F) tmp.words_t.hi=0x0079; // set to max nearly
+  }
+  *ptr = tmp.dword;
+  // this implementation saves 18bytes flash
+
+/*      dv=*ptr>>8;
+  if (dv>(32767-RESXl)) {
+    *ptr=(32767-RESXl)<<8;
+  } else if (dv<(-32767+RESXl)) {
+    *ptr=(-32767+RESXl)<<8;
+  }*/
+  // *ptr=limit( int32_t(int32_t(-1)<<23), *ptr, int32_t(int32_t(1)<<23));  // limit code cost 72 bytes
+  // *ptr=limit( int32_t((-32767+RESXl)<<8), *ptr, int32_t((32767-RESXl)<<8));  // limit code cost 80 bytes
+#endif
+}
+
 uint8_t mixerCurrentFlightMode;
 void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms)
 {
@@ -678,6 +1082,33 @@ void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms)
   //========== MIXER LOOP ===============
   uint8_t lv_mixWarning = 0;
 
+#if defined(BOLD_FONT)
+  if (mode == e_perout_mode_normal) {
+    for (uint8_t i=0; i<MAX_MIXERS; i++) {
+      swOn[i].activeMix = 0;
+      if (mixAddress(i)->srcRaw == 0) break;
+    }
+  }
+#endif
+
+#if defined(CPUARM)
+  if (!mixerPlan.valid) {
+    compileMixerPlan();
+  }
+
+  uint8_t count = mixerPlan.count[mixerCurrentFlightMode];
+  if (count != MIXER_PLAN_MULTIPASS) {
+    // single pass: the plan computes every channel before the lines using it as a source
+    bitfield_channels_t passDirtyChannels = 0;
+    const uint8_t * lines = mixerPlan.lines[mixerCurrentFlightMode];
+    for (uint8_t n=0; n<count; n++) {
+      evalMixerLine(lines[n], mode, tick10ms, (bitfield_channels_t)-1, 0, passDirtyChannels, lv_mixWarning);
+    }
+    mixWarning = lv_mixWarning;
+    return;
+  }
+#endif
+
   uint8_t pass = 0;
 
   bitfield_channels_t dirtyChannels = (bitfield_channels_t)-1; // all dirty when mixer starts
@@ -687,332 +1118,234 @@ void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms)
     bitfield_channels_t passDirtyChannels = 0;
 
     for (uint8_t i=0; i<MAX_MIXERS; i++) {
+      MixData * md = mixAddress(i);
 
-#if defined(BOLD_FONT)
-      if (mode==e_perout_mode_normal && pass==0) swOn[i].activeMix = 0;
-#endif
+      if (md->srcRaw == 0) break;
 
-      MixData *md = mixAddress(i);
+      if (!(dirtyChannels & ((bitfield_channels_t)1 << md->destCh))) continue;
 
-      if (md->srcRaw == 0) break;
+      // on the first pass only the channels before the destination channel are up to date
+      bitfield_channels_t freshChannels = (pass > 0 ? (bitfield_channels_t)-1 : ((bitfield_channels_t)1 << md->destCh) - 1);
+      evalMixerLine(i, mode, tick10ms, freshChannels, dirtyChannels, passDirtyChannels, lv_mixWarning);
+    }
 
-      mixsrc_t stickIndex = md->srcRaw - MIXSRC_Rud;
+    tick10ms = 0;
+    dirtyChannels &= passDirtyChannels;
 
-      if (!(dirtyChannels & ((bitfield_channels_t)1 << md->destCh))) continue;
+  } while (++pass < 5 && dirtyChannels);
 
-      // if this is the first calculation for the destination channel, initialize it with 0 (otherwise would be random)
-      if (i == 0 || md->destCh != (md-1)->destCh) {
-        chans[md->destCh] = 0;
-      }
 
-      //========== PHASE && SWITCH =====
-      bool mixCondition = (md->flightModes != 0 || md->swtch);
-      delayval_t mixEnabled = (!(md->flightModes & (1 << mixerCurrentFlightMode)) && getSwitch(md->swtch)) ? DELAY_POS_MARGIN+1 : 0;
+  mixWarning = lv_mixWarning;
+}
 
-#define MIXER_LINE_DISABLE()   (mixCondition = true, mixEnabled = 0)
+int32_t sum_chans512[MAX_OUTPUT_CHANNELS] = {0};
 
-      if (mixEnabled && md->srcRaw >= MIXSRC_FIRST_TRAINER && md->srcRaw <= MIXSRC_LAST_TRAINER && !IS_TRAINER_INPUT_VALID()) {
-        MIXER_LINE_DISABLE();
-      }
 
-#if defined(LUA_MODEL_SCRIPTS)
-      // disable mixer if Lua script is used as source and script was killed
-      if (mixEnabled && md->srcRaw >= MIXSRC_FIRST_LUA && md->srcRaw <= MIXSRC_LAST_LUA) {
-        div_t qr = div(md->srcRaw-MIXSRC_FIRST_LUA, MAX_SCRIPT_OUTPUTS);
-        if (scriptInternalData[qr.quot].state != SCRIPT_OK) {
-          MIXER_LINE_DISABLE();
-        }
-      }
+#define MAX_ACT 0xffff
+uint8_t lastFlightMode = 255; // TODO reinit everything here when the model changes, no???
+
+#if defined(CPUARM)
+tmr10ms_t flightModeTransitionTime;
+uint8_t   flightModeTransitionLast = 255;
 #endif
 
-      //========== VALUE ===============
-      getvalue_t v = 0;
-      if (mode > e_perout_mode_inactive_flight_mode) {
-#if defined(VIRTUAL_INPUTS)
-        if (!mixEnabled) {
-          continue;
-        }
-        else {
-          v = getValue(md->srcRaw);
-        }
+#if defined(CPUARM) && defined(VIRTUAL_INPUTS)
+#if defined(GVARS)
+  #define IS_GVAR_FIELD(x, min, max)  GV_IS_GV_VALUE(x, min, max)
 #else
-        if (!mixEnabled || stickIndex >= NUM_STICKS || (stickIndex == THR_STICK && g_model.thrTrim)) {
-          continue;
-        }
-        else {
-          if (!(mode & e_perout_mode_nosticks)) v = anas[stickIndex];
-        }
+  #define IS_GVAR_FIELD(x, min, max)  false
 #endif
-      }
-      else {
-#if !defined(VIRTUAL_INPUTS)
-        if (stickIndex < NUM_STICKS) {
-          v = md->noExpo ? rawAnas[stickIndex] : anas[stickIndex];
-        }
-        else
-#endif
-        {
-          mixsrc_t srcRaw = MIXSRC_Rud + stickIndex;
-          v = getValue(srcRaw);
-          srcRaw -= MIXSRC_CH1;
-          if (srcRaw<=MIXSRC_LAST_CH-MIXSRC_CH1 && md->destCh != srcRaw) {
-            if (dirtyChannels & ((bitfield_channels_t)1 << srcRaw) & (passDirtyChannels|~(((bitfield_channels_t) 1 << md->destCh)-1)))
-              passDirtyChannels |= (bitfield_channels_t) 1 << md->destCh;
-            if (srcRaw < md->destCh || pass > 0)
-              v = chans[srcRaw] >> 8;
-          }
-        }
-        if (!mixCondition) {
-          mixEnabled = v >> DELAY_POS_SHIFT;
-        }
-      }
 
-      bool apply_offset_and_curve = true;
-
-      //========== DELAYS ===============
-      delayval_t _swOn = swOn[i].now;
-      delayval_t _swPrev = swOn[i].prev;
-      bool swTog = (mixEnabled > _swOn+DELAY_POS_MARGIN || mixEnabled < _swOn-DELAY_POS_MARGIN);
-      if (mode==e_perout_mode_normal && swTog) {
-        if (!swOn[i].delay) _swPrev = _swOn;
-        swOn[i].delay = (mixEnabled > _swOn ? md->delayUp : md->delayDown) * (100/DELAY_STEP);
-        swOn[i].now = mixEnabled;
-        swOn[i].prev = _swPrev;
-      }
-      if (mode==e_perout_mode_normal && swOn[i].delay > 0) {
-        swOn[i].delay = max<int16_t>(0, (int16_t)swOn[i].delay - tick10ms);
-        if (!mixCondition)
-          v = _swPrev << DELAY_POS_SHIFT;
-        else if (mixEnabled)
-          continue;
-      }
-      else {
-        if (mode==e_perout_mode_normal) {
-          swOn[i].now = swOn[i].prev = mixEnabled;
-        }
-        if (!mixEnabled) {
-          if ((md->speedDown || md->speedUp) && md->mltpx!=MLTPX_REP) {
-            if (mixCondition) {
-              v = (md->mltpx == MLTPX_ADD ? 0 : RESX);
-              apply_offset_and_curve = false;
-            }
-          }
-          else if (mixCondition) {
-            continue;
-          }
-        }
-      }
+static bool isFlightModeDependentSwitch(swsrc_t swtch)
+{
+  uint8_t cs_idx = abs(swtch);
+  return (cs_idx >= SWSRC_FIRST_LOGICAL_SWITCH && cs_idx <= SWSRC_LAST_LOGICAL_SWITCH) ||
+         (cs_idx >= SWSRC_FIRST_FLIGHT_MODE && cs_idx <= SWSRC_LAST_FLIGHT_MODE);
+}
 
-      if (mode==e_perout_mode_normal && (!mixCondition || mixEnabled || swOn[i].delay)) {
-        if (md->mixWarn) lv_mixWarning |= 1 << (md->mixWarn - 1);
-#if defined(BOLD_FONT)
-        swOn[i].activeMix = true;
-#endif
-      }
+// inputs and channels excepted
+static bool isFlightModeDependentSource(mixsrc_t source, bool trimsDiffer)
+{
+  if (source >= MIXSRC_FIRST_TRIM && source <= MIXSRC_LAST_TRIM)
+    return trimsDiffer;
+  return (source >= MIXSRC_FIRST_LOGICAL_SWITCH && source <= MIXSRC_LAST_LOGICAL_SWITCH) ||
+         (source >= MIXSRC_FIRST_GVAR && source <= MIXSRC_LAST_GVAR);
+}
 
-      if (apply_offset_and_curve) {
+static bool isGVarCurve(const CurveRef & curve)
+{
+  return (curve.type == CURVE_REF_DIFF || curve.type == CURVE_REF_EXPO) && IS_GVAR_FIELD(curve.value, -100, 100);
+}
 
-        //========== TRIMS ================
-        if (!(mode & e_perout_mode_notrims)) {
-#if defined(VIRTUAL_INPUTS)
-          if (md->carryTrim == 0) {
-            v += getSourceTrimValue(md->srcRaw, v);
-          }
-#else
-          int8_t mix_trim = md->carryTrim;
-          if (mix_trim < TRIM_ON)
-            mix_trim = -mix_trim - 1;
-          else if (mix_trim == TRIM_ON && stickIndex < NUM_STICKS)
-            mix_trim = stickIndex;
-          else
-            mix_trim = -1;
-          if (mix_trim >= 0) {
-            int16_t trim = trims[mix_trim];
-            if (mix_trim == THR_STICK && g_model.throttleReversed)
-              v -= trim;
-            else
-              v += trim;
-          }
-#endif
-        }
-      }
+static bool isFlightModeMaskDifferent(uint16_t flightModes, uint8_t fm1, uint8_t fm2)
+{
+  return ((flightModes >> fm1) ^ (flightModes >> fm2)) & 1;
+}
 
-#if defined(CPUARM)
-      int32_t weight = GET_GVAR_PREC1(MD_WEIGHT(md), GV_RANGELARGE_NEG, GV_RANGELARGE, mixerCurrentFlightMode);
-      weight = calc100to256_16Bits(weight);
-#else
-      // saves 12 bytes code if done here and not together with weight; unknown reason
-      int16_t weight = GET_GVAR(MD_WEIGHT(md), GV_RANGELARGE_NEG, GV_RANGELARGE, mixerCurrentFlightMode);
-      weight = calc100to256_16Bits(weight);
-#endif
-      //========== SPEED ===============
-      // now its on input side, but without weight compensation. More like other remote controls
-      // lower weight causes slower movement
+// the inputs which value may be different in the two flight modes
+static uint32_t getFlightModeDependentInputs(uint8_t fm1, uint8_t fm2, bool trimsDiffer)
+{
+  uint32_t inputs = 0;
 
-      if (mode <= e_perout_mode_inactive_flight_mode && (md->speedUp || md->speedDown)) { // there are delay values
-#define DEL_MULT_SHIFT 8
-        // we recale to a mult 256 higher value for calculation
-        int32_t tact = act[i];
-        int16_t diff = v - (tact>>DEL_MULT_SHIFT);
-        if (diff) {
-          // open.20.fsguruh: speed is defined in % movement per second; In menu we specify the full movement (-100% to 100%) = 200% in total
-          // the unit of the stored value is the value from md->speedUp or md->speedDown divide SLOW_STEP seconds; e.g. value 4 means 4/SLOW_STEP = 2 seconds for CPU64
-          // because we get a tick each 10msec, we need 100 ticks for one second
-          // the value in md->speedXXX gives the time it should take to do a full movement from -100 to 100 therefore 200%. This equals 2048 in recalculated internal range
-          if (tick10ms || !s_mixer_first_run_done) {
-            // only if already time is passed add or substract a value according the speed configured
-            int32_t rate = (int32_t) tick10ms << (DEL_MULT_SHIFT+11);  // = DEL_MULT*2048*tick10ms
-            // rate equals a full range for one second; if less time is passed rate is accordingly smaller
-            // if one second passed, rate would be 2048 (full motion)*256(recalculated weight)*100(100 ticks needed for one second)
-            int32_t currentValue = ((int32_t) v<<DEL_MULT_SHIFT);
-            if (diff > 0) {
-              if (s_mixer_first_run_done && md->speedUp > 0) {
-                // if a speed upwards is defined recalculate the new value according configured speed; the higher the speed the smaller the add value is
-                int32_t newValue = tact+rate/((int16_t)(100/SLOW_STEP)*md->speedUp);
-                if (newValue<currentValue) currentValue = newValue; // Endposition; prevent toggling around the destination
-              }
-            }
-            else {  // if is <0 because ==0 is not possible
-              if (s_mixer_first_run_done && md->speedDown > 0) {
-                // see explanation in speedUp
-                int32_t newValue = tact-rate/((int16_t)(100/SLOW_STEP)*md->speedDown);
-                if (newValue>currentValue) currentValue = newValue; // Endposition; prevent toggling around the destination
-              }
-            }
-            act[i] = tact = currentValue;
-            // open.20.fsguruh: this implementation would save about 50 bytes code
-          } // endif tick10ms ; in case no time passed assign the old value, not the current value from source
-          v = (tact >> DEL_MULT_SHIFT);
-        }
-      }
+  for (uint8_t i=0; i<MAX_EXPOS; i++) {
+    ExpoData * ed = expoAddress(i);
+    if (!EXPO_VALID(ed)) break;
+    if (isFlightModeMaskDifferent(ed->flightModes, fm1, fm2) ||
+        isFlightModeDependentSwitch(ed->swtch) ||
+        isFlightModeDependentSource(ed->srcRaw, trimsDiffer) ||
+        IS_GVAR_FIELD(ed->weight, MIN_EXPO_WEIGHT, 100) ||
+        IS_GVAR_FIELD(ed->offset, -100, 100) ||
+        isGVarCurve(ed->curve)) {
+      inputs |= (uint32_t)1 << ed->chn;
+    }
+  }
 
-      //========== CURVES ===============
-#if defined(CPUARM)
-      if (apply_offset_and_curve && md->curve.type != CURVE_REF_DIFF && md->curve.value) {
-        v = applyCurve(v, md->curve);
-      }
-#else
-      if (apply_offset_and_curve && md->curveParam && md->curveMode == MODE_CURVE) {
-        v = applyCurve(v, md->curveParam);
-      }
-#endif
+  return inputs;
+}
 
-      //========== WEIGHT ===============
-      int32_t dv = (int32_t)v * weight;
-#if defined(CPUARM)
-      dv = div_and_round(dv, 10);
-#endif
+static bool isFlightModeDependentMixerLine(const MixData * md, uint8_t fm1, uint8_t fm2, uint32_t inputs, bool trimsDiffer)
+{
+  // delays and slow downs are only computed in the active flight mode
+  if (md->delayUp || md->delayDown || md->speedUp || md->speedDown)
+    return true;
 
-      //========== OFFSET / AFTER ===============
-      if (apply_offset_and_curve) {
-#if defined(CPUARM)
-        int32_t offset = GET_GVAR_PREC1(MD_OFFSET(md), GV_RANGELARGE_NEG, GV_RANGELARGE, mixerCurrentFlightMode);
-        if (offset) dv += div_and_round(calc100toRESX_16Bits(offset), 10) << 8;
-#else
-        int16_t offset = GET_GVAR(MD_OFFSET(md), GV_RANGELARGE_NEG, GV_RANGELARGE, mixerCurrentFlightMode);
-        if (offset) dv += int32_t(calc100toRESX_16Bits(offset)) << 8;
-#endif
-      }
+  if (isFlightModeMaskDifferent(md->flightModes, fm1, fm2) ||
+      isFlightModeDependentSwitch(md->swtch) ||
+      isFlightModeDependentSource(md->srcRaw, trimsDiffer))
+    return true;
 
-      //========== DIFFERENTIAL =========
-#if defined(CPUARM)
-      if (md->curve.type == CURVE_REF_DIFF && md->curve.value) {
-        dv = applyCurve(dv, md->curve);
-      }
+  bool isInput = (md->srcRaw >= MIXSRC_FIRST_INPUT && md->srcRaw <= MIXSRC_LAST_INPUT);
+  if (isInput && (inputs & ((uint32_t)1 << (md->srcRaw-MIXSRC_FIRST_INPUT))))
+    return true;
+
+  if (trimsDiffer && md->carryTrim == 0 && (isInput || (md->srcRaw >= MIXSRC_Rud && md->srcRaw <= MIXSRC_Ail)))
+    return true;
+
+  return IS_GVAR_FIELD(MD_WEIGHT(md), GV_RANGELARGE_NEG, GV_RANGELARGE) ||
+         IS_GVAR_FIELD(MD_OFFSET(md), GV_RANGELARGE_NEG, GV_RANGELARGE) ||
+         isGVarCurve(md->curve);
+}
+
+// mixerCurrentFlightMode is the fading flight mode, chans[] holds the active flight mode outputs
+static bitfield_channels_t evalFadingFlightModeMixes(uint8_t fm, const int16_t * activeTrims)
+{
+  uint8_t p = mixerCurrentFlightMode;
+  uint8_t count = mixerPlan.count[p];
+
+#if defined(HELI)
+  bool swash = g_model.swashR.type;
 #else
-      if (md->curveMode == MODE_DIFFERENTIAL) {
-        // @@@2 also recalculate curveParam to a 256 basis which ease the calculation later a lot
-        int16_t curveParam = calc100to256(GET_GVAR(md->curveParam, -100, 100, mixerCurrentFlightMode));
-        if (curveParam > 0 && dv < 0)
-          dv = (dv * (256 - curveParam)) >> 8;
-        else if (curveParam < 0 && dv > 0)
-          dv = (dv * (256 + curveParam)) >> 8;
-      }
+  bool swash = false;
 #endif
 
-      int32_t * ptr = &chans[md->destCh]; // Save calculating address several times
+  if (swash || count == MIXER_PLAN_MULTIPASS || mixerPlan.count[fm] == MIXER_PLAN_MULTIPASS) {
+    evalFlightModeMixes(e_perout_mode_inactive_flight_mode, 0);
+    return (bitfield_channels_t)-1;
+  }
 
-      switch (md->mltpx) {
-        case MLTPX_REP:
-          *ptr = dv;
-#if defined(BOLD_FONT)
-          if (mode==e_perout_mode_normal) {
-            for (uint8_t m=i-1; m<MAX_MIXERS && mixAddress(m)->destCh==md->destCh; m--)
-              swOn[m].activeMix = false;
-          }
-#endif
-          break;
-        case MLTPX_MUL:
-          // @@@2 we have to remove the weight factor of 256 in case of 100%; now we use the new base of 256
-          dv >>= 8;
-          dv *= *ptr;
-          dv >>= RESX_SHIFT;   // same as dv /= RESXl;
-          *ptr = dv;
-          break;
-        default: // MLTPX_ADD
-          *ptr += dv; //Mixer output add up to the line (dv + (dv>0 ? 100/2 : -100/2))/(100);
-          break;
-      } //endswitch md->mltpx
-#ifdef PREVENT_ARITHMETIC_OVERFLOW
-/*
-      // a lot of assumptions must be true, for this kind of check; not really worth for only 4 bytes flash savings
-      // this solution would save again 4 bytes flash
-      int8_t testVar=(*ptr<<1)>>24;
-      if ( (testVar!=-1) && (testVar!=0 ) ) {
-        // this devices by 64 which should give a good balance between still over 100% but lower then 32x100%; should be OK
-        *ptr >>= 6;  // this is quite tricky, reduces the value a lot but should be still over 100% and reduces flash need
-      } */
-
-
-      PACK( union u_int16int32_t {
-        struct {
-          int16_t lo;
-          int16_t hi;
-        } words_t;
-        int32_t dword;
-      });
-
-      u_int16int32_t tmp;
-      tmp.dword=*ptr;
-
-      if (tmp.dword<0) {
-        if ((tmp.words_t.hi&0xFF80)!=0xFF80) tmp.words_t.hi=0xFF86; // set to min nearly
-      }
-      else {
-        if ((tmp.words_t.hi|0x007F)!=0x007F) tmp.words_t.hi=0x0079; // set to max nearly
-      }
-      *ptr = tmp.dword;
-      // this implementation saves 18bytes flash
+  evalTrims();
+  bool trimsDiffer = memcmp(trims, activeTrims, sizeof(trims));
+  uint32_t inputs = getFlightModeDependentInputs(fm, p, trimsDiffer);
+  if (inputs) {
+    evalInputs(e_perout_mode_inactive_flight_mode);
+  }
 
-/*      dv=*ptr>>8;
-      if (dv>(32767-RESXl)) {
-        *ptr=(32767-RESXl)<<8;
-      } else if (dv<(-32767+RESXl)) {
-        *ptr=(-32767+RESXl)<<8;
-      }*/
-      // *ptr=limit( int32_t(int32_t(-1)<<23), *ptr, int32_t(int32_t(1)<<23));  // limit code cost 72 bytes
-      // *ptr=limit( int32_t((-32767+RESXl)<<8), *ptr, int32_t((32767-RESXl)<<8));  // limit code cost 80 bytes
-#endif
+  bitfield_channels_t channels = 0;
+  for (uint8_t i=0; i<MAX_MIXERS; i++) {
+    MixData * md = mixAddress(i);
+    if (md->srcRaw == 0) break;
+    if (isFlightModeDependentMixerLine(md, fm, p, inputs, trimsDiffer)) {
+      channels |= (bitfield_channels_t)1 << md->destCh;
+    }
+  }
 
-    } //endfor mixers
+  // the plan has the channels sources first, the channels using a dependent channel are found in one pass
+  const uint8_t * lines = mixerPlan.lines[p];
+  for (uint8_t n=0; n<count; n++) {
+    MixData * md = mixAddress(lines[n]);
+    if (md->srcRaw >= MIXSRC_CH1 && md->srcRaw <= MIXSRC_LAST_CH && (channels & ((bitfield_channels_t)1 << (md->srcRaw-MIXSRC_CH1)))) {
+      channels |= (bitfield_channels_t)1 << md->destCh;
+    }
+  }
 
-    tick10ms = 0;
-    dirtyChannels &= passDirtyChannels;
+  for (uint8_t ch=0; ch<MAX_OUTPUT_CHANNELS; ch++) {
+    if (channels & ((bitfield_channels_t)1 << ch)) {
+      chans[ch] = 0;
+    }
+  }
 
-  } while (++pass < 5 && dirtyChannels);
+  bitfield_channels_t passDirtyChannels = 0;
+  uint8_t lv_mixWarning = 0;
+  for (uint8_t n=0; n<count; n++) {
+    if (channels & ((bitfield_channels_t)1 << mixAddress(lines[n])->destCh)) {
+      evalMixerLine(lines[n], e_perout_mode_inactive_flight_mode, 0, (bitfield_channels_t)-1, 0, passDirtyChannels, lv_mixWarning);
+    }
+  }
 
-  mixWarning = lv_mixWarning;
+  return channels;
 }
 
-int32_t sum_chans512[MAX_OUTPUT_CHANNELS] = {0};
+// The active flight mode is evaluated once, each other fading flight mode only re-evaluates the channels which may be
+// different (lines disabled in one of the modes, GVARs, trims, logical switches, ...). Only those channels are blended
+// in sum_chans512, the returned mask. The other channels keep the active flight mode outputs in chans[].
+static bitfield_channels_t evalCrossFadeMixes(uint8_t fm, ACTIVE_PHASES_TYPE flightModesFade, const uint16_t * fp_act, uint8_t tick10ms, int32_t & weight)
+{
+  static int32_t activeChans[MAX_OUTPUT_CHANNELS];
+  static int32_t activeWeight[MAX_OUTPUT_CHANNELS];
+  static int16_t activeAnas[NUM_INPUTS];
+  static int8_t  activeInputsTrims[NUM_INPUTS];
+  static int16_t activeTrims[NUM_STICKS+NUM_AUX_TRIMS];
+
+  mixerCurrentFlightMode = fm;
+  evalFlightModeMixes(e_perout_mode_normal, tick10ms);
+
+  memcpy(activeChans, chans, sizeof(activeChans));
+  memcpy(activeAnas, anas, sizeof(activeAnas));
+  memcpy(activeInputsTrims, virtualInputsTrims, sizeof(activeInputsTrims));
+  memcpy(activeTrims, trims, sizeof(activeTrims));
+  uint8_t activeMixWarning = mixWarning;
+
+  bitfield_channels_t fadeChannels = 0;
+  weight = 0;
+
+  for (uint8_t p=0; p<MAX_FLIGHT_MODES; p++) {
+    if (flightModesFade & ((ACTIVE_PHASES_TYPE)1 << p)) {
+      weight += fp_act[p];
+      if (p != fm) {
+        mixerCurrentFlightMode = p;
+        bitfield_channels_t channels = evalFadingFlightModeMixes(fm, activeTrims);
+        for (uint8_t i=0; i<MAX_OUTPUT_CHANNELS; i++) {
+          bitfield_channels_t mask = (bitfield_channels_t)1 << i;
+          if (channels & mask) {
+            if (!(fadeChannels & mask)) {
+              sum_chans512[i] = 0;
+              activeWeight[i] = 0;
+            }
+            sum_chans512[i] += (chans[i] >> 4) * fp_act[p];
+            activeWeight[i] += fp_act[p];
+          }
+          chans[i] = activeChans[i];
+        }
+        fadeChannels |= channels;
+      }
+    }
+  }
 
+  // the active flight mode, and the fading ones where the channel didn't need to be evaluated again
+  for (uint8_t i=0; i<MAX_OUTPUT_CHANNELS; i++) {
+    if (fadeChannels & ((bitfield_channels_t)1 << i)) {
+      sum_chans512[i] += (activeChans[i] >> 4) * (weight - activeWeight[i]);
+    }
+  }
 
-#define MAX_ACT 0xffff
-uint8_t lastFlightMode = 255; // TODO reinit everything here when the model changes, no???
+  memcpy(anas, activeAnas, sizeof(activeAnas));
+  memcpy(virtualInputsTrims, activeInputsTrims, sizeof(activeInputsTrims));
+  memcpy(trims, activeTrims, sizeof(activeTrims));
+  mixWarning = activeMixWarning;
+  mixerCurrentFlightMode = fm;
 
-#if defined(CPUARM)
-tmr10ms_t flightModeTransitionTime;
-uint8_t   flightModeTransitionLast = 255;
+  return fadeChannels;
+}
 #endif
 
 void evalMixes(uint8_t tick10ms)
@@ -1068,7 +1401,11 @@ void evalMixes(uint8_t tick10ms)
 #endif
 
   int32_t weight = 0;
+  bitfield_channels_t fadeChannels = (bitfield_channels_t)-1;
   if (flightModesFade) {
+#if defined(CPUARM) && defined(VIRTUAL_INPUTS)
+    fadeChannels = evalCrossFadeMixes(fm, flightModesFade, fp_act, tick10ms, weight);
+#else
     memclear(sum_chans512, sizeof(sum_chans512));
     for (uint8_t p=0; p<MAX_FLIGHT_MODES; p++) {
       LS_RECURSIVE_EVALUATION_RESET();
@@ -1081,8 +1418,9 @@ void evalMixes(uint8_t tick10ms)
       }
       LS_RECURSIVE_EVALUATION_RESET();
     }
-    assert(weight);
     mixerCurrentFlightMode = fm;
+#endif
+    assert(weight);
   }
   else {
     mixerCurrentFlightMode = fm;
@@ -1114,7 +1452,11 @@ void evalMixes(uint8_t tick10ms)
     // at the end chans[i] = chans[i]/256 =>  -1024..1024
     // interpolate value with min/max so we get smooth motion from center to stop
     // this limits based on v original values and min=-1024, max=1024  RESX=1024
-    int32_t q = (flightModesFade ? (sum_chans512[i] / weight) << 4 : chans[i]);
+    int32_t q = chans[i];
+    if (flightModesFade) {
+      // a channel which is the same in all the fading flight modes has nothing to blend
+      q = (fadeChannels & ((bitfield_channels_t)1 << i)) ? (sum_chans512[i] / weight) << 4 : (q >> 4) << 4;
+    }
 
 #if defined(PCBSTD)
     ex_chans[i] = q >> 8;
@@ -363,22 +363,22 @@ void defaultInputs()
 #endif
 #endif
   }
-  storageDirty(EE_MODEL);
+  storageModelChanged();
 }
 #endif
 
 #if defined(TEMPLATES)
 inline void applyDefaultTemplate()
 {
-  applyTemplate(TMPL_SIMPLE_4CH); // calls storageDirty internally
+  applyTemplate(TMPL_SIMPLE_4CH); // calls storageModelChanged internally
 }
 #else
 void applyDefaultTemplate()
 {
 #if defined(VIRTUAL_INPUTS)
-  defaultInputs(); // calls storageDirty internally
+  defaultInputs(); // calls storageModelChanged internally
 #else
-  storageDirty(EE_MODEL);
+  storageModelChanged();
 #endif
 
   for (int i=0; i<NUM_STICKS; i++) {
@@ -242,6 +242,8 @@
 
 #if defined(DISK_CACHE)
   #include "disk_cache.h"
+#else
+  #define DISK_CACHE_CONSUMER(consumer)
 #endif
 
 #if defined(SIMU)
@@ -654,6 +656,9 @@ extern uint8_t flightModeTransitionLast;
 
 void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms);
 void evalMixes(uint8_t tick10ms);
+#if defined(CPUARM)
+  void invalidateMixerPlan();
+#endif
 void doMixerCalculations();
 void scheduleNextMixerCalculation(uint8_t module, uint16_t delay);
 
@@ -678,6 +683,7 @@ void logicalSwitchesReset();
 #if defined(CPUARM)
   void evalLogicalSwitches(bool isCurrentPhase=true);
   void logicalSwitchesCopyState(uint8_t src, uint8_t dst);
+  void invalidateLogicalSwitchesDependencies();
   #define LS_RECURSIVE_EVALUATION_RESET()
 #else
   #define evalLogicalSwitches(xxx)
@@ -775,6 +781,10 @@ extern uint8_t unexpectedShutdown;
 
 extern uint16_t maxMixerDuration;
 
+#if defined(CPUARM)
+extern uint16_t mixerDeadlineMisses;
+#endif
+
 #if !defined(CPUARM)
 extern uint8_t g_tmr1Latency_max;
 extern uint8_t g_tmr1Latency_min;
@@ -875,6 +885,9 @@ uint16_t isqrt32(uint32_t n);
 #if defined(CPUARM) && !defined(BOOT)
 #include "tasks_arm.h"
 extern OS_MutexID mixerMutex;
+#if defined(LOGS_BINARY)
+extern OS_MutexID logsMutex;
+#endif
 inline void pauseMixerCalculations()
 {
   CoEnterMutexSection(mixerMutex);
@@ -1015,11 +1028,15 @@ struct point_t
 point_t getPoint(uint8_t i);
 #if !defined(CURVES)
 #define LOAD_MODEL_CURVES()
+#define invalidateCurvesCache()
+#define updateCurvesCache()
 #define applyCurve(x, idx) (x)
 #elif defined(CPUARM)
 typedef CurveData CurveInfo;
 void loadCurves();
 #define LOAD_MODEL_CURVES() loadCurves()
+void invalidateCurvesCache();
+void updateCurvesCache();
 int intpol(int x, uint8_t idx);
 int applyCurve(int x, CurveRef & curve);
 int applyCustomCurve(int x, uint8_t idx);
@@ -1200,7 +1217,7 @@ void evalFunctions();
 
 #if defined(CPUARM)
 uint8_t crc8(const uint8_t * ptr, uint32_t len);
-uint16_t crc16(const uint8_t * ptr, uint32_t len);
+uint16_t crc16(const uint8_t * ptr, uint32_t len, uint16_t crc=0);
 #endif
 
 #define PLAY_REPEAT(x)            (x)                 /* Range 0 to 15 */
@@ -1344,6 +1361,7 @@ extern uint8_t requiredSpeakerVolume;
 enum MainRequest {
   REQUEST_SCREENSHOT,
   REQUEST_FLIGHT_RESET,
+  REQUEST_MODEL_CACHES_INVALIDATION,
 };
 
 extern uint8_t mainRequestFlags;
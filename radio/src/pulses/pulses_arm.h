@@ -48,7 +48,6 @@ template<class T> struct PpmPulsesData {
 PACK(struct PxxSerialPulsesData {
   uint8_t  pulses[64];
   uint8_t  * ptr;
-  uint16_t pcmValue;
   uint16_t pcmCrc;
   uint32_t pcmOnesCount;
   uint16_t serialByte;
@@ -102,41 +102,86 @@ void uartPutPcmCrc(uint8_t port)
 }
 #endif
 
-#if defined(PPM_PIN_SERIAL)
-void pxxPutPcmSerialBit(uint8_t port, uint8_t bit)
+// Each byte is sent MSB first with a 0 stuffed after five consecutive 1s.
+// pxxEncodeTable[ones][byte] holds the parts sent for a byte when the
+// previous bytes ended with a run of <ones> 1s:
+//   bits 0-9: the parts, first one in bit 0
+//   bits 10-11: the number of stuffed 0s
+//   bits 12-14: the run of 1s at the end of the byte
+#define PXX_PARTS(code)                    ((code) & 0x3FF)
+#define PXX_PARTS_COUNT(code)              (8 + (((code) >> 10) & 0x03))
+#define PXX_ONES_COUNT(code)               ((code) >> 12)
+
+constexpr uint16_t pxxEncodeByte(uint8_t byte, uint8_t ones, uint8_t bit=0, uint8_t count=0, uint16_t parts=0)
 {
-  modulePulsesData[port].pxx.serialByte >>= 1;
-  if (bit & 1) {
-    modulePulsesData[port].pxx.serialByte |= 0x80;
-  }
-  if (++modulePulsesData[port].pxx.serialBitCount >= 8) {
-    *modulePulsesData[port].pxx.ptr++ = modulePulsesData[port].pxx.serialByte;
-    modulePulsesData[port].pxx.serialBitCount = 0;
-  }
+  return bit == 8 ? (parts | ((count - 8) << 10) | (ones << 12)) :
+         !(byte & (0x80 >> bit)) ? pxxEncodeByte(byte, 0, bit+1, count+1, parts) :
+         ones == 4 ? pxxEncodeByte(byte, 0, bit+1, count+2, parts | (1 << count)) :
+         pxxEncodeByte(byte, ones+1, bit+1, count+1, parts | (1 << count));
 }
 
-// 8uS/bit 01 = 0, 001 = 1
-void pxxPutPcmPart(uint8_t port, uint8_t value)
+#define PXX_ENCODE_ROW(ones, high) \
+  pxxEncodeByte(high+0x0, ones), pxxEncodeByte(high+0x1, ones), pxxEncodeByte(high+0x2, ones), pxxEncodeByte(high+0x3, ones), \
+  pxxEncodeByte(high+0x4, ones), pxxEncodeByte(high+0x5, ones), pxxEncodeByte(high+0x6, ones), pxxEncodeByte(high+0x7, ones), \
+  pxxEncodeByte(high+0x8, ones), pxxEncodeByte(high+0x9, ones), pxxEncodeByte(high+0xA, ones), pxxEncodeByte(high+0xB, ones), \
+  pxxEncodeByte(high+0xC, ones), pxxEncodeByte(high+0xD, ones), pxxEncodeByte(high+0xE, ones), pxxEncodeByte(high+0xF, ones)
+
+#define PXX_ENCODE_ONES(ones) { \
+  PXX_ENCODE_ROW(ones, 0x00), PXX_ENCODE_ROW(ones, 0x10), PXX_ENCODE_ROW(ones, 0x20), PXX_ENCODE_ROW(ones, 0x30), \
+  PXX_ENCODE_ROW(ones, 0x40), PXX_ENCODE_ROW(ones, 0x50), PXX_ENCODE_ROW(ones, 0x60), PXX_ENCODE_ROW(ones, 0x70), \
+  PXX_ENCODE_ROW(ones, 0x80), PXX_ENCODE_ROW(ones, 0x90), PXX_ENCODE_ROW(ones, 0xA0), PXX_ENCODE_ROW(ones, 0xB0), \
+  PXX_ENCODE_ROW(ones, 0xC0), PXX_ENCODE_ROW(ones, 0xD0), PXX_ENCODE_ROW(ones, 0xE0), PXX_ENCODE_ROW(ones, 0xF0) }
+
+const uint16_t pxxEncodeTable[5][256] = {
+  PXX_ENCODE_ONES(0),
+  PXX_ENCODE_ONES(1),
+  PXX_ENCODE_ONES(2),
+  PXX_ENCODE_ONES(3),
+  PXX_ENCODE_ONES(4)
+};
+
+#if defined(PPM_PIN_SERIAL)
+// 8uS/bit 01 = 0, 001 = 1, the serial bytes are sent LSB first
+void pxxPutPcmParts(uint8_t port, uint16_t parts, uint8_t count)
 {
-  pxxPutPcmSerialBit(port, 0);
-  if (value) {
-    pxxPutPcmSerialBit(port, 0);
+  uint8_t * ptr = modulePulsesData[port].pxx.ptr;
+  uint16_t serialByte = modulePulsesData[port].pxx.serialByte;
+  uint8_t serialBitCount = modulePulsesData[port].pxx.serialBitCount;
+  for (uint8_t i=0; i<count; i++) {
+    uint8_t bit = parts & 1;
+    serialByte |= (0x02 << bit) << serialBitCount;
+    serialBitCount += 2 + bit;
+    parts >>= 1;
+    if (serialBitCount >= 8) {
+      *ptr++ = serialByte;
+      serialByte >>= 8;
+      serialBitCount -= 8;
+    }
   }
-  pxxPutPcmSerialBit(port, 1);
+  modulePulsesData[port].pxx.ptr = ptr;
+  modulePulsesData[port].pxx.serialByte = serialByte;
+  modulePulsesData[port].pxx.serialBitCount = serialBitCount;
 }
 
 void pxxPutPcmTail(uint8_t port)
 {
-  while (modulePulsesData[port].pxx.serialBitCount != 0) {
-    pxxPutPcmSerialBit(port, 1);
+  if (modulePulsesData[port].pxx.serialBitCount != 0) {
+    *modulePulsesData[port].pxx.ptr++ = modulePulsesData[port].pxx.serialByte | (0xFF << modulePulsesData[port].pxx.serialBitCount);
+    modulePulsesData[port].pxx.serialByte = 0;
+    modulePulsesData[port].pxx.serialBitCount = 0;
   }
 }
 #else
-void pxxPutPcmPart(uint8_t port, uint8_t value)
+void pxxPutPcmParts(uint8_t port, uint16_t parts, uint8_t count)
 {
-  pulse_duration_t duration = value ? 48 : 32;
-  *modulePulsesData[port].pxx.ptr++ = duration;
-  modulePulsesData[port].pxx.rest -= duration + 1;
+  pulse_duration_t * ptr = modulePulsesData[port].pxx.ptr;
+  // each part lasts 32 or 48 + 1
+  modulePulsesData[port].pxx.rest -= 33 * count + 16 * __builtin_popcount(parts);
+  for (uint8_t i=0; i<count; i++) {
+    *ptr++ = (parts & 1) ? 48 : 32;
+    parts >>= 1;
+  }
+  modulePulsesData[port].pxx.ptr = ptr;
 }
 
 void pxxPutPcmTail(uint8_t port)
@@ -146,36 +191,20 @@ void pxxPutPcmTail(uint8_t port)
 }
 #endif
 
-void pxxPutPcmBit(uint8_t port, uint8_t bit)
-{
-  if (bit) {
-    pxxPutPcmPart(port, 1);
-    if (++modulePulsesData[port].pxx.pcmOnesCount == 5) {
-      modulePulsesData[port].pxx.pcmOnesCount = 0;
-      pxxPutPcmPart(port, 0);                                // Stuff a 0 bit in
-    }
-  }
-  else {
-    pxxPutPcmPart(port, 0);
-    modulePulsesData[port].pxx.pcmOnesCount = 0;
-  }
-
-}
-
 void pxxPutPcmByte(uint8_t port, uint8_t byte)
 {
   modulePulsesData[port].pxx.pcmCrc = (modulePulsesData[port].pxx.pcmCrc<<8) ^ (CRCTable[((modulePulsesData[port].pxx.pcmCrc>>8)^byte) & 0xFF]);
-  for (uint8_t i=0; i<8; i++) {
-    pxxPutPcmBit(port, byte & 0x80);
-    byte <<= 1;
-  }
+  uint16_t code = pxxEncodeTable[modulePulsesData[port].pxx.pcmOnesCount][byte];
+  modulePulsesData[port].pxx.pcmOnesCount = PXX_ONES_COUNT(code);
+  pxxPutPcmParts(port, PXX_PARTS(code), PXX_PARTS_COUNT(code));
 }
 
 void pxxInitPcmArray(uint8_t port)
 {
   modulePulsesData[port].pxx.ptr = modulePulsesData[port].pxx.pulses;
 #if defined(PPM_PIN_SERIAL)
-  modulePulsesData[port].pxx.pcmValue = 0;
+  modulePulsesData[port].pxx.serialByte = 0;
+  modulePulsesData[port].pxx.serialBitCount = 0;
 #else
   modulePulsesData[port].pxx.rest = 18000;
 #endif
@@ -185,16 +214,9 @@ void pxxInitPcmArray(uint8_t port)
 
 void pxxPutPcmHead(uint8_t port)
 {
-  // send 7E, do not CRC
+  // send 7E, do not CRC, no bit stuffing
   // 01111110
-  pxxPutPcmPart(port, 0);
-  pxxPutPcmPart(port, 1);
-  pxxPutPcmPart(port, 1);
-  pxxPutPcmPart(port, 1);
-  pxxPutPcmPart(port, 1);
-  pxxPutPcmPart(port, 1);
-  pxxPutPcmPart(port, 1);
-  pxxPutPcmPart(port, 0);
+  pxxPutPcmParts(port, 0x7E, 8);
 }
 
 void pxxPutPcmCrc(uint8_t port)
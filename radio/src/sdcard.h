@@ -47,13 +47,26 @@
 
 #define LEN_FILE_PATH_MAX   (sizeof(SCRIPTS_TELEM_PATH)+1)  // longest + "/"
 
+// the compiled scripts cache, the simulator bytecode differs from the radio one
+#if defined(SIMU)
+  #define SCRIPTS_CACHE_INDEX SCRIPTS_PATH "/simucache.idx"
+  #define SCRIPTS_CACHE_DATA  SCRIPTS_PATH "/simucache.bin"
+#else
+  #define SCRIPTS_CACHE_INDEX SCRIPTS_PATH "/luacache.idx"
+  #define SCRIPTS_CACHE_DATA  SCRIPTS_PATH "/luacache.bin"
+#endif
+
 #if defined(COLORLCD)
 const char RADIO_MODELSLIST_PATH[] = RADIO_PATH "/models.txt";
 const char RADIO_SETTINGS_PATH[] = RADIO_PATH "/radio.bin";
 #endif
 
 #define MODELS_EXT          ".bin"
-#define LOGS_EXT            ".csv"
+#if defined(LOGS_BINARY)
+  #define LOGS_EXT          ".otl"
+#else
+  #define LOGS_EXT          ".csv"
+#endif
 #define SOUNDS_EXT          ".wav"
 #define BMP_EXT             ".bmp"
 #define PNG_EXT             ".png"
@@ -95,6 +108,9 @@ extern uint8_t logDelay;
 void logsInit();
 void logsClose();
 void logsWrite();
+#if defined(LOGS_BINARY)
+void logsFlush();
+#endif
 
 uint32_t sdGetNoSectors();
 uint32_t sdGetSize();
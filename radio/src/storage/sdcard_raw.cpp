@@ -30,6 +30,7 @@ void getModelPath(char * path, const char * filename)
 const char * writeFile(const char * filename, const uint8_t * data, uint16_t size)
 {
   TRACE("writeFile(%s)", filename);
+  DISK_CACHE_CONSUMER(DISK_CACHE_MODELS);
   
   FIL file;
   char buf[8];
@@ -71,6 +72,7 @@ const char * writeModel()
 const char * loadFile(const char * filename, uint8_t * data, uint16_t maxsize)
 {
   TRACE("loadFile(%s)", filename);
+  DISK_CACHE_CONSUMER(DISK_CACHE_MODELS);
   
   FIL file;
   char buf[8];
@@ -49,6 +49,12 @@ void storageEraseAll(bool warn);
 void storageFormat();
 void storageReadAll();
 void storageDirty(uint8_t msk);
+void storageModelChanged();
+#if defined(CPUARM)
+void invalidateModelCaches();
+#else
+#define invalidateModelCaches()
+#endif
 void storageCheck(bool immediately);
 void storageFlushCurrentModel();
 
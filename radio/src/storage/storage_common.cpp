@@ -39,6 +39,26 @@ void storageDirty(uint8_t msk)
 #endif
 }
 
+#if defined(CPUARM)
+// they are rebuilt from the model data on their next use
+void invalidateModelCaches()
+{
+  invalidateMixerPlan();
+  invalidateLogicalSwitchesDependencies();
+  invalidateTelemetrySensorsIndex();
+  invalidateCalculatedSensorsPlan();
+  invalidateCurvesCache();
+}
+#endif
+
+// an edit of the model structure (menus, templates, Lua model API). The values changed in flight
+// (trims, timers, GVARs, new sensors) only call storageDirty(EE_MODEL)
+void storageModelChanged()
+{
+  invalidateModelCaches();
+  storageDirty(EE_MODEL);
+}
+
 void preModelLoad()
 {
 #if defined(CPUARM)
@@ -86,6 +106,8 @@ void postModelLoad(bool alarms)
 
   LOAD_MODEL_CURVES();
 
+  invalidateModelCaches();
+
   resumeMixerCalculations();
   // TODO pulses should be started after mixer calculations ...
 
@@ -95,6 +117,7 @@ void postModelLoad(bool alarms)
 
 #if defined(CPUARM) && defined(SDCARD)
   referenceModelAudioFiles();
+  PRELOAD_PROMPTS();
 #endif
 
 #if defined(PCBHORUS)
@@ -54,13 +54,28 @@ PACK(typedef struct {
   int16_t lastValue;
 }) LogicalSwitchContext;
 
+typedef uint64_t bitfield_lsw_t;
+
 PACK(typedef struct {
   LogicalSwitchContext lsw[MAX_LOGICAL_SWITCHES];
+  bitfield_lsw_t pending; // tracked switches which inputs changed since their last evaluation
 }) LogicalSwitchesFlightModeContext;
 LogicalSwitchesFlightModeContext lswFm[MAX_FLIGHT_MODES];
 
 #define LS_LAST_VALUE(fm, idx) lswFm[fm].lsw[idx].lastValue
 
+// Dependency graph of the logical switches, built on the first evaluation after a model change.
+// A switch is tracked when its result only depends on other logical switches, on constants
+// (in a given flight mode context) and on its own state updated by logicalSwitchesTimerTick().
+// A tracked switch is evaluated again only when it is marked pending in the flight mode context.
+struct LogicalSwitchesDependencies {
+  bool valid;
+  bitfield_lsw_t tracked;
+  bitfield_lsw_t dependents[MAX_LOGICAL_SWITCHES]; // switches reading the state of each switch
+};
+
+static LogicalSwitchesDependencies lswDependencies;
+
 #else
 
 int16_t lsLastValue[MAX_LOGICAL_SWITCHES];
@@ -304,6 +319,67 @@ PACK(typedef struct {
   uint16_t duration:15;
 }) ls_stay_struct;
 
+#if defined(CPUARM)
+void invalidateLogicalSwitchesDependencies()
+{
+  lswDependencies.valid = false;
+}
+
+// returns false if the switch may change without any logical switch change
+static bool addLogicalSwitchDependency(uint8_t idx, swsrc_t swtch)
+{
+  uint8_t cs_idx = abs(swtch);
+
+  if (cs_idx == SWSRC_NONE || cs_idx == SWSRC_ON) {
+    return true;
+  }
+  else if (cs_idx >= SWSRC_FIRST_LOGICAL_SWITCH && cs_idx <= SWSRC_LAST_LOGICAL_SWITCH) {
+    lswDependencies.dependents[cs_idx-SWSRC_FIRST_LOGICAL_SWITCH] |= ((bitfield_lsw_t)1 << idx);
+    return true;
+  }
+  else if (cs_idx >= SWSRC_FIRST_FLIGHT_MODE && cs_idx <= SWSRC_LAST_FLIGHT_MODE) {
+    // constant inside a flight mode context
+    return true;
+  }
+  else {
+    return false;
+  }
+}
+
+static void compileLogicalSwitchesDependencies()
+{
+  memclear(&lswDependencies, sizeof(lswDependencies));
+
+  for (uint8_t idx=0; idx<MAX_LOGICAL_SWITCHES; idx++) {
+    LogicalSwitchData * ls = lswAddress(idx);
+    bool tracked = (ls->delay == 0 && ls->duration == 0);
+    if (ls->func != LS_FUNC_NONE) {
+      uint8_t family = lswFamily(ls->func);
+      if (!addLogicalSwitchDependency(idx, ls->andsw)) {
+        tracked = false;
+      }
+      if (family == LS_FAMILY_BOOL) {
+        if (!addLogicalSwitchDependency(idx, ls->v1) || !addLogicalSwitchDependency(idx, ls->v2)) {
+          tracked = false;
+        }
+      }
+      else if (family != LS_FAMILY_TIMER && family != LS_FAMILY_STICKY && family != LS_FAMILY_EDGE) {
+        tracked = false;
+      }
+    }
+    if (tracked) {
+      lswDependencies.tracked |= ((bitfield_lsw_t)1 << idx);
+    }
+  }
+
+  for (uint8_t fm=0; fm<MAX_FLIGHT_MODES; fm++) {
+    lswFm[fm].pending = (bitfield_lsw_t)-1;
+  }
+
+  lswDependencies.valid = true;
+}
+#endif
+
 bool getLogicalSwitch(uint8_t idx)
 {
   LogicalSwitchData * ls = lswAddress(idx);
@@ -636,9 +712,24 @@ bool getSwitch(swsrc_t swtch)
 */
 void evalLogicalSwitches(bool isCurrentPhase)
 {
+  if (!lswDependencies.valid) {
+    compileLogicalSwitchesDependencies();
+  }
+
+  LogicalSwitchesFlightModeContext & fmContext = lswFm[mixerCurrentFlightMode];
+
   for (unsigned int idx=0; idx<MAX_LOGICAL_SWITCHES; idx++) {
-    LogicalSwitchContext & context = lswFm[mixerCurrentFlightMode].lsw[idx];
+    bitfield_lsw_t mask = ((bitfield_lsw_t)1 << idx);
+    if ((lswDependencies.tracked & mask) && !(fmContext.pending & mask)) {
+      // inputs unchanged, keep the last result
+      continue;
+    }
+    fmContext.pending &= ~mask;
+    LogicalSwitchContext & context = fmContext.lsw[idx];
     bool result = getLogicalSwitch(idx);
+    if (result != context.state) {
+      fmContext.pending |= lswDependencies.dependents[idx];
+    }
     if (isCurrentPhase) {
       if (result) {
         if (!context.state) PLAY_LOGICAL_SWITCH_ON(idx);
@@ -958,6 +1049,9 @@ void logicalSwitchesTimerTick()
 #endif
     for (uint8_t i=0; i<MAX_LOGICAL_SWITCHES; i++) {
       LogicalSwitchData * ls = lswAddress(i);
+#if defined(CPUARM)
+      int16_t previousValue = LS_LAST_VALUE(fm, i);
+#endif
       if (ls->func == LS_FUNC_TIMER) {
         int16_t *lastValue = &LS_LAST_VALUE(fm, i);
         if (*lastValue == 0 || *lastValue == CS_LAST_VALUE_INIT) {
@@ -1023,6 +1117,10 @@ void logicalSwitchesTimerTick()
       if (context.timer) {
         context.timer--;
       }
+
+      if (LS_LAST_VALUE(fm, i) != previousValue) {
+        lswFm[fm].pending |= ((bitfield_lsw_t)1 << i);
+      }
 #endif
     }
 #if defined(CPUARM)
@@ -1074,6 +1172,7 @@ void logicalSwitchesReset()
       LS_LAST_VALUE(fm, i) = CS_LAST_VALUE_INIT;
     }
 #if defined(CPUARM)
+    lswFm[fm].pending = (bitfield_lsw_t)-1;
   }
 #endif
 }
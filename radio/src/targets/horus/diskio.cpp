@@ -125,6 +125,7 @@ DRESULT disk_read_dma(BYTE drv, BYTE * buff, DWORD sector, UINT count)
   DRESULT res;
   SD_Error Status;
   SDTransferState State;
+  DEBUG_TIMER_START(debugTimerSdRead);
   for (int retry=0; retry<3; retry++) {
     res = RES_OK;
     if (count == 1) {
@@ -152,6 +153,7 @@ DRESULT disk_read_dma(BYTE drv, BYTE * buff, DWORD sector, UINT count)
     if (res == RES_OK) break;
     sdReadRetries += 1;
   }
+  DEBUG_TIMER_STOP(debugTimerSdRead);
   return res;
 }
 
@@ -231,6 +233,7 @@ DRESULT __disk_write(
     return(res);
   }
 
+  DEBUG_TIMER_START(debugTimerSdWrite);
   if (count == 1) {
     Status = SD_WriteBlock((uint8_t *)buff, sector, BLOCK_SIZE); // 4GB Compliant
   }
@@ -254,6 +257,8 @@ DRESULT __disk_write(
     res = RES_ERROR;
   }
 
+  DEBUG_TIMER_STOP(debugTimerSdWrite);
+
   // TRACE("result=%d", res);
   return res;
 }
@@ -293,6 +298,10 @@ DRESULT disk_ioctl (
       break;
 
     case CTRL_SYNC:
+#if defined(DISK_CACHE)
+      res = diskCache.flush(drv);
+      if (res != RES_OK) break;
+#endif
       while (SD_GetStatus() == SD_TRANSFER_BUSY); /* Complete pending write process (needed at _FS_READONLY == 0) */
       res = RES_OK;
       break;
@@ -355,6 +364,9 @@ void sdDone()
     audioQueue.stopSD();
 #if defined(LOG_TELEMETRY)
     f_close(&g_telemetryFile);
+#endif
+#if defined(DISK_CACHE)
+    diskCache.flush(0);
 #endif
     f_mount(NULL, "", 0); // unmount SD
   }
@@ -302,8 +302,10 @@ extern "C" void EXTMODULE_DMA_IRQHandler()
 
 extern "C" void EXTMODULE_TIMER_IRQHandler()
 {
+  CoEnterISR(); // setupPulses() wakes the mixer task
   EXTMODULE_TIMER->DIER &= ~TIM_DIER_CC2IE; // Stop this interrupt
   EXTMODULE_TIMER->SR &= ~TIM_SR_CC2IF;
   setupPulses(EXTERNAL_MODULE);
   extmoduleSendNextFrame();
+  CoExitISR();
 }
@@ -573,10 +573,22 @@ int lcdRestoreBackupBuffer()
 
 void lcdRefresh()
 {
+  BitmapBuffer * previous = lcd;
+
   LCD_SetTransparency(255);
   if (CurrentLayer == LCD_FIRST_LAYER)
     LCD_SetLayer(LCD_SECOND_LAYER);
   else
     LCD_SetLayer(LCD_FIRST_LAYER);
   LCD_SetTransparency(0);
+
+  // the layer we will now draw on holds the frame before: it gets the areas which changed since
+  if (previous->isDamageTracked()) {
+    for (uint8_t i=0; i<previous->getDamagedRectsCount(); i++) {
+      const DamagedRect & rect = previous->getDamagedRect(i);
+      DMACopyBitmap(lcd->getData(), LCD_W, LCD_H, rect.x, rect.y, previous->getData(), LCD_W, LCD_H, rect.x, rect.y, rect.w, rect.h);
+    }
+  }
+  lcd->setSynchronized(previous->isDamageTracked());
+  previous->stopDamageTracking();
 }
@@ -262,9 +262,11 @@ extern "C" void INTMODULE_TIMER_IRQHandler()
   DEBUG_TIMER_SAMPLE(debugTimerIntPulses);
   DEBUG_TIMER_START(debugTimerIntPulsesDuration);
 
+  CoEnterISR(); // setupPulses() wakes the mixer task
   INTMODULE_TIMER->SR &= ~TIM_SR_CC2IF;           // clear flag
   setupPulses(INTERNAL_MODULE);
   intmoduleSendNextFrame();
+  CoExitISR();
   
   DEBUG_TIMER_STOP(debugTimerIntPulsesDuration);
 }
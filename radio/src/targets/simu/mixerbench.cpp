@@ -0,0 +1,327 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+// Host benchmark of the mixer hot path over real model files
+//
+// usage: mixerbench [--ticks N] [--output file.json] image...
+//   image: a radio EEPROM image (EEPROM boards) or a model file from the MODELS
+//          directory of the SD card (SD card boards). The .otx files saved by
+//          Companion are zip archives and need to be extracted first.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include "opentx.h"
+
+#define BENCH_DEFAULT_TICKS    1000000
+#define BENCH_SWITCHES_PERIOD  500 // ticks between two scripted switches moves
+
+// as in the simulator, the SIMU evalInputs() skips the calibration and takes
+// the analogs as calibrated values in [-RESX, RESX]
+int16_t benchAnalogs[NUM_STICKS+NUM_POTS+NUM_SLIDERS];
+
+uint16_t anaIn(uint8_t chan)
+{
+  return benchAnalogs[chan];
+}
+
+uint16_t getAnalogValue(uint8_t index)
+{
+  return anaIn(index);
+}
+
+enum BenchStages {
+  BENCH_STAGE_MIXES,
+  BENCH_STAGE_LOGICAL_SWITCHES,
+  BENCH_STAGE_FUNCTIONS,
+  BENCH_STAGES_COUNT
+};
+
+const char * const benchStageNames[BENCH_STAGES_COUNT] = {
+  "evalMixes",
+  "evalLogicalSwitches",
+  "evalFunctions",
+};
+
+struct BenchResult {
+  double nsPerTick;
+  uint64_t p50;
+  uint64_t p99;
+  uint64_t max;
+};
+
+struct BenchModel {
+  const char * file;
+  int index;
+  char name[LEN_MODEL_NAME+1];
+  BenchResult stages[BENCH_STAGES_COUNT];
+};
+
+static inline uint64_t benchNow()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// deterministic stick moves: a triangle with a different period on each analog
+static void benchSetInputs(uint32_t tick)
+{
+  for (int i=0; i<NUM_STICKS+NUM_POTS+NUM_SLIDERS; i++) {
+    uint32_t period = 200 + 37*i;
+    int32_t phase = (tick + 50*i) % period;
+    int32_t value = (phase < (int32_t)period/2 ? phase : period - phase) * 4 * RESX / period - RESX;
+    benchAnalogs[i] = value;
+  }
+
+  if (tick % BENCH_SWITCHES_PERIOD == 0) {
+    uint32_t step = tick / BENCH_SWITCHES_PERIOD;
+    for (int i=0; i<NUM_SWITCHES; i++) {
+      simuSetSwitch(i, (int)((step + i) % 3) - 1);
+    }
+  }
+}
+
+static void benchResetModel()
+{
+  s_mixer_first_run_done = false;
+  lastFlightMode = 255;
+  memclear(chans, sizeof(chans));
+  memclear(ex_chans, sizeof(ex_chans));
+  memclear(act, sizeof(act));
+  memclear(swOn, sizeof(swOn));
+  LOAD_MODEL_CURVES();
+  invalidateMixerPlan();
+  invalidateLogicalSwitchesDependencies();
+  logicalSwitchesReset();
+  customFunctionsReset();
+}
+
+static void benchEvalFunctions()
+{
+  if (!g_model.noGlobalFunctions) {
+    evalFunctions(g_eeGeneral.customFn, globalFunctionsContext);
+  }
+  evalFunctions(g_model.customFn, modelFunctionsContext);
+}
+
+static BenchResult benchStats(std::vector<uint64_t> & samples)
+{
+  BenchResult result;
+  uint64_t total = 0;
+  for (uint64_t sample: samples) {
+    total += sample;
+  }
+  result.nsPerTick = double(total) / samples.size();
+  std::nth_element(samples.begin(), samples.begin() + samples.size()/2, samples.end());
+  result.p50 = samples[samples.size()/2];
+  std::nth_element(samples.begin(), samples.begin() + samples.size()*99/100, samples.end());
+  result.p99 = samples[samples.size()*99/100];
+  result.max = *std::max_element(samples.begin(), samples.end());
+  return result;
+}
+
+// each stage is replayed over the same scripted inputs, with the model state reset in between
+static void benchModel(BenchModel & model, uint32_t ticks)
+{
+  std::vector<uint64_t> samples(ticks);
+
+  zchar2str(model.name, g_model.header.name, LEN_MODEL_NAME);
+
+  for (int stage=0; stage<BENCH_STAGES_COUNT; stage++) {
+    benchResetModel();
+    for (uint32_t tick=0; tick<ticks; tick++) {
+      g_tmr10ms++;
+      benchSetInputs(tick);
+      getADC();
+      getSwitchesPosition(!s_mixer_first_run_done);
+      uint64_t start;
+      switch (stage) {
+        case BENCH_STAGE_MIXES:
+          start = benchNow();
+          evalMixes(1);
+          samples[tick] = benchNow() - start;
+          break;
+        case BENCH_STAGE_LOGICAL_SWITCHES:
+          evalInputs(e_perout_mode_normal);
+          start = benchNow();
+          evalLogicalSwitches(true);
+          samples[tick] = benchNow() - start;
+          break;
+        case BENCH_STAGE_FUNCTIONS:
+          evalInputs(e_perout_mode_normal);
+          evalLogicalSwitches(true);
+          start = benchNow();
+          benchEvalFunctions();
+          samples[tick] = benchNow() - start;
+          break;
+      }
+      s_mixer_first_run_done = true;
+    }
+    model.stages[stage] = benchStats(samples);
+  }
+}
+
+static bool benchReadFile(const char * filename, std::vector<uint8_t> & data)
+{
+  FILE * f = fopen(filename, "rb");
+  if (!f) {
+    perror(filename);
+    return false;
+  }
+  fseek(f, 0, SEEK_END);
+  data.resize(ftell(f));
+  fseek(f, 0, SEEK_SET);
+  bool result = (fread(data.data(), 1, data.size(), f) == data.size());
+  fclose(f);
+  return result;
+}
+
+static bool benchLoadFile(const char * filename, uint32_t ticks, std::vector<BenchModel> & models)
+{
+  std::vector<uint8_t> data;
+  if (!benchReadFile(filename, data)) {
+    return false;
+  }
+
+#if defined(EEPROM)
+  if (data.size() > EEPROM_SIZE) {
+    fprintf(stderr, "%s: not an EEPROM image (%d bytes)\n", filename, (int)data.size());
+    return false;
+  }
+  memclear(eeprom, EEPROM_SIZE);
+  memcpy(eeprom, data.data(), data.size());
+  if (!eepromOpen() || !eeLoadGeneral()) {
+    fprintf(stderr, "%s: incompatible EEPROM image\n", filename);
+    return false;
+  }
+  for (int i=0; i<MAX_MODELS; i++) {
+    if (eeModelExists(i) && eeLoadModelData(i) >= EEPROM_MIN_MODEL_SIZE) {
+      BenchModel model;
+      model.file = filename;
+      model.index = i;
+      benchModel(model, ticks);
+      models.push_back(model);
+    }
+  }
+  return true;
+#else
+  // model file, same header check than loadFile()
+  if (data.size() < 8 || *(uint32_t *)&data[0] != OTX_FOURCC || data[4] != EEPROM_VER || data[5] != 'M') {
+    fprintf(stderr, "%s: incompatible model file\n", filename);
+    return false;
+  }
+  memclear(&g_model, sizeof(g_model));
+  memcpy(&g_model, &data[8], min<size_t>(sizeof(g_model), min<size_t>(*(uint16_t *)&data[6], data.size()-8)));
+  BenchModel model;
+  model.file = filename;
+  model.index = 0;
+  benchModel(model, ticks);
+  models.push_back(model);
+  return true;
+#endif
+}
+
+static void benchWriteJsonString(FILE * f, const char * str)
+{
+  fputc('"', f);
+  for (; *str; str++) {
+    unsigned char c = *str;
+    if (c == '"' || c == '\\')
+      fprintf(f, "\\%c", c);
+    else if (c < 0x20)
+      fprintf(f, "\\u%04x", c);
+    else
+      fputc(c, f);
+  }
+  fputc('"', f);
+}
+
+static void benchWriteJson(FILE * f, uint32_t ticks, const std::vector<BenchModel> & models)
+{
+  fprintf(f, "{\n  \"flavour\": \"%s\",\n  \"ticks\": %u,\n  \"models\": [", FLAVOUR, ticks);
+  for (unsigned i=0; i<models.size(); i++) {
+    const BenchModel & model = models[i];
+    fprintf(f, "%s\n    {\n      \"file\": ", i ? "," : "");
+    benchWriteJsonString(f, model.file);
+    fprintf(f, ",\n      \"index\": %d,\n      \"name\": ", model.index);
+    benchWriteJsonString(f, model.name);
+    fprintf(f, ",\n      \"stages\": {");
+    for (int stage=0; stage<BENCH_STAGES_COUNT; stage++) {
+      const BenchResult & result = model.stages[stage];
+      fprintf(f, "%s\n        \"%s\": { \"ns_per_tick\": %.1f, \"p50\": %llu, \"p99\": %llu, \"max\": %llu }", stage ? "," : "", benchStageNames[stage],
+              result.nsPerTick, (unsigned long long)result.p50, (unsigned long long)result.p99, (unsigned long long)result.max);
+    }
+    fprintf(f, "\n      }\n    }");
+  }
+  fprintf(f, "\n  ]\n}\n");
+}
+
+int main(int argc, char ** argv)
+{
+  uint32_t ticks = BENCH_DEFAULT_TICKS;
+  const char * output = NULL;
+  std::vector<const char *> files;
+
+  for (int i=1; i<argc; i++) {
+    if (!strcmp(argv[i], "--ticks") && i+1<argc)
+      ticks = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--output") && i+1<argc)
+      output = argv[++i];
+    else
+      files.push_back(argv[i]);
+  }
+
+  if (files.empty() || ticks == 0) {
+    fprintf(stderr, "usage: %s [--ticks N] [--output file.json] image...\n", argv[0]);
+    return 1;
+  }
+
+  simuInit();
+#if defined(EEPROM)
+  StartEepromThread(NULL);
+#endif
+  g_tmr10ms = 1;
+
+  std::vector<BenchModel> models;
+  int errors = 0;
+  for (const char * file: files) {
+    if (!benchLoadFile(file, ticks, models)) {
+      errors++;
+    }
+  }
+
+#if defined(EEPROM)
+  StopEepromThread();
+#endif
+
+  FILE * f = output ? fopen(output, "w") : stdout;
+  if (!f) {
+    perror(output);
+    return 1;
+  }
+  benchWriteJson(f, ticks, models);
+  if (output) {
+    fclose(f);
+  }
+
+  return errors ? 1 : 0;
+}
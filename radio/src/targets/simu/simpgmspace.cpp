@@ -325,6 +325,10 @@ void StartSimu(bool tests, const char * sdPath, const char * settingsPath)
 
   simuFatfsSetPaths(sdPath, settingsPath);
 
+#if defined(LUA) && defined(LUA_COMPILER) && defined(SIMU_USE_SDCARD)
+  luaPrecompileScripts();
+#endif
+
   /*
     g_tmr10ms must be non-zero otherwise some SF functions (that use this timer as a marker when it was last executed)
     will be executed twice on startup. Normal radio does not see this issue because g_tmr10ms is already a big number
@@ -366,6 +370,9 @@ void StopSimu()
 #if defined(CPUARM)
   pthread_join(mixerTaskId, NULL);
   pthread_join(menusTaskId, NULL);
+#endif
+#if defined(LOGS_BINARY)
+  pthread_join(logsTaskId, NULL);
 #endif
   pthread_join(main_thread_pid, NULL);
 }
@@ -556,6 +563,12 @@ void lcdRefresh()
 
   memcpy(simuLcdBuf, displayBuf, sizeof(simuLcdBuf));
   simuLcdRefresh = true;
+
+#if defined(COLORLCD)
+  // only one buffer here, it always holds the frame displayed
+  lcd->setSynchronized(lcd->isDamageTracked());
+  lcd->stopDamageTracking();
+#endif
 }
 
 void telemetryPortInit(uint8_t baudrate)
@@ -404,12 +404,14 @@ typedef void               (*FUNCPtr)(void*);
 
 OS_TID CoCreateTask(FUNCPtr task, void *argv, uint32_t parameter, void * stk, uint32_t stksize);
 #define CoCreateTaskEx(...)            0
+#define CoGetCurTaskID()               pthread_self()
 
 #define CoCreateMutex(...)             PTHREAD_MUTEX_INITIALIZER
 #define CoEnterMutexSection(m)         pthread_mutex_lock(&(m))
 #define CoLeaveMutexSection(m)         pthread_mutex_unlock(&(m))
 
 #define CoSetFlag(...)
+#define isr_SetFlag(...)
 #define CoClearFlag(...)
 #define CoSetTmrCnt(...)
 #define CoEnterISR(...)
@@ -470,6 +472,8 @@ inline void delay_01us(int dummy) { }
 
 #if defined(SIMU_USE_SDCARD)
   void simuFatfsSetPaths(const char * sdPath, const char * settingsPath);
+  const uint8_t * simuMapFile(const char * name, uint32_t * size);
+  void simuUnmapFile(const uint8_t * data, uint32_t size);
 #else
   #define simuFatfsSetPaths(...)
 #endif
@@ -140,7 +140,11 @@ DRESULT disk_ioctl (BYTE pdrv, BYTE cmd, void* buff)
   switch(cmd) {
 /* Generic command (Used by FatFs) */
     case CTRL_SYNC :     /* Complete pending write process (needed at _FS_READONLY == 0) */
+#if defined(DISK_CACHE)
+      return diskCache.flush(pdrv);
+#else
       break;
+#endif
 
     case GET_SECTOR_COUNT: /* Get media size (needed at _USE_MKFS == 1) */
       {
@@ -222,6 +226,9 @@ void sdDone()
     audioQueue.stopSD();
 #if defined(LOG_TELEMETRY)
     f_close(&g_telemetryFile);
+#endif
+#if defined(DISK_CACHE)
+    diskCache.flush(0);
 #endif
     f_mount(NULL, "", 0); // unmount SD
   }
@@ -49,6 +49,11 @@
   #include <utime.h>
 #endif
 
+#if !defined(_WIN32)
+  #include <sys/mman.h>
+  #include <unistd.h>
+#endif
+
 #include "ff.h"
 
 namespace simu {
@@ -563,6 +568,58 @@ FRESULT f_getfree (const TCHAR* path, DWORD* nclst, FATFS** fatfs)
   return FR_OK;
 }
 
+// maps a whole file read-only, for the files read often (the Lua scripts cache)
+const uint8_t * simuMapFile(const char * name, uint32_t * size)
+{
+  std::string path = convertToSimuPath(name);
+  std::string realPath = findTrueFileName(path);
+#if defined(_WIN32)
+  HANDLE file = CreateFileA(realPath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE) {
+    return NULL;
+  }
+  const uint8_t * result = NULL;
+  LARGE_INTEGER fileSize;
+  if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping) {
+      result = (const uint8_t *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+      CloseHandle(mapping);   // the view keeps the mapping
+    }
+  }
+  CloseHandle(file);
+  if (result) {
+    *size = (uint32_t)fileSize.QuadPart;
+  }
+#else
+  int fd = open(realPath.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return NULL;
+  }
+  const uint8_t * result = NULL;
+  struct stat tmp;
+  if (fstat(fd, &tmp) == 0 && tmp.st_size > 0) {
+    void * data = mmap(NULL, tmp.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data != MAP_FAILED) {
+      result = (const uint8_t *)data;
+      *size = tmp.st_size;
+    }
+  }
+  close(fd);
+#endif
+  TRACE_SIMPGMSPACE("simuMapFile(%s) = %p", path.c_str(), result);
+  return result;
+}
+
+void simuUnmapFile(const uint8_t * data, uint32_t size)
+{
+#if defined(_WIN32)
+  UnmapViewOfFile(data);
+#else
+  munmap((void *)data, size);
+#endif
+}
+
 #if defined(PCBSKY9X)
 int32_t Card_state = SD_ST_MOUNTED;
 uint32_t Card_CSD[4]; // TODO elsewhere
@@ -265,6 +265,8 @@ extern "C" void PWM_IRQHandler(void)
   uint32_t reason = pwmptr->PWM_ISR1;
   uint32_t period;
 
+  CoEnterISR(); // setupPulses() wakes the mixer task
+
   if (reason & PWM_ISR1_CHID3) {
     // Use the current protocol, don't switch until set_up_pulses
     switch (s_current_protocol[EXTERNAL_MODULE]) {
@@ -359,5 +361,7 @@ extern "C" void PWM_IRQHandler(void)
     }
   }
 #endif
+
+  CoExitISR();
 }
 #endif
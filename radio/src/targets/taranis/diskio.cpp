@@ -698,7 +698,9 @@ DRESULT disk_read (
 {
   if (drv || !count) return RES_PARERR;
   if (Stat & STA_NOINIT) return RES_NOTRDY;
+  DEBUG_TIMER_START(debugTimerSdRead);
   int8_t res = SD_ReadSectors(buff, sector, count);
+  DEBUG_TIMER_STOP(debugTimerSdRead);
   TRACE_SD_CARD_EVENT((res != 0), sd_disk_read, (count << 24) + (sector & 0x00FFFFFF));
   return (res != 0) ? RES_ERROR : RES_OK;
 }
@@ -772,7 +774,9 @@ DRESULT disk_write (
   if (drv || !count) return RES_PARERR;
   if (Stat & STA_NOINIT) return RES_NOTRDY;
   if (Stat & STA_PROTECT) return RES_WRPRT;
+  DEBUG_TIMER_START(debugTimerSdWrite);
   int8_t res = SD_WriteSectors(buff, sector, count);
+  DEBUG_TIMER_STOP(debugTimerSdWrite);
   TRACE_SD_CARD_EVENT((res != 0), sd_disk_write, (count << 24) + (sector & 0x00FFFFFF));
   return (res != 0) ? RES_ERROR : RES_OK;
 }
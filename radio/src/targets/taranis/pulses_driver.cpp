@@ -285,8 +285,10 @@ extern "C" void INTMODULE_DMA_IRQHandler()
 
 extern "C" void INTMODULE_TIMER_CC_IRQHandler()
 {
+  CoEnterISR(); // setupPulses() wakes the mixer task
   INTMODULE_TIMER->DIER &= ~TIM_DIER_CC2IE; // Stop this interrupt
   INTMODULE_TIMER->SR &= ~TIM_SR_CC2IF;
   setupPulses(INTERNAL_MODULE);
   intmoduleSendNextFrame();
+  CoExitISR();
 }
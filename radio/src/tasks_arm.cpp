@@ -35,6 +35,12 @@ OS_TID btTaskId;
 TaskStack<BLUETOOTH_STACK_SIZE> bluetoothStack;
 #endif
 
+#if defined(LOGS_BINARY)
+OS_TID logsTaskId;
+TaskStack<LOGS_STACK_SIZE> logsStack;
+OS_MutexID logsMutex;
+#endif
+
 OS_MutexID audioMutex;
 OS_MutexID mixerMutex;
 
@@ -44,6 +50,7 @@ enum TaskIndex {
   AUDIO_TASK_INDEX,
   CLI_TASK_INDEX,
   BLUETOOTH_TASK_INDEX,
+  LOGS_TASK_INDEX,
   TASK_INDEX_COUNT,
   MAIN_TASK_INDEX = 255
 };
@@ -74,6 +81,9 @@ void stackPaint()
   menusStack.paint();
   mixerStack.paint();
   audioStack.paint();
+#if defined(LOGS_BINARY)
+  logsStack.paint();
+#endif
 #if defined(CLI)
   cliStack.paint();
 #endif
@@ -117,7 +127,39 @@ bool isForcePowerOffRequested()
   return false;
 }
 
+#define MIXER_MAX_PERIOD_TICKS      10    // run at least every 20ms
+#define MIXER_SCHEDULE_MARGIN       1000  // 500us (2MHz ticks) for the task switch and the interrupts
+
+OS_FlagID mixerFlag;
+
+// each module builds its next pulses at nextMixerTime (OS ticks), the mixer
+// task serves this deadline when mixerServedCount catches up mixerScheduleCount
 uint32_t nextMixerTime[NUM_MODULES];
+volatile uint8_t mixerScheduleCount[NUM_MODULES];
+uint8_t mixerServedCount[NUM_MODULES];
+uint16_t mixerDeadlineMisses;
+
+// doMixerCalculations() duration estimate (2MHz ticks): EWMA of the duration
+// (x8) and of its mean deviation (x4), the same way TCP estimates its RTT
+uint32_t mixerDurationAvg8 = 3000 * 8;
+uint32_t mixerDurationDev4 = 0;
+
+void updateMixerDuration(uint16_t duration)
+{
+  int32_t error = duration - (mixerDurationAvg8 >> 3);
+  mixerDurationAvg8 += error;
+  if (error < 0) {
+    error = -error;
+  }
+  mixerDurationDev4 += error - (mixerDurationDev4 >> 2);
+}
+
+// OS ticks between the start of the mixer calculation and the deadline
+uint32_t getMixerLeadTicks()
+{
+  uint32_t lead = (mixerDurationAvg8 >> 3) + mixerDurationDev4 + MIXER_SCHEDULE_MARGIN;
+  return (lead + 3999) / 4000;
+}
 
 void mixerTask(void * pdata)
 {
@@ -135,27 +177,49 @@ void mixerTask(void * pdata)
     processSbusInput();
 #endif
 
-    CoTickDelay(1);
-
     if (isForcePowerOffRequested()) {
       pwrOff();
     }
 
     uint32_t now = CoGetOSTime();
-    bool run = false;
-    if ((now - lastRunTime) > 10) {     // run at least every 20ms
-      run = true;
-    }
-    else if (now == nextMixerTime[0]) {
-      run = true;
-    }
-#if NUM_MODULES >= 2
-    else if (now == nextMixerTime[1]) {
-      run = true;
+    uint32_t lead = getMixerLeadTicks();
+    int32_t delay = (int32_t)(lastRunTime + MIXER_MAX_PERIOD_TICKS - now);
+    uint8_t due = 0;
+    uint8_t pending = 0;
+    for (uint8_t module=0; module<NUM_MODULES; module++) {
+      if (mixerServedCount[module] != mixerScheduleCount[module]) {
+        int32_t wake = (int32_t)(nextMixerTime[module] - lead - now);
+        if (wake <= 0)
+          due |= (1 << module);
+        else if (wake <= (int32_t)lead)
+          pending |= (1 << module);
+        if (wake < delay)
+          delay = wake;
+      }
     }
+
+    if (delay > 0) {
+#if defined(PCBTARANIS)
+      if (currentTrainerMode == TRAINER_MODE_MASTER_SBUS_EXTERNAL_MODULE || currentTrainerMode == TRAINER_MODE_MASTER_BATTERY_COMPARTMENT) {
+        // the SBUS DMA fifo must be emptied every tick
+        delay = 1;
+      }
 #endif
-    if (!run) {
-      continue;  // go back to sleep
+#if defined(SIMU)
+      CoTickDelay(1);
+#else
+      // scheduleNextMixerCalculation() sets the flag when a new deadline comes
+      CoWaitForSingleFlag(mixerFlag, delay);
+#endif
+      continue;
+    }
+
+    // the deadlines close to the one which is due are served by the same calculation
+    due |= pending;
+
+    uint8_t served[NUM_MODULES];
+    for (uint8_t module=0; module<NUM_MODULES; module++) {
+      served[module] = mixerScheduleCount[module];
     }
 
     lastRunTime = now;
@@ -163,6 +227,7 @@ void mixerTask(void * pdata)
     if (!s_pulses_paused) {
       uint16_t t0 = getTmr2MHz();
 
+      DEBUG_MIXER_CYCLE_START();
       DEBUG_TIMER_START(debugTimerMixer);
       CoEnterMutexSection(mixerMutex);
       doMixerCalculations();
@@ -170,12 +235,14 @@ void mixerTask(void * pdata)
       DEBUG_TIMER_SAMPLE(debugTimerMixerIterval);
       CoLeaveMutexSection(mixerMutex);
       DEBUG_TIMER_STOP(debugTimerMixer);
+      updateMixerDuration(getTmr2MHz() - t0);
 
 #if defined(TELEMETRY_FRSKY) || defined(TELEMETRY_MAVLINK)
       DEBUG_TIMER_START(debugTimerTelemetryWakeup);
       telemetryWakeup();
       DEBUG_TIMER_STOP(debugTimerTelemetryWakeup);
 #endif
+      DEBUG_MIXER_CYCLE_STOP();
 
       if (heartbeat == HEART_WDT_CHECK) {
         wdt_reset();
@@ -185,18 +252,31 @@ void mixerTask(void * pdata)
       t0 = getTmr2MHz() - t0;
       if (t0 > maxMixerDuration) maxMixerDuration = t0 ;
     }
+
+    for (uint8_t module=0; module<NUM_MODULES; module++) {
+      if (due & (1 << module)) {
+        mixerServedCount[module] = served[module];
+      }
+    }
   }
 }
 
+// called when the pulses of a module are built, delay (ms) is the time until the next ones
+// the pulses interrupts call it between CoEnterISR() and CoExitISR(), for isr_SetFlag()
 void scheduleNextMixerCalculation(uint8_t module, uint16_t delay)
 {
-  // Schedule next mixer calculation time,
-  // for now assume mixer calculation takes 2 ms.
-  nextMixerTime[module] = (uint32_t)CoGetOSTime() + (delay)/2 - 1/*2ms*/;
+  if (!s_pulses_paused && mixerServedCount[module] != mixerScheduleCount[module]) {
+    // these pulses use the outputs calculated for the previous deadline
+    mixerDeadlineMisses++;
+  }
+  nextMixerTime[module] = (uint32_t)CoGetOSTime() + delay/2;
+  mixerScheduleCount[module]++;
+  isr_SetFlag(mixerFlag);
   DEBUG_TIMER_STOP(debugTimerMixerCalcToUsage);
 }
 
 #define MENU_TASK_PERIOD_TICKS      25    // 50ms
+#define MENU_TASK_GC_MARGIN_TICKS   1     // 2ms
 
 void menusTask(void * pdata)
 {
@@ -219,8 +299,18 @@ void menusTask(void * pdata)
     DEBUG_TIMER_START(debugTimerPerMain);
     perMain();
     DEBUG_TIMER_STOP(debugTimerPerMain);
+#if defined(DISK_CACHE)
+    diskCache.prefetch(0);
+#endif
     // TODO remove completely massstorage from sky9x firmware
     uint32_t runtime = ((uint32_t)CoGetOSTime() - start);
+#if defined(LUA)
+    // the Lua GC steps use the idle tail of the period, one tick is left to the lower priority tasks
+    if (runtime + MENU_TASK_GC_MARGIN_TICKS < MENU_TASK_PERIOD_TICKS) {
+      luaIdleGc((MENU_TASK_PERIOD_TICKS - MENU_TASK_GC_MARGIN_TICKS - runtime) * 2000);
+      runtime = ((uint32_t)CoGetOSTime() - start);
+    }
+#endif
     // deduct the thread run-time from the wait, if run-time was more than
     // desired period, then skip the wait all together
     if (runtime < MENU_TASK_PERIOD_TICKS) {
@@ -249,6 +339,9 @@ void menusTask(void * pdata)
 }
 
 extern void audioTask(void* pdata);
+#if defined(LOGS_BINARY)
+extern void logsTask(void * pdata);
+#endif
 
 void tasksStart()
 {
@@ -267,9 +360,17 @@ void tasksStart()
 #if !defined(SIMU)
   // TODO move the SIMU audio in this task
   audioTaskId = CoCreateTask(audioTask, NULL, 7, &audioStack.stack[AUDIO_STACK_SIZE-1], AUDIO_STACK_SIZE);
+#endif
+#if defined(LOGS_BINARY)
+  // below the menus priority, the SD card writes are done when the radio is idle
+  logsTaskId = CoCreateTask(logsTask, NULL, 15, &logsStack.stack[LOGS_STACK_SIZE-1], LOGS_STACK_SIZE);
 #endif
   audioMutex = CoCreateMutex();
   mixerMutex = CoCreateMutex();
+  mixerFlag = CoCreateFlag(true, false);
+#if defined(LOGS_BINARY)
+  logsMutex = CoCreateMutex();
+#endif
 
   CoStartOS();
 }
@@ -31,6 +31,7 @@ extern "C" {
 #define MIXER_STACK_SIZE       500
 #define AUDIO_STACK_SIZE       500
 #define BLUETOOTH_STACK_SIZE   500
+#define LOGS_STACK_SIZE        400
 
 #if defined(_MSC_VER)
 #define _ALIGNED(x) __declspec(align(x))
@@ -76,6 +77,11 @@ extern OS_TID btTaskId;
 extern TaskStack<BLUETOOTH_STACK_SIZE> bluetoothStack;
 #endif
 
+#if defined(LOGS_BINARY)
+extern OS_TID logsTaskId;
+extern TaskStack<LOGS_STACK_SIZE> logsStack;
+#endif
+
 void tasksStart();
 
 #endif // _TASKS_ARM_H_
@@ -198,11 +198,9 @@ void processCrossfireTelemetryFrame()
 
 #if defined(LUA)
     default:
-      if (luaInputTelemetryFifo && luaInputTelemetryFifo->hasSpace(telemetryRxBufferCount-2) ) {
-        for (uint8_t i=1; i<telemetryRxBufferCount-1; i++) {
-          // destination address and CRC are skipped
-          luaInputTelemetryFifo->push(telemetryRxBuffer[i]);
-        }
+      if (luaInputTelemetryFifo && telemetryRxBufferCount > 2) {
+        // destination address and CRC are skipped
+        luaInputTelemetryFifo->pushN(&telemetryRxBuffer[1], telemetryRxBufferCount-2);
       }
       break;
 #endif
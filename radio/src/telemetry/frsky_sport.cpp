@@ -66,15 +66,64 @@ const FrSkySportSensor sportSensors[] = {
   { 0, 0, 0, NULL, UNIT_RAW, 0 } // sentinel
 };
 
-const FrSkySportSensor * getFrSkySportSensor(uint16_t id, uint8_t subId=0)
+#define SPORT_SENSORS_COUNT          (DIM(sportSensors) - 1)
+#define SPORT_SENSORS_BUCKET_IDS     16
+#define SPORT_SENSORS_BUCKETS        (0x1000 / SPORT_SENSORS_BUCKET_IDS)
+#define SPORT_SENSORS_NO_INDEX       0xFF
+
+// the sensors ranges are chained by bucket of 16 ids, the ranges which
+// don't fit in one bucket are chained in the others list
+struct FrSkySportSensorsIndex {
+  bool valid;
+  uint8_t buckets[SPORT_SENSORS_BUCKETS];
+  uint8_t others;
+  uint8_t next[SPORT_SENSORS_COUNT];
+};
+
+static FrSkySportSensorsIndex sportSensorsIndex;
+
+static void buildFrSkySportSensorsIndex()
 {
-  const FrSkySportSensor * result = NULL;
-  for (const FrSkySportSensor * sensor = sportSensors; sensor->firstId; sensor++) {
+  memset(sportSensorsIndex.buckets, SPORT_SENSORS_NO_INDEX, sizeof(sportSensorsIndex.buckets));
+  sportSensorsIndex.others = SPORT_SENSORS_NO_INDEX;
+  for (int index=SPORT_SENSORS_COUNT-1; index>=0; index--) {
+    const FrSkySportSensor & sensor = sportSensors[index];
+    unsigned int bucket = sensor.firstId / SPORT_SENSORS_BUCKET_IDS;
+    uint8_t * first = &sportSensorsIndex.others;
+    if (bucket < SPORT_SENSORS_BUCKETS && bucket == sensor.lastId / SPORT_SENSORS_BUCKET_IDS) {
+      first = &sportSensorsIndex.buckets[bucket];
+    }
+    sportSensorsIndex.next[index] = *first;
+    *first = index;
+  }
+  sportSensorsIndex.valid = true;
+}
+
+static const FrSkySportSensor * findFrSkySportSensor(uint8_t index, uint16_t id, uint8_t subId)
+{
+  for (; index!=SPORT_SENSORS_NO_INDEX; index=sportSensorsIndex.next[index]) {
+    const FrSkySportSensor * sensor = &sportSensors[index];
     if (id >= sensor->firstId && id <= sensor->lastId && subId == sensor->subId) {
-      result = sensor;
-      break;
+      return sensor;
     }
   }
+  return NULL;
+}
+
+const FrSkySportSensor * getFrSkySportSensor(uint16_t id, uint8_t subId=0)
+{
+  if (!sportSensorsIndex.valid) {
+    buildFrSkySportSensorsIndex();
+  }
+
+  const FrSkySportSensor * result = NULL;
+  unsigned int bucket = id / SPORT_SENSORS_BUCKET_IDS;
+  if (bucket < SPORT_SENSORS_BUCKETS) {
+    result = findFrSkySportSensor(sportSensorsIndex.buckets[bucket], id, subId);
+  }
+  if (!result) {
+    result = findFrSkySportSensor(sportSensorsIndex.others, id, subId);
+  }
   return result;
 }
 
@@ -212,15 +261,13 @@ void sportProcessTelemetryPacket(const uint8_t * packet)
         }
         else if (id >= DIY_STREAM_FIRST_ID && id <= DIY_STREAM_LAST_ID) {
 #if defined(LUA)
-          if (luaInputTelemetryFifo && luaInputTelemetryFifo->hasSpace(sizeof(SportTelemetryPacket))) {
+          if (luaInputTelemetryFifo) {
             SportTelemetryPacket luaPacket;
             luaPacket.physicalId = physicalId;
             luaPacket.primId = primId;
             luaPacket.dataId = id;
             luaPacket.value = data;
-            for (uint8_t i=0; i<sizeof(SportTelemetryPacket); i++) {
-              luaInputTelemetryFifo->push(luaPacket.raw[i]);
-            }
+            luaInputTelemetryFifo->pushN(luaPacket.raw, sizeof(SportTelemetryPacket));
           }
 #endif
         }
@@ -232,15 +279,13 @@ void sportProcessTelemetryPacket(const uint8_t * packet)
   }
 #if defined(LUA)
   else if (primId == 0x32) {
-    if (luaInputTelemetryFifo && luaInputTelemetryFifo->hasSpace(sizeof(SportTelemetryPacket))) {
+    if (luaInputTelemetryFifo) {
       SportTelemetryPacket luaPacket;
       luaPacket.physicalId = physicalId;
       luaPacket.primId = primId;
       luaPacket.dataId = id;
       luaPacket.value = data;
-      for (uint8_t i=0; i<sizeof(SportTelemetryPacket); i++) {
-        luaInputTelemetryFifo->push(luaPacket.raw[i]);
-      }
+      luaInputTelemetryFifo->pushN(luaPacket.raw, sizeof(SportTelemetryPacket));
     }
   }
 #endif
@@ -38,6 +38,10 @@ TelemetryData telemetryData;
 
 #if defined(CPUARM)
 uint8_t telemetryProtocol = 255;
+
+// 10ms ticks counted by the interrupt, the calculated sensors integrate them in telemetryWakeup()
+volatile uint8_t telemetryTicks = 0;
+uint8_t telemetryTicksDone = 0;
 #endif
 
 #if defined(PCBSKY9X) && defined(REVX)
@@ -139,12 +143,19 @@ void telemetryWakeup()
 #endif
 
 #if defined(CPUARM)
-  for (int i=0; i<MAX_TELEMETRY_SENSORS; i++) {
-    const TelemetrySensor & sensor = g_model.telemetrySensors[i];
-    if (sensor.type == TELEM_TYPE_CALCULATED) {
-      telemetryItems[i].eval(sensor);
+  // the telemetry items are only updated from this task, the interrupt just counts the ticks
+  uint8_t ticks = telemetryTicks - telemetryTicksDone;
+  telemetryTicksDone += ticks;
+  while (ticks-- > 0) {
+    for (int i=0; i<MAX_TELEMETRY_SENSORS; i++) {
+      const TelemetrySensor & sensor = g_model.telemetrySensors[i];
+      if (sensor.type == TELEM_TYPE_CALCULATED) {
+        telemetryItems[i].per10ms(sensor);
+      }
     }
   }
+
+  evalCalculatedSensors();
 #endif
 
 #if defined(VARIO)
@@ -230,12 +241,7 @@ void telemetryInterrupt10ms()
   if (TELEMETRY_STREAMING()) {
     if (!TELEMETRY_OPENXSENSOR()) {
 #if defined(CPUARM)
-      for (int i=0; i<MAX_TELEMETRY_SENSORS; i++) {
-        const TelemetrySensor & sensor = g_model.telemetrySensors[i];
-        if (sensor.type == TELEM_TYPE_CALCULATED) {
-          telemetryItems[i].per10ms(sensor);
-        }
-      }
+      telemetryTicks++;
 #else
       // power calculation
       uint8_t channel = g_model.frsky.voltsSource;
@@ -110,6 +110,9 @@ PACK(struct CellValue
 });
 
 int setTelemetryValue(TelemetryProtocol protocol, uint16_t id, uint8_t subId, uint8_t instance, int32_t value, uint32_t unit, uint32_t prec);
+void invalidateTelemetrySensorsIndex();
+void invalidateCalculatedSensorsPlan();
+void evalCalculatedSensors();
 void delTelemetryIndex(uint8_t index);
 int availableTelemetryIndex();
 int lastUsedTelemetryIndex();
@@ -23,6 +23,25 @@
 TelemetryItem telemetryItems[MAX_TELEMETRY_SENSORS];
 uint8_t allowNewSensors;
 
+#if MAX_TELEMETRY_SENSORS > 32
+  #define bitfield_sensors_t uint64_t
+#else
+  #define bitfield_sensors_t uint32_t
+#endif
+
+#define SENSOR_BIT(index)   ((bitfield_sensors_t)1 << (index))
+
+// items updated since the last evaluation of the calculated sensors, only cleared by
+// evalCalculatedSensors() in the mixer task, the other writers (menus) may only add bits
+bitfield_sensors_t telemetryItemsChanged;
+
+void TelemetryItem::markChanged()
+{
+  if (this >= telemetryItems && this < telemetryItems + MAX_TELEMETRY_SENSORS) {
+    telemetryItemsChanged |= SENSOR_BIT(this - telemetryItems);
+  }
+}
+
 // TODO in maths
 uint32_t getDistFromEarthAxis(int32_t latitude)
 {
@@ -36,6 +55,9 @@ void TelemetryItem::setValue(const TelemetrySensor & sensor, int32_t val, uint32
 {
   int32_t newVal = val;
 
+  // even when no value comes out, the cells or the GPS position may change
+  markChanged();
+
   if (unit == UNIT_CELLS) {
     uint32_t data = uint32_t(newVal);
     uint8_t cellsCount = (data >> 24);
@@ -210,6 +232,7 @@ void TelemetryItem::per10ms(const TelemetrySensor & sensor)
         }
         else if (currentItem.isOld()) {
           lastReceived = TELEMETRY_VALUE_OLD;
+          markChanged();
           return;
         }
         int32_t current = convertTelemetryValue(currentItem.value, currentSensor.unit, currentSensor.prec, UNIT_AMPS, 1);
@@ -219,6 +242,7 @@ void TelemetryItem::per10ms(const TelemetrySensor & sensor)
           setValue(sensor, value+1, sensor.unit, sensor.prec);
         }
         lastReceived = now();
+        markChanged();
       }
       break;
 
@@ -390,11 +414,133 @@ void TelemetryItem::eval(const TelemetrySensor & sensor)
   }
 }
 
+// the calculated sensors in evaluation order, each one after its sources
+struct CalculatedSensorsPlan {
+  bool valid;
+  uint8_t count;
+  uint8_t order[MAX_TELEMETRY_SENSORS];
+  bitfield_sensors_t sources[MAX_TELEMETRY_SENSORS];
+  bitfield_sensors_t circular;  // evaluated on each cycle, as their sources can't be ordered
+};
+
+static CalculatedSensorsPlan calculatedSensorsPlan;
+
+void invalidateCalculatedSensorsPlan()
+{
+  calculatedSensorsPlan.valid = false;
+}
+
+static void addCalculatedSensorSource(bitfield_sensors_t & sources, int source)
+{
+  if (source > 0 && source <= MAX_TELEMETRY_SENSORS) {
+    sources |= SENSOR_BIT(source - 1);
+  }
+}
+
+static bitfield_sensors_t getCalculatedSensorSources(const TelemetrySensor & sensor)
+{
+  bitfield_sensors_t sources = 0;
+
+  switch (sensor.formula) {
+    case TELEM_FORMULA_CELL:
+      addCalculatedSensorSource(sources, sensor.cell.source);
+      break;
+
+    case TELEM_FORMULA_DIST:
+      addCalculatedSensorSource(sources, sensor.dist.gps);
+      addCalculatedSensorSource(sources, sensor.dist.alt);
+      break;
+
+    case TELEM_FORMULA_ADD:
+    case TELEM_FORMULA_AVERAGE:
+    case TELEM_FORMULA_MIN:
+    case TELEM_FORMULA_MAX:
+    case TELEM_FORMULA_MULTIPLY:
+      for (int i=0; i<(sensor.formula == TELEM_FORMULA_MULTIPLY ? 2 : 4); i++) {
+        addCalculatedSensorSource(sources, abs(sensor.calc.sources[i]));
+      }
+      break;
+
+    default:
+      // the consumption and the totalize are updated by their source
+      break;
+  }
+
+  return sources;
+}
+
+static void buildCalculatedSensorsPlan()
+{
+  CalculatedSensorsPlan & plan = calculatedSensorsPlan;
+  bitfield_sensors_t remaining = 0;
+
+  for (int i=0; i<MAX_TELEMETRY_SENSORS; i++) {
+    const TelemetrySensor & sensor = g_model.telemetrySensors[i];
+    if (sensor.type == TELEM_TYPE_CALCULATED) {
+      plan.sources[i] = getCalculatedSensorSources(sensor);
+      remaining |= SENSOR_BIT(i);
+    }
+  }
+
+  plan.count = 0;
+  plan.circular = 0;
+  while (remaining) {
+    int next = -1;
+    int first = -1;
+    for (int i=0; i<MAX_TELEMETRY_SENSORS; i++) {
+      if (remaining & SENSOR_BIT(i)) {
+        if (first < 0)
+          first = i;
+        if (!(plan.sources[i] & remaining)) {
+          next = i;
+          break;
+        }
+      }
+    }
+    if (next < 0) {
+      next = first;
+      plan.circular |= SENSOR_BIT(next);
+    }
+    plan.order[plan.count++] = next;
+    remaining &= ~SENSOR_BIT(next);
+  }
+
+  plan.valid = true;
+}
+
+// a calculated sensor is evaluated only when one of its sources changed
+void evalCalculatedSensors()
+{
+  CalculatedSensorsPlan & plan = calculatedSensorsPlan;
+  bool all = !plan.valid;
+  bitfield_sensors_t changed = telemetryItemsChanged;
+  bitfield_sensors_t evaluated = 0;
+
+  telemetryItemsChanged = 0;
+
+  if (all) {
+    buildCalculatedSensorsPlan();
+  }
+
+  for (uint8_t i=0; i<plan.count; i++) {
+    uint8_t index = plan.order[i];
+    bitfield_sensors_t bit = SENSOR_BIT(index);
+    if (all || (plan.sources[index] & changed) || (plan.circular & bit)) {
+      telemetryItems[index].eval(g_model.telemetrySensors[index]);
+      changed |= bit;
+      evaluated |= bit;
+    }
+  }
+
+  // the changes of the evaluated sensors were propagated above
+  telemetryItemsChanged &= ~evaluated;
+}
+
 void delTelemetryIndex(uint8_t index)
 {
   memclear(&g_model.telemetrySensors[index], sizeof(TelemetrySensor));
   telemetryItems[index].clear();
-  storageDirty(EE_MODEL);
+  storageModelChanged();
 }
 
 int availableTelemetryIndex()
@@ -419,11 +565,55 @@ int lastUsedTelemetryIndex()
   return -1;
 }
 
+#define TELEMETRY_SENSORS_HASH_BITS  5
+#define TELEMETRY_SENSORS_HASH_SIZE  (1 << TELEMETRY_SENSORS_HASH_BITS)
+#define TELEMETRY_SENSORS_NO_INDEX   0xFF
+
+// the custom sensors chained by hash of (id, subId), in index order. The
+// instance is checked when walking the chain, as it is ignored when
+// g_model.ignoreSensorIds is set
+struct TelemetrySensorsIndex {
+  bool valid;
+  uint8_t first[TELEMETRY_SENSORS_HASH_SIZE];
+  uint8_t next[MAX_TELEMETRY_SENSORS];
+};
+
+static TelemetrySensorsIndex telemetrySensorsIndex;
+
+void invalidateTelemetrySensorsIndex()
+{
+  telemetrySensorsIndex.valid = false;
+}
+
+static inline uint8_t getTelemetrySensorHash(uint16_t id, uint8_t subId)
+{
+  // Fibonacci hashing, the FrSky ids differ in their bits 4-11
+  return (uint16_t)((id ^ (subId << 12)) * 40503u) >> (16 - TELEMETRY_SENSORS_HASH_BITS);
+}
+
+static void buildTelemetrySensorsIndex()
+{
+  memset(telemetrySensorsIndex.first, TELEMETRY_SENSORS_NO_INDEX, sizeof(telemetrySensorsIndex.first));
+  for (int index=MAX_TELEMETRY_SENSORS-1; index>=0; index--) {
+    const TelemetrySensor & telemetrySensor = g_model.telemetrySensors[index];
+    if (telemetrySensor.type == TELEM_TYPE_CUSTOM) {
+      uint8_t hash = getTelemetrySensorHash(telemetrySensor.id, telemetrySensor.subId);
+      telemetrySensorsIndex.next[index] = telemetrySensorsIndex.first[hash];
+      telemetrySensorsIndex.first[hash] = index;
+    }
+  }
+  telemetrySensorsIndex.valid = true;
+}
+
 int setTelemetryValue(TelemetryProtocol protocol, uint16_t id, uint8_t subId, uint8_t instance, int32_t value, uint32_t unit, uint32_t prec)
 {
   bool available = false;
 
-  for (int index=0; index<MAX_TELEMETRY_SENSORS; index++) {
+  if (!telemetrySensorsIndex.valid) {
+    buildTelemetrySensorsIndex();
+  }
+
+  for (uint8_t index=telemetrySensorsIndex.first[getTelemetrySensorHash(id, subId)]; index!=TELEMETRY_SENSORS_NO_INDEX; index=telemetrySensorsIndex.next[index]) {
     TelemetrySensor & telemetrySensor = g_model.telemetrySensors[index];
     if (telemetrySensor.type == TELEM_TYPE_CUSTOM && telemetrySensor.id == id && telemetrySensor.subId == subId && (telemetrySensor.instance == instance || g_model.ignoreSensorIds)) {
       telemetryItems[index].setValue(telemetrySensor, value, unit, prec);
@@ -438,6 +628,13 @@ int setTelemetryValue(TelemetryProtocol protocol, uint16_t id, uint8_t subId, ui
 
   int index = availableTelemetryIndex();
   if (index >= 0) {
+    // the new sensor is initialized below or by the caller. Its identity is set before the
+    // index is invalidated: the mixer task may rebuild the index at any time
+    TelemetrySensor & telemetrySensor = g_model.telemetrySensors[index];
+    telemetrySensor.id = id;
+    telemetrySensor.subId = subId;
+    telemetrySensor.instance = instance;
+    invalidateTelemetrySensorsIndex();
     switch (protocol) {
 #if defined(TELEMETRY_FRSKY_SPORT)
       case TELEM_PROTO_FRSKY_SPORT:
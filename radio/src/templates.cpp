@@ -254,5 +254,5 @@ void applyTemplate(uint8_t idx)
 
     }
 
-    storageDirty(EE_MODEL);
+    storageModelChanged();
 }
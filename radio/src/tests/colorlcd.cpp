@@ -22,7 +22,10 @@
 
 #if defined(COLORLCD)
 
+#include <chrono>
+#include <vector>
 #include "colors.h"
+#include "blend.h"
 
 TEST(color, RGB)
 {
@@ -51,4 +54,101 @@ TEST(color, ARGB)
   EXPECT_EQ(ARGB(128, 30, 40, 150), (uint16_t)0x8129);
 }
 
+// the blending done before the kernels, with divides
+uint16_t referenceBlendARGB4444(uint16_t p, uint16_t q)
+{
+  uint8_t alpha = q >> 12;
+  uint8_t red = ((((q >> 8) & 0x0f) << 1) * alpha + (p >> 11) * (0x0f-alpha)) / 0x0f;
+  uint8_t green = ((((q >> 4) & 0x0f) << 2) * alpha + ((p >> 5) & 0x3f) * (0x0f-alpha)) / 0x0f;
+  uint8_t blue = ((((q >> 0) & 0x0f) << 1) * alpha + ((p >> 0) & 0x1f) * (0x0f-alpha)) / 0x0f;
+  return (red << 11) + (green << 5) + (blue << 0);
+}
+
+uint16_t referenceBlendRGB565(uint16_t p, uint16_t color, uint8_t opacity)
+{
+  uint8_t bgWeight = OPACITY_MAX - opacity;
+  RGB_SPLIT(color, red, green, blue);
+  RGB_SPLIT(p, bgRed, bgGreen, bgBlue);
+  uint16_t r = (bgRed * bgWeight + red * opacity) / OPACITY_MAX;
+  uint16_t g = (bgGreen * bgWeight + green * opacity) / OPACITY_MAX;
+  uint16_t b = (bgBlue * bgWeight + blue * opacity) / OPACITY_MAX;
+  return RGB_JOIN(r, g, b);
+}
+
+TEST(color, blendKernels)
+{
+  for (uint32_t x=0; x<65536; x++) {
+    ASSERT_EQ(divOpacity(x), x / 15);
+  }
+
+  uint16_t background[67];
+  uint16_t foreground[67];
+  uint16_t expected[67];
+  for (uint32_t i=0; i<10000; i++) {
+    for (int j=0; j<67; j++) {
+      background[j] = (i * 40503 + j * 2654435761u) >> 7;
+      foreground[j] = (i * 2654435761u + j * 40503) >> 9;
+      expected[j] = referenceBlendARGB4444(background[j], foreground[j]);
+      ASSERT_EQ(blendRGB565(background[j], foreground[j], j % 16), referenceBlendRGB565(background[j], foreground[j], j % 16));
+    }
+    // odd lengths and offsets, for the SIMD path and its tail
+    blendARGB4444(background + 1, foreground + 1, 66 - i % 8);
+    for (int j=1; j<67 - i % 8; j++) {
+      ASSERT_EQ(background[j], expected[j]);
+    }
+  }
+}
+
+TEST(color, fillAndConvertKernels)
+{
+  uint16_t buffer[11];
+  for (int offset=0; offset<2; offset++) {
+    memset(buffer, 0, sizeof(buffer));
+    fillRGB565(buffer + offset, 0x1234, 7);
+    for (int i=0; i<11; i++) {
+      EXPECT_EQ(buffer[i], (i >= offset && i < offset + 7) ? 0x1234 : 0);
+    }
+
+    uint8_t pixels[7*4];
+    for (int i=0; i<7*4; i++) {
+      pixels[i] = i * 37;
+    }
+    convertARGB8888(buffer + offset, pixels, 7, true);
+    for (int i=0; i<7; i++) {
+      EXPECT_EQ(buffer[offset + i], ARGB(pixels[i*4], pixels[i*4+1], pixels[i*4+2], pixels[i*4+3]));
+    }
+    convertARGB8888(buffer + offset, pixels, 7, false);
+    for (int i=0; i<7; i++) {
+      EXPECT_EQ(buffer[offset + i], RGB(pixels[i*4+1], pixels[i*4+2], pixels[i*4+3]));
+    }
+  }
+}
+
+// run with --gtest_also_run_disabled_tests
+TEST(color, DISABLED_blendKernelsBenchmark)
+{
+  const int count = LCD_W * LCD_H;
+  std::vector<uint16_t> background(count);
+  std::vector<uint16_t> foreground(count);
+  for (int i=0; i<count; i++) {
+    foreground[i] = i * 40503;
+  }
+
+  typedef std::chrono::high_resolution_clock Clock;
+  double reference = 0, kernel = 0;
+  for (int loop=0; loop<100; loop++) {
+    Clock::time_point start = Clock::now();
+    for (int i=0; i<count; i++) {
+      background[i] = referenceBlendARGB4444(background[i], foreground[i]);
+    }
+    Clock::time_point middle = Clock::now();
+    blendARGB4444(background.data(), foreground.data(), count);
+    Clock::time_point end = Clock::now();
+    reference += std::chrono::duration<double, std::micro>(middle - start).count();
+    kernel += std::chrono::duration<double, std::micro>(end - middle).count();
+  }
+
+  printf("ARGB4444 blend of a %dx%d screen: %.0fus before, %.0fus now\n", LCD_W, LCD_H, reference / 100, kernel / 100);
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x 
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "gtests.h"
+
+#if defined(CPUARM)
+TEST(Fifo, pushPop)
+{
+  Fifo<uint8_t, 8> fifo;
+  uint8_t value;
+
+  EXPECT_TRUE(fifo.isEmpty());
+  EXPECT_FALSE(fifo.pop(value));
+  for (int i=0; i<7; i++) {
+    EXPECT_TRUE(fifo.push(i));
+  }
+  EXPECT_TRUE(fifo.isFull());
+  EXPECT_EQ(fifo.size(), 7u);
+  EXPECT_FALSE(fifo.push(7));
+  EXPECT_EQ(fifo.getOverflows(), 1u);
+  EXPECT_EQ(fifo.getHighWater(), 7u);
+  for (int i=0; i<7; i++) {
+    EXPECT_TRUE(fifo.pop(value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_TRUE(fifo.isEmpty());
+}
+
+TEST(Fifo, bulk)
+{
+  Fifo<uint8_t, 16> fifo;
+  uint8_t data[16];
+  uint8_t result[16];
+  for (int i=0; i<16; i++) {
+    data[i] = 100 + i;
+  }
+
+  // wrap around the end of the buffer
+  for (int round=0; round<10; round++) {
+    EXPECT_TRUE(fifo.pushN(data, 11));
+    EXPECT_EQ(fifo.popN(result, 16), 11u);
+    for (int i=0; i<11; i++) {
+      EXPECT_EQ(result[i], data[i]);
+    }
+  }
+
+  // all or nothing
+  EXPECT_TRUE(fifo.pushN(data, 10));
+  EXPECT_FALSE(fifo.pushN(data, 6));
+  EXPECT_EQ(fifo.size(), 10u);
+  EXPECT_EQ(fifo.getOverflows(), 6u);
+  EXPECT_TRUE(fifo.pushN(data, 5));
+  EXPECT_TRUE(fifo.isFull());
+  EXPECT_EQ(fifo.getHighWater(), 15u);
+
+  EXPECT_EQ(fifo.popN(result, 4), 4u);
+  EXPECT_EQ(result[3], data[3]);
+  EXPECT_EQ(fifo.size(), 11u);
+}
+
+TEST(Fifo, spans)
+{
+  Fifo<uint8_t, 16> fifo;
+  uint8_t * write;
+  const uint8_t * read;
+
+  fifo.pushN((const uint8_t *)"0123456789", 10);
+  uint8_t value;
+  for (int i=0; i<8; i++) {
+    fifo.pop(value);
+  }
+
+  // 2 elements at 8..9, free space 10..15 then 0..6
+  EXPECT_EQ(fifo.writeSpan(write), 6u);
+  memcpy(write, "abcdef", 6);
+  fifo.commit(6);
+  EXPECT_EQ(fifo.writeSpan(write), 7u);
+  memcpy(write, "ghi", 3);
+  fifo.commit(3);
+  EXPECT_EQ(fifo.size(), 11u);
+
+  EXPECT_EQ(fifo.readSpan(read), 8u);
+  EXPECT_EQ(0, memcmp(read, "89abcdef", 8));
+  fifo.skip(8);
+  EXPECT_EQ(fifo.readSpan(read), 3u);
+  EXPECT_EQ(0, memcmp(read, "ghi", 3));
+  fifo.skip(3);
+  EXPECT_TRUE(fifo.isEmpty());
+  EXPECT_EQ(fifo.readSpan(read), 0u);
+}
+#endif
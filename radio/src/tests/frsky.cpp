@@ -553,4 +553,85 @@ TEST(FrSkySPORT, frskyCurrent)
   EXPECT_EQ(telemetryItems[0].valueMax, 505);
 }
 
+TEST(FrSkySPORT, sensorsLookup)
+{
+  MODEL_RESET();
+  TELEMETRY_RESET();
+  allowNewSensors = true;
+
+  // new sensors take their defaults from the S.Port sensors table
+  setTelemetryValue(TELEM_PROTO_FRSKY_SPORT, RBOX_BATT2_FIRST_ID+2, 1, 0, 100, UNIT_RAW, 0);
+  setTelemetryValue(TELEM_PROTO_FRSKY_SPORT, RSSI_ID, 0, 0, 90, UNIT_RAW, 0);
+  setTelemetryValue(TELEM_PROTO_FRSKY_SPORT, DIY_FIRST_ID+0x100, 0, 0, 12, UNIT_RAW, 0);
+  EXPECT_EQ(g_model.telemetrySensors[0].unit, UNIT_AMPS);
+  EXPECT_EQ(g_model.telemetrySensors[1].unit, UNIT_DB);
+  EXPECT_EQ(g_model.telemetrySensors[2].unit, UNIT_RAW);
+  EXPECT_EQ(telemetryItems[2].value, 12);
+
+  // sensors sharing the same id and instance
+  g_model.telemetrySensors[5] = g_model.telemetrySensors[2];
+  storageModelChanged();
+  setTelemetryValue(TELEM_PROTO_FRSKY_SPORT, DIY_FIRST_ID+0x100, 0, 0, 34, UNIT_RAW, 0);
+  EXPECT_EQ(telemetryItems[2].value, 34);
+  EXPECT_EQ(telemetryItems[5].value, 34);
+
+  // the instance is checked unless the sensors ids are ignored
+  g_model.telemetrySensors[5].instance = 3;
+  storageModelChanged();
+  setTelemetryValue(TELEM_PROTO_FRSKY_SPORT, DIY_FIRST_ID+0x100, 0, 0, 56, UNIT_RAW, 0);
+  EXPECT_EQ(telemetryItems[2].value, 56);
+  EXPECT_EQ(telemetryItems[5].value, 34);
+  g_model.ignoreSensorIds = 1;
+  setTelemetryValue(TELEM_PROTO_FRSKY_SPORT, DIY_FIRST_ID+0x100, 0, 0, 78, UNIT_RAW, 0);
+  EXPECT_EQ(telemetryItems[2].value, 78);
+  EXPECT_EQ(telemetryItems[5].value, 78);
+  g_model.ignoreSensorIds = 0;
+
+  // an edited id is found without creating a new sensor
+  g_model.telemetrySensors[5].id = DIY_FIRST_ID+0x101;
+  storageModelChanged();
+  setTelemetryValue(TELEM_PROTO_FRSKY_SPORT, DIY_FIRST_ID+0x101, 0, 3, 90, UNIT_RAW, 0);
+  EXPECT_EQ(telemetryItems[5].value, 90);
+  EXPECT_EQ(availableTelemetryIndex(), 3);
+}
+
+TEST(FrSkySPORT, calculatedSensorsOrder)
+{
+  MODEL_RESET();
+  TELEMETRY_RESET();
+  allowNewSensors = true;
+
+  setTelemetryValue(TELEM_PROTO_FRSKY_SPORT, DIY_FIRST_ID, 0, 0, 10, UNIT_RAW, 0);
+  setTelemetryValue(TELEM_PROTO_FRSKY_SPORT, DIY_FIRST_ID+1, 0, 0, 1, UNIT_RAW, 0);
+
+  // sensor 2 = sensor 3 + sensor 1 and sensor 3 = 2 * sensor 0, evaluated in the same cycle
+  g_model.telemetrySensors[2].type = TELEM_TYPE_CALCULATED;
+  g_model.telemetrySensors[2].formula = TELEM_FORMULA_ADD;
+  g_model.telemetrySensors[2].calc.sources[0] = 4;
+  g_model.telemetrySensors[2].calc.sources[1] = 2;
+  g_model.telemetrySensors[3].type = TELEM_TYPE_CALCULATED;
+  g_model.telemetrySensors[3].formula = TELEM_FORMULA_ADD;
+  g_model.telemetrySensors[3].calc.sources[0] = 1;
+  g_model.telemetrySensors[3].calc.sources[1] = 1;
+  storageModelChanged();
+  telemetryWakeup();
+  EXPECT_EQ(telemetryItems[3].value, 20);
+  EXPECT_EQ(telemetryItems[2].value, 21);
+
+  // no evaluation while the sources don't change
+  telemetryItems[2].value = 0;
+  telemetryWakeup();
+  EXPECT_EQ(telemetryItems[2].value, 0);
+
+  setTelemetryValue(TELEM_PROTO_FRSKY_SPORT, DIY_FIRST_ID, 0, 0, 15, UNIT_RAW, 0);
+  telemetryWakeup();
+  EXPECT_EQ(telemetryItems[3].value, 30);
+  EXPECT_EQ(telemetryItems[2].value, 31);
+
+  setTelemetryValue(TELEM_PROTO_FRSKY_SPORT, DIY_FIRST_ID+1, 0, 0, 2, UNIT_RAW, 0);
+  telemetryWakeup();
+  EXPECT_EQ(telemetryItems[3].value, 30);
+  EXPECT_EQ(telemetryItems[2].value, 32);
+}
+
 #endif  //#if defined(TELEMETRY_FRSKY_SPORT)
@@ -58,6 +58,7 @@ inline void MODEL_RESET()
   extern uint8_t s_mixer_first_run_done;
   s_mixer_first_run_done = false;
   lastFlightMode = 255;
+  invalidateModelCaches();
 }
 
 inline void MIXER_RESET()
@@ -89,6 +90,8 @@ inline void TELEMETRY_RESET()
   }
 #endif
   memclear(g_model.telemetrySensors, sizeof(g_model.telemetrySensors));
+  invalidateTelemetrySensorsIndex();
+  invalidateCalculatedSensorsPlan();
 #endif
 }
 
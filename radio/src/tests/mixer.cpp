@@ -407,6 +407,40 @@ TEST(Curves, LinearIntpol)
   EXPECT_EQ(applyCustomCurve(-192, 0), -192);
 }
 
+#if defined(CPUARM) && !defined(CURVES_LUT)
+TEST(Curves, CompiledSmoothCurve)
+{
+  SYSTEM_RESET();
+  MODEL_RESET();
+  MIXER_RESET();
+  modelDefault(0);
+  g_model.curves[0].type = CURVE_TYPE_CUSTOM;
+  g_model.curves[0].smooth = 1;
+  g_model.curves[0].points = 0;
+  int8_t * points = g_model.points;
+  const int8_t y[] = { -100, -20, 10, 80, 40 };
+  const int8_t x[] = { -60, -10, 55 };
+  memcpy(points, y, sizeof(y));
+  memcpy(points + 5, x, sizeof(x));
+  loadCurves();
+
+  int16_t values[2*RESX+1];
+  for (int i=-RESX; i<=RESX; i++) {
+    values[i+RESX] = applyCustomCurve(i, 0);
+  }
+
+  updateCurvesCache();
+  for (int i=-RESX; i<=RESX; i++) {
+    EXPECT_EQ(values[i+RESX], applyCustomCurve(i, 0));
+  }
+
+  points[3] = -80;
+  storageModelChanged();
+  updateCurvesCache();
+  EXPECT_EQ(calc100toRESX(-80), applyCustomCurve(calc100toRESX(55), 0));
+}
+#endif
+
 
 #if !defined(CPUARM)
 TEST(FlightModes, nullFadeOut_posFadeIn)
@@ -556,6 +590,82 @@ TEST_F(MixerTest, BlockingChannel)
   EXPECT_EQ(chans[0], 0);
 }
 
+#if defined(CPUARM)
+TEST_F(MixerTest, CascadedReversedChannels)
+{
+  // deeper than the 5 passes of the multi-pass evaluation
+  for (int i=0; i<8; i++) {
+    g_model.mixData[i].destCh = i;
+    g_model.mixData[i].srcRaw = (i == 7 ? MIXSRC_MAX : MIXSRC_CH2+i);
+    g_model.mixData[i].weight = 100;
+  }
+  evalFlightModeMixes(e_perout_mode_normal, 0);
+  for (int i=0; i<8; i++) {
+    EXPECT_EQ(chans[i], CHANNEL_MAX);
+  }
+}
+
+TEST_F(MixerTest, CascadedChannelsInactiveInFlightMode)
+{
+  // CH1 <- CH2 <- CH1 is a loop, but the line CH2 <- CH1 is not active in FM0
+  g_model.mixData[0].destCh = 0;
+  g_model.mixData[0].srcRaw = MIXSRC_CH2;
+  g_model.mixData[0].weight = 100;
+  g_model.mixData[1].destCh = 1;
+  g_model.mixData[1].srcRaw = MIXSRC_CH1;
+  g_model.mixData[1].flightModes = 0b00001;
+  g_model.mixData[1].weight = 100;
+  g_model.mixData[2].destCh = 1;
+  g_model.mixData[2].srcRaw = MIXSRC_MAX;
+  g_model.mixData[2].weight = 50;
+  evalFlightModeMixes(e_perout_mode_normal, 0);
+  EXPECT_EQ(chans[0], CHANNEL_MAX/2);
+  EXPECT_EQ(chans[1], CHANNEL_MAX/2);
+}
+
+#if defined(VIRTUAL_INPUTS)
+TEST_F(MixerTest, FadeOnlyFlightModeDependentChannels)
+{
+  g_model.flightModeData[1].swtch = SWSRC_ID1;
+  g_model.flightModeData[1].fadeIn = 15;
+  g_model.mixData[0].destCh = 0;
+  g_model.mixData[0].srcRaw = MIXSRC_MAX;
+  g_model.mixData[0].weight = 100;
+  g_model.mixData[1].destCh = 1;
+  g_model.mixData[1].srcRaw = MIXSRC_MAX;
+  g_model.mixData[1].flightModes = 0b00010; // disabled in FM1
+  g_model.mixData[1].weight = 100;
+  g_model.mixData[2].destCh = 2;
+  g_model.mixData[2].srcRaw = MIXSRC_CH2;
+  g_model.mixData[2].weight = 100;
+  lastFlightMode = 255;
+  simuSetSwitch(0, -1);
+  evalMixes(1);
+  EXPECT_EQ(mixerCurrentFlightMode, 0);
+  EXPECT_EQ(channelOutputs[1], 1024);
+  EXPECT_EQ(channelOutputs[2], 1024);
+
+  simuSetSwitch(0, 0);
+  for (int i=0; i<50; i++) {
+    evalMixes(1);
+  }
+  EXPECT_EQ(mixerCurrentFlightMode, 1);
+  EXPECT_EQ(channelOutputs[0], 1024);
+  EXPECT_GT(channelOutputs[1], 0);
+  EXPECT_LT(channelOutputs[1], 1024);
+  EXPECT_EQ(channelOutputs[2], channelOutputs[1]);
+
+  // run the mixer until the end of the fade, the fade state would otherwise affect the other tests
+  for (int i=0; i<200; i++) {
+    evalMixes(1);
+  }
+  EXPECT_EQ(channelOutputs[0], 1024);
+  EXPECT_EQ(channelOutputs[1], 0);
+  EXPECT_EQ(channelOutputs[2], 0);
+}
+#endif
+#endif
+
 TEST_F(MixerTest, RecursiveAddChannel)
 {
   g_model.mixData[0].destCh = 0;
@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <vector>
+#include "gtests.h"
+
+#if defined(CPUARM) && defined(PXX)
+void pxxInitPcmArray(uint8_t port);
+void pxxPutPcmHead(uint8_t port);
+void pxxPutPcmByte(uint8_t port, uint8_t byte);
+void pxxPutPcmCrc(uint8_t port);
+void pxxPutPcmTail(uint8_t port);
+
+// The PXX encoder as it was written before the tables, one bit at a time
+class PxxReferenceEncoder
+{
+  public:
+    PxxReferenceEncoder():
+      crc(0),
+      onesCount(0)
+#if defined(PPM_PIN_SERIAL)
+      , serialByte(0),
+      serialBitCount(0)
+#else
+      , rest(18000)
+#endif
+    {
+    }
+
+    void putHead()
+    {
+      // 01111110
+      putPart(0);
+      for (int i=0; i<6; i++) {
+        putPart(1);
+      }
+      putPart(0);
+    }
+
+    void putByte(uint8_t byte)
+    {
+      crc = (crc<<8) ^ (CRCTable[((crc>>8)^byte) & 0xFF]);
+      for (int i=0; i<8; i++) {
+        putBit(byte & 0x80);
+        byte <<= 1;
+      }
+    }
+
+    void putCrc()
+    {
+      uint16_t value = crc;
+      putByte(value >> 8);
+      putByte(value);
+    }
+
+#if defined(PPM_PIN_SERIAL)
+    void putTail()
+    {
+      while (serialBitCount != 0) {
+        putSerialBit(1);
+      }
+    }
+
+    std::vector<uint8_t> output;
+#else
+    void putTail()
+    {
+      output.back() += rest;
+    }
+
+    std::vector<pulse_duration_t> output;
+#endif
+
+  protected:
+    void putBit(uint8_t bit)
+    {
+      if (bit) {
+        putPart(1);
+        if (++onesCount == 5) {
+          onesCount = 0;
+          putPart(0);
+        }
+      }
+      else {
+        putPart(0);
+        onesCount = 0;
+      }
+    }
+
+#if defined(PPM_PIN_SERIAL)
+    void putSerialBit(uint8_t bit)
+    {
+      serialByte >>= 1;
+      if (bit & 1) {
+        serialByte |= 0x80;
+      }
+      if (++serialBitCount >= 8) {
+        output.push_back(serialByte);
+        serialBitCount = 0;
+      }
+    }
+
+    void putPart(uint8_t value)
+    {
+      putSerialBit(0);
+      if (value) {
+        putSerialBit(0);
+      }
+      putSerialBit(1);
+    }
+#else
+    void putPart(uint8_t value)
+    {
+      pulse_duration_t duration = value ? 48 : 32;
+      output.push_back(duration);
+      rest -= duration + 1;
+    }
+#endif
+
+    uint16_t crc;
+    uint8_t onesCount;
+#if defined(PPM_PIN_SERIAL)
+    uint8_t serialByte;
+    uint8_t serialBitCount;
+#else
+    uint16_t rest;
+#endif
+};
+
+#define EXPECT_PXX_OUTPUT(reference, port) do { \
+  ASSERT_EQ(reference.output.size(), (size_t)(modulePulsesData[port].pxx.ptr - modulePulsesData[port].pxx.pulses)); \
+  for (unsigned i=0; i<reference.output.size(); i++) { \
+    ASSERT_EQ(reference.output[i], modulePulsesData[port].pxx.pulses[i]) << "at " << i; \
+  } \
+} while (0)
+
+TEST(Pxx, encodeBytePairs)
+{
+  // all the bytes after all the runs of 1s a previous byte can leave
+  for (int first=0; first<256; first++) {
+    for (int second=0; second<256; second++) {
+      PxxReferenceEncoder reference;
+      reference.putHead();
+      reference.putByte(first);
+      reference.putByte(second);
+      reference.putCrc();
+      reference.putHead();
+      reference.putTail();
+
+      pxxInitPcmArray(EXTERNAL_MODULE);
+      pxxPutPcmHead(EXTERNAL_MODULE);
+      pxxPutPcmByte(EXTERNAL_MODULE, first);
+      pxxPutPcmByte(EXTERNAL_MODULE, second);
+      pxxPutPcmCrc(EXTERNAL_MODULE);
+      pxxPutPcmHead(EXTERNAL_MODULE);
+      pxxPutPcmTail(EXTERNAL_MODULE);
+
+      EXPECT_PXX_OUTPUT(reference, EXTERNAL_MODULE);
+    }
+  }
+}
+
+TEST(Pxx, setupPulsesAllChannelValues)
+{
+  MODEL_RESET();
+  moduleFlag[EXTERNAL_MODULE] = MODULE_NORMAL_MODE;
+  g_model.header.modelId[EXTERNAL_MODULE] = 0x7E;
+  g_model.moduleData[EXTERNAL_MODULE].rfProtocol = 1;
+
+  for (int value=-1536; value<=1536; value++) {
+    for (int ch=0; ch<MAX_OUTPUT_CHANNELS; ch++) {
+      channelOutputs[ch] = value;
+    }
+
+    PxxReferenceEncoder reference;
+    reference.putHead();
+    reference.putByte(0x7E);
+    reference.putByte(1 << 6);
+    reference.putByte(0);
+    uint16_t pulseValue = limit(1, (value * 512 / 682) + 1024, 2046);
+    for (int i=0; i<4; i++) {
+      reference.putByte(pulseValue);
+      reference.putByte(((pulseValue >> 8) & 0x0F) | (pulseValue << 4));
+      reference.putByte(pulseValue >> 4);
+    }
+#if defined(PCBHORUS)
+    reference.putByte(XJT_INTERNAL_ANTENNA);
+#else
+    reference.putByte(0);
+#endif
+    reference.putCrc();
+    reference.putHead();
+    reference.putTail();
+
+    setupPulsesPXX(EXTERNAL_MODULE);
+
+    EXPECT_PXX_OUTPUT(reference, EXTERNAL_MODULE);
+  }
+}
+#endif
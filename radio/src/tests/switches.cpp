@@ -91,6 +91,42 @@ TEST(getSwitch, OldTypeStickyCSW)
   EXPECT_EQ(getSwitch(SWSRC_SW1), false);
   EXPECT_EQ(getSwitch(SWSRC_SW2), false);
 }
+
+TEST(evalLogicalSwitches, chainedSwitches)
+{
+  MODEL_RESET();
+  MIXER_RESET();
+
+  setLogicalSwitch(0, LS_FUNC_AND, SWSRC_SA0, SWSRC_NONE);
+  setLogicalSwitch(1, LS_FUNC_AND, SWSRC_SW1, SWSRC_ON);
+  setLogicalSwitch(2, LS_FUNC_OR, -SWSRC_SW2, SWSRC_SW4); // L4 is read from the previous evaluation
+  setLogicalSwitch(3, LS_FUNC_AND, SWSRC_SW2, SWSRC_NONE);
+
+  simuSetSwitch(0, 0);
+  evalLogicalSwitches();
+  EXPECT_EQ(getSwitch(SWSRC_SW2), false);
+  EXPECT_EQ(getSwitch(SWSRC_SW3), true);
+  EXPECT_EQ(getSwitch(SWSRC_SW4), false);
+
+  simuSetSwitch(0, -1);
+  evalLogicalSwitches();
+  EXPECT_EQ(getSwitch(SWSRC_SW2), true);
+  EXPECT_EQ(getSwitch(SWSRC_SW3), false);
+  EXPECT_EQ(getSwitch(SWSRC_SW4), true);
+
+  // no input change, L3 still has to see the new L4 state
+  evalLogicalSwitches();
+  EXPECT_EQ(getSwitch(SWSRC_SW2), true);
+  EXPECT_EQ(getSwitch(SWSRC_SW3), true);
+  EXPECT_EQ(getSwitch(SWSRC_SW4), true);
+
+  // a model change rebuilds the dependencies
+  setLogicalSwitch(1, LS_FUNC_AND, -SWSRC_SW1, SWSRC_ON);
+  storageModelChanged();
+  evalLogicalSwitches();
+  EXPECT_EQ(getSwitch(SWSRC_SW2), false);
+  EXPECT_EQ(getSwitch(SWSRC_SW4), false);
+}
 #endif
 
 TEST(getSwitch, nullSW)
@@ -0,0 +1,205 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+# This program converts the binary telemetry logs (.otl files, firmware built
+# with the LOGS_BINARY cmake option ON) to the CSV format written by the other firmwares
+#
+# usage: otl2csv.py log.otl [log.csv]
+
+from __future__ import division, print_function
+
+import sys
+import argparse
+import datetime
+
+
+MAGIC = b'OTXL'
+HEADER_TAG = ord('O')
+VERSION = 1
+
+FLAG_RTC = 0x01
+
+RECORD_KEY = 0x01
+RECORD_DELTA = 0x02
+
+COLUMN_VALUE = 0
+COLUMN_GPS = 1
+COLUMN_DATETIME = 2
+COLUMN_BITS64 = 3
+
+
+class Column:
+    def __init__(self, type, prec, label):
+        self.type = type
+        self.prec = prec
+        self.label = label
+
+    def valuesCount(self):
+        return 1 if self.type == COLUMN_VALUE else 2
+
+    def format(self, values):
+        if self.type == COLUMN_GPS:
+            if values[0] == 0 or values[1] == 0:
+                return ""
+            return "%s %s" % (formatValue(values[0], 6), formatValue(values[1], 6))
+        elif self.type == COLUMN_DATETIME:
+            date, time = values
+            return "%04d-%02d-%02d %02d:%02d:%02d" % (date // 10000, date // 100 % 100, date % 100,
+                                                    time // 10000, time // 100 % 100, time % 100)
+        elif self.type == COLUMN_BITS64:
+            return "0x%08X%08X" % (values[0] & 0xFFFFFFFF, values[1] & 0xFFFFFFFF)
+        else:
+            return formatValue(values[0], self.prec)
+
+
+def formatValue(value, prec):
+    if prec == 0:
+        return "%d" % value
+    divisor = 10 ** prec
+    return "%s%d.%0*d" % ("-" if value < 0 else "", abs(value) // divisor, prec, abs(value) % divisor)
+
+
+def toInt32(value):
+    value &= 0xFFFFFFFF
+    return value - 0x100000000 if value & 0x80000000 else value
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = bytearray(data)
+        self.offset = 0
+
+    def atEnd(self):
+        return self.offset >= len(self.data)
+
+    def byte(self):
+        value = self.data[self.offset]
+        self.offset += 1
+        return value
+
+    def bytes(self, count):
+        if self.offset + count > len(self.data):
+            raise IndexError()
+        value = bytes(self.data[self.offset:self.offset + count])
+        self.offset += count
+        return value
+
+    def varint(self):
+        value = 0
+        shift = 0
+        while True:
+            byte = self.byte()
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if byte < 0x80:
+                return value
+
+    def signed(self):
+        value = self.varint()
+        return toInt32((value >> 1) ^ -(value & 1))
+
+
+class Session:
+    def __init__(self, flags, period, columns):
+        self.flags = flags
+        self.period = period
+        self.columns = columns
+        self.valuesCount = sum(column.valuesCount() for column in columns)
+
+    def header(self):
+        time = "Date,Time" if self.flags & FLAG_RTC else "Time"
+        return ",".join([time] + [column.label for column in self.columns])
+
+
+def readHeader(reader):
+    if reader.bytes(len(MAGIC)) != MAGIC:
+        raise ValueError("bad header at offset %d" % reader.offset)
+    version = reader.byte()
+    if version != VERSION:
+        raise ValueError("unsupported log version %d" % version)
+    flags = reader.byte()
+    period = reader.byte() + (reader.byte() << 8)
+    columns = []
+    for i in range(reader.byte()):
+        type = reader.byte()
+        prec = reader.byte()
+        label = reader.bytes(reader.byte()).decode('latin-1')
+        columns.append(Column(type, prec, label))
+    return Session(flags, period, columns)
+
+
+def formatTime(session, seconds, hundredths):
+    if session.flags & FLAG_RTC:
+        t = datetime.datetime(1970, 1, 1) + datetime.timedelta(seconds=seconds)
+        return "%s,%s.%02d0" % (t.strftime("%Y-%m-%d"), t.strftime("%H:%M:%S"), hundredths)
+    return "%d" % (seconds * 100 + hundredths)
+
+
+def convert(data, output):
+    reader = Reader(data)
+    session = None
+    values = []
+    seconds = hundredths = 0
+    records = 0
+    try:
+        while not reader.atEnd():
+            offset = reader.offset
+            tag = reader.byte()
+            if tag == HEADER_TAG:
+                reader.offset = offset
+                session = readHeader(reader)
+                values = [0] * session.valuesCount
+                output.write(session.header() + "\n")
+                continue
+            if session is None:
+                raise ValueError("record without header at offset %d" % offset)
+            if tag == RECORD_KEY:
+                seconds = reader.varint()
+                hundredths = reader.varint()
+                values = [reader.signed() for i in range(session.valuesCount)]
+            elif tag == RECORD_DELTA:
+                elapsed = hundredths + reader.varint()
+                seconds += elapsed // 100
+                hundredths = elapsed % 100
+                bitmap = reader.bytes((session.valuesCount + 7) // 8)
+                for i in range(session.valuesCount):
+                    if bytearray(bitmap)[i // 8] & (1 << (i % 8)):
+                        values[i] = toInt32(values[i] + reader.signed())
+            else:
+                raise ValueError("bad record type %d at offset %d" % (tag, offset))
+            fields = [formatTime(session, seconds, hundredths)]
+            index = 0
+            for column in session.columns:
+                count = column.valuesCount()
+                fields.append(column.format(values[index:index + count]))
+                index += count
+            output.write(",".join(fields) + "\n")
+            records += 1
+    except IndexError:
+        print("truncated log, the last record is lost", file=sys.stderr)
+    return records
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Converts an OpenTX binary log to CSV")
+    parser.add_argument('input', help="binary log (.otl)")
+    parser.add_argument('output', nargs='?', help="CSV file (default: stdout)")
+    args = parser.parse_args()
+
+    with open(args.input, 'rb') as f:
+        data = f.read()
+
+    output = open(args.output, 'w') if args.output else sys.stdout
+    try:
+        convert(data, output)
+    except ValueError as e:
+        print("%s: %s" % (args.input, e), file=sys.stderr)
+        return 1
+    finally:
+        if args.output:
+            output.close()
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,151 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+# This program decodes the binary profile sent by the "profile dump" CLI
+# command (firmware built with DEBUG_TIMERS=YES)
+#
+# usage: profile-decode.py [--folded] capture.bin
+#   --folded: output the mixer cycles as folded stacks for flamegraph.pl
+
+from __future__ import division, print_function
+
+import sys
+import struct
+import argparse
+
+
+MAGIC = b'OTXP'
+VERSION = 1
+
+
+class Timer:
+    def __init__(self, name, min, max, last, histogram):
+        self.name = name
+        self.min = min
+        self.max = max
+        self.last = last
+        self.histogram = histogram
+
+    def count(self):
+        return sum(self.histogram)
+
+    def percentile(self, p):
+        # upper bound (us) of the histogram bin holding the percentile
+        total = self.count()
+        if total == 0:
+            return 0
+        acc = 0
+        for bin, value in enumerate(self.histogram):
+            acc += value
+            if acc * 100 >= total * p:
+                return (2 << bin) - 1
+        return (2 << len(self.histogram)) - 1
+
+
+class Reader:
+    def __init__(self, data, offset):
+        self.data = data
+        self.offset = offset
+
+    def read(self, fmt):
+        values = struct.unpack_from('<' + fmt, self.data, self.offset)
+        self.offset += struct.calcsize('<' + fmt)
+        return values
+
+
+def decode(data, offset):
+    reader = Reader(data, offset + len(MAGIC))
+    version, timersCount, histogramSize, stagesCount, cyclesCount = reader.read('BBBBH')
+    if version != VERSION:
+        raise ValueError("unsupported profile version %d" % version)
+
+    timers = []
+    for i in range(timersCount):
+        length, = reader.read('B')
+        name = reader.data[reader.offset:reader.offset + length].decode('ascii').strip()
+        reader.offset += length
+        min, max, last = reader.read('III')
+        histogram = reader.read('%dH' % histogramSize)
+        timers.append(Timer(name, min, max, last, histogram))
+
+    stages = reader.read('%dB' % stagesCount)
+
+    cycles = []
+    for i in range(cyclesCount):
+        values = reader.read('%dH' % (3 + stagesCount))
+        if values[2] != 0:
+            cycles.append(values)
+
+    expected = sum(bytearray(data[offset:reader.offset])) & 0xFFFF
+    checksum, = reader.read('H')
+    if checksum != expected:
+        raise ValueError("bad checksum (%04x instead of %04x)" % (checksum, expected))
+
+    return timers, stages, cycles
+
+
+def printTimers(timers):
+    print("%-12s %8s %8s %8s %8s %8s %8s" % ("timer", "count", "min", "max", "last", "p50<", "p99<"))
+    for timer in timers:
+        if timer.count() == 0:
+            continue
+        print("%-12s %8d %8d %8d %8d %8d %8d" % (timer.name, timer.count(), timer.min, timer.max, timer.last,
+                                                timer.percentile(50), timer.percentile(99)))
+        print("%-12s %s" % ("", " ".join("%d" % value for value in timer.histogram)))
+
+
+def printCycles(timers, stages, cycles):
+    if len(cycles) < 2:
+        print("not enough mixer cycles")
+        return
+    # the 2MHz timer is 16 bits, it wraps every 32ms
+    intervals = [((cycles[i][1] - cycles[i-1][1]) & 0xFFFF) / 2 for i in range(1, len(cycles))]
+    average = sum(intervals) / len(intervals)
+    jitter = max(abs(interval - average) for interval in intervals)
+    durations = [cycle[2] / 2 for cycle in cycles]
+    print("mixer cycles: %d, interval avg %.1fus min %.1fus max %.1fus jitter %.1fus" % (len(cycles), average, min(intervals), max(intervals), jitter))
+    print("mixer duration: avg %.1fus max %.1fus" % (sum(durations) / len(durations), max(durations)))
+    for i, stage in enumerate(stages):
+        values = [cycle[3 + i] for cycle in cycles]
+        print("  %-12s avg %.1fus max %dus" % (timers[stage].name, sum(values) / len(values), max(values)))
+
+
+def printFolded(timers, stages, cycles):
+    totals = [0] * len(stages)
+    other = 0
+    for cycle in cycles:
+        duration = cycle[2] // 2
+        for i in range(len(stages)):
+            totals[i] += cycle[3 + i]
+        other += max(0, duration - sum(cycle[3:]))
+    for i, stage in enumerate(stages):
+        print("mixer;%s %d" % (timers[stage].name.replace(' ', '_'), totals[i]))
+    print("mixer;other %d" % other)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decodes an OpenTX profile dump")
+    parser.add_argument('file', help="serial capture of the \"profile dump\" command")
+    parser.add_argument('--folded', action='store_true', help="output folded stacks for flamegraph.pl")
+    args = parser.parse_args()
+
+    with open(args.file, 'rb') as f:
+        data = f.read()
+
+    offset = data.find(MAGIC)
+    if offset < 0:
+        print("no profile found in %s" % args.file, file=sys.stderr)
+        return 1
+
+    timers, stages, cycles = decode(data, offset)
+    if args.folded:
+        printFolded(timers, stages, cycles)
+    else:
+        printTimers(timers)
+        print()
+        printCycles(timers, stages, cycles)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())